@@ -0,0 +1,123 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cost_report.h"
+
+#include <set>
+#include <utility>
+
+#include "libshaderc_util/json.h"
+
+namespace {
+
+using shaderc_util::JsonValue;
+using shaderc_util::ParseJson;
+
+// Collects the metrics of a cost report object into *metrics.  Returns false
+// if the value is not such an object.
+bool GetCostMetrics(const JsonValue& report, glslc::CostMetrics* metrics) {
+  const JsonValue* entry_points = report.Find("entry_points");
+  if (report.kind != JsonValue::Kind::Object || !entry_points ||
+      entry_points->kind != JsonValue::Kind::Array) {
+    return false;
+  }
+  for (const JsonValue& entry_point : entry_points->items) {
+    const JsonValue* name = entry_point.Find("name");
+    if (!name || name->kind != JsonValue::Kind::String) return false;
+    auto& entry = (*metrics)[name->string];
+    for (const auto& member : entry_point.members) {
+      if (member.second.kind == JsonValue::Kind::Number) {
+        entry[member.first] = member.second.number;
+      }
+    }
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+namespace glslc {
+
+bool ParseCostReport(const std::string& json, CostMetrics* metrics) {
+  JsonValue report;
+  size_t error_offset = 0;
+  metrics->clear();
+  return ParseJson(json, &report, &error_offset) &&
+         GetCostMetrics(report, metrics);
+}
+
+bool ParseCostReportFile(const std::string& json,
+                         std::map<std::string, CostMetrics>* metrics_by_output,
+                         std::string* err) {
+  metrics_by_output->clear();
+  JsonValue file;
+  size_t error_offset = 0;
+  if (!ParseJson(json, &file, &error_offset)) {
+    *err = "malformed JSON near offset " + std::to_string(error_offset);
+    return false;
+  }
+  const JsonValue* shaders = file.Find("shaders");
+  if (file.kind != JsonValue::Kind::Object || !shaders ||
+      shaders->kind != JsonValue::Kind::Array) {
+    *err = "expected an object with a \"shaders\" array";
+    return false;
+  }
+  for (const JsonValue& shader : shaders->items) {
+    const JsonValue* output = shader.Find("output");
+    const JsonValue* cost = shader.Find("cost");
+    if (!output || output->kind != JsonValue::Kind::String || !cost) {
+      *err = "expected \"output\" and \"cost\" for each shader";
+      return false;
+    }
+    CostMetrics& metrics = (*metrics_by_output)[output->string];
+    // A module that could not be analyzed has a null cost.
+    if (cost->kind != JsonValue::Kind::Null &&
+        !GetCostMetrics(*cost, &metrics)) {
+      *err = "malformed cost of '" + output->string + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<CostChange> CompareCostMetrics(const CostMetrics& baseline,
+                                           const CostMetrics& metrics) {
+  // Returns the value of a metric, or zero if it is missing.
+  auto get = [](const CostMetrics& from, const std::string& entry_point,
+                const std::string& metric) -> uint64_t {
+    auto entry = from.find(entry_point);
+    if (entry == from.end()) return 0;
+    auto value = entry->second.find(metric);
+    return value == entry->second.end() ? 0 : value->second;
+  };
+  std::set<std::pair<std::string, std::string>> keys;
+  for (const CostMetrics* side : {&baseline, &metrics}) {
+    for (const auto& entry : *side) {
+      for (const auto& value : entry.second) {
+        keys.emplace(entry.first, value.first);
+      }
+    }
+  }
+  std::vector<CostChange> changes;
+  for (const auto& key : keys) {
+    const uint64_t before = get(baseline, key.first, key.second);
+    const uint64_t after = get(metrics, key.first, key.second);
+    if (before != after) {
+      changes.push_back({key.first, key.second, before, after});
+    }
+  }
+  return changes;
+}
+
+}  // namespace glslc
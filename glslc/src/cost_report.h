@@ -0,0 +1,57 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GLSLC_COST_REPORT_H
+#define GLSLC_COST_REPORT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace glslc {
+
+// The static cost metrics of the entry points of one module: entry point
+// name -> metric name -> value.
+using CostMetrics = std::map<std::string, std::map<std::string, uint64_t>>;
+
+// Parses the cost report of one module, as returned by
+// shaderc::CompilationResult::GetCostReport(), into *metrics.  Returns false
+// if the text is not such a report.
+bool ParseCostReport(const std::string& json, CostMetrics* metrics);
+
+// Parses a file written by -fcost-report into *metrics_by_output, which maps
+// the name of each output file to its metrics.  Returns false, and writes a
+// message to *err, if the text is not such a file.
+bool ParseCostReportFile(const std::string& json,
+                         std::map<std::string, CostMetrics>* metrics_by_output,
+                         std::string* err);
+
+// A metric of an entry point that differs from the baseline.
+struct CostChange {
+  std::string entry_point;
+  std::string metric;
+  uint64_t baseline;
+  uint64_t cost;
+};
+
+// Returns the metrics that differ between baseline and metrics, sorted by
+// entry point and then metric name.  A metric or entry point missing from
+// one side counts as zero there.
+std::vector<CostChange> CompareCostMetrics(const CostMetrics& baseline,
+                                           const CostMetrics& metrics);
+
+}  // namespace glslc
+
+#endif  // GLSLC_COST_REPORT_H
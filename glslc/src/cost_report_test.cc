@@ -0,0 +1,100 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "cost_report.h"
+
+#include <gmock/gmock.h>
+
+namespace {
+
+using glslc::CompareCostMetrics;
+using glslc::CostMetrics;
+using glslc::ParseCostReport;
+using glslc::ParseCostReportFile;
+
+const char kReport[] = R"({
+  "entry_points": [
+    {"name": "main", "stage": "compute", "alu": 5, "memory": 2},
+    {"name": "other", "stage": "vertex", "alu": 1}
+  ]
+})";
+
+TEST(ParseCostReport, ReadsNumericMetrics) {
+  CostMetrics metrics;
+  ASSERT_TRUE(ParseCostReport(kReport, &metrics));
+  ASSERT_EQ(2u, metrics.size());
+  EXPECT_EQ(5u, metrics["main"]["alu"]);
+  EXPECT_EQ(2u, metrics["main"]["memory"]);
+  EXPECT_EQ(0u, metrics["main"].count("stage"));
+  EXPECT_EQ(1u, metrics["other"]["alu"]);
+}
+
+TEST(ParseCostReport, RejectsMalformedText) {
+  CostMetrics metrics;
+  EXPECT_FALSE(ParseCostReport("", &metrics));
+  EXPECT_FALSE(ParseCostReport("{\"entry_points\": [", &metrics));
+  EXPECT_FALSE(ParseCostReport("{\"entry_points\": [{}]}", &metrics));
+  EXPECT_FALSE(ParseCostReport("[]", &metrics));
+}
+
+TEST(ParseCostReportFile, KeysMetricsByOutput) {
+  std::map<std::string, CostMetrics> metrics;
+  std::string err;
+  ASSERT_TRUE(ParseCostReportFile(
+      std::string("{\"shaders\": [\n"
+                  "  {\"input\": \"a.comp\", \"output\": \"a.spv\", "
+                  "\"cost\": ") +
+          kReport +
+          "},\n"
+          "  {\"input\": \"b.vert\", \"output\": \"b\\u002espv\", "
+          "\"cost\": null}\n]}",
+      &metrics, &err))
+      << err;
+  ASSERT_EQ(2u, metrics.size());
+  EXPECT_EQ(5u, metrics["a.spv"]["main"]["alu"]);
+  EXPECT_TRUE(metrics["b.spv"].empty());
+}
+
+TEST(ParseCostReportFile, ExplainsErrors) {
+  std::map<std::string, CostMetrics> metrics;
+  std::string err;
+  EXPECT_FALSE(ParseCostReportFile("{\"shaders\": 1}", &metrics, &err));
+  EXPECT_EQ("expected an object with a \"shaders\" array", err);
+  EXPECT_FALSE(ParseCostReportFile("{\"shaders\": [}", &metrics, &err));
+  EXPECT_EQ("malformed JSON near offset 13", err);
+}
+
+TEST(CompareCostMetrics, ListsChangedMetricsInOrder) {
+  CostMetrics baseline;
+  baseline["main"]["alu"] = 5;
+  baseline["main"]["memory"] = 2;
+  baseline["gone"]["alu"] = 1;
+  CostMetrics metrics;
+  metrics["main"]["alu"] = 7;
+  metrics["main"]["memory"] = 2;
+  metrics["main"]["loops"] = 1;
+  const auto changes = CompareCostMetrics(baseline, metrics);
+  ASSERT_EQ(3u, changes.size());
+  EXPECT_EQ("gone", changes[0].entry_point);
+  EXPECT_EQ(1u, changes[0].baseline);
+  EXPECT_EQ(0u, changes[0].cost);
+  EXPECT_EQ("alu", changes[1].metric);
+  EXPECT_EQ(5u, changes[1].baseline);
+  EXPECT_EQ(7u, changes[1].cost);
+  EXPECT_EQ("loops", changes[2].metric);
+  EXPECT_EQ(0u, changes[2].baseline);
+  EXPECT_TRUE(CompareCostMetrics(metrics, metrics).empty());
+}
+
+}  // anonymous namespace
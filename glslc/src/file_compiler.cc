@@ -15,10 +15,12 @@
 #include "file_compiler.h"
 
 #include <cassert>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 #if SHADERC_ENABLE_WGSL_OUTPUT == 1
 #include "tint/tint.h"
@@ -29,9 +31,11 @@
 #include "shader_stage.h"
 
 #include "libshaderc_util/io_shaderc.h"
+#include "libshaderc_util/json.h"
 #include "libshaderc_util/message.h"
 
 namespace {
+using shaderc_util::QuoteJson;
 using shaderc_util::string_piece;
 
 // A helper function to emit SPIR-V binary code as a list of hex numbers in
@@ -63,6 +67,74 @@ bool EmitSpirvBinaryAsCommaSeparatedNumbers(const CompilationResultType& result,
   out->flags(output_stream_flag_cache);
   return true;
 }
+
+// Returns text with every line after the first indented by the given number
+// of spaces.
+std::string IndentLines(const std::string& text, size_t indent) {
+  std::string result;
+  for (const char c : text) {
+    result.push_back(c);
+    if (c == '\n') result.append(indent, ' ');
+  }
+  return result;
+}
+
+// Writes the given JSON objects to the named file, as the array of the only
+// member of a JSON object.  Returns true on success.
+bool WriteJsonArrayFile(const std::string& file_name, const std::string& key,
+                        const std::vector<std::string>& entries,
+                        const char* description) {
+  std::ofstream potential_file_stream;
+  std::ostream* out = shaderc_util::GetOutputStream(
+      file_name, &potential_file_stream, &std::cerr);
+  if (!out || out->fail()) return false;
+  *out << "{\n  " << QuoteJson(key) << ": [";
+  for (size_t i = 0; i < entries.size(); ++i) {
+    *out << (i ? ",\n    " : "\n    ") << IndentLines(entries[i], 4);
+  }
+  *out << (entries.empty() ? "]\n}\n" : "\n  ]\n}\n");
+  out->flush();
+  if (out->fail()) {
+    std::cerr << "glslc: error: error writing to " << description << ": '"
+              << file_name << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// A difference from a baseline report.
+struct ReportChange {
+  // Names what changed, in messages.
+  std::string label;
+  // The JSON members naming what changed.
+  std::string members;
+  uint64_t baseline;
+  uint64_t value;
+};
+
+// Prints each of the changes to standard error, and appends the "changes"
+// member listing them to the report entry.  The new value is named
+// value_name in the JSON, and followed by unit in the messages.
+void AppendReportChanges(const std::string& output_file_name,
+                         const std::vector<ReportChange>& changes,
+                         const char* value_name, const char* unit,
+                         std::string* entry) {
+  *entry += ",\n  \"changes\": [";
+  for (size_t i = 0; i < changes.size(); ++i) {
+    const ReportChange& change = changes[i];
+    const bool increased = change.value > change.baseline;
+    const uint64_t delta = increased ? change.value - change.baseline
+                                     : change.baseline - change.value;
+    std::cerr << output_file_name << ": " << change.label << " "
+              << change.baseline << " -> " << change.value << unit << " ("
+              << (increased ? "+" : "-") << delta << ")" << std::endl;
+    *entry += std::string(i ? ",\n" : "\n") + "    {" + change.members +
+              ", \"baseline\": " + std::to_string(change.baseline) + ", " +
+              QuoteJson(value_name) + ": " + std::to_string(change.value) +
+              "}";
+  }
+  *entry += changes.empty() ? "]" : "\n  ]";
+}
 }  // anonymous namespace
 
 namespace glslc {
@@ -100,17 +172,64 @@ bool FileCompiler::CompileShaderFile(const InputFileSpec& input_file) {
       const auto result =
           compiler_.AssembleToSpv(source_string.data(), source_string.size());
       return EmitCompiledResult(result, input_file.name, output_file_name,
-                                error_file_name, used_source_files);
+                                error_file_name, used_source_files) &&
+             EmitSpecializedResults(result, input_file.name,
+                                    output_file_name, error_file_name,
+                                    used_source_files);
     } else {
       return true;
     }
   }
 
+  if (GetFileExtension(input_file.name) == "spv") {
+    // A SPIR-V binary is only optimized, and only if the requested target is
+    // SPIR-V binary.  The input has been read in full, so the output may
+    // replace it.
+    if (output_type_ != OutputType::SpirvBinary) return true;
+    if (input_data.size() % sizeof(uint32_t) != 0) {
+      std::cerr << "glslc: error: '" << error_file_name
+                << "': SPIR-V binary size is not a multiple of 4 bytes"
+                << std::endl;
+      return false;
+    }
+    std::vector<uint32_t> words(input_data.size() / sizeof(uint32_t));
+    if (!words.empty()) {
+      std::memcpy(words.data(), input_data.data(), input_data.size());
+    }
+    const auto result = compiler_.OptimizeSpv(words, options_);
+    return EmitCompiledResult(result, input_file.name, output_file_name,
+                              error_file_name, used_source_files) &&
+           EmitSpecializedResults(result, input_file.name, output_file_name,
+                                  error_file_name, used_source_files);
+  }
+
   // Set the language.  Since we only use the options object in this
   // method, then it's ok to always set it without resetting it after
   // compilation.  A subsequent compilation will set it again anyway.
   options_.SetSourceLanguage(input_file.language);
 
+  if (!variants_.empty() && output_type_ != OutputType::PreprocessedText) {
+    std::vector<shaderc_optimization_recipe> recipes(1, primary_recipe_);
+    for (const auto& variant : variants_) recipes.push_back(variant.recipe);
+    if (output_type_ == OutputType::SpirvBinary) {
+      const auto results = compiler_.CompileGlslToSpvWithRecipes(
+          source_string.data(), source_string.size(), input_file.stage,
+          error_file_name.data(), input_file.entry_point_name.c_str(), recipes,
+          options_);
+      return EmitVariantResults(results, input_file.name, output_file_name,
+                                error_file_name, used_source_files) &&
+             EmitSpecializedResults(results[0], input_file.name,
+                                    output_file_name, error_file_name,
+                                    used_source_files);
+    }
+    const auto results = compiler_.CompileGlslToSpvAssemblyWithRecipes(
+        source_string.data(), source_string.size(), input_file.stage,
+        error_file_name.data(), input_file.entry_point_name.c_str(), recipes,
+        options_);
+    return EmitVariantResults(results, input_file.name, output_file_name,
+                              error_file_name, used_source_files);
+  }
+
   switch (output_type_) {
     case OutputType::SpirvBinary: {
       const auto result = compiler_.CompileGlslToSpv(
@@ -118,7 +237,10 @@ bool FileCompiler::CompileShaderFile(const InputFileSpec& input_file) {
           error_file_name.data(), input_file.entry_point_name.c_str(),
           options_);
       return EmitCompiledResult(result, input_file.name, output_file_name,
-                                error_file_name, used_source_files);
+                                error_file_name, used_source_files) &&
+             EmitSpecializedResults(result, input_file.name,
+                                    output_file_name, error_file_name,
+                                    used_source_files);
     }
     case OutputType::SpirvAssemblyText: {
       const auto result = compiler_.CompileGlslToSpvAssembly(
@@ -139,13 +261,106 @@ bool FileCompiler::CompileShaderFile(const InputFileSpec& input_file) {
   return false;
 }
 
+template <typename CompilationResultType>
+bool FileCompiler::EmitVariantResults(
+    const std::vector<CompilationResultType>& results,
+    const std::string& input_file, const std::string& output_file_name,
+    string_piece error_file_name,
+    const std::unordered_set<std::string>& used_source_files) {
+  bool success = EmitCompiledResult(results[0], input_file, output_file_name,
+                                    error_file_name, used_source_files);
+  for (size_t i = 1; i < results.size(); ++i) {
+    const auto status = results[i].GetCompilationStatus();
+    // A front-end failure is shared by all outputs, and has already been
+    // reported for the primary one.
+    if (status == shaderc_compilation_status_compilation_error ||
+        status == shaderc_compilation_status_invalid_stage) {
+      continue;
+    }
+    const OptimizationVariant& variant = variants_[i - 1];
+    const uint32_t* size = variant.recipe.workgroup_size;
+    if (EmitCompiledResult(
+            results[i], input_file,
+            GetVariantOutputFileName(output_file_name, variant.name),
+            error_file_name, used_source_files,
+            status != shaderc_compilation_status_success)) {
+      AddVariantManifestEntry(input_file, output_file_name, variant.name,
+                              size[0] || size[1] || size[2] ? size : nullptr);
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
+bool FileCompiler::EmitSpecializedResults(
+    const shaderc::SpvCompilationResult& primary, const std::string& input_file,
+    const std::string& output_file_name, string_piece error_file_name,
+    const std::unordered_set<std::string>& used_source_files) {
+  if (specializations_.empty()) return true;
+  std::vector<std::map<uint32_t, std::string>> values;
+  for (const auto& specialization : specializations_) {
+    values.push_back(specialization.values);
+  }
+  const auto results = compiler_.SpecializeSpv(
+      std::vector<uint32_t>(primary.cbegin(), primary.cend()), values,
+      options_);
+  bool success = true;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const std::string& name = specializations_[i].name;
+    if (EmitCompiledResult(results[i], input_file,
+                           GetVariantOutputFileName(output_file_name, name),
+                           error_file_name, used_source_files)) {
+      AddVariantManifestEntry(input_file, output_file_name, name, nullptr);
+    } else {
+      success = false;
+    }
+  }
+  return success;
+}
+
+std::string FileCompiler::GetVariantOutputFileName(
+    const std::string& output_file_name, const std::string& variant_name) {
+  const size_t last_slash = output_file_name.find_last_of("/\\");
+  const size_t last_dot = output_file_name.find_last_of('.');
+  if (last_dot == std::string::npos ||
+      (last_slash != std::string::npos && last_dot < last_slash)) {
+    return output_file_name + "." + variant_name;
+  }
+  return output_file_name.substr(0, last_dot) + "." + variant_name +
+         output_file_name.substr(last_dot);
+}
+
+void FileCompiler::AddVariantManifestEntry(
+    const std::string& input_file, const std::string& primary_output_file_name,
+    const std::string& variant_name, const uint32_t* workgroup_size) {
+  if (variant_manifest_file_name_.empty()) return;
+  std::string entry = "{\n  \"input\": " + QuoteJson(input_file) +
+                      ",\n  \"name\": " + QuoteJson(variant_name) +
+                      ",\n  \"primary_output\": " +
+                      QuoteJson(primary_output_file_name) +
+                      ",\n  \"output\": " +
+                      QuoteJson(GetVariantOutputFileName(
+                          primary_output_file_name, variant_name));
+  if (workgroup_size) {
+    entry += ",\n  \"workgroup_size\": [" +
+             std::to_string(workgroup_size[0]) + ", " +
+             std::to_string(workgroup_size[1]) + ", " +
+             std::to_string(workgroup_size[2]) + "]";
+  }
+  variant_manifest_entries_.push_back(entry + "\n}");
+}
+
 template <typename CompilationResultType>
 bool FileCompiler::EmitCompiledResult(
     const CompilationResultType& result, const std::string& input_file,
     const std::string& output_file_name, string_piece error_file_name,
-    const std::unordered_set<std::string>& used_source_files) {
-  total_errors_ += result.GetNumErrors();
-  total_warnings_ += result.GetNumWarnings();
+    const std::unordered_set<std::string>& used_source_files,
+    bool report_messages) {
+  if (report_messages) {
+    total_errors_ += result.GetNumErrors();
+    total_warnings_ += result.GetNumWarnings();
+  }
 
   bool compilation_success =
       result.GetCompilationStatus() == shaderc_compilation_status_success;
@@ -153,24 +368,7 @@ bool FileCompiler::EmitCompiledResult(
   // Handle the error message for failing to deduce the shader kind.
   if (result.GetCompilationStatus() ==
       shaderc_compilation_status_invalid_stage) {
-    auto glsl_or_hlsl_extension = GetGlslOrHlslExtension(error_file_name);
-    if (glsl_or_hlsl_extension != "") {
-      std::cerr << "glslc: error: "
-                << "'" << error_file_name << "': "
-                << "." << glsl_or_hlsl_extension
-                << " file encountered but no -fshader-stage specified ahead";
-    } else if (error_file_name == "<stdin>") {
-      std::cerr
-          << "glslc: error: '-': -fshader-stage required when input is from "
-             "standard "
-             "input \"-\"";
-    } else {
-      std::cerr << "glslc: error: "
-                << "'" << error_file_name << "': "
-                << "file not recognized: File format not recognized";
-    }
-    std::cerr << "\n";
-
+    ReportInvalidStage(error_file_name);
     return false;
   }
 
@@ -273,8 +471,102 @@ bool FileCompiler::EmitCompiledResult(
     }
   }
 
+  // The reflection, cost and size reports describe this output, so they
+  // cover the variant outputs too; the include report is shared by every
+  // output of a compilation.
+  if (compilation_success && !reflection_file_name_.empty() &&
+      !PreprocessingOnly()) {
+    // A module that could not be reflected has a warning instead.
+    const std::string reflection = result.GetReflection();
+    reflection_entries_.push_back(
+        "{\n  \"input\": " + QuoteJson(input_file) +
+        ",\n  \"output\": " + QuoteJson(output_file_name) +
+        ",\n  \"reflection\": " +
+        (reflection.empty() ? "null" : IndentLines(reflection, 2)) + "\n}");
+  }
+
+  if (compilation_success &&
+      (!cost_report_file_name_.empty() || has_cost_baseline_) &&
+      !PreprocessingOnly()) {
+    // A module that could not be analyzed has a warning instead.
+    const std::string cost = result.GetCostReport();
+    std::string entry = "{\n  \"input\": " + QuoteJson(input_file) +
+                        ",\n  \"output\": " + QuoteJson(output_file_name) +
+                        ",\n  \"cost\": " +
+                        (cost.empty() ? "null" : IndentLines(cost, 2));
+    CostMetrics metrics;
+    if (has_cost_baseline_ && ParseCostReport(cost, &metrics)) {
+      auto baseline = cost_baseline_.find(output_file_name);
+      const auto changes = CompareCostMetrics(
+          baseline == cost_baseline_.end() ? CostMetrics() : baseline->second,
+          metrics);
+      std::vector<ReportChange> report_changes;
+      for (const CostChange& change : changes) {
+        report_changes.push_back(
+            {change.entry_point + ": " + change.metric,
+             "\"entry_point\": " + QuoteJson(change.entry_point) +
+                 ", \"metric\": " + QuoteJson(change.metric),
+             change.baseline, change.cost});
+      }
+      AppendReportChanges(output_file_name, report_changes, "cost", "",
+                          &entry);
+    }
+    cost_report_entries_.push_back(entry + "\n}");
+  }
+
+  if (compilation_success &&
+      (!size_attribution_file_name_.empty() || has_size_baseline_) &&
+      !PreprocessingOnly()) {
+    // A module that could not be attributed has a warning instead.
+    const std::string size = result.GetSizeAttribution();
+    std::string entry = "{\n  \"input\": " + QuoteJson(input_file) +
+                        ",\n  \"output\": " + QuoteJson(output_file_name) +
+                        ",\n  \"size\": " +
+                        (size.empty() ? "null" : IndentLines(size, 2));
+    SizeMetrics metrics;
+    if (has_size_baseline_ && ParseSizeAttribution(size, &metrics)) {
+      auto baseline = size_baseline_.find(output_file_name);
+      const auto changes = CompareSizeMetrics(
+          baseline == size_baseline_.end() ? SizeMetrics() : baseline->second,
+          metrics);
+      std::vector<ReportChange> report_changes;
+      for (const SizeChange& change : changes) {
+        report_changes.push_back(
+            {change.contributor + ":",
+             "\"contributor\": " + QuoteJson(change.contributor),
+             change.baseline, change.words});
+      }
+      AppendReportChanges(output_file_name, report_changes, "words", " words",
+                          &entry);
+    }
+    size_attribution_entries_.push_back(entry + "\n}");
+  }
+
+  if (compilation_success && report_messages &&
+      !include_report_file_name_.empty() && !PreprocessingOnly()) {
+    AddIncludeReport(result.GetIncludeReport(), &include_totals_);
+  }
+
+  if (compilation_success && size_report_) {
+    const auto stages = result.GetOptimizationStages();
+    for (size_t i = 0; i < stages.size(); ++i) {
+      std::cerr << output_file_name << ": " << stages[i].name << ": "
+                << stages[i].size_in_bytes << " bytes";
+      if (i > 0) {
+        const size_t before = stages[i - 1].size_in_bytes;
+        const size_t after = stages[i].size_in_bytes;
+        std::cerr << " (" << (after > before ? "+" : "-")
+                  << (after > before ? after - before : before - after)
+                  << ")";
+      }
+      std::cerr << std::endl;
+    }
+  }
+
   // Write error message to std::cerr.
-  std::cerr << result.GetErrorMessage();
+  if (report_messages) {
+    ReportMessages(result.GetErrorMessage(), result.GetDiagnostics());
+  }
   if (out && out->fail()) {
     // Something wrong happened on output.
     if (out == &std::cout) {
@@ -290,6 +582,126 @@ bool FileCompiler::EmitCompiledResult(
   return compilation_success;
 }
 
+void FileCompiler::ReportInvalidStage(string_piece error_file_name) {
+  auto glsl_or_hlsl_extension = GetGlslOrHlslExtension(error_file_name);
+  if (glsl_or_hlsl_extension != "") {
+    std::cerr << "glslc: error: "
+              << "'" << error_file_name << "': "
+              << "." << glsl_or_hlsl_extension
+              << " file encountered but no -fshader-stage specified ahead";
+  } else if (error_file_name == "<stdin>") {
+    std::cerr
+        << "glslc: error: '-': -fshader-stage required when input is from "
+           "standard "
+           "input \"-\"";
+  } else {
+    std::cerr << "glslc: error: "
+              << "'" << error_file_name << "': "
+              << "file not recognized: File format not recognized";
+  }
+  std::cerr << "\n";
+}
+
+void FileCompiler::ReportMessages(
+    const std::string& messages,
+    const std::vector<shaderc_diagnostic>& diagnostics) const {
+  // Messages that have no diagnostics, such as errors in SPIR-V assembly,
+  // are written as text.
+  if (!json_diagnostics_ || diagnostics.empty()) {
+    std::cerr << messages;
+    return;
+  }
+  for (const shaderc_diagnostic& diagnostic : diagnostics) {
+    shaderc_util::WriteDiagnosticJson(
+        {diagnostic.severity == shaderc_diagnostic_severity_error,
+         std::string(diagnostic.file, diagnostic.file_length),
+         static_cast<int>(diagnostic.line),
+         std::string(diagnostic.message, diagnostic.message_length)},
+        &std::cerr);
+  }
+}
+
+bool FileCompiler::LinkShaderFiles(
+    const std::vector<InputFileSpec>& input_files) {
+  // Each input becomes a SPIR-V module: sources are compiled without linking,
+  // so that they can call functions defined in other inputs, SPIR-V assembly
+  // is assembled, and SPIR-V binaries are used as they are.
+  options_.SetCompileOnly(true);
+  std::vector<std::vector<uint32_t>> modules;
+  std::unordered_set<std::string> used_source_files;
+  bool success = true;
+  for (const auto& input_file : input_files) {
+    std::vector<char> input_data;
+    if (!shaderc_util::ReadFile(input_file.name, &input_data)) {
+      success = false;
+      continue;
+    }
+    string_piece error_file_name = input_file.name;
+    if (error_file_name == "-") error_file_name = "<stdin>";
+    if (&input_file != &input_files.front()) {
+      used_source_files.insert(input_file.name);
+    }
+
+    if (GetFileExtension(input_file.name) == "spv") {
+      if (input_data.size() % sizeof(uint32_t) != 0) {
+        std::cerr << "glslc: error: '" << error_file_name
+                  << "': SPIR-V binary size is not a multiple of 4 bytes"
+                  << std::endl;
+        success = false;
+        continue;
+      }
+      modules.emplace_back(input_data.size() / sizeof(uint32_t));
+      if (!input_data.empty()) {
+        std::memcpy(modules.back().data(), input_data.data(),
+                    input_data.size());
+      }
+      continue;
+    }
+
+    std::unique_ptr<FileIncluder> includer(
+        new FileIncluder(&include_file_finder_));
+    const auto& file_path_trace = includer->file_path_trace();
+    options_.SetIncluder(std::move(includer));
+    options_.SetSourceLanguage(input_file.language);
+    const auto result =
+        input_file.stage == shaderc_spirv_assembly
+            ? compiler_.AssembleToSpv(input_data.data(), input_data.size(),
+                                      options_)
+            : compiler_.CompileGlslToSpv(
+                  input_data.data(), input_data.size(), input_file.stage,
+                  error_file_name.data(), input_file.entry_point_name.c_str(),
+                  options_);
+    used_source_files.insert(file_path_trace.begin(), file_path_trace.end());
+
+    total_errors_ += result.GetNumErrors();
+    total_warnings_ += result.GetNumWarnings();
+    if (result.GetCompilationStatus() ==
+        shaderc_compilation_status_invalid_stage) {
+      ReportInvalidStage(error_file_name);
+      success = false;
+      continue;
+    }
+    ReportMessages(result.GetErrorMessage(), result.GetDiagnostics());
+    if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+      success = false;
+      continue;
+    }
+    modules.emplace_back(result.cbegin(), result.cend());
+  }
+  options_.SetCompileOnly(false);
+  if (!success) return false;
+
+  const auto linked = compiler_.LinkSpv(modules, options_);
+  const std::string output_file_name =
+      GetOutputFileName(input_files.front().name);
+  return EmitCompiledResult(linked, input_files.front().name,
+                            output_file_name, input_files.front().name,
+                            used_source_files) &&
+         EmitSpecializedResults(linked, input_files.front().name,
+                                output_file_name, input_files.front().name,
+                                used_source_files);
+}
+
 void FileCompiler::AddIncludeDirectory(const std::string& path) {
   include_file_finder_.search_path().push_back(path);
 }
@@ -323,10 +735,9 @@ bool FileCompiler::ValidateOptions(size_t num_files) {
     return false;
   }
 
-  if (num_files > 1 && needs_linking_) {
-    std::cerr << "glslc: error: linking multiple files is not supported yet. "
-                 "Use -c to compile files individually."
-              << std::endl;
+  if (num_files > 1 && needs_linking_ && !variants_.empty()) {
+    std::cerr << "glslc: error: cannot use " << variants_.front().option
+              << " when linking multiple files" << std::endl;
     return false;
   }
 
@@ -388,6 +799,58 @@ bool FileCompiler::ValidateOptions(size_t num_files) {
     }
   }
 
+  // Options whose output describes the compiled module, which is never
+  // produced when only preprocessing or only writing dependency info.
+  if (PreprocessingOnly() || dependency_info_dumping_handler_) {
+    const std::pair<bool, std::string> module_options[] = {
+        {!variants_.empty(),
+         variants_.empty() ? std::string() : variants_.front().option},
+        {!reflection_file_name_.empty(), "--reflect"},
+        {!cost_report_file_name_.empty(), "-fcost-report"},
+        {has_cost_baseline_, "-fcost-baseline"},
+        {!size_attribution_file_name_.empty(), "-fsize-attribution"},
+        {has_size_baseline_, "-fsize-baseline"},
+        {!include_report_file_name_.empty(), "-finclude-report"},
+        {!variant_manifest_file_name_.empty(), "--variant-manifest"},
+    };
+    for (const auto& option : module_options) {
+      if (option.first) {
+        std::cerr << "glslc: error: cannot use " << option.second
+                  << " with -E or -M" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  if (!variants_.empty() && output_file_name_ == "-") {
+    std::cerr << "glslc: error: cannot write " << variants_.front().option
+              << " outputs to standard output" << std::endl;
+    return false;
+  }
+
+  if (!specializations_.empty()) {
+    if (output_type_ != OutputType::SpirvBinary ||
+        dependency_info_dumping_handler_) {
+      std::cerr << "glslc: error: cannot use -fspecialize with -S, -E or -M"
+                << std::endl;
+      return false;
+    }
+    if (output_file_name_ == "-") {
+      std::cerr << "glslc: error: cannot write -fspecialize outputs to "
+                   "standard output"
+                << std::endl;
+      return false;
+    }
+  }
+
+  // The includes of a prelude are read only when it is first prepared, so
+  // they would be missing from the dependencies of later inputs.
+  if (has_prelude_ && dependency_info_dumping_handler_) {
+    std::cerr << "glslc: error: cannot use -include-pch with -M or -MD"
+              << std::endl;
+    return false;
+  }
+
   if (binary_emission_format_ == SpirvBinaryEmissionFormat::WGSL) {
 #if SHADERC_ENABLE_WGSL_OUTPUT != 1
     std::cerr << "glslc: error: can't output WGSL: glslc was built without "
@@ -400,7 +863,39 @@ bool FileCompiler::ValidateOptions(size_t num_files) {
   return true;
 }
 
+bool FileCompiler::WriteReflectionFile() {
+  if (reflection_file_name_.empty()) return true;
+  return WriteJsonArrayFile(reflection_file_name_, "shaders",
+                            reflection_entries_, "reflection file");
+}
+
+bool FileCompiler::WriteCostReportFile() {
+  if (cost_report_file_name_.empty()) return true;
+  return WriteJsonArrayFile(cost_report_file_name_, "shaders",
+                            cost_report_entries_, "cost report");
+}
+
+bool FileCompiler::WriteSizeAttributionFile() {
+  if (size_attribution_file_name_.empty()) return true;
+  return WriteJsonArrayFile(size_attribution_file_name_, "shaders",
+                            size_attribution_entries_, "size attribution file");
+}
+
+bool FileCompiler::WriteIncludeReportFile() {
+  if (include_report_file_name_.empty()) return true;
+  return WriteJsonArrayFile(include_report_file_name_, "includes",
+                            IncludeTotalsToJson(include_totals_),
+                            "include report");
+}
+
+bool FileCompiler::WriteVariantManifest() {
+  if (variant_manifest_file_name_.empty()) return true;
+  return WriteJsonArrayFile(variant_manifest_file_name_, "variants",
+                            variant_manifest_entries_, "variant manifest");
+}
+
 void FileCompiler::OutputMessages() {
+  if (json_diagnostics_) return;
   shaderc_util::OutputMessages(&std::cerr, total_warnings_, total_errors_);
 }
 
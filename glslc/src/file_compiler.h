@@ -15,13 +15,19 @@
 #ifndef GLSLC_FILE_COMPILER_H
 #define GLSLC_FILE_COMPILER_H
 
+#include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "libshaderc_util/file_finder.h"
 #include "libshaderc_util/string_piece.h"
 #include "shaderc/shaderc.hpp"
 
+#include "cost_report.h"
 #include "dependency_info.h"
+#include "include_report.h"
+#include "size_attribution.h"
 
 namespace glslc {
 
@@ -33,6 +39,24 @@ struct InputFileSpec {
   std::string entry_point_name;
 };
 
+// Describes an additional output requested with -fopt-variant or
+// -fworkgroup-size-variant.  It is written next to the primary output, with
+// name inserted before the output file extension.
+struct OptimizationVariant {
+  std::string name;
+  shaderc_optimization_recipe recipe;
+  // The option that requested the variant, for error messages.
+  std::string option = "-fopt-variant";
+};
+
+// Describes an additional output requested with -fspecialize.  It is
+// specialized from the primary output with the given specialization constant
+// values, keyed by SpecId, and named like an OptimizationVariant.
+struct Specialization {
+  std::string name;
+  std::map<uint32_t, std::string> values;
+};
+
 // Context for managing compilation of source GLSL files into destination
 // SPIR-V files or preprocessed output.
 class FileCompiler {
@@ -72,6 +96,17 @@ class FileCompiler {
   // and increment the counts reported by OutputMessages().
   bool CompileShaderFile(const InputFileSpec& input_file);
 
+  // Compiles the given shaders without linking them individually, and links
+  // the resulting SPIR-V modules into one, along with any SPIR-V assembly or
+  // binary inputs.  Unreachable functions are removed, and the optimization
+  // level then applies to the linked module.  Places the output into the
+  // file named by SetOutputFileName(), or "a.spv".  Returns true on success.
+  bool LinkShaderFiles(const std::vector<InputFileSpec>& input_files);
+
+  // Returns true if the inputs are to be linked into a single output, rather
+  // than compiled individually.
+  bool NeedsLinking() const { return needs_linking_; }
+
   // Adds a directory to be searched when processing #include directives.
   //
   // Best practice: if you add an empty string before any other path, that will
@@ -89,6 +124,121 @@ class FileCompiler {
     binary_emission_format_ = format;
   }
 
+  // Requests additional outputs, each optimized according to its own recipe,
+  // from the same front-end run as the primary output.  The primary output
+  // is optimized according to primary_recipe, which must match the
+  // optimization level and debug info settings in options().
+  void SetOptimizationVariants(
+      const shaderc_optimization_recipe& primary_recipe,
+      std::vector<OptimizationVariant> variants) {
+    primary_recipe_ = primary_recipe;
+    variants_ = std::move(variants);
+  }
+
+  // Requests additional outputs, each specialized from the primary output.
+  // Only SPIR-V binary outputs are specialized.
+  void SetSpecializations(std::vector<Specialization> specializations) {
+    specializations_ = std::move(specializations);
+  }
+
+  // Requests reflection data for every output, to be written as one JSON
+  // document to the given file by WriteReflectionFile().  A name of "-"
+  // indicates standard output.
+  void SetReflectionFileName(const std::string& file_name) {
+    reflection_file_name_ = file_name;
+    options_.SetGenerateReflection(true);
+  }
+
+  // Requests the static cost metrics of every output, to be written as one
+  // JSON document to the given file by WriteCostReportFile().  A name of "-"
+  // indicates standard output.
+  void SetCostReportFileName(const std::string& file_name) {
+    cost_report_file_name_ = file_name;
+    options_.SetGenerateCostReport(true);
+  }
+
+  // Requests that the cost metrics of every output be compared with those in
+  // baseline, keyed by output file name, as read from an earlier cost report.
+  // Each difference is printed to std::cerr, and recorded in the cost report.
+  void SetCostBaseline(std::map<std::string, CostMetrics> baseline) {
+    cost_baseline_ = std::move(baseline);
+    has_cost_baseline_ = true;
+    options_.SetGenerateCostReport(true);
+  }
+
+  // Requests the size attribution of every output, to be written as one JSON
+  // document to the given file by WriteSizeAttributionFile().  A name of "-"
+  // indicates standard output.
+  void SetSizeAttributionFileName(const std::string& file_name) {
+    size_attribution_file_name_ = file_name;
+    options_.SetGenerateSizeAttribution(true);
+  }
+
+  // Requests that the size attribution of every output be compared with that
+  // in baseline, keyed by output file name, as read from an earlier size
+  // attribution file.  Each difference is printed to std::cerr, and recorded
+  // in the size attribution file.
+  void SetSizeBaseline(std::map<std::string, SizeMetrics> baseline) {
+    size_baseline_ = std::move(baseline);
+    has_size_baseline_ = true;
+    options_.SetGenerateSizeAttribution(true);
+  }
+
+  // Requests a report of what each file included by the inputs cost, summed
+  // over all of them, to be written as one JSON document to the given file
+  // by WriteIncludeReportFile().  A name of "-" indicates standard output.
+  void SetIncludeReportFileName(const std::string& file_name) {
+    include_report_file_name_ = file_name;
+    options_.SetGenerateIncludeReport(true);
+  }
+
+  // Sets the prelude that every GLSL input is compiled with, read from the
+  // named file.  See shaderc::CompileOptions::SetPrelude.
+  void SetPrelude(const std::string& source, const std::string& file_name) {
+    options_.SetPrelude(source, file_name);
+    has_prelude_ = true;
+  }
+
+  // Requests that the warnings and errors of compilations be written to
+  // std::cerr as JSON objects, one per line, instead of as text.  The total
+  // counts written by OutputMessages() are then left out.
+  void SetJsonDiagnostics(bool enable) { json_diagnostics_ = enable; }
+
+  // Requests that the size of each output after each stage of optimization
+  // be printed to std::cerr, for outputs optimized with -Oz.
+  void SetSizeReport(bool enable) { size_report_ = enable; }
+
+  // Writes the reflection data gathered from the outputs produced so far, if
+  // it was requested.  Returns true on success, or if there is nothing to
+  // write.
+  bool WriteReflectionFile();
+
+  // Writes the cost metrics gathered from the outputs produced so far, if
+  // they were requested.  Returns true on success, or if there is nothing to
+  // write.
+  bool WriteCostReportFile();
+
+  // Writes the size attribution gathered from the outputs produced so far, if
+  // it was requested.  Returns true on success, or if there is nothing to
+  // write.
+  bool WriteSizeAttributionFile();
+
+  // Writes the include costs gathered from the outputs produced so far, if
+  // they were requested.  Returns true on success, or if there is nothing to
+  // write.
+  bool WriteIncludeReportFile();
+
+  // Requests a list of the optimization variant and specialization outputs,
+  // to be written as one JSON document to the given file by
+  // WriteVariantManifest().  A name of "-" indicates standard output.
+  void SetVariantManifestFileName(const std::string& file_name) {
+    variant_manifest_file_name_ = file_name;
+  }
+
+  // Writes the list of the variant outputs produced so far, if it was
+  // requested.  Returns true on success, or if there is nothing to write.
+  bool WriteVariantManifest();
+
   // Returns false if any options are incompatible. The num_files parameter
   // represents the number of files that will be compiled.
   bool ValidateOptions(size_t num_files);
@@ -141,14 +291,58 @@ class FileCompiler {
   // file and returns true if the result represents a successful compilation
   // step.  Otherwise returns false, possibly emits messages to the standard
   // error stream, and does not produce an output file.  Accumulates error
-  // and warning counts for use by the OutputMessages() method.
+  // and warning counts for use by the OutputMessages() method.  If
+  // report_messages is false, the messages and counts in the result are
+  // ignored, because they have already been reported for another output of
+  // the same compilation, and so is the include report; the reports that
+  // describe this output, such as --reflect, are emitted either way.
   template <typename CompilationResultType>
   bool EmitCompiledResult(
       const CompilationResultType& result, const std::string& input_file_name,
       const std::string& output_file_name,
       shaderc_util::string_piece error_file_name,
+      const std::unordered_set<std::string>& used_source_files,
+      bool report_messages = true);
+
+  // Emits the primary output from the first of the given results, and the
+  // output of each optimization variant from the rest, in order.  Returns
+  // true if all of them succeed.
+  template <typename CompilationResultType>
+  bool EmitVariantResults(
+      const std::vector<CompilationResultType>& results,
+      const std::string& input_file_name, const std::string& output_file_name,
+      shaderc_util::string_piece error_file_name,
+      const std::unordered_set<std::string>& used_source_files);
+
+  // Emits the output of each specialization requested with -fspecialize,
+  // specialized from the given primary result, which must be successful.
+  // Returns true if all of them succeed.
+  bool EmitSpecializedResults(
+      const shaderc::SpvCompilationResult& primary,
+      const std::string& input_file_name, const std::string& output_file_name,
+      shaderc_util::string_piece error_file_name,
       const std::unordered_set<std::string>& used_source_files);
 
+  // Returns the output file name of the given optimization variant or
+  // specialization, derived from the primary output file name.
+  static std::string GetVariantOutputFileName(
+      const std::string& output_file_name, const std::string& variant_name);
+
+  // Adds a variant output to the manifest, if one was requested.  A null
+  // workgroup_size means that the variant has the size of the primary output.
+  void AddVariantManifestEntry(const std::string& input_file,
+                               const std::string& primary_output_file_name,
+                               const std::string& variant_name,
+                               const uint32_t* workgroup_size);
+
+  // Reports that the shader stage of the given file could not be deduced.
+  static void ReportInvalidStage(shaderc_util::string_piece error_file_name);
+
+  // Writes the warnings and errors of a compilation to std::cerr, as its
+  // messages or, with JSON diagnostics, as its diagnostics.
+  void ReportMessages(const std::string& messages,
+                      const std::vector<shaderc_diagnostic>& diagnostics) const;
+
   // Returns the final file name to be used for the output file.
   //
   // If an output file name is specified by the SetOutputFileName(), use that
@@ -225,6 +419,63 @@ class FileCompiler {
   // Name of the file where the compilation output will go.
   shaderc_util::string_piece output_file_name_;
 
+  // The recipe of the primary output, used when variants_ is not empty.
+  shaderc_optimization_recipe primary_recipe_ = {
+      shaderc_optimization_level_zero, false};
+  // Additional outputs requested with -fopt-variant and
+  // -fworkgroup-size-variant.
+  std::vector<OptimizationVariant> variants_;
+
+  // Additional outputs requested with -fspecialize.
+  std::vector<Specialization> specializations_;
+
+  // The file named by --reflect, or empty if reflection is not requested.
+  std::string reflection_file_name_;
+  // The reflection data of each output so far, as JSON objects ready to be
+  // placed in the "shaders" array of the reflection file.
+  std::vector<std::string> reflection_entries_;
+
+  // The file named by -fcost-report, or empty if no report is requested.
+  std::string cost_report_file_name_;
+  // The cost metrics of each output so far, as JSON objects ready to be
+  // placed in the "shaders" array of the cost report.
+  std::vector<std::string> cost_report_entries_;
+  // True if -fcost-baseline was given, in which case cost_baseline_ holds the
+  // metrics it read, keyed by output file name.
+  bool has_cost_baseline_ = false;
+  std::map<std::string, CostMetrics> cost_baseline_;
+
+  // The file named by -fsize-attribution, or empty if none is requested.
+  std::string size_attribution_file_name_;
+  // The size attribution of each output so far, as JSON objects ready to be
+  // placed in the "shaders" array of the size attribution file.
+  std::vector<std::string> size_attribution_entries_;
+  // True if -fsize-baseline was given, in which case size_baseline_ holds the
+  // metrics it read, keyed by output file name.
+  bool has_size_baseline_ = false;
+  std::map<std::string, SizeMetrics> size_baseline_;
+
+  // The file named by -finclude-report, or empty if no report is requested.
+  std::string include_report_file_name_;
+  // The costs of each included file, summed over the outputs so far.
+  std::map<std::string, IncludeTotals> include_totals_;
+
+  // True if -include-pch was given.
+  bool has_prelude_ = false;
+
+  // True if --size-report was given.
+  bool size_report_ = false;
+
+  // True if -fdiagnostics-format=json was given.
+  bool json_diagnostics_ = false;
+
+  // The file named by --variant-manifest, or empty if no manifest is
+  // requested.
+  std::string variant_manifest_file_name_;
+  // The variant outputs so far, as JSON objects ready to be placed in the
+  // "variants" array of the manifest.
+  std::vector<std::string> variant_manifest_entries_;
+
   // Counts warnings encountered in all compilations via this object.
   size_t total_warnings_;
   // Counts errors encountered in all compilations via this object.
@@ -0,0 +1,120 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_report.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "libshaderc_util/json.h"
+
+namespace {
+
+using glslc::IncludeTotals;
+using shaderc_util::JsonValue;
+using shaderc_util::ParseJson;
+using shaderc_util::QuoteJson;
+
+// Returns the number held by the named member of an object, or nullptr if
+// there is no such number.
+const uint64_t* FindNumber(const JsonValue& object, const char* name) {
+  const JsonValue* value = object.Find(name);
+  if (!value || value->kind != JsonValue::Kind::Number) return nullptr;
+  return &value->number;
+}
+
+}  // anonymous namespace
+
+namespace glslc {
+
+bool AddIncludeReport(const std::string& json,
+                      std::map<std::string, IncludeTotals>* totals) {
+  JsonValue report;
+  size_t error_offset = 0;
+  if (!ParseJson(json, &report, &error_offset)) return false;
+  const JsonValue* includes = report.Find("includes");
+  if (report.kind != JsonValue::Kind::Object || !includes ||
+      includes->kind != JsonValue::Kind::Array) {
+    return false;
+  }
+  // Check every file before adding any.
+  std::vector<std::pair<std::string, IncludeTotals>> files;
+  for (const JsonValue& include : includes->items) {
+    const JsonValue* name = include.Find("name");
+    const uint64_t* count = FindNumber(include, "count");
+    const uint64_t* bytes = FindNumber(include, "bytes");
+    const uint64_t* microseconds = FindNumber(include, "microseconds");
+    const JsonValue* words = include.Find("words");
+    if (!name || name->kind != JsonValue::Kind::String || !count || !bytes ||
+        !microseconds || !words ||
+        (words->kind != JsonValue::Kind::Number &&
+         words->kind != JsonValue::Kind::Null)) {
+      return false;
+    }
+    IncludeTotals file;
+    file.shaders = 1;
+    // Null words mean that the module had no lines to tell.
+    file.unused_in =
+        words->kind == JsonValue::Kind::Number && words->number == 0;
+    file.count = *count;
+    file.bytes = *bytes;
+    file.microseconds = *microseconds;
+    file.words = words->number;
+    files.emplace_back(name->string, file);
+  }
+  for (const auto& file : files) {
+    IncludeTotals& total = (*totals)[file.first];
+    total.shaders += file.second.shaders;
+    total.unused_in += file.second.unused_in;
+    total.count += file.second.count;
+    total.bytes += file.second.bytes;
+    total.microseconds += file.second.microseconds;
+    total.words += file.second.words;
+  }
+  return true;
+}
+
+std::string SuggestIncludeChange(const IncludeTotals& totals) {
+  if (totals.unused_in == 0) return "";
+  return totals.unused_in == totals.shaders ? "remove" : "split";
+}
+
+std::vector<std::string> IncludeTotalsToJson(
+    const std::map<std::string, IncludeTotals>& totals) {
+  using Entry = std::pair<const std::string, IncludeTotals>;
+  std::vector<const Entry*> files;
+  for (const Entry& entry : totals) files.push_back(&entry);
+  // The map is ordered by name, which breaks ties.
+  std::stable_sort(files.begin(), files.end(),
+                   [](const Entry* a, const Entry* b) {
+                     return a->second.microseconds > b->second.microseconds;
+                   });
+  std::vector<std::string> entries;
+  for (const Entry* file : files) {
+    const IncludeTotals& total = file->second;
+    const std::string suggestion = SuggestIncludeChange(total);
+    entries.push_back(
+        "{\"name\": " + QuoteJson(file->first) +
+        ", \"shaders\": " + std::to_string(total.shaders) +
+        ", \"unused_in\": " + std::to_string(total.unused_in) +
+        ", \"count\": " + std::to_string(total.count) +
+        ", \"bytes\": " + std::to_string(total.bytes) +
+        ", \"microseconds\": " + std::to_string(total.microseconds) +
+        ", \"words\": " + std::to_string(total.words) + ", \"suggestion\": " +
+        (suggestion.empty() ? "null" : QuoteJson(suggestion)) + "}");
+  }
+  return entries;
+}
+
+}  // namespace glslc
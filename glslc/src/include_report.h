@@ -0,0 +1,57 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GLSLC_INCLUDE_REPORT_H
+#define GLSLC_INCLUDE_REPORT_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace glslc {
+
+// What one included file cost across the modules of a batch.
+struct IncludeTotals {
+  // The modules that included the file.
+  uint64_t shaders = 0;
+  // Of those, the modules known to have no code from it.
+  uint64_t unused_in = 0;
+  // The inclusions, bytes, time and words of code, summed over the modules.
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+  uint64_t microseconds = 0;
+  uint64_t words = 0;
+};
+
+// Adds the include report of one module, as returned by
+// shaderc::CompilationResult::GetIncludeReport(), to *totals, which maps the
+// name of each included file to its totals.  Returns false, leaving *totals
+// unchanged, if the text is not such a report.
+bool AddIncludeReport(const std::string& json,
+                      std::map<std::string, IncludeTotals>* totals);
+
+// Returns "remove" if none of the modules that included a file had code from
+// it, "split" if only some of them did, or an empty string otherwise.
+std::string SuggestIncludeChange(const IncludeTotals& totals);
+
+// Returns one JSON object per file in totals, from the slowest down, with
+// its "name", its totals and its "suggestion", which is null if there is
+// none.
+std::vector<std::string> IncludeTotalsToJson(
+    const std::map<std::string, IncludeTotals>& totals);
+
+}  // namespace glslc
+
+#endif  // GLSLC_INCLUDE_REPORT_H
@@ -0,0 +1,108 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "include_report.h"
+
+#include <gmock/gmock.h>
+
+namespace {
+
+using glslc::AddIncludeReport;
+using glslc::IncludeTotals;
+using glslc::IncludeTotalsToJson;
+using glslc::SuggestIncludeChange;
+
+using IncludeTotalsMap = std::map<std::string, IncludeTotals>;
+
+const char kLightingReport[] = R"({
+  "includes": [
+    {"name": "common.glsl", "count": 1, "bytes": 400, "microseconds": 90,
+     "words": 0},
+    {"name": "brdf.glsl", "count": 2, "bytes": 900, "microseconds": 60,
+     "words": 120}
+  ]
+})";
+
+const char kPostReport[] = R"({
+  "includes": [
+    {"name": "common.glsl", "count": 1, "bytes": 400, "microseconds": 80,
+     "words": 14}
+  ]
+})";
+
+TEST(AddIncludeReport, SumsFilesAcrossModules) {
+  IncludeTotalsMap totals;
+  ASSERT_TRUE(AddIncludeReport(kLightingReport, &totals));
+  ASSERT_TRUE(AddIncludeReport(kPostReport, &totals));
+  ASSERT_EQ(2u, totals.size());
+  const IncludeTotals& common = totals["common.glsl"];
+  EXPECT_EQ(2u, common.shaders);
+  EXPECT_EQ(1u, common.unused_in);
+  EXPECT_EQ(2u, common.count);
+  EXPECT_EQ(800u, common.bytes);
+  EXPECT_EQ(170u, common.microseconds);
+  EXPECT_EQ(14u, common.words);
+  const IncludeTotals& brdf = totals["brdf.glsl"];
+  EXPECT_EQ(1u, brdf.shaders);
+  EXPECT_EQ(0u, brdf.unused_in);
+  EXPECT_EQ(2u, brdf.count);
+}
+
+TEST(AddIncludeReport, NullWordsAreNotUnused) {
+  IncludeTotalsMap totals;
+  ASSERT_TRUE(AddIncludeReport(
+      "{\"includes\": [{\"name\": \"a.glsl\", \"count\": 1, \"bytes\": 3, "
+      "\"microseconds\": 1, \"words\": null}]}",
+      &totals));
+  EXPECT_EQ(1u, totals["a.glsl"].shaders);
+  EXPECT_EQ(0u, totals["a.glsl"].unused_in);
+}
+
+TEST(AddIncludeReport, RejectsMalformedTextWithoutAddingAnything) {
+  IncludeTotalsMap totals;
+  EXPECT_FALSE(AddIncludeReport("", &totals));
+  EXPECT_FALSE(AddIncludeReport("{\"includes\": {}}", &totals));
+  EXPECT_FALSE(AddIncludeReport(
+      "{\"includes\": [{\"name\": \"a.glsl\", \"count\": 1, \"bytes\": 3, "
+      "\"microseconds\": 1, \"words\": 0}, {\"name\": \"b.glsl\"}]}",
+      &totals));
+  EXPECT_TRUE(totals.empty());
+}
+
+TEST(SuggestIncludeChange, RemovesUnusedAndSplitsPartlyUsedFiles) {
+  IncludeTotals totals;
+  totals.shaders = 3;
+  EXPECT_EQ("", SuggestIncludeChange(totals));
+  totals.unused_in = 2;
+  EXPECT_EQ("split", SuggestIncludeChange(totals));
+  totals.unused_in = 3;
+  EXPECT_EQ("remove", SuggestIncludeChange(totals));
+}
+
+TEST(IncludeTotalsToJson, WritesSlowestFirst) {
+  IncludeTotalsMap totals;
+  ASSERT_TRUE(AddIncludeReport(kLightingReport, &totals));
+  ASSERT_TRUE(AddIncludeReport(kPostReport, &totals));
+  EXPECT_THAT(
+      IncludeTotalsToJson(totals),
+      testing::ElementsAre(
+          "{\"name\": \"common.glsl\", \"shaders\": 2, \"unused_in\": 1, "
+          "\"count\": 2, \"bytes\": 800, \"microseconds\": 170, "
+          "\"words\": 14, \"suggestion\": \"split\"}",
+          "{\"name\": \"brdf.glsl\", \"shaders\": 1, \"unused_in\": 0, "
+          "\"count\": 2, \"bytes\": 900, \"microseconds\": 60, "
+          "\"words\": 120, \"suggestion\": null}"));
+}
+
+}  // anonymous namespace
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cctype>
 #include <cstdint>
@@ -19,21 +21,25 @@
 #include <iomanip>
 #include <iostream>
 #include <list>
+#include <map>
 #include <sstream>
 #include <string>
 #include <tuple>
 #include <utility>
 
+#include "cost_report.h"
 #include "file.h"
 #include "file_compiler.h"
 #include "libshaderc_util/args.h"
 #include "libshaderc_util/compiler.h"
 #include "libshaderc_util/io_shaderc.h"
+#include "libshaderc_util/spirv_tools_wrapper.h"
 #include "libshaderc_util/string_piece.h"
 #include "resource_parse.h"
 #include "shader_stage.h"
 #include "shaderc/env.h"
 #include "shaderc/shaderc.h"
+#include "size_attribution.h"
 #include "spirv-tools/libspirv.h"
 
 using shaderc_util::string_piece;
@@ -64,6 +70,32 @@ Options:
   -fauto-combined-image-sampler
                     Removes sampler variables and converts existing textures
                     to combined image-samplers.
+  -fbake-uniform=<block>.<member>=<value>
+                    Compile with the given uniform block member fixed to
+                    <value>, so that the optimizer folds it and drops the
+                    code and bindings it leaves unused.  Vector components
+                    are separated by commas.  May be repeated.
+  -fcompile-only    Compile GLSL shaders without linking them, so that they
+                    may call functions defined in other modules, and export
+                    their own functions to them.  Such modules are linked by
+                    passing them together to glslc without -c.
+  -fcost-baseline=<file>
+                    Compare the static cost of each output with that recorded
+                    for the same output file in <file>, written earlier by
+                    -fcost-report, and print every metric that changed.
+  -fcost-report=<file>
+                    Write static cost metrics for each entry point of each
+                    output to <file>, as JSON: ALU, transcendental, texture
+                    and memory instructions, branches, loops, live values,
+                    and a loop-weighted operation count.
+  -fdiagnostics-format=<format>
+                    Write the warnings and errors of compilations to standard
+                    error in the given format.  Available formats are:
+                      text  - Lines of the form <file>:<line>: error: <text>.
+                              This is the default.
+                      json  - One JSON object per line, with the "severity",
+                              "file", "line" and "message" of each.  Errors
+                              from glslc itself are still written as text.
   -fentry-point=<name>
                     Specify the entry point name for HLSL compilation, for
                     all subsequent source files.  Default is "main".
@@ -75,6 +107,13 @@ Options:
   -fhlsl-iomap      Use HLSL IO mappings for bindings.
   -fhlsl-offsets    Use HLSL offset rules for packing members of blocks.
                     Affects only GLSL.  HLSL rules are always used for HLSL.
+  -finclude-report=<file>
+                    Write what each file included by the inputs cost across
+                    all of them to <file>, as JSON, from the slowest down:
+                    how many inputs included it, the bytes and time spent on
+                    it, and how many of those inputs had no code from it.  A
+                    file no input had code from is suggested for removal, and
+                    one only some inputs had code from for splitting.
   -finvert-y        Invert position.Y output in vertex shader.
   -flimit=<settings>
                     Specify resource limits. Each limit is specified by a limit
@@ -87,6 +126,13 @@ Options:
                     a NaN operand, the other operand is returned. Similarly,
                     the clamp builtin will favour the non-NaN operands, as if
                     clamp were implemented as a composition of max and min.
+  -fopt-variant=<name>:<flags>
+                    Also write an output optimized according to <flags>, a
+                    comma-separated list of -O0, -O, -Os, -Oz,
+                    -Ofast-compile, and -g.  Its file name is the output
+                    file name with .<name> inserted before the extension.
+                    The source is compiled only once for all outputs.  May
+                    be repeated.
   -fpreserve-bindings
                     Preserve all binding declarations, even if those bindings
                     are not used.
@@ -131,10 +177,49 @@ Options:
                     Treat subsequent input files as having stage <stage>.
                     Valid stages are vertex, vert, fragment, frag, tesscontrol,
                     tesc, tesseval, tese, geometry, geom, compute, and comp.
+  -fsize-attribution=<file>
+                    Write the words of each output attributed to its
+                    functions, and to the source files and includes their
+                    code comes from, to <file>, as JSON, from the largest
+                    contributor down.  Lines are taken from debug info,
+                    which is generated for this and stripped afterwards.
+  -fsize-baseline=<file>
+                    Compare the size attribution of each output with that
+                    recorded for the same output file in <file>, written
+                    earlier by -fsize-attribution, and print every
+                    contributor that changed, from the largest change down.
+  -fspecialize=<name>:<id>=<value>[,<id>=<value>...]
+                    Also write an output specialized from the primary output,
+                    with the specialization constant of each SpecId <id> set
+                    to <value>.  All specialization constants are then frozen
+                    and folded, and the output is optimized like the primary
+                    output.  Its file name is derived as for -fopt-variant.
+                    Requires SPIR-V binary output.  May be repeated.
+  -fworkgroup-size=<x>,<y>,<z>
+                    Set the workgroup size of compute, task and mesh
+                    shaders.  A zero component keeps the size the shader
+                    declares.  If the shader uses gl_WorkGroupSize, only
+                    components declared with local_size_x_id and the like
+                    can be changed.
+  -fworkgroup-size-spec-ids=<x>,<y>,<z>
+                    Make the workgroup size of compute, task and mesh
+                    shaders specializable, with the given SpecIds for the
+                    components that are not specialization constants yet.
+  -fworkgroup-size-variant=<x>,<y>,<z>
+                    Also write an output with the given workgroup size,
+                    named wg<x>x<y>x<z> and otherwise like an -fopt-variant
+                    output optimized like the primary output.  May be
+                    repeated.
   -g                Generate source-level debug information.
   -h                Display available options.
   --help            Display available options.
   -I <value>        Add directory to include search path.
+  -include-pch <file>
+                    Compile each GLSL input as if it included <file> right
+                    after its #version directive and the #extension and
+                    #pragma directives that follow it.  <file> and its
+                    includes are preprocessed once for each #version they
+                    are used with, rather than once for each input.
   -mfmt=<format>    Output SPIR-V binary code using the selected format. This
                     option may be specified only when the compilation output is
                     in SPIR-V binary code form. Available options are:
@@ -150,12 +235,32 @@ Options:
   -O                Optimize the generated SPIR-V code for better performance.
   -Os               Optimize the generated SPIR-V code for smaller size.
   -O0               Disable optimization.
+  -Oz               Minimize the size of the generated SPIR-V code, for
+                    shipping: -Os, then strip non-semantic instructions,
+                    merge duplicate declarations, and compact IDs.  The
+                    result is validated.
+  -Ofast-compile    Run only cheap optimizations and skip SPIR-V validation,
+                    for the lowest compile time that still removes dead code.
   -o <file>         Write output to <file>.
                     A file name of '-' represents standard output.
+  --opt-profile=<profile>
+                    Tune -O for a kind of GPU.  Values are:
+                        generic   # The default
+                        mobile    # Fewer registers: no loop unrolling,
+                                  # less scalar replacement, and 16-bit
+                                  # arithmetic for mediump operations.
+                                  # Needs the shaderFloat16 feature.
+  --reflect=<file>  Write reflection data for each output to <file>, as
+                    JSON: entry points, workgroup sizes, descriptor
+                    bindings, push constants, specialization constants,
+                    and input and output locations.  The data of all the
+                    outputs of one invocation goes into one file.
   -std=<value>      Version and profile for GLSL input files. Possible values
                     are concatenations of version and profile, e.g. 310es,
                     450core, etc.  Ignored for HLSL files.
   -S                Emit SPIR-V assembly instead of binary.
+  --size-report     With -Oz, print the size of each output after each
+                    stage of optimization to standard error.
   --show-limits     Display available limit names and their default values.
   --target-env=<environment>
                     Set the target client environment, and the semantics
@@ -180,6 +285,11 @@ Options:
                     the default for vulkan1.4 is spv1.6.
                     Values are:
                         spv1.0, spv1.1, spv1.2, spv1.3, spv1.4, spv1.5, spv1.6
+  --variant-manifest=<file>
+                    Write a list of the outputs written for -fopt-variant,
+                    -fspecialize and -fworkgroup-size-variant to <file>, as
+                    JSON: the input, variant name, primary output, output,
+                    and workgroup size of each.
   --version         Display compiler version information.
   -w                Suppresses all warning messages.
   -Werror           Treat all warnings as errors.
@@ -187,6 +297,15 @@ Options:
                     Valid languages are: glsl, hlsl.
                     For files ending in .hlsl the default is hlsl.
                     Otherwise the default is glsl.
+  -Xspirv-opt <flag>
+                    Run the optimization pass named by the given spirv-opt
+                    flag, e.g. --loop-unroll, after the passes selected by
+                    -O, -Os, -Ofast-compile, or -O0.  May be repeated;
+                    passes run in the order given.
+  -Xspirv-opt-file <file>
+                    Like -Xspirv-opt, but reads the flags from a pass-list
+                    file.  Flags are separated by whitespace, and '#' starts
+                    a comment that runs to the end of the line.
 )";
 }
 
@@ -206,6 +325,93 @@ bool SetResourceLimits(const std::string& str, shaderc::CompileOptions* options,
   return true;
 }
 
+// Parses the argument of -fopt-variant, in the form <name>:<flags>.  Returns
+// true on success.  Otherwise returns false and sets err to a descriptive
+// error message.
+bool ParseOptimizationVariant(const string_piece& arg,
+                              glslc::OptimizationVariant* variant,
+                              std::string* err) {
+  const size_t colon = arg.find_first_of(':');
+  if (colon == string_piece::npos || colon == 0) {
+    *err = "expected <name>:<flags>, got '" + arg.str() + "'";
+    return false;
+  }
+  variant->name = arg.substr(0, colon).str();
+  variant->recipe = {shaderc_optimization_level_zero, false};
+  std::istringstream flags(arg.substr(colon + 1).str());
+  std::string flag;
+  while (std::getline(flags, flag, ',')) {
+    if (flag == "-O0") {
+      variant->recipe.optimization_level = shaderc_optimization_level_zero;
+    } else if (flag == "-O") {
+      variant->recipe.optimization_level =
+          shaderc_optimization_level_performance;
+    } else if (flag == "-Os") {
+      variant->recipe.optimization_level = shaderc_optimization_level_size;
+    } else if (flag == "-Oz") {
+      variant->recipe.optimization_level = shaderc_optimization_level_min_size;
+    } else if (flag == "-Ofast-compile") {
+      variant->recipe.optimization_level =
+          shaderc_optimization_level_fast_compile;
+    } else if (flag == "-g") {
+      variant->recipe.generate_debug_info = true;
+    } else {
+      *err = "unknown flag '" + flag + "' in variant '" + variant->name + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+// Parses the argument of -fspecialize, in the form
+// <name>:<id>=<value>[,<id>=<value>...].  Returns true on success.  Otherwise
+// returns false and sets err to a descriptive error message.
+bool ParseSpecialization(const string_piece& arg,
+                         glslc::Specialization* specialization,
+                         std::string* err) {
+  const size_t colon = arg.find_first_of(':');
+  if (colon == string_piece::npos || colon == 0) {
+    *err = "expected <name>:<id>=<value>,..., got '" + arg.str() + "'";
+    return false;
+  }
+  specialization->name = arg.substr(0, colon).str();
+  std::istringstream values(arg.substr(colon + 1).str());
+  std::string value;
+  while (std::getline(values, value, ',')) {
+    const size_t equals = value.find('=');
+    uint32_t id = 0;
+    if (equals == std::string::npos || equals + 1 == value.size() ||
+        !shaderc_util::ParseUint32(value.substr(0, equals), &id)) {
+      *err = "expected <id>=<value>, got '" + value + "' in specialization '" +
+             specialization->name + "'";
+      return false;
+    }
+    specialization->values[id] = value.substr(equals + 1);
+  }
+  return true;
+}
+
+// Parses a workgroup size in the form <x>,<y>,<z>.  Returns true on success.
+// Otherwise returns false and sets err to a descriptive error message.
+bool ParseWorkgroupSize(const string_piece& arg, uint32_t size[3],
+                        std::string* err) {
+  std::istringstream components(arg.str());
+  std::string component;
+  int count = 0;
+  while (std::getline(components, component, ',')) {
+    if (count == 3 || !shaderc_util::ParseUint32(component, &size[count])) {
+      count = 0;
+      break;
+    }
+    ++count;
+  }
+  if (count != 3) {
+    *err = "expected <x>,<y>,<z>, got '" + arg.str() + "'";
+    return false;
+  }
+  return true;
+}
+
 const char kBuildVersion[] =
 #include "build-version.inc"
     ;
@@ -265,6 +471,28 @@ int main(int argc, char** argv) {
   // What kind of uniform variable are we setting the binding base for?
   shaderc_uniform_kind u_kind = shaderc_uniform_kind_buffer;
 
+  // spirv-opt flags from -Xspirv-opt and -Xspirv-opt-file, in order.
+  std::vector<std::string> spirv_opt_flags;
+
+  // The optimization settings of the primary output, and the additional
+  // outputs requested with -fopt-variant.
+  shaderc_optimization_recipe primary_recipe = {
+      shaderc_optimization_level_zero, false};
+  std::vector<glslc::OptimizationVariant> variants;
+  // The workgroup sizes requested with -fworkgroup-size-variant.
+  std::vector<std::array<uint32_t, 3>> workgroup_size_variants;
+  // The last of -fworkgroup-size and -fworkgroup-size-spec-ids given, if any.
+  std::string workgroup_size_option;
+
+  // Whether -fcompile-only was given.
+  bool compile_only = false;
+
+  // Whether --size-report was given.
+  bool size_report = false;
+
+  // The additional outputs requested with -fspecialize.
+  std::vector<glslc::Specialization> specializations;
+
   // Sets binding base for the given uniform kind.  If stage is
   // shader_glsl_infer_from_source then set it for all shader stages.
   auto set_binding_base = [&compiler](shaderc_shader_kind stage,
@@ -323,6 +551,21 @@ int main(int argc, char** argv) {
       compiler.options().SetAutoSampledTextures(true);
     } else if (arg == "-fauto-map-locations") {
       compiler.options().SetAutoMapLocations(true);
+    } else if (arg.starts_with("-fbake-uniform=")) {
+      const std::string uniform =
+          arg.substr(std::strlen("-fbake-uniform=")).str();
+      const size_t equals = uniform.find('=');
+      const size_t dot = uniform.substr(0, equals).find('.');
+      if (equals == std::string::npos || dot == std::string::npos ||
+          dot == 0 || dot + 1 == equals) {
+        std::cerr << "glslc: error: -fbake-uniform: expected "
+                     "<block>.<member>=<value>, got '"
+                  << uniform << "'" << std::endl;
+        return 1;
+      }
+      compiler.options().AddBakedUniform(
+          uniform.substr(0, dot), uniform.substr(dot + 1, equals - dot - 1),
+          uniform.substr(equals + 1));
     } else if (arg == "-fhlsl-iomap") {
       compiler.options().SetHlslIoMapping(true);
     } else if (arg == "-fhlsl-offsets") {
@@ -336,6 +579,44 @@ int main(int argc, char** argv) {
       compiler.options().SetInvertY(true);
     } else if (arg == "-fnan-clamp") {
       compiler.options().SetNanClamp(true);
+    } else if (arg.starts_with("-fopt-variant=")) {
+      glslc::OptimizationVariant variant;
+      std::string err;
+      if (!ParseOptimizationVariant(
+              arg.substr(std::strlen("-fopt-variant=")), &variant, &err)) {
+        std::cerr << "glslc: error: -fopt-variant: " << err << std::endl;
+        return 1;
+      }
+      variants.push_back(std::move(variant));
+    } else if (arg.starts_with("-fworkgroup-size=") ||
+               arg.starts_with("-fworkgroup-size-spec-ids=") ||
+               arg.starts_with("-fworkgroup-size-variant=")) {
+      const size_t equals = arg.find_first_of('=');
+      const string_piece option = arg.substr(0, equals);
+      uint32_t size[3];
+      std::string err;
+      if (!ParseWorkgroupSize(arg.substr(equals + 1), size, &err)) {
+        std::cerr << "glslc: error: " << option << ": " << err << std::endl;
+        return 1;
+      }
+      if (option == "-fworkgroup-size") {
+        compiler.options().SetWorkgroupSize(size[0], size[1], size[2]);
+        workgroup_size_option = option.str();
+      } else if (option == "-fworkgroup-size-spec-ids") {
+        compiler.options().SetWorkgroupSizeSpecIds(size[0], size[1], size[2]);
+        workgroup_size_option = option.str();
+      } else {
+        workgroup_size_variants.push_back({size[0], size[1], size[2]});
+      }
+    } else if (arg.starts_with("-fspecialize=")) {
+      glslc::Specialization specialization;
+      std::string err;
+      if (!ParseSpecialization(arg.substr(std::strlen("-fspecialize=")),
+                               &specialization, &err)) {
+        std::cerr << "glslc: error: -fspecialize: " << err << std::endl;
+        return 1;
+      }
+      specializations.push_back(std::move(specialization));
     } else if (arg.starts_with("-fpreserve-bindings")) {
       compiler.options().SetPreserveBindings(true);
     } else if (((u_kind = shaderc_uniform_kind_image),
@@ -393,6 +674,98 @@ int main(int argc, char** argv) {
         i += 3;
       }
       if (!seen_triple) return need_three_args_err();
+    } else if (arg == "-fcompile-only") {
+      compiler.options().SetCompileOnly(true);
+      compile_only = true;
+    } else if (arg.starts_with("-fcost-report=")) {
+      const string_piece file_name =
+          arg.substr(std::strlen("-fcost-report="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '-fcost-report=' is missing"
+                  << std::endl;
+        return 1;
+      }
+      compiler.SetCostReportFileName(file_name.str());
+    } else if (arg.starts_with("-fcost-baseline=")) {
+      const string_piece file_name =
+          arg.substr(std::strlen("-fcost-baseline="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '-fcost-baseline=' is missing"
+                  << std::endl;
+        return 1;
+      }
+      std::vector<char> contents;
+      if (!shaderc_util::ReadFile(file_name.str(), &contents)) {
+        std::cerr << "glslc: error: cannot read cost baseline: " << file_name
+                  << std::endl;
+        return 1;
+      }
+      std::map<std::string, glslc::CostMetrics> baseline;
+      std::string err;
+      if (!glslc::ParseCostReportFile(
+              std::string(contents.begin(), contents.end()), &baseline,
+              &err)) {
+        std::cerr << "glslc: error: invalid cost baseline '" << file_name
+                  << "': " << err << std::endl;
+        return 1;
+      }
+      compiler.SetCostBaseline(std::move(baseline));
+    } else if (arg.starts_with("-finclude-report=")) {
+      const string_piece file_name =
+          arg.substr(std::strlen("-finclude-report="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '-finclude-report=' is missing"
+                  << std::endl;
+        return 1;
+      }
+      compiler.SetIncludeReportFileName(file_name.str());
+    } else if (arg.starts_with("-fsize-attribution=")) {
+      const string_piece file_name =
+          arg.substr(std::strlen("-fsize-attribution="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '-fsize-attribution=' is "
+                     "missing"
+                  << std::endl;
+        return 1;
+      }
+      compiler.SetSizeAttributionFileName(file_name.str());
+    } else if (arg.starts_with("-fsize-baseline=")) {
+      const string_piece file_name =
+          arg.substr(std::strlen("-fsize-baseline="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '-fsize-baseline=' is missing"
+                  << std::endl;
+        return 1;
+      }
+      std::vector<char> contents;
+      if (!shaderc_util::ReadFile(file_name.str(), &contents)) {
+        std::cerr << "glslc: error: cannot read size baseline: " << file_name
+                  << std::endl;
+        return 1;
+      }
+      std::map<std::string, glslc::SizeMetrics> baseline;
+      std::string err;
+      if (!glslc::ParseSizeAttributionFile(
+              std::string(contents.begin(), contents.end()), &baseline,
+              &err)) {
+        std::cerr << "glslc: error: invalid size baseline '" << file_name
+                  << "': " << err << std::endl;
+        return 1;
+      }
+      compiler.SetSizeBaseline(std::move(baseline));
+    } else if (arg.starts_with("-fdiagnostics-format=")) {
+      const string_piece format =
+          arg.substr(std::strlen("-fdiagnostics-format="));
+      if (format == "text") {
+        compiler.SetJsonDiagnostics(false);
+      } else if (format == "json") {
+        compiler.SetJsonDiagnostics(true);
+      } else {
+        std::cerr << "glslc: error: invalid value '" << format
+                  << "' in '-fdiagnostics-format=" << format << "'"
+                  << std::endl;
+        return 1;
+      }
     } else if (arg.starts_with("-fentry-point=")) {
       current_entry_point_name =
           arg.substr(std::strlen("-fentry-point=")).str();
@@ -498,6 +871,49 @@ int main(int argc, char** argv) {
         return 1;
       }
       compiler.options().SetTargetSpirv(ver);
+    } else if (arg.starts_with("--opt-profile=")) {
+      const string_piece profile_str =
+          arg.substr(std::strlen("--opt-profile="));
+      const std::pair<string_piece, shaderc_optimization_profile>
+          kProfiles[] = {
+              {"generic", shaderc_optimization_profile_generic},
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES) \
+  {#CNAME, shaderc_optimization_profile_##CNAME},
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+          };
+      const auto profile = std::find_if(
+          std::begin(kProfiles), std::end(kProfiles),
+          [&profile_str](const auto& entry) {
+            return entry.first == profile_str;
+          });
+      if (profile == std::end(kProfiles)) {
+        std::cerr << "glslc: error: invalid value '" << profile_str
+                  << "' in '--opt-profile=" << profile_str << "'"
+                  << std::endl;
+        return 1;
+      }
+      compiler.options().SetOptimizationProfile(profile->second);
+    } else if (arg == "--size-report") {
+      size_report = true;
+    } else if (arg.starts_with("--reflect=")) {
+      const string_piece file_name = arg.substr(std::strlen("--reflect="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '--reflect=' is missing"
+                  << std::endl;
+        return 1;
+      }
+      compiler.SetReflectionFileName(file_name.str());
+    } else if (arg.starts_with("--variant-manifest=")) {
+      const string_piece file_name =
+          arg.substr(std::strlen("--variant-manifest="));
+      if (file_name.empty()) {
+        std::cerr << "glslc: error: argument to '--variant-manifest=' is "
+                     "missing"
+                  << std::endl;
+        return 1;
+      }
+      compiler.SetVariantManifestFileName(file_name.str());
     } else if (arg.starts_with("-mfmt=")) {
       const string_piece binary_output_format =
           arg.substr(std::strlen("-mfmt="));
@@ -622,6 +1038,22 @@ int main(int argc, char** argv) {
             name_piece.data(), name_piece.size(), value_piece.data(),
             value_piece.size());
       }
+    } else if (arg == "-include-pch") {
+      if (i + 1 >= argc) {
+        std::cerr << "glslc: error: argument to '-include-pch' is missing "
+                     "(expected 1 value)"
+                  << std::endl;
+        return 1;
+      }
+      const string_piece file_name = argv[++i];
+      std::vector<char> contents;
+      if (!shaderc_util::ReadFile(file_name.str(), &contents)) {
+        std::cerr << "glslc: error: cannot read prelude: " << file_name
+                  << std::endl;
+        return 1;
+      }
+      compiler.SetPrelude(std::string(contents.begin(), contents.end()),
+                          file_name.str());
     } else if (arg.starts_with("-I")) {
       string_piece option_arg;
       if (!shaderc_util::GetOptionArgument(argc, argv, &i, "-I", &option_arg)) {
@@ -634,22 +1066,56 @@ int main(int argc, char** argv) {
       }
     } else if (arg == "-g") {
       compiler.options().SetGenerateDebugInfo();
+      primary_recipe.generate_debug_info = true;
     } else if (arg.starts_with("-O")) {
       if (arg == "-O") {
-        compiler.options().SetOptimizationLevel(
-            shaderc_optimization_level_performance);
+        primary_recipe.optimization_level =
+            shaderc_optimization_level_performance;
       } else if (arg == "-Os") {
-        compiler.options().SetOptimizationLevel(
-            shaderc_optimization_level_size);
+        primary_recipe.optimization_level = shaderc_optimization_level_size;
+      } else if (arg == "-Oz") {
+        primary_recipe.optimization_level =
+            shaderc_optimization_level_min_size;
       } else if (arg == "-O0") {
-        compiler.options().SetOptimizationLevel(
-            shaderc_optimization_level_zero);
+        primary_recipe.optimization_level = shaderc_optimization_level_zero;
+      } else if (arg == "-Ofast-compile") {
+        primary_recipe.optimization_level =
+            shaderc_optimization_level_fast_compile;
       } else {
         std::cerr << "glslc: error: invalid value '"
                   << arg.substr(std::strlen("-O")) << "' in '" << arg << "'"
                   << std::endl;
         return 1;
       }
+      compiler.options().SetOptimizationLevel(
+          primary_recipe.optimization_level);
+    } else if (arg == "-Xspirv-opt" || arg == "-Xspirv-opt-file") {
+      if (i + 1 >= argc) {
+        std::cerr << "glslc: error: argument to '" << arg
+                  << "' is missing (expected 1 value)" << std::endl;
+        return 1;
+      }
+      const string_piece option_arg = argv[++i];
+      std::vector<std::string> flags;
+      if (arg == "-Xspirv-opt") {
+        flags.push_back(option_arg.str());
+      } else {
+        std::vector<char> contents;
+        if (!shaderc_util::ReadFile(option_arg.str(), &contents)) {
+          std::cerr << "glslc: error: cannot read pass-list file: "
+                    << option_arg << std::endl;
+          return 1;
+        }
+        flags = shaderc_util::ParseSpirvOptPassList(
+            string_piece(contents.data(), contents.data() + contents.size()));
+      }
+      std::string err;
+      if (!shaderc_util::SpirvToolsValidatePassFlags(flags, &err)) {
+        std::cerr << "glslc: error: " << arg << ": " << err << std::endl;
+        return 1;
+      }
+      spirv_opt_flags.insert(spirv_opt_flags.end(), flags.begin(),
+                             flags.end());
     } else if (arg == "-w") {
       compiler.options().SetSuppressWarnings();
     } else if (arg == "-Werror") {
@@ -689,14 +1155,74 @@ int main(int argc, char** argv) {
     }
   }
 
+  if (!spirv_opt_flags.empty()) {
+    compiler.options().SetOptimizerPasses(spirv_opt_flags);
+  }
+
+  if (size_report) {
+    // Only -Oz measures the stages of optimization.
+    if (primary_recipe.optimization_level !=
+            shaderc_optimization_level_min_size &&
+        std::none_of(variants.begin(), variants.end(),
+                     [](const glslc::OptimizationVariant& variant) {
+                       return variant.recipe.optimization_level ==
+                              shaderc_optimization_level_min_size;
+                     })) {
+      std::cerr << "glslc: error: --size-report requires -Oz" << std::endl;
+      return 1;
+    }
+    compiler.SetSizeReport(true);
+  }
+
+  // Workgroup size variants are optimized like the primary output, so their
+  // recipes are only known once all the options have been seen.
+  for (const auto& size : workgroup_size_variants) {
+    glslc::OptimizationVariant variant;
+    variant.name = "wg" + std::to_string(size[0]) + "x" +
+                   std::to_string(size[1]) + "x" + std::to_string(size[2]);
+    variant.recipe = primary_recipe;
+    std::copy(size.begin(), size.end(), variant.recipe.workgroup_size);
+    variant.option = "-fworkgroup-size-variant";
+    variants.push_back(std::move(variant));
+  }
+
+  if (!variants.empty()) {
+    compiler.SetOptimizationVariants(primary_recipe, std::move(variants));
+  }
+
+  if (!specializations.empty()) {
+    compiler.SetSpecializations(std::move(specializations));
+  }
+
   if (!compiler.ValidateOptions(input_files.size())) return 1;
 
+  // Compile-only modules keep their declared workgroup size, and whether the
+  // sources use gl_WorkGroupSize is no longer known once they are linked.
+  if (!workgroup_size_option.empty() &&
+      (compile_only ||
+       (input_files.size() > 1 && compiler.NeedsLinking()))) {
+    std::cerr << "glslc: error: cannot use " << workgroup_size_option
+              << " with -fcompile-only or when linking multiple files"
+              << std::endl;
+    return 1;
+  }
+
   if (!success) return 1;
 
-  for (const auto& input_file : input_files) {
-    success &= compiler.CompileShaderFile(input_file);
+  if (input_files.size() > 1 && compiler.NeedsLinking()) {
+    success = compiler.LinkShaderFiles(input_files);
+  } else {
+    for (const auto& input_file : input_files) {
+      success &= compiler.CompileShaderFile(input_file);
+    }
   }
 
+  if (success) success = compiler.WriteReflectionFile();
+  if (success) success = compiler.WriteCostReportFile();
+  if (success) success = compiler.WriteSizeAttributionFile();
+  if (success) success = compiler.WriteIncludeReportFile();
+  if (success) success = compiler.WriteVariantManifest();
+
   compiler.OutputMessages();
   return success ? 0 : 1;
 }
@@ -0,0 +1,145 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "size_attribution.h"
+
+#include <algorithm>
+
+#include "libshaderc_util/json.h"
+
+namespace {
+
+using shaderc_util::JsonValue;
+using shaderc_util::ParseJson;
+
+// Adds the contributors in the given array of an attribution object to
+// *metrics, each named by prefix and its name.  Returns false if the array
+// is malformed.
+bool GetContributors(const JsonValue& attribution, const char* key,
+                     const std::string& prefix, glslc::SizeMetrics* metrics) {
+  const JsonValue* contributors = attribution.Find(key);
+  if (!contributors || contributors->kind != JsonValue::Kind::Array) {
+    return false;
+  }
+  for (const JsonValue& contributor : contributors->items) {
+    const JsonValue* name = contributor.Find("name");
+    const JsonValue* words = contributor.Find("words");
+    if (!name || !words || words->kind != JsonValue::Kind::Number) {
+      return false;
+    }
+    if (name->kind == JsonValue::Kind::String) {
+      (*metrics)[prefix + name->string] += words->number;
+    } else if (name->kind == JsonValue::Kind::Null) {
+      (*metrics)[prefix + "<unknown>"] += words->number;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Collects the metrics of a size attribution object into *metrics.  Returns
+// false if the value is not such an object.
+bool GetSizeMetrics(const JsonValue& attribution,
+                    glslc::SizeMetrics* metrics) {
+  const JsonValue* total = attribution.Find("total_words");
+  const JsonValue* declarations = attribution.Find("declaration_words");
+  if (attribution.kind != JsonValue::Kind::Object || !total ||
+      total->kind != JsonValue::Kind::Number || !declarations ||
+      declarations->kind != JsonValue::Kind::Number) {
+    return false;
+  }
+  (*metrics)["total"] = total->number;
+  (*metrics)["declarations"] = declarations->number;
+  return GetContributors(attribution, "functions", "function ", metrics) &&
+         GetContributors(attribution, "files", "file ", metrics);
+}
+
+}  // anonymous namespace
+
+namespace glslc {
+
+bool ParseSizeAttribution(const std::string& json, SizeMetrics* metrics) {
+  JsonValue attribution;
+  size_t error_offset = 0;
+  metrics->clear();
+  return ParseJson(json, &attribution, &error_offset) &&
+         GetSizeMetrics(attribution, metrics);
+}
+
+bool ParseSizeAttributionFile(
+    const std::string& json,
+    std::map<std::string, SizeMetrics>* metrics_by_output, std::string* err) {
+  metrics_by_output->clear();
+  JsonValue file;
+  size_t error_offset = 0;
+  if (!ParseJson(json, &file, &error_offset)) {
+    *err = "malformed JSON near offset " + std::to_string(error_offset);
+    return false;
+  }
+  const JsonValue* shaders = file.Find("shaders");
+  if (file.kind != JsonValue::Kind::Object || !shaders ||
+      shaders->kind != JsonValue::Kind::Array) {
+    *err = "expected an object with a \"shaders\" array";
+    return false;
+  }
+  for (const JsonValue& shader : shaders->items) {
+    const JsonValue* output = shader.Find("output");
+    const JsonValue* size = shader.Find("size");
+    if (!output || output->kind != JsonValue::Kind::String || !size) {
+      *err = "expected \"output\" and \"size\" for each shader";
+      return false;
+    }
+    SizeMetrics& metrics = (*metrics_by_output)[output->string];
+    // A module that could not be attributed has a null size.
+    if (size->kind != JsonValue::Kind::Null &&
+        !GetSizeMetrics(*size, &metrics)) {
+      *err = "malformed size of '" + output->string + "'";
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<SizeChange> CompareSizeMetrics(const SizeMetrics& baseline,
+                                           const SizeMetrics& metrics) {
+  std::vector<SizeChange> changes;
+  for (const auto& entry : baseline) {
+    auto now = metrics.find(entry.first);
+    const uint64_t words = now == metrics.end() ? 0 : now->second;
+    if (words != entry.second) {
+      changes.push_back({entry.first, entry.second, words});
+    }
+  }
+  for (const auto& entry : metrics) {
+    if (entry.second && !baseline.count(entry.first)) {
+      changes.push_back({entry.first, 0, entry.second});
+    }
+  }
+  auto magnitude = [](const SizeChange& change) {
+    return change.words > change.baseline ? change.words - change.baseline
+                                          : change.baseline - change.words;
+  };
+  std::sort(changes.begin(), changes.end(),
+            [&magnitude](const SizeChange& a, const SizeChange& b) {
+              const uint64_t a_magnitude = magnitude(a);
+              const uint64_t b_magnitude = magnitude(b);
+              return a_magnitude != b_magnitude
+                         ? a_magnitude > b_magnitude
+                         : a.contributor < b.contributor;
+            });
+  return changes;
+}
+
+}  // namespace glslc
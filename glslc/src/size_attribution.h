@@ -0,0 +1,57 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GLSLC_SIZE_ATTRIBUTION_H
+#define GLSLC_SIZE_ATTRIBUTION_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace glslc {
+
+// The words of one module by contributor: "total", "declarations",
+// "function <name>" and "file <name>", where code without line information
+// comes from "file <unknown>".
+using SizeMetrics = std::map<std::string, uint64_t>;
+
+// Parses the size attribution of one module, as returned by
+// shaderc::CompilationResult::GetSizeAttribution(), into *metrics.  Returns
+// false if the text is not such an attribution.
+bool ParseSizeAttribution(const std::string& json, SizeMetrics* metrics);
+
+// Parses a file written by -fsize-attribution into *metrics_by_output, which
+// maps the name of each output file to its metrics.  Returns false, and
+// writes a message to *err, if the text is not such a file.
+bool ParseSizeAttributionFile(
+    const std::string& json,
+    std::map<std::string, SizeMetrics>* metrics_by_output, std::string* err);
+
+// A contributor whose words differ from the baseline.
+struct SizeChange {
+  std::string contributor;
+  uint64_t baseline;
+  uint64_t words;
+};
+
+// Returns the contributors whose words differ between baseline and metrics,
+// from the largest change down, and by name among equal changes.  A
+// contributor missing from one side has no words there.
+std::vector<SizeChange> CompareSizeMetrics(const SizeMetrics& baseline,
+                                           const SizeMetrics& metrics);
+
+}  // namespace glslc
+
+#endif  // GLSLC_SIZE_ATTRIBUTION_H
@@ -0,0 +1,98 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "size_attribution.h"
+
+#include <gmock/gmock.h>
+
+namespace {
+
+using glslc::CompareSizeMetrics;
+using glslc::ParseSizeAttribution;
+using glslc::ParseSizeAttributionFile;
+using glslc::SizeMetrics;
+
+const char kAttribution[] = R"({
+  "total_words": 70,
+  "declaration_words": 33,
+  "functions": [
+    {"name": "main", "words": 22},
+    {"name": "noise(f1;", "words": 15}
+  ],
+  "files": [
+    {"name": "noise.glsl", "words": 15},
+    {"name": "shader.frag", "words": 13},
+    {"name": null, "words": 9}
+  ]
+})";
+
+TEST(ParseSizeAttribution, NamesContributorsByKind) {
+  SizeMetrics metrics;
+  ASSERT_TRUE(ParseSizeAttribution(kAttribution, &metrics));
+  EXPECT_EQ(7u, metrics.size());
+  EXPECT_EQ(70u, metrics["total"]);
+  EXPECT_EQ(33u, metrics["declarations"]);
+  EXPECT_EQ(22u, metrics["function main"]);
+  EXPECT_EQ(15u, metrics["function noise(f1;"]);
+  EXPECT_EQ(15u, metrics["file noise.glsl"]);
+  EXPECT_EQ(9u, metrics["file <unknown>"]);
+}
+
+TEST(ParseSizeAttribution, RejectsMalformedText) {
+  SizeMetrics metrics;
+  EXPECT_FALSE(ParseSizeAttribution("", &metrics));
+  EXPECT_FALSE(ParseSizeAttribution("{\"total_words\": 1}", &metrics));
+  EXPECT_FALSE(ParseSizeAttribution(
+      "{\"total_words\": 5, \"declaration_words\": 5, \"functions\": "
+      "[{\"name\": 1, \"words\": 2}], \"files\": []}",
+      &metrics));
+}
+
+TEST(ParseSizeAttributionFile, KeysMetricsByOutput) {
+  std::map<std::string, SizeMetrics> metrics;
+  std::string err;
+  ASSERT_TRUE(ParseSizeAttributionFile(
+      std::string("{\"shaders\": [\n"
+                  "  {\"input\": \"a.frag\", \"output\": \"a.spv\", "
+                  "\"size\": ") +
+          kAttribution +
+          "},\n"
+          "  {\"input\": \"b.vert\", \"output\": \"b.spv\", \"size\": null}\n"
+          "]}",
+      &metrics, &err))
+      << err;
+  ASSERT_EQ(2u, metrics.size());
+  EXPECT_EQ(13u, metrics["a.spv"]["file shader.frag"]);
+  EXPECT_TRUE(metrics["b.spv"].empty());
+  EXPECT_FALSE(ParseSizeAttributionFile("{\"shaders\": [{}]}", &metrics, &err));
+  EXPECT_EQ("expected \"output\" and \"size\" for each shader", err);
+}
+
+TEST(CompareSizeMetrics, ListsLargestChangesFirst) {
+  SizeMetrics baseline = {
+      {"total", 100}, {"function main", 40}, {"file old.glsl", 10}};
+  SizeMetrics metrics = {
+      {"total", 150}, {"function main", 40}, {"file new.glsl", 60}};
+  const auto changes = CompareSizeMetrics(baseline, metrics);
+  ASSERT_EQ(3u, changes.size());
+  EXPECT_EQ("file new.glsl", changes[0].contributor);
+  EXPECT_EQ(0u, changes[0].baseline);
+  EXPECT_EQ(60u, changes[0].words);
+  EXPECT_EQ("total", changes[1].contributor);
+  EXPECT_EQ("file old.glsl", changes[2].contributor);
+  EXPECT_EQ(0u, changes[2].words);
+  EXPECT_TRUE(CompareSizeMetrics(metrics, metrics).empty());
+}
+
+}  // anonymous namespace
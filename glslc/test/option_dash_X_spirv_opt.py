@@ -0,0 +1,106 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+PASS_LIST = '''# Strip names, then drop anything left unused.
+--strip-debug
+--eliminate-dead-code-aggressive   # trailing comment
+'''
+
+
+@inside_glslc_testsuite('OptionXSpirvOpt')
+class TestXSpirvOptRunsPass(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that -Xspirv-opt runs the named pass without -O."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-S', '-Xspirv-opt', '--strip-debug', shader]
+    unexpected_assembly_substr = 'OpName'
+
+
+@inside_glslc_testsuite('OptionXSpirvOpt')
+class TestXSpirvOptFileRunsPasses(expect.ValidFileContents):
+    """Tests that -Xspirv-opt-file reads flags and skips comments."""
+
+    environment = Directory('.', [
+        File('shader.vert', MINIMAL_SHADER),
+        File('passes.txt', PASS_LIST)])
+    glslc_args = ['-S', '-O0', '-Xspirv-opt-file', 'passes.txt',
+                  'shader.vert']
+    target_filename = 'shader.vert.spvasm'
+    expected_file_contents = [
+        """; SPIR-V
+; Version: 1.0
+; Generator: Google Shaderc over Glslang; 11
+; Bound: 6
+; Schema: 0
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Vertex %4 "main"
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+          %4 = OpFunction %void None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+"""]
+
+
+@inside_glslc_testsuite('OptionXSpirvOpt')
+class TestXSpirvOptMissingArgument(expect.ErrorMessage):
+    """Tests that -Xspirv-opt without a flag is an error."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', shader, '-Xspirv-opt']
+    expected_error = [
+        "glslc: error: argument to '-Xspirv-opt' is missing "
+        '(expected 1 value)\n']
+
+
+@inside_glslc_testsuite('OptionXSpirvOpt')
+class TestXSpirvOptUnknownFlag(expect.NoGeneratedFiles,
+                               expect.ErrorMessageSubstr):
+    """Tests that an unknown spirv-opt flag is rejected up front."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-Xspirv-opt', '--no-such-pass', shader]
+    expected_error_substr = (
+        "glslc: error: -Xspirv-opt: unknown optimizer flag '--no-such-pass'")
+
+
+@inside_glslc_testsuite('OptionXSpirvOpt')
+class TestXSpirvOptMalformedFlag(expect.NoGeneratedFiles, expect.ErrorMessage):
+    """Tests that a flag not spelled like a spirv-opt flag is rejected."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-Xspirv-opt', 'strip-debug', shader]
+    expected_error = [
+        "glslc: error: -Xspirv-opt: invalid optimizer flag 'strip-debug': "
+        "flags must start with '-O' or '--'\n"]
+
+
+@inside_glslc_testsuite('OptionXSpirvOpt')
+class TestXSpirvOptFileMissing(expect.NoGeneratedFiles,
+                               expect.ErrorMessageSubstr):
+    """Tests that a missing pass-list file is an error."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-Xspirv-opt-file', 'does_not_exist.txt', shader]
+    expected_error_substr = (
+        'glslc: error: cannot read pass-list file: does_not_exist.txt\n')
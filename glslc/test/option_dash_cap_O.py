@@ -12,12 +12,30 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
+import struct
+
 import expect
 from environment import File, Directory
 from glslc_test_framework import inside_glslc_testsuite
-from placeholder import FileShader
+from placeholder import FileBinary, FileShader
 
 MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+
+# A minimal vertex shader, as a little-endian SPIR-V binary module.
+MINIMAL_SPIRV_WORDS = [
+    0x07230203, 0x00010000, expect.ASSEMBLER_GENERATOR_WORD, 5, 0,
+    0x00020011, 1,                    # OpCapability Shader
+    0x0003000e, 0, 1,                 # OpMemoryModel Logical GLSL450
+    0x0005000f, 0, 1, 0x6e69616d, 0,  # OpEntryPoint Vertex %1 "main"
+    0x00020013, 2,                    # %2 = OpTypeVoid
+    0x00030021, 3, 2,                 # %3 = OpTypeFunction %2
+    0x00050036, 2, 1, 0, 3,           # %1 = OpFunction %2 None %3
+    0x000200f8, 4,                    # %4 = OpLabel
+    0x000100fd,                       # OpReturn
+    0x00010038,                       # OpFunctionEnd
+]
+MINIMAL_SPIRV_BINARY = struct.pack(
+    '<%dI' % len(MINIMAL_SPIRV_WORDS), *MINIMAL_SPIRV_WORDS)
 EMPTY_SHADER_IN_CWD = Directory('.', [File('shader.vert', MINIMAL_SHADER)])
 
 ASSEMBLY_WITH_DEBUG_SOURCE = [
@@ -141,6 +159,26 @@ class TestDashCapOs(expect.ValidFileContents):
     expected_file_contents = ASSEMBLY_Os
 
 
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOFastCompile(expect.ValidFileContents):
+    """Tests that -Ofast-compile works."""
+
+    environment = EMPTY_SHADER_IN_CWD
+    glslc_args = ['-S', '-Ofast-compile', 'shader.vert']
+    target_filename = 'shader.vert.spvasm'
+    expected_file_contents = ASSEMBLY_O
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOFastCompileWithDashG(expect.ValidFileContents):
+    """Tests that -g restrains -Ofast-compile from stripping debug info."""
+
+    environment = EMPTY_SHADER_IN_CWD
+    glslc_args = ['-S', '-Ofast-compile', '-g', 'shader.vert']
+    target_filename = 'shader.vert.spvasm'
+    expected_file_contents = ASSEMBLY_WITH_DEBUG_SOURCE
+
+
 @inside_glslc_testsuite('OptionDashCapO')
 class TestDashCapOOverriding(expect.ValidFileContents):
     """Tests that if there are multiple -O's, only the last one takes effect."""
@@ -178,3 +216,60 @@ class TestWrongOptLevel(expect.NoGeneratedFiles, expect.ErrorMessage):
     shader = FileShader(MINIMAL_SHADER, '.vert')
     glslc_args = ['-c', '-O2', shader]
     expected_error = "glslc: error: invalid value '2' in '-O2'\n"
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOOptimizesSpirvBinary(expect.ValidNamedObjectFile):
+    """Tests that a SPIR-V binary input is optimized instead of compiled."""
+
+    binary = FileBinary(MINIMAL_SPIRV_BINARY, '.spv')
+    glslc_args = ['-c', '-O', binary, '-o', 'optimized.spv']
+    expected_object_filenames = ('optimized.spv',)
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOTruncatedSpirvBinary(expect.ErrorMessageSubstr):
+    """Tests that a SPIR-V binary input must be a whole number of words."""
+
+    binary = FileBinary(MINIMAL_SPIRV_BINARY[:-1], '.spv')
+    glslc_args = ['-c', '-O', binary, '-o', 'optimized.spv']
+    expected_error_substr = 'SPIR-V binary size is not a multiple of 4 bytes'
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOz(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that -Oz strips names and debug info."""
+
+    shader = FileShader('#version 310 es\nvoid f() {}\nvoid main() { f(); }',
+                        '.vert')
+    glslc_args = ['-S', '-Oz', shader]
+    unexpected_assembly_substr = 'OpName'
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOzSizeReport(expect.ReturnCodeIsZero, expect.StderrMatch):
+    """Tests that --size-report prints the size after each -Oz stage."""
+
+    environment = EMPTY_SHADER_IN_CWD
+    glslc_args = ['-c', '-Oz', '--size-report', 'shader.vert']
+    expected_stderr = True
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestDashCapOzVariantSizeReport(expect.ReturnCodeIsZero,
+                                     expect.StderrMatch):
+    """Tests that --size-report covers an -Oz variant of an -O output."""
+
+    environment = EMPTY_SHADER_IN_CWD
+    glslc_args = ['-c', '-O', '-fopt-variant=ship:-Oz', '--size-report',
+                  'shader.vert']
+    expected_stderr = True
+
+
+@inside_glslc_testsuite('OptionDashCapO')
+class TestSizeReportWithoutDashCapOz(expect.ErrorMessage):
+    """Tests that --size-report is rejected without -Oz."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-Os', '--size-report', shader]
+    expected_error = ['glslc: error: --size-report requires -Oz\n']
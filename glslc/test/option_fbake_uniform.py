@@ -0,0 +1,78 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+# A fragment shader that samples a texture only for rough materials.
+BAKEABLE_SHADER = """#version 450
+  layout(binding=1) uniform Material { float roughness; vec3 tint; } material;
+  layout(binding=2) uniform sampler2D detail;
+  layout(location=0) out vec4 color;
+
+  void main() {
+    color = vec4(material.tint, 1.0);
+    if (material.roughness > 0.5) color *= texture(detail, vec2(0.5));
+  }
+  """
+
+
+@inside_glslc_testsuite('OptionFBakeUniform')
+class TestFBakeUniformRemovesDeadBranch(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that a baked value decides a branch, even without -O."""
+
+    shader = FileShader(BAKEABLE_SHADER, '.frag')
+    glslc_args = ['-S', '-fbake-uniform=Material.roughness=0.25', shader]
+    unexpected_assembly_substr = 'OpImageSampleImplicitLod'
+
+
+@inside_glslc_testsuite('OptionFBakeUniform')
+class TestFBakeUniformRemovesBindings(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that bindings left unused by baked values are removed."""
+
+    shader = FileShader(BAKEABLE_SHADER, '.frag')
+    glslc_args = ['-S', '-O', '-fbake-uniform=material.roughness=0.25',
+                  '-fbake-uniform=material.tint=1,0.5,0', shader]
+    unexpected_assembly_substr = 'Binding'
+
+
+@inside_glslc_testsuite('OptionFBakeUniform')
+class TestFBakeUniformKeepsLiveBranch(expect.ValidAssemblyFileWithSubstr):
+    """Tests that a baked value can keep a branch."""
+
+    shader = FileShader(BAKEABLE_SHADER, '.frag')
+    glslc_args = ['-S', '-fbake-uniform=Material.roughness=0.75', shader]
+    expected_assembly_substr = 'OpImageSampleImplicitLod'
+
+
+@inside_glslc_testsuite('OptionFBakeUniform')
+class TestFBakeUniformBadValue(expect.ErrorMessageSubstr):
+    """Tests that a value that does not fit the member is rejected."""
+
+    shader = FileShader(BAKEABLE_SHADER, '.frag')
+    glslc_args = ['-c', '-fbake-uniform=Material.tint=1,0', shader]
+    expected_error_substr = (
+        "error: cannot bake 'Material.tint': expected 3 components, got 2\n")
+
+
+@inside_glslc_testsuite('OptionFBakeUniform')
+class TestFBakeUniformMalformed(expect.ErrorMessage):
+    """Tests that the option needs a block, a member and a value."""
+
+    shader = FileShader(BAKEABLE_SHADER, '.frag')
+    glslc_args = ['-c', '-fbake-uniform=roughness=0.5', shader]
+    expected_error = [
+        "glslc: error: -fbake-uniform: expected <block>.<member>=<value>, "
+        "got 'roughness=0.5'\n"]
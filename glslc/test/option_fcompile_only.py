@@ -0,0 +1,78 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+
+LIBRARY_SHADER = """#version 450
+float twice(float x) { return 2.0 * x; }
+"""
+
+KERNEL_SHADER = """#version 450
+layout(local_size_x = 1) in;
+layout(std430, binding = 0) buffer B { float v; };
+float twice(float x);
+void main() { v = twice(v); }
+"""
+
+
+@inside_glslc_testsuite('OptionFCompileOnly')
+class TestFCompileOnlyLibrary(expect.ValidNamedObjectFile):
+    """Tests that a library without main() compiles with -fcompile-only."""
+
+    environment = Directory('.', [File('library.comp', LIBRARY_SHADER)])
+    glslc_args = ['-c', '-fcompile-only', 'library.comp']
+    expected_object_filenames = ('library.comp.spv',)
+
+
+@inside_glslc_testsuite('OptionFCompileOnly')
+class TestLinkMultipleSources(expect.ValidNamedObjectFile):
+    """Tests that several inputs without -c are linked into a.spv."""
+
+    environment = Directory('.', [File('kernel.comp', KERNEL_SHADER),
+                                  File('library.comp', LIBRARY_SHADER)])
+    glslc_args = ['-O', 'kernel.comp', 'library.comp']
+    expected_object_filenames = ('a.spv',)
+
+
+@inside_glslc_testsuite('OptionFCompileOnly')
+class TestLinkNamedOutput(expect.ValidNamedObjectFile):
+    """Tests that the linked module follows -o."""
+
+    environment = Directory('.', [File('kernel.comp', KERNEL_SHADER),
+                                  File('library.comp', LIBRARY_SHADER)])
+    glslc_args = ['kernel.comp', 'library.comp', '-o', 'kernel.spv']
+    expected_object_filenames = ('kernel.spv',)
+
+
+@inside_glslc_testsuite('OptionFCompileOnly')
+class TestLinkUnresolvedFunction(expect.ErrorMessageSubstr):
+    """Tests that a function no input defines fails to link."""
+
+    environment = Directory('.', [File('kernel.comp', KERNEL_SHADER),
+                                  File('other.comp', KERNEL_SHADER)])
+    glslc_args = ['kernel.comp', 'other.comp']
+    expected_error_substr = 'shaderc: error: failed to link: '
+
+
+@inside_glslc_testsuite('OptionFCompileOnly')
+class TestLinkWithOptVariant(expect.ErrorMessage):
+    """Tests that variants cannot be combined with linking."""
+
+    environment = Directory('.', [File('kernel.comp', KERNEL_SHADER),
+                                  File('library.comp', LIBRARY_SHADER)])
+    glslc_args = ['-fopt-variant=opt:-O', 'kernel.comp', 'library.comp']
+    expected_error = [
+        'glslc: error: cannot use -fopt-variant when linking multiple files\n']
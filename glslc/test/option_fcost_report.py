@@ -0,0 +1,105 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import re
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+COMPUTE_SHADER = '''#version 450
+layout(local_size_x = 64) in;
+layout(set = 0, binding = 0) buffer Data { float values[]; } data;
+void main() {
+  uint i = gl_GlobalInvocationID.x;
+  data.values[i] = sqrt(data.values[i]);
+}
+'''
+BASELINE = '''{
+  "shaders": [
+    {
+      "input": "shader.comp",
+      "output": "shader.comp.spv",
+      "cost": {
+        "entry_points": [
+          {"name": "main", "stage": "compute", "transcendental": 3}
+        ]
+      }
+    }
+  ]
+}
+'''
+
+
+@inside_glslc_testsuite('OptionFCostReport')
+class TestCostReportWritesFile(expect.ValidFileContents,
+                               expect.ValidNamedObjectFile):
+    """Tests that -fcost-report writes the metrics of each entry point."""
+
+    environment = Directory('.', [File('shader.comp', COMPUTE_SHADER)])
+    glslc_args = ['-c', '-fcost-report=c.json', 'shader.comp']
+    expected_object_filenames = ('shader.comp.spv', )
+    target_filename = 'c.json'
+    expected_file_contents = re.compile(
+        r'"shaders": \[\n    \{\n      "input": "shader.comp",\n'
+        r'      "output": "shader.comp.spv",\n'
+        r'(.|\n)*\{"name": "main", "stage": "compute", "alu": \d+, '
+        r'"transcendental": 1, "texture": 0, "memory": \d+, ')
+
+
+@inside_glslc_testsuite('OptionFCostReport')
+class TestCostBaselineRecordsChanges(expect.ReturnCodeIsZero,
+                                     expect.StderrMatch,
+                                     expect.ValidFileContents):
+    """Tests that -fcost-baseline reports the metrics that changed."""
+
+    environment = Directory('.', [File('shader.comp', COMPUTE_SHADER),
+                                  File('base.json', BASELINE)])
+    glslc_args = ['-c', '-fcost-baseline=base.json', '-fcost-report=c.json',
+                  'shader.comp']
+    expected_stderr = True
+    target_filename = 'c.json'
+    expected_file_contents = re.compile(
+        r'"changes": \[(.|\n)*\{"entry_point": "main", '
+        r'"metric": "transcendental", "baseline": 3, "cost": 1\}')
+
+
+@inside_glslc_testsuite('OptionFCostReport')
+class TestCostReportMissingArgument(expect.ErrorMessage):
+    """Tests that -fcost-report= needs a file name."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-fcost-report=', shader]
+    expected_error = [
+        "glslc: error: argument to '-fcost-report=' is missing\n"]
+
+
+@inside_glslc_testsuite('OptionFCostReport')
+class TestCostBaselineMalformed(expect.ErrorMessageSubstr):
+    """Tests that -fcost-baseline rejects a file that is not a report."""
+
+    environment = Directory('.', [File('base.json', '{"shaders": 1}')])
+    glslc_args = ['-c', '-fcost-baseline=base.json', 'shader.vert']
+    expected_error_substr = "glslc: error: invalid cost baseline 'base.json'"
+
+
+@inside_glslc_testsuite('OptionFCostReport')
+class TestCostReportWithPreprocessing(expect.ErrorMessage):
+    """Tests that -fcost-report cannot be combined with -E."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-E', '-fcost-report=c.json', shader]
+    expected_error = ['glslc: error: cannot use -fcost-report with -E or -M\n']
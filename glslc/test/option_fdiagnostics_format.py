@@ -0,0 +1,62 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+BAD_SHADER = '''#version 140
+int a() {
+}
+void main() {
+  int x = a();
+}
+'''
+
+
+@inside_glslc_testsuite('OptionFDiagnosticsFormat')
+class TestDiagnosticsFormatJson(expect.ErrorMessage):
+    """Tests that errors are written as JSON objects, one per line, without
+    the totals."""
+
+    environment = Directory('.', [File('bad.vert', BAD_SHADER)])
+    glslc_args = ['-c', '-fdiagnostics-format=json', 'bad.vert']
+    expected_error = [
+        '{"severity": "error", "file": "bad.vert", "line": 2, '
+        '"message": "\'\' : function does not return a value: a"}\n']
+
+
+@inside_glslc_testsuite('OptionFDiagnosticsFormat')
+class TestDiagnosticsFormatText(expect.ErrorMessage):
+    """Tests that -fdiagnostics-format=text keeps the usual messages."""
+
+    environment = Directory('.', [File('bad.vert', BAD_SHADER)])
+    glslc_args = ['-c', '-fdiagnostics-format=json',
+                  '-fdiagnostics-format=text', 'bad.vert']
+    expected_error = [
+        "bad.vert:2: error: '' : function does not return a value: a\n",
+        '1 error generated.\n']
+
+
+@inside_glslc_testsuite('OptionFDiagnosticsFormat')
+class TestDiagnosticsFormatInvalid(expect.ErrorMessage):
+    """Tests that an unknown format is rejected."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-fdiagnostics-format=xml', shader]
+    expected_error = [
+        "glslc: error: invalid value 'xml' in "
+        "'-fdiagnostics-format=xml'\n"]
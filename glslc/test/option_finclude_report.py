@@ -0,0 +1,94 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import re
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+NOISE = 'float noise(float x) { return fract(sin(x) * 43758.5453); }\n'
+SCALE = '#define SCALE 2.0\n'
+NOISY_SHADER = '''#version 450
+#extension GL_GOOGLE_include_directive : enable
+#include "noise.glsl"
+#include "scale.glsl"
+layout(location = 0) out vec4 color;
+void main() { color = vec4(noise(gl_FragCoord.x)); }
+'''
+PLAIN_SHADER = '''#version 450
+#extension GL_GOOGLE_include_directive : enable
+#include "noise.glsl"
+layout(location = 0) out vec4 color;
+void main() { color = vec4(gl_FragCoord.x); }
+'''
+
+
+@inside_glslc_testsuite('OptionFIncludeReport')
+class TestIncludeReportSumsInputs(expect.ValidFileContents,
+                                  expect.ValidNamedObjectFile):
+    """Tests that -finclude-report sums the costs of each included file over
+    the inputs, and suggests what to do with the files they do not use."""
+
+    environment = Directory('.', [File('noisy.frag', NOISY_SHADER),
+                                  File('plain.frag', PLAIN_SHADER),
+                                  File('noise.glsl', NOISE),
+                                  File('scale.glsl', SCALE)])
+    glslc_args = ['-c', '-finclude-report=i.json', 'noisy.frag',
+                  'plain.frag']
+    expected_object_filenames = ('noisy.frag.spv', 'plain.frag.spv')
+    target_filename = 'i.json'
+    # The files are ordered by time, so either may come first.
+    expected_file_contents = re.compile(
+        r'(?s)^(?=.*\{"name": "noise.glsl", "shaders": 2, "unused_in": 1, '
+        r'"count": 2, "bytes": 120, "microseconds": \d+, "words": [1-9]\d*, '
+        r'"suggestion": "split"\})'
+        r'(?=.*\{"name": "scale.glsl", "shaders": 1, "unused_in": 1, '
+        r'"count": 1, "bytes": 18, "microseconds": \d+, "words": 0, '
+        r'"suggestion": "remove"\})')
+
+
+@inside_glslc_testsuite('OptionFIncludeReport')
+class TestIncludeReportWithoutIncludes(expect.ValidFileContents,
+                                       expect.ValidNamedObjectFile):
+    """Tests that -finclude-report writes an empty report when nothing is
+    included."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-finclude-report=i.json', shader]
+    expected_object_filenames = ('shader.vert.spv', )
+    target_filename = 'i.json'
+    expected_file_contents = '{\n  "includes": []\n}\n'
+
+
+@inside_glslc_testsuite('OptionFIncludeReport')
+class TestIncludeReportMissingArgument(expect.ErrorMessage):
+    """Tests that -finclude-report= needs a file name."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-finclude-report=', shader]
+    expected_error = [
+        "glslc: error: argument to '-finclude-report=' is missing\n"]
+
+
+@inside_glslc_testsuite('OptionFIncludeReport')
+class TestIncludeReportWithPreprocessing(expect.ErrorMessage):
+    """Tests that -finclude-report cannot be combined with -E."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-E', '-finclude-report=i.json', shader]
+    expected_error = [
+        'glslc: error: cannot use -finclude-report with -E or -M\n']
@@ -0,0 +1,79 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+
+
+@inside_glslc_testsuite('OptionFOptVariant')
+class TestFOptVariantWritesEachOutput(expect.ValidNamedObjectFile):
+    """Tests that each variant is written next to the primary output."""
+
+    environment = Directory('.', [File('shader.vert', MINIMAL_SHADER)])
+    glslc_args = ['-c', '-O', '-fopt-variant=debug:-O0,-g',
+                  '-fopt-variant=small:-Os', 'shader.vert']
+    expected_object_filenames = ('shader.vert.spv', 'shader.vert.debug.spv',
+                                 'shader.vert.small.spv')
+
+
+@inside_glslc_testsuite('OptionFOptVariant')
+class TestFOptVariantWithOutputName(expect.ValidNamedObjectFile):
+    """Tests that variant names are derived from the -o file name."""
+
+    environment = Directory('.', [File('shader.vert', MINIMAL_SHADER)])
+    glslc_args = ['-c', '-fopt-variant=opt:-O', 'shader.vert', '-o', 'out.bin']
+    expected_object_filenames = ('out.bin', 'out.opt.bin')
+
+
+@inside_glslc_testsuite('OptionFOptVariant')
+class TestFOptVariantAssembly(expect.ValidNamedAssemblyFile):
+    """Tests that variants follow -S."""
+
+    environment = Directory('.', [File('shader.vert', MINIMAL_SHADER)])
+    glslc_args = ['-S', '-fopt-variant=opt:-O', 'shader.vert']
+    expected_assembly_filenames = ('shader.vert.spvasm',
+                                   'shader.vert.opt.spvasm')
+
+
+@inside_glslc_testsuite('OptionFOptVariant')
+class TestFOptVariantUnknownFlag(expect.ErrorMessage):
+    """Tests that an unknown flag in a variant is rejected."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-fopt-variant=fast:-O3', shader]
+    expected_error = [
+        "glslc: error: -fopt-variant: unknown flag '-O3' in variant 'fast'\n"]
+
+
+@inside_glslc_testsuite('OptionFOptVariant')
+class TestFOptVariantMissingName(expect.ErrorMessage):
+    """Tests that a variant needs a name."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-fopt-variant=-O', shader]
+    expected_error = [
+        "glslc: error: -fopt-variant: expected <name>:<flags>, got '-O'\n"]
+
+
+@inside_glslc_testsuite('OptionFOptVariant')
+class TestFOptVariantWithPreprocessing(expect.ErrorMessage):
+    """Tests that variants cannot be combined with -E."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-E', '-fopt-variant=opt:-O', shader]
+    expected_error = ['glslc: error: cannot use -fopt-variant with -E or -M\n']
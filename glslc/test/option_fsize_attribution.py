@@ -0,0 +1,119 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import re
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+NOISE = 'float noise(float x) { return fract(sin(x) * 43758.5453); }\n'
+FRAGMENT_SHADER = '''#version 450
+#extension GL_GOOGLE_include_directive : enable
+#include "noise.glsl"
+layout(location = 0) out vec4 color;
+void main() { color = vec4(noise(gl_FragCoord.x)); }
+'''
+BASELINE = '''{
+  "shaders": [
+    {
+      "input": "shader.frag",
+      "output": "shader.frag.spv",
+      "size": {
+        "total_words": 5,
+        "declaration_words": 5,
+        "functions": [],
+        "files": []
+      }
+    }
+  ]
+}
+'''
+
+
+@inside_glslc_testsuite('OptionFSizeAttribution')
+class TestSizeAttributionWritesFile(expect.ValidFileContents,
+                                    expect.ValidNamedObjectFile):
+    """Tests that -fsize-attribution attributes words to functions and
+    included files."""
+
+    environment = Directory('.', [File('shader.frag', FRAGMENT_SHADER),
+                                  File('noise.glsl', NOISE)])
+    glslc_args = ['-c', '-fsize-attribution=s.json', 'shader.frag']
+    expected_object_filenames = ('shader.frag.spv', )
+    target_filename = 's.json'
+    expected_file_contents = re.compile(
+        r'"output": "shader.frag.spv",\n'
+        r'(.|\n)*\{"name": "noise\(f1;", "words": \d+\}'
+        r'(.|\n)*\{"name": "noise.glsl", "words": \d+\}')
+
+
+@inside_glslc_testsuite('OptionFSizeAttribution')
+class TestSizeAttributionStripsDebugInfo(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that the lines generated for the attribution are not output."""
+
+    shader = FileShader(FRAGMENT_SHADER.replace('#include "noise.glsl"',
+                                                NOISE), '.frag')
+    glslc_args = ['-S', '-fsize-attribution=s.json', shader]
+    unexpected_assembly_substr = 'OpLine'
+
+
+@inside_glslc_testsuite('OptionFSizeAttribution')
+class TestSizeAttributionKeepsNames(expect.ValidAssemblyFileWithSubstr):
+    """Tests that the attribution does not strip the names that -O0 keeps."""
+
+    shader = FileShader(FRAGMENT_SHADER.replace('#include "noise.glsl"',
+                                                NOISE), '.frag')
+    glslc_args = ['-S', '-O0', '-fsize-attribution=s.json', shader]
+    expected_assembly_substr = 'OpName %main "main"'
+
+
+@inside_glslc_testsuite('OptionFSizeAttribution')
+class TestSizeBaselineRecordsChanges(expect.ReturnCodeIsZero,
+                                     expect.StderrMatch,
+                                     expect.ValidFileContents):
+    """Tests that -fsize-baseline reports the contributors that changed."""
+
+    environment = Directory('.', [File('shader.frag', FRAGMENT_SHADER),
+                                  File('noise.glsl', NOISE),
+                                  File('base.json', BASELINE)])
+    glslc_args = ['-c', '-fsize-baseline=base.json',
+                  '-fsize-attribution=s.json', 'shader.frag']
+    expected_stderr = True
+    target_filename = 's.json'
+    expected_file_contents = re.compile(
+        r'"changes": \[(.|\n)*\{"contributor": "file noise.glsl", '
+        r'"baseline": 0, "words": \d+\}')
+
+
+@inside_glslc_testsuite('OptionFSizeAttribution')
+class TestSizeAttributionMissingArgument(expect.ErrorMessage):
+    """Tests that -fsize-attribution= needs a file name."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-fsize-attribution=', shader]
+    expected_error = [
+        "glslc: error: argument to '-fsize-attribution=' is missing\n"]
+
+
+@inside_glslc_testsuite('OptionFSizeAttribution')
+class TestSizeAttributionWithPreprocessing(expect.ErrorMessage):
+    """Tests that -fsize-attribution cannot be combined with -E."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-E', '-fsize-attribution=s.json', shader]
+    expected_error = [
+        'glslc: error: cannot use -fsize-attribution with -E or -M\n']
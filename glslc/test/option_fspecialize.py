@@ -0,0 +1,95 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+SPECIALIZABLE_SHADER = '''#version 450
+layout(constant_id = 3) const bool kFancy = false;
+layout(constant_id = 5) const int kCount = 2;
+layout(location = 0) out vec4 color;
+void main() {
+  color = kFancy ? vec4(float(kCount)) : vec4(1.0);
+}
+'''
+
+SPECIALIZABLE_ASSEMBLY = """; SPIR-V
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main"
+               OpExecutionMode %main OriginUpperLeft
+               OpDecorate %fancy SpecId 3
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+       %bool = OpTypeBool
+      %fancy = OpSpecConstantFalse %bool
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+               OpReturn
+               OpFunctionEnd
+"""
+
+
+@inside_glslc_testsuite('OptionFSpecialize')
+class TestFSpecializeWritesEachOutput(expect.ValidNamedObjectFile):
+    """Tests that each specialization is written next to the primary output."""
+
+    environment = Directory('.', [File('shader.frag', SPECIALIZABLE_SHADER)])
+    glslc_args = ['-c', '-fspecialize=fancy:3=true,5=8',
+                  '-fspecialize=plain:3=false', 'shader.frag']
+    expected_object_filenames = ('shader.frag.spv', 'shader.frag.fancy.spv',
+                                 'shader.frag.plain.spv')
+
+
+@inside_glslc_testsuite('OptionFSpecialize')
+class TestFSpecializeAssemblyInput(expect.ValidNamedObjectFile):
+    """Tests that an assembled SPIR-V input can be specialized."""
+
+    environment = Directory('.',
+                            [File('shader.spvasm', SPECIALIZABLE_ASSEMBLY)])
+    glslc_args = ['-c', '-fspecialize=fancy:3=true', 'shader.spvasm']
+    expected_object_filenames = ('shader.spv', 'shader.fancy.spv')
+
+
+@inside_glslc_testsuite('OptionFSpecialize')
+class TestFSpecializeUnknownSpecId(expect.ErrorMessageSubstr):
+    """Tests that a SpecId the module does not have is rejected."""
+
+    shader = FileShader(SPECIALIZABLE_SHADER, '.frag')
+    glslc_args = ['-c', '-fspecialize=bad:9=1', shader]
+    expected_error_substr = (
+        'failed to specialize: no specialization constant has SpecId 9')
+
+
+@inside_glslc_testsuite('OptionFSpecialize')
+class TestFSpecializeMalformedValue(expect.ErrorMessage):
+    """Tests that each value must be given as <id>=<value>."""
+
+    shader = FileShader(SPECIALIZABLE_SHADER, '.frag')
+    glslc_args = ['-c', '-fspecialize=bad:3', shader]
+    expected_error = [
+        "glslc: error: -fspecialize: expected <id>=<value>, got '3' in "
+        "specialization 'bad'\n"]
+
+
+@inside_glslc_testsuite('OptionFSpecialize')
+class TestFSpecializeWithAssembly(expect.ErrorMessage):
+    """Tests that specializations need SPIR-V binary output."""
+
+    shader = FileShader(SPECIALIZABLE_SHADER, '.frag')
+    glslc_args = ['-S', '-fspecialize=fancy:3=true', shader]
+    expected_error = [
+        'glslc: error: cannot use -fspecialize with -S, -E or -M\n']
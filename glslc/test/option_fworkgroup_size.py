@@ -0,0 +1,141 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import re
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+COMPUTE_SHADER = '''#version 450
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(set = 0, binding = 0) buffer Data { uint values[]; };
+void main() { values[gl_LocalInvocationIndex] = 1u; }
+'''
+FOLDED_SHADER = '''#version 450
+layout(local_size_x = 8) in;
+layout(set = 0, binding = 0) buffer Data { uint values[]; };
+void main() { values[0] = gl_WorkGroupSize.x; }
+'''
+LIBRARY_SHADER = '''#version 450
+uint twice(uint x) { return 2u * x; }
+'''
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeChangesLocalSize(
+        expect.ValidAssemblyFileWithSubstr):
+    """Tests that -fworkgroup-size replaces the declared size."""
+
+    shader = FileShader(COMPUTE_SHADER, '.comp')
+    glslc_args = ['-S', '-fworkgroup-size=64,1,0', shader]
+    expected_assembly_substr = 'LocalSize 64 1 1'
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeSpecIds(expect.ValidAssemblyFileWithSubstr):
+    """Tests that -fworkgroup-size-spec-ids makes the size specializable."""
+
+    shader = FileShader(COMPUTE_SHADER, '.comp')
+    glslc_args = ['-S', '-fworkgroup-size-spec-ids=3,4,5', shader]
+    expected_assembly_substr = 'SpecId 5'
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeFolded(expect.ErrorMessageSubstr):
+    """Tests that a size folded into the code cannot be changed."""
+
+    shader = FileShader(FOLDED_SHADER, '.comp')
+    glslc_args = ['-c', '-fworkgroup-size=64,1,1', shader]
+    expected_error_substr = 'cannot change workgroup size component x'
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeBadValue(expect.ErrorMessage):
+    """Tests that a size needs three components."""
+
+    shader = FileShader(COMPUTE_SHADER, '.comp')
+    glslc_args = ['-c', '-fworkgroup-size=64,1', shader]
+    expected_error = [
+        "glslc: error: -fworkgroup-size: expected <x>,<y>,<z>, got '64,1'\n"]
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeVariantWritesEachOutput(expect.ValidNamedObjectFile):
+    """Tests that each workgroup size variant gets its own output."""
+
+    environment = Directory('.', [File('shader.comp', COMPUTE_SHADER)])
+    glslc_args = ['-c', '-O', '-fworkgroup-size-variant=64,1,1',
+                  '-fworkgroup-size-variant=16,16,1', 'shader.comp']
+    expected_object_filenames = ('shader.comp.spv',
+                                 'shader.comp.wg64x1x1.spv',
+                                 'shader.comp.wg16x16x1.spv')
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeVariantManifest(expect.ValidFileContents,
+                                        expect.ValidNamedObjectFile):
+    """Tests that --variant-manifest lists the variant outputs."""
+
+    environment = Directory('.', [File('shader.comp', COMPUTE_SHADER)])
+    glslc_args = ['-c', '-fworkgroup-size-variant=64,1,1',
+                  '-fopt-variant=small:-Os', '--variant-manifest=m.json',
+                  'shader.comp']
+    expected_object_filenames = ('shader.comp.spv', 'shader.comp.small.spv',
+                                 'shader.comp.wg64x1x1.spv')
+    target_filename = 'm.json'
+    expected_file_contents = re.compile(
+        r'"variants": \[\n    \{\n      "input": "shader.comp",\n'
+        r'      "name": "small",\n'
+        r'      "primary_output": "shader.comp.spv",\n'
+        r'      "output": "shader.comp.small.spv"\n    \},'
+        r'(.|\n)*"name": "wg64x1x1"(.|\n)*'
+        r'"output": "shader.comp.wg64x1x1.spv",\n'
+        r'      "workgroup_size": \[64, 1, 1\]')
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeVariantWithPreprocessing(expect.ErrorMessage):
+    """Tests that workgroup size variants cannot be combined with -E."""
+
+    shader = FileShader(COMPUTE_SHADER, '.comp')
+    glslc_args = ['-E', '-fworkgroup-size-variant=64,1,1', shader]
+    expected_error = [
+        'glslc: error: cannot use -fworkgroup-size-variant with -E or -M\n']
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeWhenLinking(expect.ErrorMessage):
+    """Tests that -fworkgroup-size cannot be applied to linked inputs."""
+
+    environment = Directory('.', [
+        File('kernel.comp', COMPUTE_SHADER),
+        File('lib.comp', LIBRARY_SHADER)])
+    glslc_args = ['-fworkgroup-size=64,1,1', 'kernel.comp', 'lib.comp']
+    expected_error = [
+        'glslc: error: cannot use -fworkgroup-size with -fcompile-only or '
+        'when linking multiple files\n']
+
+
+@inside_glslc_testsuite('OptionFWorkgroupSize')
+class TestFWorkgroupSizeWithCompileOnly(expect.ErrorMessage):
+    """Tests that -fworkgroup-size cannot be applied to compile-only modules."""
+
+    shader = FileShader(COMPUTE_SHADER, '.comp')
+    glslc_args = ['-c', '-fcompile-only', '-fworkgroup-size-spec-ids=3,4,5',
+                  shader]
+    expected_error = [
+        'glslc: error: cannot use -fworkgroup-size-spec-ids with '
+        '-fcompile-only or when linking multiple files\n']
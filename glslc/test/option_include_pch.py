@@ -0,0 +1,128 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import re
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+NOISE = 'float noise(float x) { return fract(sin(x) * 43758.5453); }\n'
+PRELUDE = '''#include "noise.glsl"
+#define SCALE 2.0
+#define UNSET 1
+#undef UNSET
+'''
+FRAGMENT_SHADER = '''#version 450
+layout(location = 0) out vec4 color;
+#ifdef UNSET
+#error UNSET is defined
+#endif
+void main() { color = vec4(noise(gl_FragCoord.x) * SCALE); }
+'''
+COMPUTE_SHADER = '''#version 450
+layout(local_size_x = 8) in;
+layout(std430, binding = 0) buffer Data { float values[]; };
+void main() {
+  values[gl_GlobalInvocationID.x] = noise(float(gl_GlobalInvocationID.x));
+}
+'''
+BAD_SHADER = '''#version 450
+
+void main() { bogus; }
+'''
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchCompilesEachInput(expect.ValidNamedObjectFile):
+    """Tests that every input is compiled with the declarations and macros of
+    the prelude, including those of its includes."""
+
+    environment = Directory('.', [File('prelude.glsl', PRELUDE),
+                                  File('noise.glsl', NOISE),
+                                  File('a.frag', FRAGMENT_SHADER),
+                                  File('b.comp', COMPUTE_SHADER)])
+    glslc_args = ['-c', '-include-pch', 'prelude.glsl', 'a.frag', 'b.comp']
+    expected_object_filenames = ('a.frag.spv', 'b.comp.spv')
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchPreprocessed(expect.StdoutMatch, expect.NoOutputOnStderr):
+    """Tests that -E shows the prelude, expanded, after the #version of the
+    input."""
+
+    environment = Directory('.', [File('prelude.glsl', PRELUDE),
+                                  File('noise.glsl', NOISE),
+                                  File('a.frag', FRAGMENT_SHADER)])
+    glslc_args = ['-E', '-include-pch', 'prelude.glsl', 'a.frag']
+    expected_stdout = re.compile(
+        r'(?s)^#version 450\n.*#line 1 "prelude.glsl"\n.*'
+        r'float noise\(float x\).*#line 2 "a.frag"\n.*'
+        r'color = vec4\(noise\(gl_FragCoord\.x\) \* 2\.0\)')
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchKeepsInputLines(expect.ErrorMessageSubstr):
+    """Tests that errors in an input keep their lines."""
+
+    environment = Directory('.', [File('prelude.glsl', PRELUDE),
+                                  File('noise.glsl', NOISE),
+                                  File('bad.frag', BAD_SHADER)])
+    glslc_args = ['-c', '-include-pch', 'prelude.glsl', 'bad.frag']
+    expected_error_substr = 'bad.frag:3: error: '
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchErrorNamesPrelude(expect.ErrorMessageSubstr):
+    """Tests that errors in the prelude name it and its line."""
+
+    environment = Directory('.', [File('prelude.glsl',
+                                       'float x;\n#error in prelude\n'),
+                                  File('a.frag', MINIMAL_SHADER)])
+    glslc_args = ['-c', '-include-pch', 'prelude.glsl', 'a.frag']
+    expected_error_substr = 'prelude.glsl:2: error: '
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchMissingArgument(expect.ErrorMessage):
+    """Tests that -include-pch needs a file name."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', shader, '-include-pch']
+    expected_error = [
+        "glslc: error: argument to '-include-pch' is missing "
+        "(expected 1 value)\n"]
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchMissingFile(expect.NoGeneratedFiles,
+                                expect.ErrorMessageSubstr):
+    """Tests that -include-pch needs a readable file."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '-include-pch', 'missing.glsl', shader]
+    expected_error_substr = 'glslc: error: cannot read prelude: missing.glsl\n'
+
+
+@inside_glslc_testsuite('OptionIncludePch')
+class TestIncludePchWithDependencies(expect.ErrorMessage):
+    """Tests that -include-pch cannot be combined with -M."""
+
+    environment = Directory('.', [File('prelude.glsl', 'float x;\n'),
+                                  File('a.frag', MINIMAL_SHADER)])
+    glslc_args = ['-M', '-include-pch', 'prelude.glsl', 'a.frag']
+    expected_error = [
+        'glslc: error: cannot use -include-pch with -M or -MD\n']
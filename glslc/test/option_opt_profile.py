@@ -0,0 +1,76 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import expect
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+# A fragment shader with mediump arithmetic in a loop marked for unrolling.
+RELAXED_LOOP_SHADER = """#version 450
+#extension GL_EXT_control_flow_attributes : require
+layout(location = 0) in mediump vec4 in_color;
+layout(location = 0) out mediump vec4 out_color;
+void main() {
+  mediump vec4 sum = vec4(0.0);
+  [[unroll]] for (int i = 0; i < 4; ++i) {
+    sum = sum * in_color + in_color;
+  }
+  out_color = sum;
+}"""
+
+
+@inside_glslc_testsuite('OptionOptProfile')
+class TestOptProfileGenericUnrolls(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that the generic profile unrolls loops marked for unrolling."""
+
+    shader = FileShader(RELAXED_LOOP_SHADER, '.frag')
+    glslc_args = ['-S', '-O', '--opt-profile=generic', shader]
+    unexpected_assembly_substr = 'OpLoopMerge'
+
+
+@inside_glslc_testsuite('OptionOptProfile')
+class TestOptProfileMobileKeepsLoops(expect.ValidAssemblyFileWithSubstr):
+    """Tests that the mobile profile does not unroll loops."""
+
+    shader = FileShader(RELAXED_LOOP_SHADER, '.frag')
+    glslc_args = ['-S', '-O', '--opt-profile=mobile', shader]
+    expected_assembly_substr = 'OpLoopMerge'
+
+
+@inside_glslc_testsuite('OptionOptProfile')
+class TestOptProfileMobileUsesHalf(expect.ValidAssemblyFileWithSubstr):
+    """Tests that the mobile profile does mediump arithmetic in 16 bits."""
+
+    shader = FileShader(RELAXED_LOOP_SHADER, '.frag')
+    glslc_args = ['-S', '--opt-profile=mobile', '-O', shader]
+    expected_assembly_substr = 'OpTypeFloat 16'
+
+
+@inside_glslc_testsuite('OptionOptProfile')
+class TestOptProfileMobileWithoutDashO(expect.ValidAssemblyFileWithoutSubstr):
+    """Tests that profiles only affect -O."""
+
+    shader = FileShader(RELAXED_LOOP_SHADER, '.frag')
+    glslc_args = ['-S', '-Os', '--opt-profile=mobile', shader]
+    unexpected_assembly_substr = 'OpTypeFloat 16'
+
+
+@inside_glslc_testsuite('OptionOptProfile')
+class TestOptProfileUnknown(expect.ErrorMessage):
+    """Tests that an unknown profile is rejected."""
+
+    shader = FileShader(RELAXED_LOOP_SHADER, '.frag')
+    glslc_args = ['-c', '-O', '--opt-profile=desktop', shader]
+    expected_error = [
+        "glslc: error: invalid value 'desktop' in '--opt-profile=desktop'\n"]
@@ -0,0 +1,94 @@
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import re
+
+import expect
+from environment import File, Directory
+from glslc_test_framework import inside_glslc_testsuite
+from placeholder import FileShader
+
+MINIMAL_SHADER = '#version 310 es\nvoid main() {}'
+COMPUTE_SHADER = '''#version 450
+layout(local_size_x = 8, local_size_y = 4) in;
+layout(set = 0, binding = 1) buffer Data { uint values[]; } data;
+void main() { data.values[gl_GlobalInvocationID.x] = 1u; }
+'''
+
+
+@inside_glslc_testsuite('OptionReflect')
+class TestReflectWritesFile(expect.ValidFileContents,
+                            expect.ValidNamedObjectFile):
+    """Tests that --reflect writes reflection next to the object file."""
+
+    environment = Directory('.', [File('shader.comp', COMPUTE_SHADER)])
+    glslc_args = ['-c', '--reflect=r.json', 'shader.comp']
+    expected_object_filenames = ('shader.comp.spv', )
+    target_filename = 'r.json'
+    expected_file_contents = re.compile(
+        r'"shaders": \[\n    \{\n      "input": "shader.comp",\n'
+        r'      "output": "shader.comp.spv",\n'
+        r'(.|\n)*"workgroup_size": \[8, 4, 1\]'
+        r'(.|\n)*"set": 0, "binding": 1')
+
+
+@inside_glslc_testsuite('OptionReflect')
+class TestReflectMergesBatch(expect.ValidFileContents,
+                             expect.ValidNamedObjectFile):
+    """Tests that a batch of inputs shares one reflection file."""
+
+    environment = Directory('.', [File('a.vert', MINIMAL_SHADER),
+                                  File('b.frag', MINIMAL_SHADER)])
+    glslc_args = ['-c', '--reflect=r.json', 'a.vert', 'b.frag']
+    expected_object_filenames = ('a.vert.spv', 'b.frag.spv')
+    target_filename = 'r.json'
+    expected_file_contents = re.compile(
+        r'"input": "a.vert"(.|\n)*"stage": "vertex"'
+        r'(.|\n)*"input": "b.frag"(.|\n)*"stage": "fragment"')
+
+
+@inside_glslc_testsuite('OptionReflect')
+class TestReflectCoversVariants(expect.ValidFileContents,
+                                expect.ValidNamedObjectFile):
+    """Tests that workgroup size variants are reflected too."""
+
+    environment = Directory('.', [File('shader.comp', COMPUTE_SHADER)])
+    glslc_args = ['-c', '--reflect=r.json', '-fworkgroup-size-variant=64,1,1',
+                  'shader.comp']
+    expected_object_filenames = ('shader.comp.spv',
+                                 'shader.comp.wg64x1x1.spv')
+    target_filename = 'r.json'
+    expected_file_contents = re.compile(
+        r'"output": "shader.comp.spv",\n'
+        r'(.|\n)*"workgroup_size": \[8, 4, 1\]'
+        r'(.|\n)*"output": "shader.comp.wg64x1x1.spv",\n'
+        r'(.|\n)*"workgroup_size": \[64, 1, 1\]')
+
+
+@inside_glslc_testsuite('OptionReflect')
+class TestReflectMissingArgument(expect.ErrorMessage):
+    """Tests that --reflect= needs a file name."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-c', '--reflect=', shader]
+    expected_error = ["glslc: error: argument to '--reflect=' is missing\n"]
+
+
+@inside_glslc_testsuite('OptionReflect')
+class TestReflectWithPreprocessing(expect.ErrorMessage):
+    """Tests that --reflect cannot be combined with -E."""
+
+    shader = FileShader(MINIMAL_SHADER, '.vert')
+    glslc_args = ['-E', '--reflect=r.json', shader]
+    expected_error = ['glslc: error: cannot use --reflect with -E or -M\n']
@@ -68,6 +68,24 @@ Options:
   -fauto-combined-image-sampler
                     Removes sampler variables and converts existing textures
                     to combined image-samplers.
+  -fbake-uniform=<block>.<member>=<value>
+                    Compile with the given uniform block member fixed to
+                    <value>, so that the optimizer folds it and drops the
+                    code and bindings it leaves unused.  Vector components
+                    are separated by commas.  May be repeated.
+  -fcompile-only    Compile GLSL shaders without linking them, so that they
+                    may call functions defined in other modules, and export
+                    their own functions to them.  Such modules are linked by
+                    passing them together to glslc without -c.
+  -fcost-baseline=<file>
+                    Compare the static cost of each output with that recorded
+                    for the same output file in <file>, written earlier by
+                    -fcost-report, and print every metric that changed.
+  -fcost-report=<file>
+                    Write static cost metrics for each entry point of each
+                    output to <file>, as JSON: ALU, transcendental, texture
+                    and memory instructions, branches, loops, live values,
+                    and a loop-weighted operation count.
   -fentry-point=<name>
                     Specify the entry point name for HLSL compilation, for
                     all subsequent source files.  Default is "main".
@@ -79,6 +97,13 @@ Options:
   -fhlsl-iomap      Use HLSL IO mappings for bindings.
   -fhlsl-offsets    Use HLSL offset rules for packing members of blocks.
                     Affects only GLSL.  HLSL rules are always used for HLSL.
+  -finclude-report=<file>
+                    Write what each file included by the inputs cost across
+                    all of them to <file>, as JSON, from the slowest down:
+                    how many inputs included it, the bytes and time spent on
+                    it, and how many of those inputs had no code from it.  A
+                    file no input had code from is suggested for removal, and
+                    one only some inputs had code from for splitting.
   -finvert-y        Invert position.Y output in vertex shader.
   -flimit=<settings>
                     Specify resource limits. Each limit is specified by a limit
@@ -91,6 +116,13 @@ Options:
                     a NaN operand, the other operand is returned. Similarly,
                     the clamp builtin will favour the non-NaN operands, as if
                     clamp were implemented as a composition of max and min.
+  -fopt-variant=<name>:<flags>
+                    Also write an output optimized according to <flags>, a
+                    comma-separated list of -O0, -O, -Os, -Oz,
+                    -Ofast-compile, and -g.  Its file name is the output
+                    file name with .<name> inserted before the extension.
+                    The source is compiled only once for all outputs.  May
+                    be repeated.
   -fpreserve-bindings
                     Preserve all binding declarations, even if those bindings
                     are not used.
@@ -135,10 +167,49 @@ Options:
                     Treat subsequent input files as having stage <stage>.
                     Valid stages are vertex, vert, fragment, frag, tesscontrol,
                     tesc, tesseval, tese, geometry, geom, compute, and comp.
+  -fsize-attribution=<file>
+                    Write the words of each output attributed to its
+                    functions, and to the source files and includes their
+                    code comes from, to <file>, as JSON, from the largest
+                    contributor down.  Lines are taken from debug info,
+                    which is generated for this and stripped afterwards.
+  -fsize-baseline=<file>
+                    Compare the size attribution of each output with that
+                    recorded for the same output file in <file>, written
+                    earlier by -fsize-attribution, and print every
+                    contributor that changed, from the largest change down.
+  -fspecialize=<name>:<id>=<value>[,<id>=<value>...]
+                    Also write an output specialized from the primary output,
+                    with the specialization constant of each SpecId <id> set
+                    to <value>.  All specialization constants are then frozen
+                    and folded, and the output is optimized like the primary
+                    output.  Its file name is derived as for -fopt-variant.
+                    Requires SPIR-V binary output.  May be repeated.
+  -fworkgroup-size=<x>,<y>,<z>
+                    Set the workgroup size of compute, task and mesh
+                    shaders.  A zero component keeps the size the shader
+                    declares.  If the shader uses gl_WorkGroupSize, only
+                    components declared with local_size_x_id and the like
+                    can be changed.
+  -fworkgroup-size-spec-ids=<x>,<y>,<z>
+                    Make the workgroup size of compute, task and mesh
+                    shaders specializable, with the given SpecIds for the
+                    components that are not specialization constants yet.
+  -fworkgroup-size-variant=<x>,<y>,<z>
+                    Also write an output with the given workgroup size,
+                    named wg<x>x<y>x<z> and otherwise like an -fopt-variant
+                    output optimized like the primary output.  May be
+                    repeated.
   -g                Generate source-level debug information.
   -h                Display available options.
   --help            Display available options.
   -I <value>        Add directory to include search path.
+  -include-pch <file>
+                    Compile each GLSL input as if it included <file> right
+                    after its #version directive and the #extension and
+                    #pragma directives that follow it.  <file> and its
+                    includes are preprocessed once for each #version they
+                    are used with, rather than once for each input.
   -mfmt=<format>    Output SPIR-V binary code using the selected format. This
                     option may be specified only when the compilation output is
                     in SPIR-V binary code form. Available options are:
@@ -154,12 +225,32 @@ Options:
   -O                Optimize the generated SPIR-V code for better performance.
   -Os               Optimize the generated SPIR-V code for smaller size.
   -O0               Disable optimization.
+  -Oz               Minimize the size of the generated SPIR-V code, for
+                    shipping: -Os, then strip non-semantic instructions,
+                    merge duplicate declarations, and compact IDs.  The
+                    result is validated.
+  -Ofast-compile    Run only cheap optimizations and skip SPIR-V validation,
+                    for the lowest compile time that still removes dead code.
   -o <file>         Write output to <file>.
                     A file name of '-' represents standard output.
+  --opt-profile=<profile>
+                    Tune -O for a kind of GPU.  Values are:
+                        generic   # The default
+                        mobile    # Fewer registers: no loop unrolling,
+                                  # less scalar replacement, and 16-bit
+                                  # arithmetic for mediump operations.
+                                  # Needs the shaderFloat16 feature.
+  --reflect=<file>  Write reflection data for each output to <file>, as
+                    JSON: entry points, workgroup sizes, descriptor
+                    bindings, push constants, specialization constants,
+                    and input and output locations.  The data of all the
+                    outputs of one invocation goes into one file.
   -std=<value>      Version and profile for GLSL input files. Possible values
                     are concatenations of version and profile, e.g. 310es,
                     450core, etc.  Ignored for HLSL files.
   -S                Emit SPIR-V assembly instead of binary.
+  --size-report     With -Oz, print the size of each output after each
+                    stage of optimization to standard error.
   --show-limits     Display available limit names and their default values.
   --target-env=<environment>
                     Set the target client environment, and the semantics
@@ -184,6 +275,11 @@ Options:
                     the default for vulkan1.4 is spv1.6.
                     Values are:
                         spv1.0, spv1.1, spv1.2, spv1.3, spv1.4, spv1.5, spv1.6
+  --variant-manifest=<file>
+                    Write a list of the outputs written for -fopt-variant,
+                    -fspecialize and -fworkgroup-size-variant to <file>, as
+                    JSON: the input, variant name, primary output, output,
+                    and workgroup size of each.
   --version         Display compiler version information.
   -w                Suppresses all warning messages.
   -Werror           Treat all warnings as errors.
@@ -191,6 +287,15 @@ Options:
                     Valid languages are: glsl, hlsl.
                     For files ending in .hlsl the default is hlsl.
                     Otherwise the default is glsl.
+  -Xspirv-opt <flag>
+                    Run the optimization pass named by the given spirv-opt
+                    flag, e.g. --loop-unroll, after the passes selected by
+                    -O, -Os, -Ofast-compile, or -O0.  May be repeated;
+                    passes run in the order given.
+  -Xspirv-opt-file <file>
+                    Like -Xspirv-opt, but reads the flags from a pass-list
+                    file.  Flags are separated by whitespace, and '#' starts
+                    a comment that runs to the end of the line.
 '''
 
     expected_stderr = ''
@@ -239,18 +344,6 @@ class FileNotFound(expect.ErrorMessage):
         "': No such file or directory\n"]
 
 
-@inside_glslc_testsuite('Unsupported')
-class LinkingNotSupported(expect.ErrorMessage):
-    """Tests the error message generated by linking not supported yet."""
-
-    shader1 = FileShader('#version 140\nvoid main() {}', '.vert')
-    shader2 = FileShader('#version 140\nvoid main() {}', '.frag')
-    glslc_args = [shader1, shader2]
-    expected_error = [
-        'glslc: error: linking multiple files is not supported yet. ',
-        'Use -c to compile files individually.\n']
-
-
 @inside_glslc_testsuite('Unsupported')
 class MultipleStdinUnsupported(expect.ErrorMessage):
     """Tests the error message generated by having more than one - input."""
@@ -88,6 +88,34 @@ class FileShader(PlaceHolder):
         return self.filename
 
 
+class FileBinary(PlaceHolder):
+    """Stands for an input file whose content is the given bytes."""
+
+    def __init__(self, content, suffix):
+        assert isinstance(content, bytes)
+        assert isinstance(suffix, str)
+        self.content = content
+        self.suffix = suffix
+        self.filename = None
+
+    def instantiate_for_glslc_args(self, testcase):
+        """Creates a temporary file and writes the content into it.
+
+        Returns:
+            The name of the temporary file.
+        """
+        binary, self.filename = tempfile.mkstemp(
+            dir=testcase.directory, suffix=self.suffix)
+        binary_object = os.fdopen(binary, 'wb')
+        binary_object.write(self.content)
+        binary_object.close()
+        return self.filename
+
+    def instantiate_for_expectation(self, testcase):
+        assert self.filename is not None
+        return self.filename
+
+
 class StdinShader(PlaceHolder):
     """Stands for a shader whose source code is from stdin."""
 
@@ -155,7 +155,8 @@ class TestConflictingPSS(expect.ErrorMessage):
     glslc_args = ['-c', shader]
     expected_error = [
         shader, ":6: error: '#pragma': conflicting stages for 'shader_stage' "
-        "#pragma: 'fragment' (was 'vertex' at ", shader, ':2)\n']
+        "#pragma: 'fragment' (was 'vertex' at ", shader, ':2)\n',
+        '1 error generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -185,7 +186,8 @@ class TestWrongPSSValue(expect.ErrorMessage):
     glslc_args = ['-c', shader]
     expected_error = [
         shader, ":2: error: '#pragma': invalid stage for 'shader_stage' "
-        "#pragma: 'superstage'\n"]
+        "#pragma: 'superstage'\n",
+        '1 error generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -202,7 +204,8 @@ class TestEmptyPSSValue(expect.ErrorMessage):
     glslc_args = ['-c', shader]
     expected_error = [
         shader, ":2: error: '#pragma': invalid stage for 'shader_stage' "
-        "#pragma: ''\n"]
+        "#pragma: ''\n",
+        '1 error generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -223,7 +226,8 @@ class TestFirstPSSBeforeNonPPCode(expect.ErrorMessage):
     glslc_args = ['-c', shader]
     expected_error = [
         shader, ":5: error: '#pragma': the first 'shader_stage' #pragma "
-        'must appear before any non-preprocessing code\n']
+        'must appear before any non-preprocessing code\n',
+        '1 error generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -246,7 +250,8 @@ class TestPSSMultipleErrors(expect.ErrorMessage):
         shader, ":3: error: '#pragma': conflicting stages for 'shader_stage' "
         "#pragma: 'vertex' (was 'idontknow' at ", shader, ':2)\n',
         shader, ":7: error: '#pragma': conflicting stages for 'shader_stage' "
-        "#pragma: 'fragment' (was 'idontknow' at ", shader, ':2)\n']
+        "#pragma: 'fragment' (was 'idontknow' at ", shader, ':2)\n',
+        '3 errors generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -328,7 +333,8 @@ class TestNoMacroExpansionInsidePSS(expect.ErrorMessage):
 
     expected_error = [
         shader, ":2: error: '#pragma': invalid stage for 'shader_stage' "
-        "#pragma: 'STAGE_FROM_CMDLINE'\n"]
+        "#pragma: 'STAGE_FROM_CMDLINE'\n",
+        '1 error generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -354,7 +360,8 @@ class TestPSSWithPoundLine310(expect.ErrorMessage):
         shader, ":42: error: '#pragma': conflicting stages for 'shader_stage' "
         "#pragma: 'google' (was 'unknown' at ", shader, ':2)\n',
         shader, ":100: error: '#pragma': conflicting stages for 'shader_stage' "
-        "#pragma: 'elgoog' (was 'unknown' at ", shader, ':2)\n']
+        "#pragma: 'elgoog' (was 'unknown' at ", shader, ':2)\n',
+        '3 errors generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -384,7 +391,8 @@ class TestPSSWithPoundLine150(expect.ErrorMessage):
         shader, ":43: error: '#pragma': conflicting stages for 'shader_stage' "
         "#pragma: 'google' (was 'unknown' at ", shader, ':2)\n',
         shader, ":101: error: '#pragma': conflicting stages for 'shader_stage' "
-        "#pragma: 'elgoog' (was 'unknown' at ", shader, ':2)\n']
+        "#pragma: 'elgoog' (was 'unknown' at ", shader, ':2)\n',
+        '3 errors generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -432,7 +440,8 @@ class TestConflictingPSSfromIncludingAndIncludedFile(expect.ErrorMessage):
 
     expected_error = [
         "b.glsl:1: error: '#pragma': conflicting stages for 'shader_stage' "
-        "#pragma: 'vertex' (was 'fragment' at a.vert:2)\n"]
+        "#pragma: 'vertex' (was 'fragment' at a.vert:2)\n",
+        '1 error generated.\n']
 
 
 @inside_glslc_testsuite('PragmaShaderStage')
@@ -458,4 +467,5 @@ class TestPSSWithFileNameBasedPoundLine(expect.ErrorMessage):
         "abc:42: error: '#pragma': conflicting stages for 'shader_stage' "
         "#pragma: 'google' (was 'unknown' at ", shader, ':2)\n',
         "def:100: error: '#pragma': conflicting stages for 'shader_stage' "
-        "#pragma: 'elgoog' (was 'unknown' at ", shader, ':2)\n']
+        "#pragma: 'elgoog' (was 'unknown' at ", shader, ':2)\n',
+        '3 errors generated.\n']
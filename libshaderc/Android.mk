@@ -22,7 +22,7 @@ LOCAL_SRC_FILES:=src/shaderc.cc
 # The Shaderc third_party/Android.mk deduces SPVHEADERS_LOCAL_PATH,
 # or delegates that responsibility to SPIRV-Tools' Android.mk.
 LOCAL_C_INCLUDES:=$(LOCAL_PATH)/include $(SPVHEADERS_LOCAL_PATH)/include
-LOCAL_STATIC_LIBRARIES:=shaderc_util SPIRV-Tools-opt
+LOCAL_STATIC_LIBRARIES:=shaderc_util SPIRV-Tools-opt SPIRV-Tools-link
 LOCAL_CXXFLAGS:=-std=c++17 -fno-exceptions -fno-rtti -DENABLE_HLSL=1
 LOCAL_EXPORT_CPPFLAGS:=-std=c++17
 LOCAL_EXPORT_LDFLAGS:=-latomic
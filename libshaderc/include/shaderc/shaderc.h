@@ -102,8 +102,27 @@ typedef enum {
   shaderc_optimization_level_zero,  // no optimization
   shaderc_optimization_level_size,  // optimize towards reducing code size
   shaderc_optimization_level_performance,  // optimize towards performance
+  // Run only cheap, function-local passes and skip validation, trading some
+  // code quality for compile latency.  Meant for runtime compilation.
+  shaderc_optimization_level_fast_compile,
+  // Reduce the size of the module as far as possible, for modules that are
+  // shipped: on top of shaderc_optimization_level_size, strip non-semantic
+  // instructions, merge duplicate declarations and compact IDs.  The result
+  // is validated, and the size after each stage is recorded; see
+  // shaderc_result_get_optimization_stages.
+  shaderc_optimization_level_min_size,
 } shaderc_optimization_level;
 
+// Kinds of GPU that shaderc_optimization_level_performance can be tuned for.
+typedef enum {
+  shaderc_optimization_profile_generic,  // the standard performance passes
+  // Tuned for mobile GPUs: scalar replacement only of small aggregates, no
+  // loop unrolling, and operations decorated RelaxedPrecision, such as
+  // mediump ones, converted to 16-bit floating point.  The output uses the
+  // Float16 capability, so the device must support shaderFloat16.
+  shaderc_optimization_profile_mobile,
+} shaderc_optimization_profile;
+
 // Resource limits.
 typedef enum {
   shaderc_limit_max_lights,
@@ -324,6 +343,41 @@ SHADERC_EXPORT void shaderc_compile_options_set_generate_debug_info(
 SHADERC_EXPORT void shaderc_compile_options_set_optimization_level(
     shaderc_compile_options_t options, shaderc_optimization_level level);
 
+// Sets the profile that shaderc_optimization_level_performance is tuned for.
+// A profile other than shaderc_optimization_profile_generic replaces the
+// performance passes with its own.  It has no effect at other optimization
+// levels.  The default is shaderc_optimization_profile_generic.
+SHADERC_EXPORT void shaderc_compile_options_set_optimization_profile(
+    shaderc_compile_options_t options, shaderc_optimization_profile profile);
+
+// Sets custom optimizer passes, given as spirv-opt command line flags such as
+// "--loop-unroll" or "--scalar-replacement=100". They run in the given order,
+// after the passes selected by the optimization level, including for
+// shaderc_optimization_level_zero. The flags are validated once by this call
+// and reused by every compilation with these options. Returns false, leaving
+// previously set passes in place, if any flag does not name a known pass;
+// see shaderc_compile_options_get_optimizer_passes_error for why.
+// Passing zero flags removes any custom passes. The flag strings can be
+// modified or deleted after this function has returned.
+SHADERC_EXPORT bool shaderc_compile_options_set_optimizer_passes(
+    shaderc_compile_options_t options, const char* const* flags,
+    size_t num_flags);
+
+// Like shaderc_compile_options_set_optimizer_passes, but takes the flags from
+// the text of a pass-list file: flags separated by whitespace, where '#'
+// starts a comment that runs to the end of the line.
+SHADERC_EXPORT bool shaderc_compile_options_set_optimizer_pass_list(
+    shaderc_compile_options_t options, const char* pass_list,
+    size_t pass_list_length);
+
+// Returns why the last call to shaderc_compile_options_set_optimizer_passes
+// or shaderc_compile_options_set_optimizer_pass_list with the options
+// returned false, such as "unknown optimizer flag '--no-such-pass'", or an
+// empty string if it succeeded or there was none.  The string is valid until
+// the next such call or until the options are released.
+SHADERC_EXPORT const char* shaderc_compile_options_get_optimizer_passes_error(
+    const shaderc_compile_options_t options);
+
 // Forces the GLSL language version and profile to a given pair. The version
 // number is the same as would appear in the #version annotation in the source.
 // Version and profile specified here overrides the #version annotation in the
@@ -463,6 +517,24 @@ SHADERC_EXPORT void shaderc_compile_options_set_binding_base_for_stage(
 SHADERC_EXPORT void shaderc_compile_options_set_preserve_bindings(
     shaderc_compile_options_t options, bool preserve_bindings);
 
+// Sets whether shaderc_compile_pipeline_into_spv removes the resources that
+// no stage of the pipeline uses, and renumbers the descriptor sets in use,
+// and the bindings in use within each set, from zero without gaps.  The
+// order of sets and bindings is kept, and a resource shared by several
+// stages gets the same set and binding in all of them.  Overrides
+// shaderc_compile_options_set_preserve_bindings for pipelines.  Has no
+// effect on other compilations.
+SHADERC_EXPORT void shaderc_compile_options_set_compact_pipeline_bindings(
+    shaderc_compile_options_t options, bool compact);
+
+// Sets whether GLSL is compiled without linking, for a SPIR-V module that
+// will be linked later with shaderc_link_spv.  Such a module exports the
+// functions it defines, imports the functions it only declares, and need not
+// have an entry point.  It is not optimized; optimization happens when it is
+// linked.  Has no effect on HLSL.
+SHADERC_EXPORT void shaderc_compile_options_set_compile_only(
+    shaderc_compile_options_t options, bool compile_only);
+
 // Sets whether the compiler should automatically assign locations to
 // uniform variables that don't have explicit locations in the shader source.
 SHADERC_EXPORT void shaderc_compile_options_set_auto_map_locations(
@@ -506,6 +578,166 @@ SHADERC_EXPORT void shaderc_compile_options_set_invert_y(
 SHADERC_EXPORT void shaderc_compile_options_set_nan_clamp(
     shaderc_compile_options_t options, bool enable);
 
+// Sets whether successful compilations to SPIR-V binary or assembly, and
+// successful calls to shaderc_assemble_into_spv, shaderc_optimize_spv,
+// shaderc_optimize_spv_batch, shaderc_specialize_spv and shaderc_link_spv,
+// also produce reflection data for the final module: its entry points and
+// workgroup sizes, descriptor bindings, push constant blocks, specialization
+// constants, and input and output locations.  This saves parsing the module
+// again with a separate reflection tool.  See shaderc_result_get_reflection.
+// Defaults to false.
+SHADERC_EXPORT void shaderc_compile_options_set_generate_reflection(
+    shaderc_compile_options_t options, bool enable);
+
+// Sets whether the results of the operations listed for
+// shaderc_compile_options_set_generate_reflection also carry a static cost
+// report for the final module.  For each entry point it counts ALU,
+// transcendental, texture and memory instructions, branches and loops, and
+// estimates the most values live at once and the operations run once loops
+// are taken into account.  The counts are meant for noticing changes that add
+// work to a shader, for example in code review, not for predicting its speed
+// on a given GPU.  See shaderc_result_get_cost_report.  Defaults to false.
+SHADERC_EXPORT void shaderc_compile_options_set_generate_cost_report(
+    shaderc_compile_options_t options, bool enable);
+
+// Sets whether the results of the operations listed for
+// shaderc_compile_options_set_generate_reflection also carry a size
+// attribution of the final module, which splits its words among its
+// functions and, through line information, the source files and includes
+// their code comes from.  When compiling source without debug info, the
+// lines come from a second compile with debug info, and the module returned
+// is the same as without the attribution.  That roughly doubles the time to
+// compile, but the second compile reuses the included files of the first,
+// so the include callbacks are called only once.  Other modules are
+// attributed only to functions unless they carry lines.  See
+// shaderc_result_get_size_attribution.  Defaults to false.
+SHADERC_EXPORT void shaderc_compile_options_set_generate_size_attribution(
+    shaderc_compile_options_t options, bool enable);
+
+// Sets whether the result of compiling or preprocessing a single source
+// carries a report of what each included file cost: how often it was
+// included, the bytes it supplied, the time spent on it, and the words of
+// code it contributed to the final module.  The words come from line
+// information, gathered as for the size attribution and at the same cost;
+// the counts, bytes and times are those of the compile that is returned.  See
+// shaderc_result_get_include_report.  Defaults to false.
+SHADERC_EXPORT void shaderc_compile_options_set_generate_include_report(
+    shaderc_compile_options_t options, bool enable);
+
+// Sets a prelude: GLSL text that many sources start with, such as a long
+// list of common #include directives.  Each GLSL source compiled or
+// preprocessed with the options is treated as if it included the prelude
+// right after its #version directive and the #extension and #pragma
+// directives that follow it.  The prelude is preprocessed, with its
+// includes, once for each #version it is used with, and the result is
+// reused by every later compilation with the options or their clones, so
+// that the sources spend no time on it beyond scanning its expanded text.
+// The name stands for the prelude in messages and line information, and
+// is the requesting source of its includes.  Setting a prelude with the
+// same name and source as the current one keeps the preprocessed results;
+// any change discards them.  A null source removes the prelude.  Has no
+// effect on HLSL.
+SHADERC_EXPORT void shaderc_compile_options_set_prelude(
+    shaderc_compile_options_t options, const char* source,
+    size_t source_length, const char* name);
+
+// A cancellation token lets another thread stop the compilations using it.
+// Cancelling is checked between the phases of a compilation, on each
+// include request, and between groups of a few optimizer passes, so a
+// compilation stops soon after, but a phase that is running, such as the
+// parse of a large source, runs to its end first.  To check between passes,
+// the optimizer parses the module again for each group, so a token or a
+// time limit makes optimized compilations somewhat slower.
+typedef struct shaderc_cancellation_token* shaderc_cancellation_token_t;
+
+// Returns a cancellation token that has not been cancelled, or NULL on
+// failure.
+SHADERC_EXPORT shaderc_cancellation_token_t
+shaderc_cancellation_token_initialize(void);
+
+// Cancels every compilation using the token, running or not yet started.
+// Safe to call from any thread, at any time before the token is released.
+SHADERC_EXPORT void shaderc_cancellation_token_cancel(
+    shaderc_cancellation_token_t token);
+
+// Releases the token.  No compilation may still be using it.
+SHADERC_EXPORT void shaderc_cancellation_token_release(
+    shaderc_cancellation_token_t token);
+
+// Sets the cancellation token of compilations with the options and their
+// clones, or removes it if token is NULL.  A compilation of a single source
+// into SPIR-V binary, assembly or preprocessed text that the token cancels
+// fails with the status shaderc_compilation_status_cancelled.  The token
+// must outlive those compilations.
+SHADERC_EXPORT void shaderc_compile_options_set_cancellation_token(
+    shaderc_compile_options_t options, shaderc_cancellation_token_t token);
+
+// Sets a time limit for each compilation of a single source with the
+// options: once the given number of milliseconds have passed since it
+// started, it is cancelled as by a cancellation token.  Zero, the default,
+// means no limit.
+SHADERC_EXPORT void shaderc_compile_options_set_time_limit(
+    shaderc_compile_options_t options, uint32_t milliseconds);
+
+// Guards on the cost of a compilation, for sources that cannot be trusted.
+typedef enum {
+  // The number of files included.  Includes are counted afresh on each pass
+  // the compiler makes over the source, so a file included once counts once.
+  shaderc_compile_guard_include_count,
+  // The bytes of source supplied by the includer, counted like
+  // shaderc_compile_guard_include_count.
+  shaderc_compile_guard_include_bytes,
+  // The bytes of the preprocessed source of a single source compilation.
+  // Setting it makes the compilation preprocess the source up front.
+  shaderc_compile_guard_preprocessed_bytes,
+  // The words of SPIR-V generated for a shader, before it is optimized.
+  shaderc_compile_guard_spirv_words,
+} shaderc_compile_guard;
+
+// Sets a guard on the cost of compilations with the options, or removes it
+// if value is zero, the default.  A compilation that would exceed it fails
+// with shaderc_compilation_status_compilation_error and a message naming the
+// limit; an include past either include guard fails at its #include.  These
+// bound the memory a compilation uses only indirectly, through the sizes of
+// its input, its expansion and its module.
+SHADERC_EXPORT void shaderc_compile_options_set_compile_guard(
+    shaderc_compile_options_t options, shaderc_compile_guard guard,
+    size_t value);
+
+// Fixes the value of a member of a uniform or push constant block for
+// compilations to SPIR-V binary or assembly.  Its loads are replaced by the
+// value before optimization, so that the optimizer can fold it, remove the
+// branches it decides, and drop the descriptor bindings left unused; see
+// shaderc_result_get_removed_bindings.  The block is named by its type or
+// instance name.  The value is written as in GLSL, with the components of a
+// vector separated by commas, e.g. "0.5" or "1,0,0".  Only 32-bit scalars and
+// vectors can be baked; members the shader does not declare are ignored.
+// Bad values fail the compilation with
+// shaderc_compilation_status_compilation_error.  The strings are copied.
+SHADERC_EXPORT void shaderc_compile_options_add_baked_uniform(
+    shaderc_compile_options_t options, const char* block, const char* member,
+    const char* value);
+
+// Sets the workgroup size of compute, task and mesh shaders compiled to
+// SPIR-V binary or assembly.  A zero component keeps the size the shader
+// declares.  A component that the shader declares with local_size_x_id, or
+// a similar qualifier, stays specializable with the new size as its default.
+// If the shader uses gl_WorkGroupSize, only such components can be changed,
+// since the others were folded into the code.  Modules compiled with
+// shaderc_compile_options_set_compile_only are not affected, and
+// shaderc_link_spv fails with options that set a size.  A size that cannot
+// be applied fails the compilation with
+// shaderc_compilation_status_compilation_error.
+SHADERC_EXPORT void shaderc_compile_options_set_workgroup_size(
+    shaderc_compile_options_t options, uint32_t x, uint32_t y, uint32_t z);
+
+// Makes the workgroup size of compute, task and mesh shaders compiled to
+// SPIR-V binary or assembly specializable.  Each component that is not a
+// specialization constant yet becomes one, with the given SpecId and the
+// current size as its default.  The SpecIds must not be in use already.
+SHADERC_EXPORT void shaderc_compile_options_set_workgroup_size_spec_ids(
+    shaderc_compile_options_t options, uint32_t x, uint32_t y, uint32_t z);
+
 // An opaque handle to the results of a call to any shaderc_compile_into_*()
 // function.
 typedef struct shaderc_compilation_result* shaderc_compilation_result_t;
@@ -552,6 +784,111 @@ SHADERC_EXPORT shaderc_compilation_result_t shaderc_compile_into_preprocessed_te
     const char* input_file_name, const char* entry_point_name,
     const shaderc_compile_options_t additional_options);
 
+// Describes one of the outputs of shaderc_compile_into_spv_with_recipes.
+typedef struct shaderc_optimization_recipe {
+  shaderc_optimization_level optimization_level;
+  bool generate_debug_info;
+  // If not all zero, replaces the workgroup size set with
+  // shaderc_compile_options_set_workgroup_size for this result.
+  uint32_t workgroup_size[3];
+} shaderc_optimization_recipe;
+
+// Like shaderc_compile_into_spv, but produces one result per recipe while
+// preprocessing, parsing, and generating SPIR-V only once.  The unoptimized
+// module is then optimized for each recipe, in parallel.  Each recipe
+// replaces the optimization level and debug info setting of
+// additional_options; custom optimizer passes still apply to every recipe.
+// When any recipe asks for debug information, the front end generates it,
+// and it is stripped from the results of the recipes that do not ask for it.
+// An unoptimized such result therefore also lacks the names that
+// shaderc_compile_into_spv would keep.
+//
+// Writes num_recipes results to the results array, in recipe order.  Each
+// must be released with shaderc_result_release.  All results carry the
+// messages from the shared front end; if it fails, every result fails.
+SHADERC_EXPORT void shaderc_compile_into_spv_with_recipes(
+    const shaderc_compiler_t compiler, const char* source_text,
+    size_t source_text_size, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options,
+    const shaderc_optimization_recipe* recipes, size_t num_recipes,
+    shaderc_compilation_result_t* results);
+
+// Like shaderc_compile_into_spv_with_recipes, but the results contain SPIR-V
+// assembly text instead of SPIR-V binary modules.
+SHADERC_EXPORT void shaderc_compile_into_spv_assembly_with_recipes(
+    const shaderc_compiler_t compiler, const char* source_text,
+    size_t source_text_size, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options,
+    const shaderc_optimization_recipe* recipes, size_t num_recipes,
+    shaderc_compilation_result_t* results);
+
+// Describes one of the shaders given to shaderc_compile_pipeline_into_spv.
+// The fields mean the same as the parameters of shaderc_compile_into_spv,
+// except that shader_kind must name a stage, such as
+// shaderc_glsl_vertex_shader, rather than ask for it to be deduced.
+typedef struct shaderc_pipeline_stage {
+  const char* source_text;
+  size_t source_text_size;
+  shaderc_shader_kind shader_kind;
+  const char* input_file_name;
+  const char* entry_point_name;
+} shaderc_pipeline_stage;
+
+// The kinds of descriptor, with the values of the matching VkDescriptorType.
+typedef enum {
+  shaderc_descriptor_type_sampler = 0,
+  shaderc_descriptor_type_combined_image_sampler = 1,
+  shaderc_descriptor_type_sampled_image = 2,
+  shaderc_descriptor_type_storage_image = 3,
+  shaderc_descriptor_type_uniform_texel_buffer = 4,
+  shaderc_descriptor_type_storage_texel_buffer = 5,
+  shaderc_descriptor_type_uniform_buffer = 6,
+  shaderc_descriptor_type_storage_buffer = 7,
+  shaderc_descriptor_type_input_attachment = 10,
+  shaderc_descriptor_type_acceleration_structure = 1000150000,
+} shaderc_descriptor_type;
+
+// One binding of the descriptor set layout of a pipeline compiled by
+// shaderc_compile_pipeline_into_spv.  The fields map to those of
+// VkDescriptorSetLayoutBinding.  descriptor_count is 0 for a runtime array.
+// stage_flags is a VkShaderStageFlags mask of the stages using the binding.
+typedef struct shaderc_descriptor_binding {
+  uint32_t set;
+  uint32_t binding;
+  shaderc_descriptor_type descriptor_type;
+  uint32_t descriptor_count;
+  uint32_t stage_flags;
+} shaderc_descriptor_binding;
+
+// Compiles the shaders of a graphics pipeline together, at most one per
+// stage, and produces one SPIR-V module per stage.  The stages are linked
+// against each other, so mismatched interfaces are reported.  Then outputs
+// that the next stage never reads are removed, along with the code
+// computing them, and the locations of the values passed to the fragment
+// shader are renumbered without gaps.  This frees interpolators and work
+// that compiling each stage alone cannot.
+//
+// Writes num_stages results to the results array, in stage order.  Each
+// must be released with shaderc_result_release.  All results carry the
+// messages for the whole pipeline; if any stage fails, every result fails.
+// On success, every result also carries the descriptor set layout of the
+// pipeline; see shaderc_result_get_descriptor_bindings.  Stages that declare
+// the same set and binding differently fail with
+// shaderc_compilation_status_compilation_error.
+SHADERC_EXPORT void shaderc_compile_pipeline_into_spv(
+    const shaderc_compiler_t compiler, const shaderc_pipeline_stage* stages,
+    size_t num_stages, const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results);
+
+// Like shaderc_compile_pipeline_into_spv, but the results contain SPIR-V
+// assembly text instead of SPIR-V binary modules.
+SHADERC_EXPORT void shaderc_compile_pipeline_into_spv_assembly(
+    const shaderc_compiler_t compiler, const shaderc_pipeline_stage* stages,
+    size_t num_stages, const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results);
+
 // Takes an assembly string of the format defined in the SPIRV-Tools project
 // (https://github.com/KhronosGroup/SPIRV-Tools/blob/master/syntax.md),
 // assembles it into SPIR-V binary and a shaderc_compilation_result will be
@@ -566,6 +903,87 @@ SHADERC_EXPORT shaderc_compilation_result_t shaderc_assemble_into_spv(
     size_t source_assembly_size,
     const shaderc_compile_options_t additional_options);
 
+// Takes a SPIR-V binary module of binary_word_count 32-bit words, optimizes it
+// and returns a shaderc_compilation_result holding the optimized module.
+// The target environment, optimization level, optimizer passes, debug info
+// and binding preservation settings are taken from the additional_options
+// parameter; an optimization level of zero and no optimizer passes returns
+// the module unchanged.  The module is validated first, at every
+// optimization level.
+// HLSL legalization is not run, so the module should already be legal.
+// On failure, the compilation status is
+// shaderc_compilation_status_transformation_error.
+// May be safely called from multiple threads without explicit synchronization.
+// If there was failure in allocating the compiler object, null will be
+// returned.
+SHADERC_EXPORT shaderc_compilation_result_t shaderc_optimize_spv(
+    const shaderc_compiler_t compiler, const uint32_t* binary,
+    size_t binary_word_count,
+    const shaderc_compile_options_t additional_options);
+
+// Like shaderc_optimize_spv, but optimizes num_binaries modules in parallel.
+// The i-th module has binary_word_counts[i] words at binaries[i], and its
+// result is written to results[i].  Each result must be released with
+// shaderc_result_release.
+SHADERC_EXPORT void shaderc_optimize_spv_batch(
+    const shaderc_compiler_t compiler, const uint32_t* const* binaries,
+    const size_t* binary_word_counts, size_t num_binaries,
+    const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results);
+
+// Links num_binaries SPIR-V binary modules into one module, and returns a
+// shaderc_compilation_result holding it.  The i-th module has
+// binary_word_counts[i] words at binaries[i].  Every imported function must
+// be exported by another module.  The linked module is validated, functions
+// that are not reachable from an entry point are removed, and then the
+// module is optimized according to additional_options, as in
+// shaderc_optimize_spv.
+// On failure, the compilation status is
+// shaderc_compilation_status_transformation_error.
+// May be safely called from multiple threads without explicit synchronization.
+// If there was failure in allocating the compiler object, null will be
+// returned.
+SHADERC_EXPORT shaderc_compilation_result_t shaderc_link_spv(
+    const shaderc_compiler_t compiler, const uint32_t* const* binaries,
+    const size_t* binary_word_counts, size_t num_binaries,
+    const shaderc_compile_options_t additional_options);
+
+// The value of the specialization constant whose SpecId is constant_id,
+// written as in GLSL source: "true" or "false" for a bool, and a decimal or
+// hexadecimal number for an integer or floating-point constant.
+typedef struct shaderc_specialization_constant {
+  uint32_t constant_id;
+  const char* value;
+} shaderc_specialization_constant;
+
+// The specialization constant values of one output of shaderc_specialize_spv.
+typedef struct shaderc_specialization {
+  const shaderc_specialization_constant* constants;
+  size_t num_constants;
+} shaderc_specialization;
+
+// Takes a SPIR-V binary module of binary_word_count 32-bit words, and
+// produces one specialized module per specialization, in parallel, without
+// running the front end again.  For each, the specialization constants are
+// given the values listed in it, and the others keep their default values.
+// Then every specialization constant is frozen into an ordinary constant,
+// the operations on them are folded, the code made unreachable by their
+// values is removed, and the module is optimized according to
+// additional_options, as in shaderc_optimize_spv.
+//
+// Writes num_specializations results to the results array, in order.  Each
+// must be released with shaderc_result_release.  A result fails with
+// shaderc_compilation_status_transformation_error if the module is invalid,
+// if a listed SpecId does not exist, or if a value does not fit its type.
+// May be safely called from multiple threads without explicit
+// synchronization.
+SHADERC_EXPORT void shaderc_specialize_spv(
+    const shaderc_compiler_t compiler, const uint32_t* binary,
+    size_t binary_word_count, const shaderc_specialization* specializations,
+    size_t num_specializations,
+    const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results);
+
 // The following functions, operating on shaderc_compilation_result_t objects,
 // offer only the basic thread-safety guarantee.
 
@@ -602,6 +1020,248 @@ SHADERC_EXPORT const char* shaderc_result_get_bytes(const shaderc_compilation_re
 SHADERC_EXPORT const char* shaderc_result_get_error_message(
     const shaderc_compilation_result_t result);
 
+typedef enum {
+  shaderc_diagnostic_severity_warning,
+  shaderc_diagnostic_severity_error,
+} shaderc_diagnostic_severity;
+
+// A warning or an error from a compilation.  Its file and message are held
+// by the result, and are not null-terminated.  Neither glslang nor the
+// SPIR-V tools report columns, so there is no column.
+typedef struct {
+  shaderc_diagnostic_severity severity;
+  // The source file, or the tool for an internal error, such as "shaderc".
+  const char* file;
+  size_t file_length;
+  // The line, or zero for a message about the whole file.
+  uint32_t line;
+  // The message, which may span several lines.
+  const char* message;
+  size_t message_length;
+} shaderc_diagnostic;
+
+// Writes the first capacity diagnostics of a result to diagnostics, in the
+// order of its error message, and returns how many it has in all.  Call it
+// with a capacity of zero, and diagnostics NULL, to count them.  They are
+// collected as the compile reports them, so the error message is not parsed
+// again.  Errors in SPIR-V assembly are only in the error message.
+// The diagnostics are valid for the lifetime of the result.
+SHADERC_EXPORT size_t shaderc_result_get_diagnostics(
+    const shaderc_compilation_result_t result, shaderc_diagnostic* diagnostics,
+    size_t capacity);
+
+// Returns the number of descriptor bindings in the pipeline layout held by a
+// result of shaderc_compile_pipeline_into_spv, or 0 for other results.
+SHADERC_EXPORT size_t shaderc_result_get_num_descriptor_bindings(
+    const shaderc_compilation_result_t result);
+
+// Returns the descriptor bindings of the pipeline layout held by a result of
+// shaderc_compile_pipeline_into_spv, sorted by set and then binding.  The
+// array is valid for the lifetime of the result.
+SHADERC_EXPORT const shaderc_descriptor_binding*
+shaderc_result_get_descriptor_bindings(
+    const shaderc_compilation_result_t result);
+
+// Returns a null-terminated string holding the reflection data of the
+// module in a result, as a JSON object, if it was requested with
+// shaderc_compile_options_set_generate_reflection.  Otherwise returns an
+// empty string.  The object has the arrays "entry_points",
+// "descriptor_bindings", "push_constants", "specialization_constants",
+// "inputs" and "outputs".
+SHADERC_EXPORT const char* shaderc_result_get_reflection(
+    const shaderc_compilation_result_t result);
+
+// Returns a null-terminated string holding the static cost report of the
+// module in a result, as a JSON object, if it was requested with
+// shaderc_compile_options_set_generate_cost_report.  Otherwise returns an
+// empty string.  The object has an "entry_points" array, holding for each
+// entry point its "name" and "stage", and the counts "alu",
+// "transcendental", "texture", "memory", "branches", "loops",
+// "max_live_ids" and "weighted_ops".  A function is counted once for each
+// call to it, and weighted_ops counts an operation eight times for each loop
+// around it.
+SHADERC_EXPORT const char* shaderc_result_get_cost_report(
+    const shaderc_compilation_result_t result);
+
+// Returns a null-terminated string holding the size attribution of the
+// module in a result, as a JSON object, if it was requested with
+// shaderc_compile_options_set_generate_size_attribution.  Otherwise returns
+// an empty string.  The object has "total_words" and "declaration_words",
+// and the arrays "functions" and "files", holding the "name" and "words" of
+// each contributor from the largest down.  Debug instructions are not
+// counted.  A file is null when code has no line information.
+SHADERC_EXPORT const char* shaderc_result_get_size_attribution(
+    const shaderc_compilation_result_t result);
+
+// Returns a null-terminated string holding the include report of a result,
+// as a JSON object, if it was requested with
+// shaderc_compile_options_set_generate_include_report.  Otherwise returns an
+// empty string.  The object has an "includes" array holding, for each file
+// resolved by the include callbacks and from the slowest down, its "name",
+// its "count" of inclusions, the "bytes" it supplied, and the
+// "microseconds" from asking for it until it was fully parsed, which
+// includes the files it includes in turn.  Its "words" are the words of
+// function code from the file in the final module.  A file with no words
+// contributed no code, though it may still hold macros, types or constants
+// used elsewhere.  The words are null when there is no module, or no line
+// information to attribute it by, as after compiling GLSL to a module that
+// is not linked.
+SHADERC_EXPORT const char* shaderc_result_get_include_report(
+    const shaderc_compilation_result_t result);
+
+// Returns the number of descriptor bindings that a compilation to SPIR-V
+// binary or assembly removed because baked uniforms left them unused.  See
+// shaderc_compile_options_add_baked_uniform.
+SHADERC_EXPORT size_t shaderc_result_get_num_removed_bindings(
+    const shaderc_compilation_result_t result);
+
+// Returns the descriptor bindings removed by baking, sorted by set and then
+// binding.  Their stage_flags hold the compiled stage.  The array is valid
+// for the lifetime of the result.
+SHADERC_EXPORT const shaderc_descriptor_binding*
+shaderc_result_get_removed_bindings(const shaderc_compilation_result_t result);
+
+// The size of a module after one stage of optimization.
+typedef struct shaderc_optimization_stage {
+  // The name of the stage, such as "compact-ids".  The first stage is named
+  // "input", and gives the size of the module before optimization.
+  const char* name;
+  size_t size_in_bytes;
+} shaderc_optimization_stage;
+
+// Returns the number of optimization stages recorded for a compilation to
+// SPIR-V binary or assembly at shaderc_optimization_level_min_size.  Other
+// compilations have none.
+SHADERC_EXPORT size_t shaderc_result_get_num_optimization_stages(
+    const shaderc_compilation_result_t result);
+
+// Returns the optimization stages of a result, in the order they ran.  The
+// names are static strings, and the array is valid for the lifetime of the
+// result.
+SHADERC_EXPORT const shaderc_optimization_stage*
+shaderc_result_get_optimization_stages(
+    const shaderc_compilation_result_t result);
+
+// Tiered compilation.  A tiered compiler returns an unoptimized module right
+// away, and optimizes it on a pool of background threads.  This suits
+// applications that compile shaders on demand and cannot wait for the
+// optimizer: they can start using the unoptimized module at once, and swap in
+// the optimized one when it arrives.
+//
+// Usage:
+//      shaderc_tiered_compiler_t tiers = shaderc_tiered_compiler_initialize(0);
+//      uint64_t job_id;
+//      shaderc_compilation_result_t quick = shaderc_tiered_compile_into_spv(
+//          tiers, compiler, source, source_size, shaderc_glsl_vertex_shader,
+//          "main.vert", "main", options, priority, on_optimized, user_data,
+//          &job_id);
+//      // Use quick, then release it.  on_optimized is called later.
+//      shaderc_tiered_compiler_release(tiers);
+typedef struct shaderc_tiered_compiler* shaderc_tiered_compiler_t;
+
+// Called once for each job queued by shaderc_tiered_compile_into_spv.  The
+// result holds the optimized SPIR-V module, or an error if optimization
+// failed, and must be released with shaderc_result_release.  Like the first
+// tier's result, it carries the reflection data and reports that the options
+// asked for, computed from the optimized module.  The result is
+// NULL if the job was cancelled before it started, either through
+// shaderc_tiered_compiler_cancel or by releasing the tiered compiler.  The
+// callback runs on a background thread, except for cancellation, where it
+// runs on the thread that cancelled the job.
+typedef void (*shaderc_optimized_result_fn)(
+    void* user_data, uint64_t job_id, shaderc_compilation_result_t result);
+
+// Returns a tiered compiler that optimizes modules on num_threads background
+// threads, or one per hardware thread if num_threads is zero.  Returns NULL
+// on failure.
+SHADERC_EXPORT shaderc_tiered_compiler_t
+shaderc_tiered_compiler_initialize(size_t num_threads);
+
+// Cancels every job that has not started, waits for running jobs to finish,
+// and releases the tiered compiler.
+SHADERC_EXPORT void shaderc_tiered_compiler_release(
+    shaderc_tiered_compiler_t tiers);
+
+// Compiles like shaderc_compile_into_spv, but without the optimization passes
+// selected by additional_options, and returns that result.  HLSL legalization
+// still runs, so the module is usable as is.  If compilation succeeds, a job
+// that runs the selected optimization passes on the module is queued, and
+// its id is written to *job_id when job_id is not NULL.  Otherwise, no job is
+// queued, the callback is never called, and *job_id is set to zero.
+//
+// Jobs with a higher priority run first; an application can use, for
+// example, how often a shader is used.  The options are copied, so they may
+// be released or modified once this function returns.
+SHADERC_EXPORT shaderc_compilation_result_t shaderc_tiered_compile_into_spv(
+    shaderc_tiered_compiler_t tiers, const shaderc_compiler_t compiler,
+    const char* source_text, size_t source_text_size,
+    shaderc_shader_kind shader_kind, const char* input_file_name,
+    const char* entry_point_name,
+    const shaderc_compile_options_t additional_options, int priority,
+    shaderc_optimized_result_fn callback, void* user_data, uint64_t* job_id);
+
+// Changes the priority of a job that has not started yet.  Returns false if
+// the job has already started or does not exist.
+SHADERC_EXPORT bool shaderc_tiered_compiler_set_priority(
+    shaderc_tiered_compiler_t tiers, uint64_t job_id, int priority);
+
+// Cancels a job that has not started yet, and calls its callback with a NULL
+// result before returning.  Returns false, and does nothing, if the job has
+// already started or does not exist.  The result of a job that is running
+// still arrives, and can simply be released.
+SHADERC_EXPORT bool shaderc_tiered_compiler_cancel(
+    shaderc_tiered_compiler_t tiers, uint64_t job_id);
+
+// Compile sessions.  A session recompiles one shader, with fixed options, as
+// its main source is edited, for example by an application that reloads
+// shaders while they are being written.  It keeps what stays the same from
+// one compile to the next: the options, the prepared prelude if they have
+// one, and the contents of every file the shader includes, which are read
+// once and not again until invalidated.  Recompiling a source identical to
+// the last one that compiled returns its result again.
+//
+// Usage:
+//      shaderc_compile_session_t session = shaderc_compile_session_initialize(
+//          compiler, shaderc_glsl_fragment_shader, "main.frag", "main",
+//          options);
+//      // Each time main.frag is saved:
+//      shaderc_compilation_result_t result =
+//          shaderc_compile_session_recompile(session, source, source_size);
+//      // Each time an included file is saved:
+//      shaderc_compile_session_invalidate_include(session, "common.glsl");
+//      shaderc_compile_session_release(session);
+typedef struct shaderc_compile_session* shaderc_compile_session_t;
+
+// Returns a session compiling a shader of the given kind, named
+// input_file_name, with the given entry point and options, or NULL on
+// failure.  The options are copied, so they may be released or modified once
+// this function returns; the include callbacks they hold are called by later
+// recompiles, and must stay valid until the session is released.  The
+// compiler must outlive the session.
+SHADERC_EXPORT shaderc_compile_session_t shaderc_compile_session_initialize(
+    const shaderc_compiler_t compiler, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options);
+
+// Compiles the given source into a SPIR-V binary, as shaderc_compile_into_spv
+// would with the session's arguments.  Included files that an earlier compile
+// of the session resolved are taken from the session; the include callbacks
+// are called only for the others, and for requests that failed before.  The
+// result must be released with shaderc_result_release.
+SHADERC_EXPORT shaderc_compilation_result_t shaderc_compile_session_recompile(
+    shaderc_compile_session_t session, const char* source_text,
+    size_t source_text_size);
+
+// Forgets the contents of the included file with the given resolved name, as
+// returned by the include resolver, so that the next compile reads it again.
+// Forgets every included file if source_name is NULL.
+SHADERC_EXPORT void shaderc_compile_session_invalidate_include(
+    shaderc_compile_session_t session, const char* source_name);
+
+// Releases the session.
+SHADERC_EXPORT void shaderc_compile_session_release(
+    shaderc_compile_session_t session);
+
 // Provides the version & revision of the SPIR-V which will be produced
 SHADERC_EXPORT void shaderc_get_spv_version(unsigned int* version, unsigned int* revision);
 
@@ -15,6 +15,9 @@
 #ifndef SHADERC_SHADERC_HPP_
 #define SHADERC_SHADERC_HPP_
 
+#include <cstdint>
+#include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -121,6 +124,97 @@ class CompilationResult {
     return shaderc_result_get_num_errors(compilation_result_);
   }
 
+  // Returns the warnings and errors of the compilation, which are held by
+  // the result.  See shaderc_result_get_diagnostics.
+  std::vector<shaderc_diagnostic> GetDiagnostics() const {
+    if (!compilation_result_) {
+      return {};
+    }
+    std::vector<shaderc_diagnostic> diagnostics(
+        shaderc_result_get_diagnostics(compilation_result_, nullptr, 0));
+    shaderc_result_get_diagnostics(compilation_result_, diagnostics.data(),
+                                   diagnostics.size());
+    return diagnostics;
+  }
+
+  // Returns the reflection data of the module as a JSON object, or an empty
+  // string if it was not requested.
+  std::string GetReflection() const {
+    if (!compilation_result_) {
+      return "";
+    }
+    return shaderc_result_get_reflection(compilation_result_);
+  }
+
+  // Returns the static cost report of the module as a JSON object, or an
+  // empty string if it was not requested.
+  std::string GetCostReport() const {
+    if (!compilation_result_) {
+      return "";
+    }
+    return shaderc_result_get_cost_report(compilation_result_);
+  }
+
+  // Returns the size attribution of the module as a JSON object, or an empty
+  // string if it was not requested.
+  std::string GetSizeAttribution() const {
+    if (!compilation_result_) {
+      return "";
+    }
+    return shaderc_result_get_size_attribution(compilation_result_);
+  }
+
+  // Returns the include report of the compilation as a JSON object, or an
+  // empty string if it was not requested.
+  std::string GetIncludeReport() const {
+    if (!compilation_result_) {
+      return "";
+    }
+    return shaderc_result_get_include_report(compilation_result_);
+  }
+
+  // Returns the descriptor set layout of a compiled pipeline, sorted by set
+  // and then binding.  Other results have none.
+  std::vector<shaderc_descriptor_binding> GetDescriptorBindings() const {
+    if (!compilation_result_) {
+      return {};
+    }
+    const shaderc_descriptor_binding* bindings =
+        shaderc_result_get_descriptor_bindings(compilation_result_);
+    return std::vector<shaderc_descriptor_binding>(
+        bindings,
+        bindings +
+            shaderc_result_get_num_descriptor_bindings(compilation_result_));
+  }
+
+  // Returns the descriptor bindings that baked uniforms left unused, sorted
+  // by set and then binding.
+  std::vector<shaderc_descriptor_binding> GetRemovedBindings() const {
+    if (!compilation_result_) {
+      return {};
+    }
+    const shaderc_descriptor_binding* bindings =
+        shaderc_result_get_removed_bindings(compilation_result_);
+    return std::vector<shaderc_descriptor_binding>(
+        bindings,
+        bindings +
+            shaderc_result_get_num_removed_bindings(compilation_result_));
+  }
+
+  // Returns the size of the module after each optimization stage, measured
+  // at shaderc_optimization_level_min_size.
+  std::vector<shaderc_optimization_stage> GetOptimizationStages() const {
+    if (!compilation_result_) {
+      return {};
+    }
+    const shaderc_optimization_stage* stages =
+        shaderc_result_get_optimization_stages(compilation_result_);
+    return std::vector<shaderc_optimization_stage>(
+        stages,
+        stages +
+            shaderc_result_get_num_optimization_stages(compilation_result_));
+  }
+
  private:
   CompilationResult(const CompilationResult& other) = delete;
   CompilationResult& operator=(const CompilationResult& other) = delete;
@@ -136,6 +230,26 @@ using AssemblyCompilationResult = CompilationResult<char>;
 // Preprocessed source text.
 using PreprocessedSourceCompilationResult = CompilationResult<char>;
 
+// Lets another thread stop the compilations whose options use it.  See
+// shaderc_cancellation_token_initialize.
+class CancellationToken {
+ public:
+  CancellationToken() : token_(shaderc_cancellation_token_initialize()) {}
+  ~CancellationToken() { shaderc_cancellation_token_release(token_); }
+
+  bool IsValid() const { return token_ != nullptr; }
+
+  // Cancels every compilation using the token.  Safe to call from any thread.
+  void Cancel() const { shaderc_cancellation_token_cancel(token_); }
+
+ private:
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  shaderc_cancellation_token_t token_;
+  friend class CompileOptions;
+};
+
 // Contains any options that can have default values for a compilation.
 class CompileOptions {
  public:
@@ -178,6 +292,41 @@ class CompileOptions {
     shaderc_compile_options_set_optimization_level(options_, level);
   }
 
+  // Sets the profile that shaderc_optimization_level_performance is tuned
+  // for.
+  void SetOptimizationProfile(shaderc_optimization_profile profile) {
+    shaderc_compile_options_set_optimization_profile(options_, profile);
+  }
+
+  // Sets custom optimizer passes, given as spirv-opt command line flags, to
+  // run after the passes selected by the optimization level.  Returns false
+  // if any flag does not name a known pass, and then writes why to *error
+  // unless error is null.
+  bool SetOptimizerPasses(const std::vector<std::string>& flags,
+                          std::string* error = nullptr) {
+    std::vector<const char*> c_flags;
+    c_flags.reserve(flags.size());
+    for (const auto& flag : flags) c_flags.push_back(flag.c_str());
+    const bool succeeded = shaderc_compile_options_set_optimizer_passes(
+        options_, c_flags.data(), c_flags.size());
+    if (!succeeded && error) {
+      *error = shaderc_compile_options_get_optimizer_passes_error(options_);
+    }
+    return succeeded;
+  }
+
+  // Sets custom optimizer passes from the text of a pass-list file, like
+  // SetOptimizerPasses.
+  bool SetOptimizerPassList(const std::string& pass_list,
+                            std::string* error = nullptr) {
+    const bool succeeded = shaderc_compile_options_set_optimizer_pass_list(
+        options_, pass_list.data(), pass_list.size());
+    if (!succeeded && error) {
+      *error = shaderc_compile_options_get_optimizer_passes_error(options_);
+    }
+    return succeeded;
+  }
+
   // A C++ version of the libshaderc includer interface.
   class IncluderInterface {
    public:
@@ -317,6 +466,19 @@ class CompileOptions {
     shaderc_compile_options_set_preserve_bindings(options_, preserve_bindings);
   }
 
+  // Sets whether pipeline compilation removes unused resources and
+  // renumbers descriptor sets and bindings without gaps.  See
+  // shaderc_compile_options_set_compact_pipeline_bindings.
+  void SetCompactPipelineBindings(bool compact) {
+    shaderc_compile_options_set_compact_pipeline_bindings(options_, compact);
+  }
+
+  // Sets whether GLSL is compiled without linking, for a module that will be
+  // linked later with Compiler::LinkSpv.
+  void SetCompileOnly(bool compile_only) {
+    shaderc_compile_options_set_compile_only(options_, compile_only);
+  }
+
   // Sets whether the compiler automatically assigns locations to
   // uniform variables that don't have explicit locations.
   void SetAutoMapLocations(bool auto_map) {
@@ -373,12 +535,88 @@ class CompileOptions {
     shaderc_compile_options_set_nan_clamp(options_, enable);
   }
 
+  // Sets whether compilation results carry reflection data for the module.
+  // See shaderc_compile_options_set_generate_reflection.
+  void SetGenerateReflection(bool enable) {
+    shaderc_compile_options_set_generate_reflection(options_, enable);
+  }
+
+  // Sets whether compilation results carry a static cost report for the
+  // module.  See shaderc_compile_options_set_generate_cost_report.
+  void SetGenerateCostReport(bool enable) {
+    shaderc_compile_options_set_generate_cost_report(options_, enable);
+  }
+
+  // Sets whether compilation results carry a size attribution of the module.
+  // See shaderc_compile_options_set_generate_size_attribution.
+  void SetGenerateSizeAttribution(bool enable) {
+    shaderc_compile_options_set_generate_size_attribution(options_, enable);
+  }
+
+  // Sets whether compilation results report what each included file cost.
+  // See shaderc_compile_options_set_generate_include_report.
+  void SetGenerateIncludeReport(bool enable) {
+    shaderc_compile_options_set_generate_include_report(options_, enable);
+  }
+
+  // Sets the prelude that GLSL sources are compiled with.  See
+  // shaderc_compile_options_set_prelude.
+  void SetPrelude(const std::string& source, const std::string& name) {
+    shaderc_compile_options_set_prelude(options_, source.data(),
+                                        source.size(), name.c_str());
+  }
+
+  // Sets the token that cancels compilations with these options, which must
+  // outlive them.  See shaderc_compile_options_set_cancellation_token.
+  void SetCancellationToken(const CancellationToken& token) {
+    shaderc_compile_options_set_cancellation_token(options_, token.token_);
+  }
+
+  // Removes the cancellation token.
+  void ClearCancellationToken() {
+    shaderc_compile_options_set_cancellation_token(options_, nullptr);
+  }
+
+  // Sets a time limit in milliseconds for each compilation, or none if zero.
+  // See shaderc_compile_options_set_time_limit.
+  void SetTimeLimit(uint32_t milliseconds) {
+    shaderc_compile_options_set_time_limit(options_, milliseconds);
+  }
+
+  // Sets a guard on the cost of each compilation, or removes it if zero.
+  // See shaderc_compile_options_set_compile_guard.
+  void SetCompileGuard(shaderc_compile_guard guard, size_t value) {
+    shaderc_compile_options_set_compile_guard(options_, guard, value);
+  }
+
+  // Fixes the value of a uniform block member, so that it is folded into the
+  // compiled code.  See shaderc_compile_options_add_baked_uniform.
+  void AddBakedUniform(const std::string& block, const std::string& member,
+                       const std::string& value) {
+    shaderc_compile_options_add_baked_uniform(options_, block.c_str(),
+                                              member.c_str(), value.c_str());
+  }
+
+  // Sets the workgroup size of compute, task and mesh shaders.  See
+  // shaderc_compile_options_set_workgroup_size.
+  void SetWorkgroupSize(uint32_t x, uint32_t y, uint32_t z) {
+    shaderc_compile_options_set_workgroup_size(options_, x, y, z);
+  }
+
+  // Makes the workgroup size of compute, task and mesh shaders
+  // specializable.  See shaderc_compile_options_set_workgroup_size_spec_ids.
+  void SetWorkgroupSizeSpecIds(uint32_t x, uint32_t y, uint32_t z) {
+    shaderc_compile_options_set_workgroup_size_spec_ids(options_, x, y, z);
+  }
+
  private:
   CompileOptions& operator=(const CompileOptions& other) = delete;
   shaderc_compile_options_t options_;
   std::unique_ptr<IncluderInterface> includer_;
 
   friend class Compiler;
+  friend class TieredCompiler;
+  friend class CompileSession;
 };
 
 // The compilation context for compiling source to SPIR-V.
@@ -537,6 +775,91 @@ class Compiler {
         compiler_, source_assembly.data(), source_assembly.size(), nullptr));
   }
 
+  // Optimizes the given SPIR-V binary module according to the given options,
+  // and returns the optimized module as a compilation result.
+  SpvCompilationResult OptimizeSpv(const uint32_t* binary,
+                                   size_t binary_word_count,
+                                   const CompileOptions& options) const {
+    return SpvCompilationResult(shaderc_optimize_spv(
+        compiler_, binary, binary_word_count, options.options_));
+  }
+
+  // Like OptimizeSpv, but the module is provided as a std::vector.
+  SpvCompilationResult OptimizeSpv(const std::vector<uint32_t>& binary,
+                                   const CompileOptions& options) const {
+    return OptimizeSpv(binary.data(), binary.size(), options);
+  }
+
+  // Links the given SPIR-V binary modules into one module, removes
+  // unreachable functions, and optimizes it according to the given options.
+  SpvCompilationResult LinkSpv(
+      const std::vector<std::vector<uint32_t>>& binaries,
+      const CompileOptions& options) const {
+    std::vector<const uint32_t*> words;
+    std::vector<size_t> word_counts;
+    for (const auto& binary : binaries) {
+      words.push_back(binary.data());
+      word_counts.push_back(binary.size());
+    }
+    return SpvCompilationResult(
+        shaderc_link_spv(compiler_, words.data(), word_counts.data(),
+                         binaries.size(), options.options_));
+  }
+
+  // Optimizes the given SPIR-V binary modules in parallel, and returns one
+  // compilation result per module, in the same order.
+  std::vector<SpvCompilationResult> OptimizeSpvBatch(
+      const std::vector<std::vector<uint32_t>>& binaries,
+      const CompileOptions& options) const {
+    std::vector<const uint32_t*> words;
+    std::vector<size_t> word_counts;
+    for (const auto& binary : binaries) {
+      words.push_back(binary.data());
+      word_counts.push_back(binary.size());
+    }
+    std::vector<shaderc_compilation_result_t> raw_results(binaries.size());
+    shaderc_optimize_spv_batch(compiler_, words.data(), word_counts.data(),
+                               binaries.size(), options.options_,
+                               raw_results.data());
+    std::vector<SpvCompilationResult> results;
+    for (shaderc_compilation_result_t raw_result : raw_results) {
+      results.emplace_back(raw_result);
+    }
+    return results;
+  }
+
+  // Specializes the given SPIR-V binary module once per entry of
+  // specializations, in parallel, and returns one compilation result per
+  // entry, in the same order.  Each entry maps SpecIds to values written as
+  // in GLSL source, such as "true" or "16".  See shaderc_specialize_spv.
+  std::vector<SpvCompilationResult> SpecializeSpv(
+      const std::vector<uint32_t>& binary,
+      const std::vector<std::map<uint32_t, std::string>>& specializations,
+      const CompileOptions& options) const {
+    std::vector<std::vector<shaderc_specialization_constant>> constants;
+    std::vector<shaderc_specialization> raw_specializations;
+    for (const auto& specialization : specializations) {
+      constants.emplace_back();
+      for (const auto& value : specialization) {
+        constants.back().push_back({value.first, value.second.c_str()});
+      }
+    }
+    for (const auto& list : constants) {
+      raw_specializations.push_back({list.data(), list.size()});
+    }
+    std::vector<shaderc_compilation_result_t> raw_results(
+        specializations.size());
+    shaderc_specialize_spv(compiler_, binary.data(), binary.size(),
+                           raw_specializations.data(),
+                           raw_specializations.size(), options.options_,
+                           raw_results.data());
+    std::vector<SpvCompilationResult> results;
+    for (shaderc_compilation_result_t raw_result : raw_results) {
+      results.emplace_back(raw_result);
+    }
+    return results;
+  }
+
   // Compiles the given source GLSL and returns the SPIR-V assembly text
   // compilation result.
   // Options are similar to the first CompileToSpv method.
@@ -585,6 +908,103 @@ class Compiler {
                                     "main", options);
   }
 
+  // Compiles the given source GLSL once and returns one SPIR-V binary
+  // compilation result per recipe, in recipe order.  The optimization level
+  // and debug info settings in options are replaced by those of each recipe.
+  // Options are otherwise similar to the first CompileToSpv method.
+  std::vector<SpvCompilationResult> CompileGlslToSpvWithRecipes(
+      const char* source_text, size_t source_text_size,
+      shaderc_shader_kind shader_kind, const char* input_file_name,
+      const char* entry_point_name,
+      const std::vector<shaderc_optimization_recipe>& recipes,
+      const CompileOptions& options) const {
+    std::vector<shaderc_compilation_result_t> raw_results(recipes.size());
+    shaderc_compile_into_spv_with_recipes(
+        compiler_, source_text, source_text_size, shader_kind,
+        input_file_name, entry_point_name, options.options_, recipes.data(),
+        recipes.size(), raw_results.data());
+    std::vector<SpvCompilationResult> results;
+    for (shaderc_compilation_result_t raw_result : raw_results) {
+      results.emplace_back(raw_result);
+    }
+    return results;
+  }
+
+  // Like the previous CompileGlslToSpvWithRecipes method but the source is
+  // provided as a std::string.
+  std::vector<SpvCompilationResult> CompileGlslToSpvWithRecipes(
+      const std::string& source_text, shaderc_shader_kind shader_kind,
+      const char* input_file_name, const char* entry_point_name,
+      const std::vector<shaderc_optimization_recipe>& recipes,
+      const CompileOptions& options) const {
+    return CompileGlslToSpvWithRecipes(source_text.data(), source_text.size(),
+                                       shader_kind, input_file_name,
+                                       entry_point_name, recipes, options);
+  }
+
+  // Like CompileGlslToSpvWithRecipes, but returns SPIR-V assembly text.
+  std::vector<AssemblyCompilationResult> CompileGlslToSpvAssemblyWithRecipes(
+      const char* source_text, size_t source_text_size,
+      shaderc_shader_kind shader_kind, const char* input_file_name,
+      const char* entry_point_name,
+      const std::vector<shaderc_optimization_recipe>& recipes,
+      const CompileOptions& options) const {
+    std::vector<shaderc_compilation_result_t> raw_results(recipes.size());
+    shaderc_compile_into_spv_assembly_with_recipes(
+        compiler_, source_text, source_text_size, shader_kind,
+        input_file_name, entry_point_name, options.options_, recipes.data(),
+        recipes.size(), raw_results.data());
+    std::vector<AssemblyCompilationResult> results;
+    for (shaderc_compilation_result_t raw_result : raw_results) {
+      results.emplace_back(raw_result);
+    }
+    return results;
+  }
+
+  // Like the previous CompileGlslToSpvAssemblyWithRecipes method but the
+  // source is provided as a std::string.
+  std::vector<AssemblyCompilationResult> CompileGlslToSpvAssemblyWithRecipes(
+      const std::string& source_text, shaderc_shader_kind shader_kind,
+      const char* input_file_name, const char* entry_point_name,
+      const std::vector<shaderc_optimization_recipe>& recipes,
+      const CompileOptions& options) const {
+    return CompileGlslToSpvAssemblyWithRecipes(
+        source_text.data(), source_text.size(), shader_kind, input_file_name,
+        entry_point_name, recipes, options);
+  }
+
+  // Compiles the shaders of a graphics pipeline together and returns one
+  // SPIR-V binary compilation result per stage, in stage order.  Outputs
+  // that the next stage never reads are removed.  See
+  // shaderc_compile_pipeline_into_spv for details.
+  std::vector<SpvCompilationResult> CompileGlslPipelineToSpv(
+      const std::vector<shaderc_pipeline_stage>& stages,
+      const CompileOptions& options) const {
+    std::vector<shaderc_compilation_result_t> raw_results(stages.size());
+    shaderc_compile_pipeline_into_spv(compiler_, stages.data(), stages.size(),
+                                      options.options_, raw_results.data());
+    std::vector<SpvCompilationResult> results;
+    for (shaderc_compilation_result_t raw_result : raw_results) {
+      results.emplace_back(raw_result);
+    }
+    return results;
+  }
+
+  // Like CompileGlslPipelineToSpv, but returns SPIR-V assembly text.
+  std::vector<AssemblyCompilationResult> CompileGlslPipelineToSpvAssembly(
+      const std::vector<shaderc_pipeline_stage>& stages,
+      const CompileOptions& options) const {
+    std::vector<shaderc_compilation_result_t> raw_results(stages.size());
+    shaderc_compile_pipeline_into_spv_assembly(
+        compiler_, stages.data(), stages.size(), options.options_,
+        raw_results.data());
+    std::vector<AssemblyCompilationResult> results;
+    for (shaderc_compilation_result_t raw_result : raw_results) {
+      results.emplace_back(raw_result);
+    }
+    return results;
+  }
+
   // Preprocesses the given source GLSL and returns the preprocessed
   // source text as a compilation result.
   // Options are similar to the first CompileToSpv method.
@@ -614,6 +1034,143 @@ class Compiler {
   Compiler& operator=(const Compiler& other) = delete;
 
   shaderc_compiler_t compiler_;
+
+  friend class TieredCompiler;
+  friend class CompileSession;
+};
+
+// Compiles shaders in two tiers: an unoptimized module is returned right
+// away, and the optimized module is delivered later from a background thread.
+// See shaderc_tiered_compile_into_spv for details.
+class TieredCompiler {
+ public:
+  // Called once for each queued job with the optimized module.  If the job
+  // was cancelled before it started, the result holds nothing and its status
+  // is shaderc_compilation_status_null_result_object.
+  using OptimizedCallback =
+      std::function<void(uint64_t job_id, SpvCompilationResult result)>;
+
+  // Optimizes on num_threads background threads, or one per hardware thread
+  // if num_threads is zero.
+  explicit TieredCompiler(size_t num_threads = 0)
+      : tiers_(shaderc_tiered_compiler_initialize(num_threads)) {}
+  // Cancels the jobs that have not started and waits for the others.
+  ~TieredCompiler() { shaderc_tiered_compiler_release(tiers_); }
+
+  bool IsValid() const { return tiers_ != nullptr; }
+
+  // Compiles the given source without optimization and returns the result.
+  // On success, also queues a job with the given priority that optimizes the
+  // module as selected by the options, and writes its id to *job_id if
+  // job_id is not null.  Options are otherwise as for
+  // Compiler::CompileGlslToSpv.
+  SpvCompilationResult CompileGlslToSpv(
+      const Compiler& compiler, const char* source_text,
+      size_t source_text_size, shaderc_shader_kind shader_kind,
+      const char* input_file_name, const char* entry_point_name,
+      const CompileOptions& options, int priority, OptimizedCallback callback,
+      uint64_t* job_id = nullptr) const {
+    auto* pending = new OptimizedCallback(std::move(callback));
+    uint64_t id = 0;
+    shaderc_compilation_result_t compilation_result =
+        shaderc_tiered_compile_into_spv(
+            tiers_, compiler.compiler_, source_text, source_text_size,
+            shader_kind, input_file_name, entry_point_name, options.options_,
+            priority, &TieredCompiler::Deliver, pending, &id);
+    // No job was queued, so the callback will never be called.
+    if (id == 0) delete pending;
+    if (job_id) *job_id = id;
+    return SpvCompilationResult(compilation_result);
+  }
+
+  // Like the first CompileGlslToSpv method but the source is provided as
+  // a std::string.
+  SpvCompilationResult CompileGlslToSpv(
+      const Compiler& compiler, const std::string& source_text,
+      shaderc_shader_kind shader_kind, const char* input_file_name,
+      const char* entry_point_name, const CompileOptions& options,
+      int priority, OptimizedCallback callback,
+      uint64_t* job_id = nullptr) const {
+    return CompileGlslToSpv(compiler, source_text.data(), source_text.size(),
+                            shader_kind, input_file_name, entry_point_name,
+                            options, priority, std::move(callback), job_id);
+  }
+
+  // Changes the priority of a job that has not started yet.  Returns false if
+  // the job has already started or does not exist.
+  bool SetPriority(uint64_t job_id, int priority) const {
+    return shaderc_tiered_compiler_set_priority(tiers_, job_id, priority);
+  }
+
+  // Cancels a job that has not started yet; its callback is called before
+  // this returns.  Returns false if the job has already started or does not
+  // exist.
+  bool Cancel(uint64_t job_id) const {
+    return shaderc_tiered_compiler_cancel(tiers_, job_id);
+  }
+
+ private:
+  TieredCompiler(const TieredCompiler&) = delete;
+  TieredCompiler& operator=(const TieredCompiler& other) = delete;
+
+  static void Deliver(void* user_data, uint64_t job_id,
+                      shaderc_compilation_result_t result) {
+    std::unique_ptr<OptimizedCallback> callback(
+        static_cast<OptimizedCallback*>(user_data));
+    (*callback)(job_id, SpvCompilationResult(result));
+  }
+
+  shaderc_tiered_compiler_t tiers_;
+};
+
+// Recompiles one shader, with fixed options, as its main source is edited,
+// reusing the files it includes.  See shaderc_compile_session_initialize for
+// details.
+class CompileSession {
+ public:
+  // The compiler must outlive the session.  The options are copied, except
+  // for an includer set with CompileOptions::SetIncluder, which stays owned
+  // by the options, so they must also outlive the session if they have one.
+  CompileSession(const Compiler& compiler, shaderc_shader_kind shader_kind,
+                 const char* input_file_name, const char* entry_point_name,
+                 const CompileOptions& options)
+      : session_(shaderc_compile_session_initialize(
+            compiler.compiler_, shader_kind, input_file_name,
+            entry_point_name, options.options_)) {}
+  ~CompileSession() { shaderc_compile_session_release(session_); }
+
+  bool IsValid() const { return session_ != nullptr; }
+
+  // Compiles the given source into a SPIR-V binary, taking the files that
+  // earlier compiles included from the session.
+  SpvCompilationResult Recompile(const char* source_text,
+                                 size_t source_text_size) const {
+    return SpvCompilationResult(shaderc_compile_session_recompile(
+        session_, source_text, source_text_size));
+  }
+
+  // Like the first Recompile method but the source is provided as a
+  // std::string.
+  SpvCompilationResult Recompile(const std::string& source_text) const {
+    return Recompile(source_text.data(), source_text.size());
+  }
+
+  // Forgets the contents of the included file with the given resolved name,
+  // so that the next compile reads it again.
+  void InvalidateInclude(const std::string& source_name) const {
+    shaderc_compile_session_invalidate_include(session_, source_name.c_str());
+  }
+
+  // Forgets the contents of every included file.
+  void InvalidateIncludes() const {
+    shaderc_compile_session_invalidate_include(session_, nullptr);
+  }
+
+ private:
+  CompileSession(const CompileSession&) = delete;
+  CompileSession& operator=(const CompileSession& other) = delete;
+
+  shaderc_compile_session_t session_;
 };
 }  // namespace shaderc
 
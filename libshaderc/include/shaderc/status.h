@@ -30,6 +30,8 @@ typedef enum {
   shaderc_compilation_status_validation_error = 6,
   shaderc_compilation_status_transformation_error = 7,
   shaderc_compilation_status_configuration_error = 8,
+  // stopped by a cancellation token or a time limit
+  shaderc_compilation_status_cancelled = 9,
 } shaderc_compilation_status;
 
 #ifdef __cplusplus
@@ -15,17 +15,29 @@
 #include "shaderc/shaderc.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
+#include "libshaderc_util/cancellation.h"
 #include "libshaderc_util/compiler.h"
 #include "libshaderc_util/counting_includer.h"
+#include "libshaderc_util/include_report.h"
+#include "libshaderc_util/message.h"
+#include "libshaderc_util/prelude.h"
 #include "libshaderc_util/resources.h"
+#include "libshaderc_util/spirv_cost.h"
+#include "libshaderc_util/spirv_size.h"
+#include "libshaderc_util/spirv_interface.h"
 #include "libshaderc_util/spirv_tools_wrapper.h"
 #include "libshaderc_util/version_profile.h"
+#include "libshaderc_util/work_queue.h"
 #include "shaderc_private.h"
 #include "spirv/unified1/spirv.hpp"
 
@@ -273,6 +285,69 @@ class InternalFileIncluder : public shaderc_util::CountingIncluder {
   void* user_data_;
 };
 
+// The files included by the compiles of a session.  Each include request,
+// named by its type and its requesting and requested sources, maps to the
+// resolved name and the contents of the file.
+using IncludeCache =
+    std::unordered_map<std::string, std::pair<std::string, std::string>>;
+
+// An includer that answers the requests found in a session's cache, and asks
+// another includer for the rest, caching what it resolves.  Failed requests
+// are not cached, so that they are retried by the next compile.
+class CachingIncluder : public shaderc_util::CountingIncluder {
+ public:
+  CachingIncluder(shaderc_util::CountingIncluder& includer, IncludeCache* cache)
+      : includer_(includer), cache_(cache) {}
+
+ private:
+  glslang::TShader::Includer::IncludeResult* include_delegate(
+      const char* requested_source, const char* requesting_source,
+      IncludeType type, size_t include_depth) override {
+    std::string key = type == IncludeType::Local ? "\"" : "<";
+    key += requesting_source;
+    key += '\0';
+    key += requested_source;
+    auto cached = cache_->find(key);
+    if (cached == cache_->end()) {
+      glslang::TShader::Includer::IncludeResult* result =
+          type == IncludeType::Local
+              ? includer_.includeLocal(requested_source, requesting_source,
+                                       include_depth)
+              : includer_.includeSystem(requested_source, requesting_source,
+                                        include_depth);
+      if (!result) return nullptr;
+      if (result->headerName.empty()) {
+        // The user data of a failed result is the one to release.
+        return new glslang::TShader::Includer::IncludeResult(
+            "", result->headerData, result->headerLength, result);
+      }
+      cached = cache_
+                   ->emplace(key, std::make_pair(
+                                      result->headerName,
+                                      std::string(result->headerData,
+                                                  result->headerLength)))
+                   .first;
+      includer_.releaseInclude(result);
+    }
+    return new glslang::TShader::Includer::IncludeResult(
+        cached->second.first, cached->second.second.data(),
+        cached->second.second.size(), nullptr);
+  }
+
+  void release_delegate(
+      glslang::TShader::Includer::IncludeResult* result) override {
+    if (result->userData) {
+      includer_.releaseInclude(
+          static_cast<glslang::TShader::Includer::IncludeResult*>(
+              result->userData));
+    }
+    delete result;
+  }
+
+  shaderc_util::CountingIncluder& includer_;
+  IncludeCache* cache_;
+};
+
 // Converts the target env to the corresponding one in shaderc_util::Compiler.
 shaderc_util::Compiler::TargetEnv GetCompilerTargetEnv(shaderc_target_env env) {
   switch (env) {
@@ -323,6 +398,41 @@ shaderc_util::Compiler::TargetEnvVersion GetCompilerTargetEnvVersion(
   return Compiler::TargetEnvVersion::Default;
 }
 
+// Returns the Compiler::OptimizationLevel for the given
+// shaderc_optimization_level.
+shaderc_util::Compiler::OptimizationLevel GetOptimizationLevel(
+    shaderc_optimization_level level) {
+  switch (level) {
+    case shaderc_optimization_level_size:
+      return shaderc_util::Compiler::OptimizationLevel::Size;
+    case shaderc_optimization_level_performance:
+      return shaderc_util::Compiler::OptimizationLevel::Performance;
+    case shaderc_optimization_level_fast_compile:
+      return shaderc_util::Compiler::OptimizationLevel::FastCompile;
+    case shaderc_optimization_level_min_size:
+      return shaderc_util::Compiler::OptimizationLevel::MinimumSize;
+    default:
+      break;
+  }
+  return shaderc_util::Compiler::OptimizationLevel::Zero;
+}
+
+// Returns the Compiler::OptimizationProfile enum for the given
+// shaderc_optimization_profile enum.
+shaderc_util::Compiler::OptimizationProfile GetOptimizationProfile(
+    shaderc_optimization_profile profile) {
+  switch (profile) {
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES) \
+  case shaderc_optimization_profile_##CNAME:      \
+    return shaderc_util::Compiler::OptimizationProfile::NAME;
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+    default:
+      break;
+  }
+  return shaderc_util::Compiler::OptimizationProfile::Generic;
+}
+
 // Returns the Compiler::Limit enum for the given shaderc_limit enum.
 shaderc_util::Compiler::Limit CompilerLimit(shaderc_limit limit) {
   switch (limit) {
@@ -338,6 +448,22 @@ shaderc_util::Compiler::Limit CompilerLimit(shaderc_limit limit) {
   return static_cast<shaderc_util::Compiler::Limit>(0);
 }
 
+// Returns the Compiler::Guard for the given shaderc_compile_guard.
+shaderc_util::Compiler::Guard CompilerGuard(shaderc_compile_guard guard) {
+  switch (guard) {
+    case shaderc_compile_guard_include_count:
+      return shaderc_util::Compiler::Guard::IncludeCount;
+    case shaderc_compile_guard_include_bytes:
+      return shaderc_util::Compiler::Guard::IncludeBytes;
+    case shaderc_compile_guard_preprocessed_bytes:
+      return shaderc_util::Compiler::Guard::PreprocessedBytes;
+    case shaderc_compile_guard_spirv_words:
+      return shaderc_util::Compiler::Guard::SpirvWords;
+  }
+  assert(0 && "Should not have reached here");
+  return static_cast<shaderc_util::Compiler::Guard>(0);
+}
+
 // Returns the Compiler::UniformKind for the given shaderc_uniform_kind.
 shaderc_util::Compiler::UniformKind GetUniformKind(shaderc_uniform_kind kind) {
   switch (kind) {
@@ -380,6 +506,34 @@ shaderc_util::Compiler::Stage GetStage(shaderc_shader_kind kind) {
   return static_cast<shaderc_util::Compiler::Stage>(0);
 }
 
+// Returns the shaderc_descriptor_type for the given DescriptorType.
+shaderc_descriptor_type GetDescriptorType(shaderc_util::DescriptorType type) {
+  switch (type) {
+    case shaderc_util::DescriptorType::Sampler:
+      return shaderc_descriptor_type_sampler;
+    case shaderc_util::DescriptorType::CombinedImageSampler:
+      return shaderc_descriptor_type_combined_image_sampler;
+    case shaderc_util::DescriptorType::SampledImage:
+      return shaderc_descriptor_type_sampled_image;
+    case shaderc_util::DescriptorType::StorageImage:
+      return shaderc_descriptor_type_storage_image;
+    case shaderc_util::DescriptorType::UniformTexelBuffer:
+      return shaderc_descriptor_type_uniform_texel_buffer;
+    case shaderc_util::DescriptorType::StorageTexelBuffer:
+      return shaderc_descriptor_type_storage_texel_buffer;
+    case shaderc_util::DescriptorType::UniformBuffer:
+      return shaderc_descriptor_type_uniform_buffer;
+    case shaderc_util::DescriptorType::StorageBuffer:
+      return shaderc_descriptor_type_storage_buffer;
+    case shaderc_util::DescriptorType::InputAttachment:
+      return shaderc_descriptor_type_input_attachment;
+    case shaderc_util::DescriptorType::AccelerationStructure:
+      return shaderc_descriptor_type_acceleration_structure;
+  }
+  assert(0 && "Should not have reached here");
+  return shaderc_descriptor_type_sampler;
+}
+
 }  // anonymous namespace
 
 struct shaderc_compile_options {
@@ -389,6 +543,16 @@ struct shaderc_compile_options {
   shaderc_include_resolve_fn include_resolver = nullptr;
   shaderc_include_result_release_fn include_result_releaser = nullptr;
   void* include_user_data = nullptr;
+  bool generate_reflection = false;
+  bool generate_cost_report = false;
+  bool generate_size_attribution = false;
+  bool generate_include_report = false;
+  // Shared with the compiler and the clones of the options.
+  std::shared_ptr<shaderc_util::Prelude> prelude;
+  shaderc_cancellation_token_t cancellation_token = nullptr;
+  std::chrono::milliseconds time_limit{0};
+  // Why the optimizer passes last set were rejected, or empty.
+  std::string optimizer_passes_error;
 };
 
 shaderc_compile_options_t shaderc_compile_options_initialize() {
@@ -428,19 +592,34 @@ void shaderc_compile_options_set_generate_debug_info(
 
 void shaderc_compile_options_set_optimization_level(
     shaderc_compile_options_t options, shaderc_optimization_level level) {
-  auto opt_level = shaderc_util::Compiler::OptimizationLevel::Zero;
-  switch (level) {
-    case shaderc_optimization_level_size:
-      opt_level = shaderc_util::Compiler::OptimizationLevel::Size;
-      break;
-    case shaderc_optimization_level_performance:
-      opt_level = shaderc_util::Compiler::OptimizationLevel::Performance;
-      break;
-    default:
-      break;
-  }
+  options->compiler.SetOptimizationLevel(GetOptimizationLevel(level));
+}
+
+void shaderc_compile_options_set_optimization_profile(
+    shaderc_compile_options_t options, shaderc_optimization_profile profile) {
+  options->compiler.SetOptimizationProfile(GetOptimizationProfile(profile));
+}
 
-  options->compiler.SetOptimizationLevel(opt_level);
+bool shaderc_compile_options_set_optimizer_passes(
+    shaderc_compile_options_t options, const char* const* flags,
+    size_t num_flags) {
+  std::vector<std::string> pass_flags(flags, flags + num_flags);
+  return options->compiler.SetOptimizerPasses(
+      pass_flags, &options->optimizer_passes_error);
+}
+
+bool shaderc_compile_options_set_optimizer_pass_list(
+    shaderc_compile_options_t options, const char* pass_list,
+    size_t pass_list_length) {
+  const auto pass_flags = shaderc_util::ParseSpirvOptPassList(
+      {pass_list, pass_list + pass_list_length});
+  return options->compiler.SetOptimizerPasses(
+      pass_flags, &options->optimizer_passes_error);
+}
+
+const char* shaderc_compile_options_get_optimizer_passes_error(
+    const shaderc_compile_options_t options) {
+  return options->optimizer_passes_error.c_str();
 }
 
 void shaderc_compile_options_set_forced_version_profile(
@@ -540,6 +719,16 @@ void shaderc_compile_options_set_preserve_bindings(
   options->compiler.SetPreserveBindings(preserve_bindings);
 }
 
+void shaderc_compile_options_set_compact_pipeline_bindings(
+    shaderc_compile_options_t options, bool compact) {
+  options->compiler.SetCompactPipelineBindings(compact);
+}
+
+void shaderc_compile_options_set_compile_only(
+    shaderc_compile_options_t options, bool compile_only) {
+  options->compiler.SetCompileOnly(compile_only);
+}
+
 void shaderc_compile_options_set_auto_map_locations(
     shaderc_compile_options_t options, bool auto_map) {
   options->compiler.SetAutoMapLocations(auto_map);
@@ -583,6 +772,93 @@ void shaderc_compile_options_set_nan_clamp(shaderc_compile_options_t options,
   options->compiler.SetNanClamp(enable);
 }
 
+void shaderc_compile_options_set_generate_reflection(
+    shaderc_compile_options_t options, bool enable) {
+  options->generate_reflection = enable;
+}
+
+void shaderc_compile_options_set_generate_cost_report(
+    shaderc_compile_options_t options, bool enable) {
+  options->generate_cost_report = enable;
+}
+
+void shaderc_compile_options_set_generate_size_attribution(
+    shaderc_compile_options_t options, bool enable) {
+  options->generate_size_attribution = enable;
+}
+
+void shaderc_compile_options_set_generate_include_report(
+    shaderc_compile_options_t options, bool enable) {
+  options->generate_include_report = enable;
+}
+
+void shaderc_compile_options_set_prelude(shaderc_compile_options_t options,
+                                         const char* source,
+                                         size_t source_length,
+                                         const char* name) {
+  if (!source) {
+    options->prelude.reset();
+  } else {
+    auto prelude = std::make_shared<shaderc_util::Prelude>(
+        std::string(source, source_length), name ? name : "");
+    // An unchanged prelude keeps what it has prepared.
+    if (options->prelude && options->prelude->hash() == prelude->hash()) {
+      return;
+    }
+    options->prelude = std::move(prelude);
+  }
+  options->compiler.SetPrelude(options->prelude);
+}
+
+struct shaderc_cancellation_token {
+  shaderc_cancellation_token() { cancelled.store(false); }
+  std::atomic<bool> cancelled;
+};
+
+shaderc_cancellation_token_t shaderc_cancellation_token_initialize() {
+  return new (std::nothrow) shaderc_cancellation_token;
+}
+
+void shaderc_cancellation_token_cancel(shaderc_cancellation_token_t token) {
+  token->cancelled.store(true);
+}
+
+void shaderc_cancellation_token_release(shaderc_cancellation_token_t token) {
+  delete token;
+}
+
+void shaderc_compile_options_set_cancellation_token(
+    shaderc_compile_options_t options, shaderc_cancellation_token_t token) {
+  options->cancellation_token = token;
+}
+
+void shaderc_compile_options_set_time_limit(shaderc_compile_options_t options,
+                                            uint32_t milliseconds) {
+  options->time_limit = std::chrono::milliseconds(milliseconds);
+}
+
+void shaderc_compile_options_set_compile_guard(
+    shaderc_compile_options_t options, shaderc_compile_guard guard,
+    size_t value) {
+  options->compiler.SetGuard(CompilerGuard(guard), value);
+}
+
+void shaderc_compile_options_add_baked_uniform(
+    shaderc_compile_options_t options, const char* block, const char* member,
+    const char* value) {
+  options->compiler.AddBakedUniform({block, member, value});
+}
+
+void shaderc_compile_options_set_workgroup_size(
+    shaderc_compile_options_t options, uint32_t x, uint32_t y, uint32_t z) {
+  options->compiler.SetWorkgroupSize(x, y, z);
+}
+
+void shaderc_compile_options_set_workgroup_size_spec_ids(
+    shaderc_compile_options_t options, uint32_t x, uint32_t y, uint32_t z) {
+  options->compiler.SetWorkgroupSizeSpecIds(x, y, z);
+}
+
 shaderc_compiler_t shaderc_compiler_initialize() {
   shaderc_compiler_t compiler = new (std::nothrow) shaderc_compiler;
   if (compiler) {
@@ -594,17 +870,104 @@ shaderc_compiler_t shaderc_compiler_initialize() {
 void shaderc_compiler_release(shaderc_compiler_t compiler) { delete compiler; }
 
 namespace {
+// Fills in the reflection data, the cost report and the size attribution of
+// a successful result, if the options ask for them.  Assembly text is
+// assembled again to reflect it.  A module that cannot be reflected or
+// analyzed gets a warning rather than failing.  A size attribution made
+// while compiling is kept.
+void ReflectResult(const shaderc_compile_options_t options,
+                   shaderc_util::Compiler::OutputType output_type,
+                   shaderc_compilation_result* result) {
+  const bool attribute_size = options &&
+                              options->generate_size_attribution &&
+                              result->size_attribution.empty();
+  if (!options ||
+      (!options->generate_reflection && !options->generate_cost_report &&
+       !attribute_size) ||
+      result->compilation_status != shaderc_compilation_status_success ||
+      output_type == shaderc_util::Compiler::OutputType::PreprocessedText) {
+    return;
+  }
+  std::vector<uint32_t> spirv;
+  std::string errors;
+  if (output_type == shaderc_util::Compiler::OutputType::SpirvBinary) {
+    const uint32_t* words =
+        reinterpret_cast<const uint32_t*>(result->GetBytes());
+    spirv.assign(words, words + result->output_data_size / sizeof(uint32_t));
+  } else {
+    spv_binary binary = nullptr;
+    const char* text = result->GetBytes();
+    if (shaderc_util::SpirvToolsAssemble(
+            GetCompilerTargetEnv(options->target_env),
+            GetCompilerTargetEnvVersion(options->target_env_version),
+            {text, text + result->output_data_size}, &binary, &errors)) {
+      spirv.assign(binary->code, binary->code + binary->wordCount);
+    }
+    spvBinaryDestroy(binary);
+  }
+  if (options->generate_reflection) {
+    shaderc_util::ShaderReflection reflection;
+    if (!spirv.empty() &&
+        shaderc_util::ReflectSpirv(spirv, &reflection, &errors)) {
+      result->reflection = shaderc_util::ReflectionToJson(reflection);
+    } else {
+      result->AddMessage(false, "cannot reflect the module: " + errors);
+      ++result->num_warnings;
+    }
+  }
+  if (options->generate_cost_report) {
+    shaderc_util::ShaderCost cost;
+    if (!spirv.empty() &&
+        shaderc_util::AnalyzeSpirvCost(spirv, &cost, &errors)) {
+      result->cost_report = shaderc_util::CostToJson(cost);
+    } else {
+      result->AddMessage(false,
+                         "cannot analyze the cost of the module: " + errors);
+      ++result->num_warnings;
+    }
+  }
+  if (attribute_size) {
+    shaderc_util::SizeAttribution attribution;
+    if (!spirv.empty() &&
+        shaderc_util::AttributeSpirvSize(spirv, &attribution, &errors)) {
+      result->size_attribution =
+          shaderc_util::SizeAttributionToJson(attribution);
+    } else {
+      result->AddMessage(
+          false, "cannot attribute the size of the module: " + errors);
+      ++result->num_warnings;
+    }
+  }
+}
+
+// Returns the cancellation of a compile with the given options that starts
+// now.
+shaderc_util::Cancellation GetCancellation(
+    const shaderc_compile_options& options) {
+  using Clock = shaderc_util::Cancellation::Clock;
+  const std::atomic<bool>* flag = options.cancellation_token
+                                      ? &options.cancellation_token->cancelled
+                                      : nullptr;
+  const Clock::time_point deadline =
+      options.time_limit.count() ? Clock::now() + options.time_limit
+                                 : Clock::time_point::max();
+  return shaderc_util::Cancellation(flag, deadline);
+}
+
 shaderc_compilation_result_t CompileToSpecifiedOutputType(
     const shaderc_compiler_t compiler, const char* source_text,
     size_t source_text_size, shaderc_shader_kind shader_kind,
     const char* input_file_name, const char* entry_point_name,
     const shaderc_compile_options_t additional_options,
-    shaderc_util::Compiler::OutputType output_type) {
+    shaderc_util::Compiler::OutputType output_type,
+    IncludeCache* include_cache = nullptr) {
   auto* result = new (std::nothrow) shaderc_compilation_result_vector;
   if (!result) return nullptr;
 
   if (!input_file_name) {
     result->messages = "Input file name string was null.";
+    shaderc_util::AddDiagnostic(&result->diagnostics, true, "shaderc", 0,
+                                result->messages);
     result->num_errors = 1;
     result->compilation_status = shaderc_compilation_status_compilation_error;
     return result;
@@ -614,6 +977,10 @@ shaderc_compilation_result_t CompileToSpecifiedOutputType(
   std::vector<uint32_t> compilation_output_data;
   size_t compilation_output_data_size_in_bytes = 0u;
   if (!compiler->initializer) return result;
+  // The time limit counts from here.
+  const shaderc_util::Cancellation cancellation =
+      additional_options ? GetCancellation(*additional_options)
+                         : shaderc_util::Cancellation();
   TRY_IF_EXCEPTIONS_ENABLED {
     std::stringstream errors;
     size_t total_warnings = 0;
@@ -624,9 +991,31 @@ shaderc_compilation_result_t CompileToSpecifiedOutputType(
         shaderc_util::string_piece(source_text, source_text + source_text_size);
     StageDeducer stage_deducer(shader_kind);
     if (additional_options) {
-      InternalFileIncluder includer(additional_options->include_resolver,
-                                    additional_options->include_result_releaser,
-                                    additional_options->include_user_data);
+      InternalFileIncluder file_includer(
+          additional_options->include_resolver,
+          additional_options->include_result_releaser,
+          additional_options->include_user_data);
+      // A session reads each included file once, across its compiles.
+      CachingIncluder caching_includer(file_includer, include_cache);
+      shaderc_util::CountingIncluder& resolving_includer =
+          include_cache ? static_cast<shaderc_util::CountingIncluder&>(
+                              caching_includer)
+                        : file_includer;
+      shaderc_util::CancellingIncluder cancelling_includer(resolving_includer,
+                                                           cancellation);
+      shaderc_util::CountingIncluder& includer =
+          cancellation.is_active()
+              ? static_cast<shaderc_util::CountingIncluder&>(
+                    cancelling_includer)
+              : resolving_includer;
+      std::vector<shaderc_util::DescriptorBinding> removed_bindings;
+      std::vector<shaderc_util::OptimizationStage> optimization_stages;
+      // The include report takes the words of each file from the size
+      // attribution.
+      const bool attribute_size =
+          additional_options->generate_size_attribution ||
+          additional_options->generate_include_report;
+      shaderc_util::SizeAttribution attribution;
       // Depends on return value optimization to avoid extra copy.
       std::tie(compilation_succeeded, compilation_output_data,
                compilation_output_data_size_in_bytes) =
@@ -637,7 +1026,31 @@ shaderc_compilation_result_t CompileToSpecifiedOutputType(
               // We need to make this a reference wrapper, so that std::function
               // won't make a copy for this callable object.
               std::ref(stage_deducer), includer, output_type, &errors,
-              &total_warnings, &total_errors);
+              &total_warnings, &total_errors, &removed_bindings,
+              &optimization_stages,
+              attribute_size ? &attribution : nullptr, &cancellation,
+              &result->diagnostics);
+      // An attribution that failed has a warning, and no words.
+      if (compilation_succeeded &&
+          additional_options->generate_size_attribution &&
+          attribution.total_words) {
+        result->size_attribution =
+            shaderc_util::SizeAttributionToJson(attribution);
+      }
+      if (compilation_succeeded &&
+          additional_options->generate_include_report) {
+        result->include_report = shaderc_util::IncludeReportToJson(
+            includer.include_stats(), attribution);
+      }
+      for (const auto& binding : removed_bindings) {
+        result->removed_bindings.push_back(
+            {binding.set, binding.binding, GetDescriptorType(binding.type),
+             binding.count, binding.stage_flags});
+      }
+      for (const auto& stage : optimization_stages) {
+        result->optimization_stages.push_back(
+            {stage.name, stage.size_in_bytes});
+      }
     } else {
       // Compile with default options.
       InternalFileIncluder includer;
@@ -646,7 +1059,8 @@ shaderc_compilation_result_t CompileToSpecifiedOutputType(
           shaderc_util::Compiler().Compile(
               source_string, forced_stage, input_file_name_str,
               entry_point_name, std::ref(stage_deducer), includer, output_type,
-              &errors, &total_warnings, &total_errors);
+              &errors, &total_warnings, &total_errors, nullptr, nullptr,
+              nullptr, nullptr, &result->diagnostics);
     }
 
     result->messages = errors.str();
@@ -656,6 +1070,8 @@ shaderc_compilation_result_t CompileToSpecifiedOutputType(
     result->num_errors = total_errors;
     if (compilation_succeeded) {
       result->compilation_status = shaderc_compilation_status_success;
+    } else if (cancellation.was_cancelled()) {
+      result->compilation_status = shaderc_compilation_status_cancelled;
     } else {
       // Check whether the error is caused by failing to deduce the shader
       // stage. If it is the case, set the error type to shader kind error.
@@ -664,12 +1080,308 @@ shaderc_compilation_result_t CompileToSpecifiedOutputType(
           stage_deducer.error() ? shaderc_compilation_status_invalid_stage
                                 : shaderc_compilation_status_compilation_error;
     }
+    ReflectResult(additional_options, output_type, result);
   }
   CATCH_IF_EXCEPTIONS_ENABLED(...) {
     result->compilation_status = shaderc_compilation_status_internal_error;
   }
   return result;
 }
+
+// Applies transform to a copy of a SPIR-V module, and returns the result, or
+// null if it could not be allocated.  If transform fails, the result carries
+// its message, prefixed with "failed to <action>: ".
+shaderc_compilation_result_t TransformSpirvModule(
+    const shaderc_compiler_t compiler, const uint32_t* binary,
+    size_t binary_word_count, const char* action,
+    const std::function<bool(std::vector<uint32_t>*, std::string*)>&
+        transform) {
+  auto* result = new (std::nothrow) shaderc_compilation_result_vector;
+  if (!result) return nullptr;
+  result->compilation_status = shaderc_compilation_status_transformation_error;
+  if (!compiler->initializer) return result;
+  if (binary == nullptr) return result;
+
+  TRY_IF_EXCEPTIONS_ENABLED {
+    std::vector<uint32_t> spirv(binary, binary + binary_word_count);
+    std::string errors;
+    if (transform(&spirv, &errors)) {
+      result->output_data_size = spirv.size() * sizeof(uint32_t);
+      result->SetOutputData(std::move(spirv));
+      result->compilation_status = shaderc_compilation_status_success;
+    } else {
+      result->AddMessage(true, std::string("failed to ") + action + ": " +
+                                   errors);
+      result->num_errors = 1;
+    }
+  }
+  CATCH_IF_EXCEPTIONS_ENABLED(...) {
+    result->compilation_status = shaderc_compilation_status_internal_error;
+  }
+  return result;
+}
+
+// Validates a SPIR-V module and optimizes it with the optimization settings
+// of util_compiler, and returns the result, or null if it could not be
+// allocated.
+shaderc_compilation_result_t OptimizeSpirvModule(
+    const shaderc_compiler_t compiler,
+    const shaderc_util::Compiler& util_compiler, const uint32_t* binary,
+    size_t binary_word_count) {
+  return TransformSpirvModule(
+      compiler, binary, binary_word_count, "optimize",
+      [&util_compiler](std::vector<uint32_t>* spirv, std::string* errors) {
+        return util_compiler.ValidateSpirv(*spirv, errors) &&
+               util_compiler.OptimizeSpirv(spirv, errors);
+      });
+}
+
+// Validates a SPIR-V module, specializes it with the given constant values,
+// and optimizes it with the optimization settings of util_compiler.  Returns
+// the result, or null if it could not be allocated.
+shaderc_compilation_result_t SpecializeSpirvModule(
+    const shaderc_compiler_t compiler,
+    const shaderc_util::Compiler& util_compiler, const uint32_t* binary,
+    size_t binary_word_count, const shaderc_specialization& specialization) {
+  return TransformSpirvModule(
+      compiler, binary, binary_word_count, "specialize",
+      [&util_compiler, &specialization](std::vector<uint32_t>* spirv,
+                                        std::string* errors) {
+        std::unordered_map<uint32_t, std::string> values;
+        for (size_t i = 0; i < specialization.num_constants; ++i) {
+          const auto& constant = specialization.constants[i];
+          if (constant.value == nullptr) {
+            *errors = "no value for SpecId " +
+                      std::to_string(constant.constant_id);
+            return false;
+          }
+          values[constant.constant_id] = constant.value;
+        }
+        return util_compiler.ValidateSpirv(*spirv, errors) &&
+               util_compiler.SpecializeSpirv(values, spirv, errors);
+      });
+}
+
+// Like CompileToSpecifiedOutputType, but runs the front end once and writes
+// one result per recipe to results.
+void CompileWithRecipesToSpecifiedOutputType(
+    const shaderc_compiler_t compiler, const char* source_text,
+    size_t source_text_size, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options,
+    const shaderc_optimization_recipe* recipes, size_t num_recipes,
+    shaderc_compilation_result_t* results,
+    shaderc_util::Compiler::OutputType output_type) {
+  std::vector<shaderc_compilation_result_vector*> outputs(num_recipes);
+  for (size_t i = 0; i < num_recipes; ++i) {
+    results[i] = outputs[i] =
+        new (std::nothrow) shaderc_compilation_result_vector;
+  }
+  if (std::find(outputs.begin(), outputs.end(), nullptr) != outputs.end()) {
+    return;
+  }
+
+  for (auto* result : outputs) {
+    result->compilation_status = shaderc_compilation_status_invalid_stage;
+  }
+  if (!input_file_name) {
+    for (auto* result : outputs) {
+      result->messages = "Input file name string was null.";
+      shaderc_util::AddDiagnostic(&result->diagnostics, true, "shaderc", 0,
+                                  result->messages);
+      result->num_errors = 1;
+      result->compilation_status = shaderc_compilation_status_compilation_error;
+    }
+    return;
+  }
+  if (!compiler->initializer) return;
+  TRY_IF_EXCEPTIONS_ENABLED {
+    std::vector<shaderc_util::Compiler::OptimizationRecipe> util_recipes;
+    for (size_t i = 0; i < num_recipes; ++i) {
+      const uint32_t* size = recipes[i].workgroup_size;
+      util_recipes.push_back(
+          {GetOptimizationLevel(recipes[i].optimization_level),
+           recipes[i].generate_debug_info,
+           {size[0], size[1], size[2]}});
+    }
+    std::stringstream errors;
+    size_t total_warnings = 0;
+    size_t total_errors = 0;
+    std::string input_file_name_str(input_file_name);
+    EShLanguage forced_stage = GetForcedStage(shader_kind);
+    shaderc_util::string_piece source_string =
+        shaderc_util::string_piece(source_text, source_text + source_text_size);
+    StageDeducer stage_deducer(shader_kind);
+    const shaderc_util::Compiler default_compiler;
+    const shaderc_util::Compiler& util_compiler =
+        additional_options ? additional_options->compiler : default_compiler;
+    InternalFileIncluder includer =
+        additional_options
+            ? InternalFileIncluder(additional_options->include_resolver,
+                                   additional_options->include_result_releaser,
+                                   additional_options->include_user_data)
+            : InternalFileIncluder();
+    std::vector<shaderc_util::Diagnostic> front_end_diagnostics;
+    std::vector<shaderc_util::Compiler::ModuleOutput> recipe_outputs =
+        util_compiler.CompileWithRecipes(
+            source_string, forced_stage, input_file_name_str, entry_point_name,
+            std::ref(stage_deducer), includer, util_recipes, output_type,
+            &errors, &total_warnings, &total_errors, &front_end_diagnostics);
+
+    const std::string front_end_messages = errors.str();
+    for (size_t i = 0; i < num_recipes; ++i) {
+      auto* result = outputs[i];
+      auto& recipe_output = recipe_outputs[i];
+      result->messages = front_end_messages + recipe_output.errors;
+      result->diagnostics = front_end_diagnostics;
+      result->diagnostics.insert(result->diagnostics.end(),
+                                 recipe_output.diagnostics.begin(),
+                                 recipe_output.diagnostics.end());
+      result->SetOutputData(std::move(recipe_output.data));
+      result->output_data_size = recipe_output.size_in_bytes;
+      for (const auto& stage : recipe_output.optimization_stages) {
+        result->optimization_stages.push_back(
+            {stage.name, stage.size_in_bytes});
+      }
+      result->num_warnings = total_warnings;
+      result->num_errors = total_errors;
+      if (recipe_output.succeeded) {
+        result->compilation_status = shaderc_compilation_status_success;
+      } else if (!recipe_output.errors.empty()) {
+        // The front end succeeded, but this recipe did not.
+        result->num_errors++;
+        result->compilation_status = shaderc_compilation_status_internal_error;
+      } else {
+        result->compilation_status =
+            stage_deducer.error()
+                ? shaderc_compilation_status_invalid_stage
+                : shaderc_compilation_status_compilation_error;
+      }
+      ReflectResult(additional_options, output_type, result);
+    }
+  }
+  CATCH_IF_EXCEPTIONS_ENABLED(...) {
+    for (auto* result : outputs) {
+      result->compilation_status = shaderc_compilation_status_internal_error;
+    }
+  }
+}
+
+// Compiles the given pipeline into one result per stage, in the specified
+// output type.
+void CompilePipelineToSpecifiedOutputType(
+    const shaderc_compiler_t compiler, const shaderc_pipeline_stage* stages,
+    size_t num_stages, const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results,
+    shaderc_util::Compiler::OutputType output_type) {
+  std::vector<shaderc_compilation_result_vector*> outputs(num_stages);
+  for (size_t i = 0; i < num_stages; ++i) {
+    results[i] = outputs[i] =
+        new (std::nothrow) shaderc_compilation_result_vector;
+  }
+  if (std::find(outputs.begin(), outputs.end(), nullptr) != outputs.end()) {
+    return;
+  }
+
+  // Fails every stage with the given message, and with a diagnostic of the
+  // given file and text.
+  auto fail_all = [&outputs](const std::string& message,
+                             const std::string& file, const std::string& text,
+                             shaderc_compilation_status status) {
+    for (auto* result : outputs) {
+      result->messages = message;
+      shaderc_util::AddDiagnostic(&result->diagnostics, true, file, 0, text);
+      result->num_errors = 1;
+      result->compilation_status = status;
+    }
+  };
+  for (auto* result : outputs) {
+    result->compilation_status = shaderc_compilation_status_invalid_stage;
+  }
+  std::vector<shaderc_util::Compiler::PipelineStage> util_stages;
+  for (size_t i = 0; i < num_stages; ++i) {
+    const shaderc_pipeline_stage& stage = stages[i];
+    if (!stage.input_file_name) {
+      fail_all("Input file name string was null.", "shaderc",
+               "Input file name string was null.",
+               shaderc_compilation_status_compilation_error);
+      return;
+    }
+    const EShLanguage forced_stage = GetForcedStage(stage.shader_kind);
+    if (forced_stage == EShLangCount) {
+      const char kMessage[] =
+          "the shader stage must be given explicitly in a pipeline";
+      fail_all(std::string(stage.input_file_name) + ": error: " + kMessage +
+                   "\n",
+               stage.input_file_name, kMessage,
+               shaderc_compilation_status_invalid_stage);
+      return;
+    }
+    util_stages.push_back(
+        {shaderc_util::string_piece(
+             stage.source_text, stage.source_text + stage.source_text_size),
+         forced_stage, stage.input_file_name,
+         stage.entry_point_name ? stage.entry_point_name : "main"});
+  }
+  if (!compiler->initializer) return;
+  TRY_IF_EXCEPTIONS_ENABLED {
+    std::stringstream errors;
+    size_t total_warnings = 0;
+    size_t total_errors = 0;
+    const shaderc_util::Compiler default_compiler;
+    const shaderc_util::Compiler& util_compiler =
+        additional_options ? additional_options->compiler : default_compiler;
+    InternalFileIncluder includer =
+        additional_options
+            ? InternalFileIncluder(additional_options->include_resolver,
+                                   additional_options->include_result_releaser,
+                                   additional_options->include_user_data)
+            : InternalFileIncluder();
+    std::vector<shaderc_util::DescriptorBinding> layout;
+    std::vector<shaderc_util::Diagnostic> front_end_diagnostics;
+    std::vector<shaderc_util::Compiler::ModuleOutput> stage_outputs =
+        util_compiler.CompilePipeline(util_stages, includer, output_type,
+                                      &layout, &errors, &total_warnings,
+                                      &total_errors, &front_end_diagnostics);
+    std::vector<shaderc_descriptor_binding> descriptor_bindings;
+    for (const auto& binding : layout) {
+      descriptor_bindings.push_back(
+          {binding.set, binding.binding, GetDescriptorType(binding.type),
+           binding.count, binding.stage_flags});
+    }
+
+    const std::string front_end_messages = errors.str();
+    for (size_t i = 0; i < num_stages; ++i) {
+      auto* result = outputs[i];
+      auto& stage_output = stage_outputs[i];
+      result->messages = front_end_messages + stage_output.errors;
+      result->diagnostics = front_end_diagnostics;
+      result->diagnostics.insert(result->diagnostics.end(),
+                                 stage_output.diagnostics.begin(),
+                                 stage_output.diagnostics.end());
+      result->SetOutputData(std::move(stage_output.data));
+      result->output_data_size = stage_output.size_in_bytes;
+      result->num_warnings = total_warnings;
+      result->num_errors = total_errors;
+      if (stage_output.succeeded) {
+        result->compilation_status = shaderc_compilation_status_success;
+        result->descriptor_bindings = descriptor_bindings;
+      } else if (!stage_output.errors.empty()) {
+        result->num_errors++;
+        result->compilation_status = shaderc_compilation_status_internal_error;
+      } else {
+        result->compilation_status =
+            shaderc_compilation_status_compilation_error;
+      }
+      ReflectResult(additional_options, output_type, result);
+    }
+  }
+  CATCH_IF_EXCEPTIONS_ENABLED(...) {
+    for (auto* result : outputs) {
+      result->compilation_status = shaderc_compilation_status_internal_error;
+    }
+  }
+}
 }  // anonymous namespace
 
 shaderc_compilation_result_t shaderc_compile_into_spv(
@@ -705,6 +1417,154 @@ shaderc_compilation_result_t shaderc_compile_into_preprocessed_text(
       shaderc_util::Compiler::OutputType::PreprocessedText);
 }
 
+void shaderc_compile_into_spv_with_recipes(
+    const shaderc_compiler_t compiler, const char* source_text,
+    size_t source_text_size, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options,
+    const shaderc_optimization_recipe* recipes, size_t num_recipes,
+    shaderc_compilation_result_t* results) {
+  CompileWithRecipesToSpecifiedOutputType(
+      compiler, source_text, source_text_size, shader_kind, input_file_name,
+      entry_point_name, additional_options, recipes, num_recipes, results,
+      shaderc_util::Compiler::OutputType::SpirvBinary);
+}
+
+void shaderc_compile_into_spv_assembly_with_recipes(
+    const shaderc_compiler_t compiler, const char* source_text,
+    size_t source_text_size, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options,
+    const shaderc_optimization_recipe* recipes, size_t num_recipes,
+    shaderc_compilation_result_t* results) {
+  CompileWithRecipesToSpecifiedOutputType(
+      compiler, source_text, source_text_size, shader_kind, input_file_name,
+      entry_point_name, additional_options, recipes, num_recipes, results,
+      shaderc_util::Compiler::OutputType::SpirvAssemblyText);
+}
+
+void shaderc_compile_pipeline_into_spv(
+    const shaderc_compiler_t compiler, const shaderc_pipeline_stage* stages,
+    size_t num_stages, const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results) {
+  CompilePipelineToSpecifiedOutputType(
+      compiler, stages, num_stages, additional_options, results,
+      shaderc_util::Compiler::OutputType::SpirvBinary);
+}
+
+void shaderc_compile_pipeline_into_spv_assembly(
+    const shaderc_compiler_t compiler, const shaderc_pipeline_stage* stages,
+    size_t num_stages, const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results) {
+  CompilePipelineToSpecifiedOutputType(
+      compiler, stages, num_stages, additional_options, results,
+      shaderc_util::Compiler::OutputType::SpirvAssemblyText);
+}
+
+shaderc_compilation_result_t shaderc_optimize_spv(
+    const shaderc_compiler_t compiler, const uint32_t* binary,
+    size_t binary_word_count,
+    const shaderc_compile_options_t additional_options) {
+  auto* result = OptimizeSpirvModule(
+      compiler,
+      additional_options ? additional_options->compiler
+                         : shaderc_util::Compiler(),
+      binary, binary_word_count);
+  if (result) {
+    ReflectResult(additional_options,
+                  shaderc_util::Compiler::OutputType::SpirvBinary, result);
+  }
+  return result;
+}
+
+void shaderc_optimize_spv_batch(
+    const shaderc_compiler_t compiler, const uint32_t* const* binaries,
+    const size_t* binary_word_counts, size_t num_binaries,
+    const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results) {
+  const shaderc_util::Compiler util_compiler =
+      additional_options ? additional_options->compiler
+                         : shaderc_util::Compiler();
+  if (num_binaries <= 1) {
+    if (num_binaries == 1) {
+      results[0] = shaderc_optimize_spv(compiler, binaries[0],
+                                        binary_word_counts[0],
+                                        additional_options);
+    }
+    return;
+  }
+  // Each module is optimized independently.
+  std::fill(results, results + num_binaries, nullptr);
+  shaderc_util::RunInParallel(num_binaries, [&](size_t i) {
+    results[i] = OptimizeSpirvModule(compiler, util_compiler, binaries[i],
+                                     binary_word_counts[i]);
+    if (results[i]) {
+      ReflectResult(additional_options,
+                    shaderc_util::Compiler::OutputType::SpirvBinary,
+                    results[i]);
+    }
+  });
+}
+
+void shaderc_specialize_spv(
+    const shaderc_compiler_t compiler, const uint32_t* binary,
+    size_t binary_word_count, const shaderc_specialization* specializations,
+    size_t num_specializations,
+    const shaderc_compile_options_t additional_options,
+    shaderc_compilation_result_t* results) {
+  const shaderc_util::Compiler util_compiler =
+      additional_options ? additional_options->compiler
+                         : shaderc_util::Compiler();
+  // The specializations share the front-end output, and are independent of
+  // one another.
+  std::fill(results, results + num_specializations, nullptr);
+  shaderc_util::RunInParallel(num_specializations, [&](size_t i) {
+    results[i] = SpecializeSpirvModule(compiler, util_compiler, binary,
+                                       binary_word_count, specializations[i]);
+    if (results[i]) {
+      ReflectResult(additional_options,
+                    shaderc_util::Compiler::OutputType::SpirvBinary,
+                    results[i]);
+    }
+  });
+}
+
+shaderc_compilation_result_t shaderc_link_spv(
+    const shaderc_compiler_t compiler, const uint32_t* const* binaries,
+    const size_t* binary_word_counts, size_t num_binaries,
+    const shaderc_compile_options_t additional_options) {
+  auto* result = new (std::nothrow) shaderc_compilation_result_vector;
+  if (!result) return nullptr;
+  result->compilation_status = shaderc_compilation_status_transformation_error;
+  if (!compiler->initializer) return result;
+
+  TRY_IF_EXCEPTIONS_ENABLED {
+    std::vector<std::vector<uint32_t>> modules;
+    for (size_t i = 0; i < num_binaries; ++i) {
+      modules.emplace_back(binaries[i], binaries[i] + binary_word_counts[i]);
+    }
+    const shaderc_util::Compiler default_compiler;
+    const shaderc_util::Compiler& util_compiler =
+        additional_options ? additional_options->compiler : default_compiler;
+    std::vector<uint32_t> linked;
+    std::string errors;
+    if (util_compiler.LinkSpirv(modules, &linked, &errors)) {
+      result->output_data_size = linked.size() * sizeof(uint32_t);
+      result->SetOutputData(std::move(linked));
+      result->compilation_status = shaderc_compilation_status_success;
+    } else {
+      result->AddMessage(true, "failed to link: " + errors);
+      result->num_errors = 1;
+    }
+    ReflectResult(additional_options,
+                  shaderc_util::Compiler::OutputType::SpirvBinary, result);
+  }
+  CATCH_IF_EXCEPTIONS_ENABLED(...) {
+    result->compilation_status = shaderc_compilation_status_internal_error;
+  }
+  return result;
+}
+
 shaderc_compilation_result_t shaderc_assemble_into_spv(
     const shaderc_compiler_t compiler, const char* source_assembly,
     size_t source_assembly_size,
@@ -737,6 +1597,8 @@ shaderc_compilation_result_t shaderc_assemble_into_spv(
       result->messages = std::move(errors);
       result->compilation_status = shaderc_compilation_status_invalid_assembly;
     }
+    ReflectResult(additional_options,
+                  shaderc_util::Compiler::OutputType::SpirvBinary, result);
   }
   CATCH_IF_EXCEPTIONS_ENABLED(...) {
     result->compilation_status = shaderc_compilation_status_internal_error;
@@ -773,11 +1635,248 @@ const char* shaderc_result_get_error_message(
   return result->messages.c_str();
 }
 
+size_t shaderc_result_get_diagnostics(
+    const shaderc_compilation_result_t result, shaderc_diagnostic* diagnostics,
+    size_t capacity) {
+  const size_t count = result->diagnostics.size();
+  for (size_t i = 0; i < count && i < capacity; ++i) {
+    const shaderc_util::Diagnostic& diagnostic = result->diagnostics[i];
+    diagnostics[i] = {diagnostic.is_error ? shaderc_diagnostic_severity_error
+                                          : shaderc_diagnostic_severity_warning,
+                      diagnostic.file.data(),
+                      diagnostic.file.size(),
+                      static_cast<uint32_t>(diagnostic.line),
+                      diagnostic.message.data(),
+                      diagnostic.message.size()};
+  }
+  return count;
+}
+
 shaderc_compilation_status shaderc_result_get_compilation_status(
     const shaderc_compilation_result_t result) {
   return result->compilation_status;
 }
 
+size_t shaderc_result_get_num_descriptor_bindings(
+    const shaderc_compilation_result_t result) {
+  return result->descriptor_bindings.size();
+}
+
+const shaderc_descriptor_binding* shaderc_result_get_descriptor_bindings(
+    const shaderc_compilation_result_t result) {
+  return result->descriptor_bindings.data();
+}
+
+const char* shaderc_result_get_reflection(
+    const shaderc_compilation_result_t result) {
+  return result->reflection.c_str();
+}
+
+const char* shaderc_result_get_cost_report(
+    const shaderc_compilation_result_t result) {
+  return result->cost_report.c_str();
+}
+
+const char* shaderc_result_get_size_attribution(
+    const shaderc_compilation_result_t result) {
+  return result->size_attribution.c_str();
+}
+
+const char* shaderc_result_get_include_report(
+    const shaderc_compilation_result_t result) {
+  return result->include_report.c_str();
+}
+
+size_t shaderc_result_get_num_removed_bindings(
+    const shaderc_compilation_result_t result) {
+  return result->removed_bindings.size();
+}
+
+const shaderc_descriptor_binding* shaderc_result_get_removed_bindings(
+    const shaderc_compilation_result_t result) {
+  return result->removed_bindings.data();
+}
+
+size_t shaderc_result_get_num_optimization_stages(
+    const shaderc_compilation_result_t result) {
+  return result->optimization_stages.size();
+}
+
+const shaderc_optimization_stage* shaderc_result_get_optimization_stages(
+    const shaderc_compilation_result_t result) {
+  return result->optimization_stages.data();
+}
+
+struct shaderc_tiered_compiler {
+  explicit shaderc_tiered_compiler(size_t num_threads) : queue(num_threads) {}
+  shaderc_util::PriorityWorkQueue queue;
+};
+
+shaderc_tiered_compiler_t shaderc_tiered_compiler_initialize(
+    size_t num_threads) {
+  return new (std::nothrow) shaderc_tiered_compiler(num_threads);
+}
+
+void shaderc_tiered_compiler_release(shaderc_tiered_compiler_t tiers) {
+  delete tiers;
+}
+
+shaderc_compilation_result_t shaderc_tiered_compile_into_spv(
+    shaderc_tiered_compiler_t tiers, const shaderc_compiler_t compiler,
+    const char* source_text, size_t source_text_size,
+    shaderc_shader_kind shader_kind, const char* input_file_name,
+    const char* entry_point_name,
+    const shaderc_compile_options_t additional_options, int priority,
+    shaderc_optimized_result_fn callback, void* user_data, uint64_t* job_id) {
+  if (job_id) *job_id = 0;
+
+  // The first tier is an ordinary compilation with the optimizer turned off.
+  // HLSL legalization is not part of the optimization level, so it still runs.
+  shaderc_compile_options unoptimized_options;
+  if (additional_options) unoptimized_options = *additional_options;
+  // The second tier keeps the options as given, for the optimizer and for
+  // the reflection and reports they ask for.
+  shaderc_compile_options optimizing_options = unoptimized_options;
+  std::string errors;
+  unoptimized_options.compiler.SetOptimizationLevel(
+      shaderc_util::Compiler::OptimizationLevel::Zero);
+  unoptimized_options.compiler.SetOptimizerPasses({}, &errors);
+
+  shaderc_compilation_result_t result = CompileToSpecifiedOutputType(
+      compiler, source_text, source_text_size, shader_kind, input_file_name,
+      entry_point_name, &unoptimized_options,
+      shaderc_util::Compiler::OutputType::SpirvBinary);
+  if (!result ||
+      result->compilation_status != shaderc_compilation_status_success) {
+    return result;
+  }
+
+  // The second tier starts from the first tier's module, so the front end
+  // runs only once.
+  const uint32_t* words =
+      reinterpret_cast<const uint32_t*>(result->GetBytes());
+  std::vector<uint32_t> spirv(
+      words, words + result->output_data_size / sizeof(uint32_t));
+  const uint64_t queued_id = tiers->queue.Push(
+      priority,
+      [optimizing_options, spirv, callback, user_data](
+          uint64_t id, bool cancelled) mutable {
+        if (cancelled) {
+          callback(user_data, id, nullptr);
+          return;
+        }
+        auto* optimized =
+            new (std::nothrow) shaderc_compilation_result_vector;
+        if (optimized) {
+          std::string opt_errors;
+          if (optimizing_options.compiler.OptimizeSpirv(&spirv, &opt_errors)) {
+            optimized->output_data_size = spirv.size() * sizeof(uint32_t);
+            optimized->SetOutputData(std::move(spirv));
+            optimized->compilation_status = shaderc_compilation_status_success;
+            ReflectResult(&optimizing_options,
+                          shaderc_util::Compiler::OutputType::SpirvBinary,
+                          optimized);
+          } else {
+            shaderc_util::Compiler::ModuleOutput output;
+            output.SetInternalError("optimize", opt_errors);
+            optimized->messages = std::move(output.errors);
+            optimized->diagnostics = std::move(output.diagnostics);
+            optimized->num_errors = 1;
+            optimized->compilation_status =
+                shaderc_compilation_status_internal_error;
+          }
+        }
+        callback(user_data, id, optimized);
+      });
+  if (job_id) *job_id = queued_id;
+  return result;
+}
+
+bool shaderc_tiered_compiler_set_priority(shaderc_tiered_compiler_t tiers,
+                                          uint64_t job_id, int priority) {
+  return tiers->queue.SetPriority(job_id, priority);
+}
+
+bool shaderc_tiered_compiler_cancel(shaderc_tiered_compiler_t tiers,
+                                    uint64_t job_id) {
+  return tiers->queue.Cancel(job_id);
+}
+
+struct shaderc_compile_session {
+  shaderc_compiler_t compiler;
+  shaderc_shader_kind shader_kind;
+  std::string input_file_name;
+  std::string entry_point_name;
+  shaderc_compile_options options;
+  IncludeCache include_cache;
+  // The source of the last compile that succeeded, and its result, which is
+  // returned again for the same source until an include is invalidated.
+  std::string last_source;
+  std::unique_ptr<shaderc_compilation_result_vector> last_result;
+};
+
+shaderc_compile_session_t shaderc_compile_session_initialize(
+    const shaderc_compiler_t compiler, shaderc_shader_kind shader_kind,
+    const char* input_file_name, const char* entry_point_name,
+    const shaderc_compile_options_t additional_options) {
+  if (!input_file_name || !entry_point_name) return nullptr;
+  auto* session = new (std::nothrow) shaderc_compile_session;
+  if (!session) return nullptr;
+  session->compiler = compiler;
+  session->shader_kind = shader_kind;
+  session->input_file_name = input_file_name;
+  session->entry_point_name = entry_point_name;
+  if (additional_options) session->options = *additional_options;
+  return session;
+}
+
+shaderc_compilation_result_t shaderc_compile_session_recompile(
+    shaderc_compile_session_t session, const char* source_text,
+    size_t source_text_size) {
+  const std::string source(source_text, source_text_size);
+  if (session->last_result && source == session->last_source) {
+    return new (std::nothrow)
+        shaderc_compilation_result_vector(*session->last_result);
+  }
+  session->last_result.reset();
+  shaderc_compilation_result_t result = CompileToSpecifiedOutputType(
+      session->compiler, source_text, source_text_size, session->shader_kind,
+      session->input_file_name.c_str(), session->entry_point_name.c_str(),
+      &session->options, shaderc_util::Compiler::OutputType::SpirvBinary,
+      &session->include_cache);
+  if (result &&
+      result->compilation_status == shaderc_compilation_status_success) {
+    // Results of CompileToSpecifiedOutputType are always vectors.
+    const auto& compiled =
+        *static_cast<shaderc_compilation_result_vector*>(result);
+    session->last_result.reset(
+        new (std::nothrow) shaderc_compilation_result_vector(compiled));
+    session->last_source = source;
+  }
+  return result;
+}
+
+void shaderc_compile_session_invalidate_include(
+    shaderc_compile_session_t session, const char* source_name) {
+  session->last_result.reset();
+  if (!source_name) {
+    session->include_cache.clear();
+    return;
+  }
+  for (auto entry = session->include_cache.begin();
+       entry != session->include_cache.end();) {
+    if (entry->second.first == source_name) {
+      entry = session->include_cache.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+}
+
+void shaderc_compile_session_release(shaderc_compile_session_t session) {
+  delete session;
+}
+
 void shaderc_get_spv_version(unsigned int* version, unsigned int* revision) {
   *version = spv::Version;
   *revision = spv::Revision;
@@ -15,6 +15,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <future>
 #include <memory>
 #include <thread>
 #include <unordered_map>
@@ -532,6 +533,215 @@ TEST_F(CppInterface, CompileAndOptimizeWithLevelSize) {
   EXPECT_THAT(disassembly_text, Not(HasSubstr("OpSource")));
 }
 
+TEST_F(CppInterface, CompileWithCustomOptimizerPasses) {
+  ASSERT_TRUE(options_.SetOptimizerPasses({"--strip-debug"}));
+  const std::string disassembly_text =
+      AssemblyOutput(kMinimalShader, shaderc_glsl_vertex_shader, options_);
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpName")));
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpSource")));
+}
+
+TEST_F(CppInterface, CompileWithCustomOptimizerPassList) {
+  ASSERT_TRUE(options_.SetOptimizerPassList("--strip-debug # names too\n"));
+  const std::string disassembly_text =
+      AssemblyOutput(kMinimalShader, shaderc_glsl_vertex_shader, options_);
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpName")));
+}
+
+TEST_F(CppInterface, UnknownOptimizerPassIsRejected) {
+  std::string error;
+  EXPECT_FALSE(options_.SetOptimizerPasses({"--no-such-pass"}, &error));
+  EXPECT_THAT(error, HasSubstr("'--no-such-pass'"));
+  EXPECT_FALSE(options_.SetOptimizerPassList("strip-debug", &error));
+  EXPECT_THAT(error, HasSubstr("invalid optimizer flag 'strip-debug'"));
+}
+
+TEST_F(CppInterface, OptimizeSpvStripsDebugInfo) {
+  const SpvCompilationResult unoptimized =
+      compiler_.CompileGlslToSpv(kMinimalShader, shaderc_glsl_vertex_shader,
+                                 "shader", options_);
+  ASSERT_TRUE(IsValidSpv(unoptimized));
+  options_.SetOptimizationLevel(shaderc_optimization_level_size);
+  const SpvCompilationResult optimized = compiler_.OptimizeSpv(
+      std::vector<uint32_t>(unoptimized.cbegin(), unoptimized.cend()),
+      options_);
+  ASSERT_TRUE(IsValidSpv(optimized));
+  EXPECT_EQ(CompilerOutputAsString(compiler_.CompileGlslToSpv(
+                kMinimalShader, shaderc_glsl_vertex_shader, "shader",
+                options_)),
+            CompilerOutputAsString(optimized));
+}
+
+TEST_F(CppInterface, LinkSpvCombinesCompileOnlyModules) {
+  options_.SetCompileOnly(true);
+  const SpvCompilationResult library = compiler_.CompileGlslToSpv(
+      "#version 450\nfloat twice(float x) { return 2.0 * x; }\n",
+      shaderc_glsl_compute_shader, "library", options_);
+  const SpvCompilationResult kernel = compiler_.CompileGlslToSpv(
+      "#version 450\n"
+      "layout(local_size_x = 1) in;\n"
+      "layout(std430, binding = 0) buffer B { float v; };\n"
+      "float twice(float x);\n"
+      "void main() { v = twice(v); }\n",
+      shaderc_glsl_compute_shader, "kernel", options_);
+  ASSERT_TRUE(IsValidSpv(library));
+  ASSERT_TRUE(IsValidSpv(kernel));
+
+  const SpvCompilationResult linked = compiler_.LinkSpv(
+      {std::vector<uint32_t>(kernel.cbegin(), kernel.cend()),
+       std::vector<uint32_t>(library.cbegin(), library.cend())},
+      options_);
+  EXPECT_TRUE(IsValidSpv(linked)) << linked.GetErrorMessage();
+
+  // The kernel alone leaves twice() unresolved.
+  const SpvCompilationResult unresolved = compiler_.LinkSpv(
+      {std::vector<uint32_t>(kernel.cbegin(), kernel.cend())}, options_);
+  EXPECT_EQ(shaderc_compilation_status_transformation_error,
+            unresolved.GetCompilationStatus());
+}
+
+TEST_F(CppInterface, SpecializeSpvFreezesGivenValues) {
+  const SpvCompilationResult module = compiler_.CompileGlslToSpv(
+      "#version 450\n"
+      "layout(constant_id = 7) const int kSize = 4;\n"
+      "layout(location = 0) out vec4 color;\n"
+      "void main() { color = vec4(float(kSize)); }\n",
+      shaderc_glsl_fragment_shader, "shader", options_);
+  ASSERT_TRUE(IsValidSpv(module));
+  const std::vector<uint32_t> words(module.cbegin(), module.cend());
+
+  const std::vector<SpvCompilationResult> results =
+      compiler_.SpecializeSpv(words, {{{7, "16"}}}, options_);
+  ASSERT_EQ(1u, results.size());
+  EXPECT_TRUE(IsValidSpv(results[0])) << results[0].GetErrorMessage();
+
+  const std::vector<SpvCompilationResult> unknown =
+      compiler_.SpecializeSpv(words, {{{8, "16"}}}, options_);
+  ASSERT_EQ(1u, unknown.size());
+  EXPECT_EQ(shaderc_compilation_status_transformation_error,
+            unknown[0].GetCompilationStatus());
+}
+
+TEST_F(CppInterface, CompileGlslPipelineToSpvProducesOneModulePerStage) {
+  const std::string vertex =
+      "#version 450\n"
+      "layout(location = 5) out vec4 color;\n"
+      "void main() { color = vec4(1.0); }\n";
+  const std::string fragment =
+      "#version 450\n"
+      "layout(location = 5) in vec4 color;\n"
+      "layout(location = 0) out vec4 frag;\n"
+      "void main() { frag = color; }\n";
+  const std::vector<SpvCompilationResult> results =
+      compiler_.CompileGlslPipelineToSpv(
+          {{vertex.data(), vertex.size(), shaderc_glsl_vertex_shader,
+            "shader.vert", "main"},
+           {fragment.data(), fragment.size(), shaderc_glsl_fragment_shader,
+            "shader.frag", "main"}},
+          options_);
+  ASSERT_EQ(2u, results.size());
+  EXPECT_TRUE(IsValidSpv(results[0]));
+  EXPECT_TRUE(IsValidSpv(results[1]));
+}
+
+TEST_F(CppInterface, GetReflectionDescribesModule) {
+  const std::string vertex =
+      "#version 450\n"
+      "layout(location = 2) in vec4 position;\n"
+      "layout(location = 1) out vec2 uv;\n"
+      "void main() { gl_Position = position; uv = position.xy; }\n";
+  options_.SetGenerateReflection(true);
+  const SpvCompilationResult result = compiler_.CompileGlslToSpv(
+      vertex, shaderc_glsl_vertex_shader, "shader.vert", options_);
+  ASSERT_TRUE(IsValidSpv(result));
+  const std::string reflection = result.GetReflection();
+  EXPECT_THAT(reflection,
+              HasSubstr("\"name\": \"main\", \"stage\": \"vertex\""));
+  EXPECT_THAT(reflection, HasSubstr("{\"name\": \"position\", "
+                                    "\"location\": 2, \"component\": 0}"));
+  EXPECT_THAT(reflection, HasSubstr("{\"name\": \"uv\", \"location\": 1, "
+                                    "\"component\": 0}"));
+}
+
+TEST_F(CppInterface, GetCostReportCountsEntryPoint) {
+  const std::string compute =
+      "#version 450\n"
+      "layout(binding = 0) buffer Data { float v[]; } data;\n"
+      "void main() {\n"
+      "  for (int i = 0; i < 4; ++i) data.v[i] = sqrt(data.v[i]);\n"
+      "}\n";
+  options_.SetGenerateCostReport(true);
+  const SpvCompilationResult result = compiler_.CompileGlslToSpv(
+      compute, shaderc_glsl_compute_shader, "shader.comp", options_);
+  ASSERT_TRUE(IsValidSpv(result));
+  const std::string report = result.GetCostReport();
+  EXPECT_THAT(report, HasSubstr("\"name\": \"main\", \"stage\": "
+                                "\"compute\""));
+  EXPECT_THAT(report, HasSubstr("\"transcendental\": 1"));
+  EXPECT_THAT(report, HasSubstr("\"loops\": 1"));
+  EXPECT_EQ("", result.GetReflection());
+}
+
+TEST_F(CppInterface, AddBakedUniformFoldsValue) {
+  const std::string fragment =
+      "#version 450\n"
+      "layout(binding = 0) uniform Params { vec2 scale; };\n"
+      "layout(location = 0) out vec4 frag;\n"
+      "void main() { frag = vec4(scale, 0.0, 1.0); }\n";
+  options_.AddBakedUniform("Params", "scale", "2, 3");
+  const SpvCompilationResult result = compiler_.CompileGlslToSpv(
+      fragment, shaderc_glsl_fragment_shader, "shader.frag", options_);
+  ASSERT_TRUE(IsValidSpv(result));
+  const std::vector<shaderc_descriptor_binding> removed =
+      result.GetRemovedBindings();
+  ASSERT_EQ(1u, removed.size());
+  EXPECT_EQ(0u, removed[0].binding);
+  EXPECT_EQ(shaderc_descriptor_type_uniform_buffer, removed[0].descriptor_type);
+}
+
+TEST_F(CppInterface, SetWorkgroupSizeChangesComputeShader) {
+  const std::string compute =
+      "#version 450\n"
+      "layout(local_size_x = 8) in;\n"
+      "void main() {}\n";
+  options_.SetWorkgroupSize(128, 0, 0);
+  options_.SetWorkgroupSizeSpecIds(0, 1, 2);
+  const AssemblyCompilationResult result = compiler_.CompileGlslToSpvAssembly(
+      compute, shaderc_glsl_compute_shader, "shader.comp", options_);
+  ASSERT_TRUE(CompilationResultIsSuccess(result));
+  EXPECT_THAT(CompilerOutputAsString(result), HasSubstr("LocalSize 128 1 1"));
+  EXPECT_THAT(CompilerOutputAsString(result), HasSubstr("SpecId 0"));
+}
+
+TEST_F(CppInterface, CompileGlslPipelineToSpvReportsDescriptorBindings) {
+  const std::string vertex =
+      "#version 450\n"
+      "layout(set = 1, binding = 3) buffer B { vec4 v[]; } b;\n"
+      "void main() { gl_Position = b.v[gl_VertexIndex]; }\n";
+  const std::string fragment =
+      "#version 450\n"
+      "layout(location = 0) out vec4 frag;\n"
+      "void main() { frag = vec4(1.0); }\n";
+  options_.SetCompactPipelineBindings(true);
+  const std::vector<SpvCompilationResult> results =
+      compiler_.CompileGlslPipelineToSpv(
+          {{vertex.data(), vertex.size(), shaderc_glsl_vertex_shader,
+            "shader.vert", "main"},
+           {fragment.data(), fragment.size(), shaderc_glsl_fragment_shader,
+            "shader.frag", "main"}},
+          options_);
+  ASSERT_EQ(2u, results.size());
+  ASSERT_TRUE(IsValidSpv(results[0]));
+  const std::vector<shaderc_descriptor_binding> bindings =
+      results[1].GetDescriptorBindings();
+  ASSERT_EQ(1u, bindings.size());
+  EXPECT_EQ(0u, bindings[0].set);
+  EXPECT_EQ(0u, bindings[0].binding);
+  EXPECT_EQ(shaderc_descriptor_type_storage_buffer,
+            bindings[0].descriptor_type);
+  EXPECT_EQ(1u, bindings[0].stage_flags);
+}
+
 TEST_F(CppInterface, CompileAndOptimizeForVulkan10Failure) {
   options_.SetSourceLanguage(shaderc_source_language_hlsl);
   options_.SetTargetEnvironment(shaderc_target_env_vulkan,
@@ -1514,4 +1724,101 @@ TEST_F(CppInterface, NanClampSurvivesCloning) {
   EXPECT_THAT(disassembly_text, HasSubstr("OpExtInst %v4float %1 NClamp"));
 }
 
+TEST_F(CppInterface, CancellationTokenStopsCompilation) {
+  shaderc::CancellationToken token;
+  ASSERT_TRUE(token.IsValid());
+  options_.SetCancellationToken(token);
+  options_.SetTimeLimit(60000);
+  EXPECT_TRUE(IsValidSpv(compiler_.CompileGlslToSpv(
+      kMinimalShader, shaderc_glsl_vertex_shader, "shader", options_)));
+  token.Cancel();
+  EXPECT_EQ(shaderc_compilation_status_cancelled,
+            compiler_
+                .CompileGlslToSpv(kMinimalShader, shaderc_glsl_vertex_shader,
+                                  "shader", options_)
+                .GetCompilationStatus());
+  options_.ClearCancellationToken();
+  EXPECT_TRUE(IsValidSpv(compiler_.CompileGlslToSpv(
+      kMinimalShader, shaderc_glsl_vertex_shader, "shader", options_)));
+}
+
+TEST_F(CppInterface, GetDiagnostics) {
+  const SpvCompilationResult result = compiler_.CompileGlslToSpv(
+      "#version 140\nint main() {}\n", shaderc_glsl_vertex_shader,
+      "shader.vert", options_);
+  const std::vector<shaderc_diagnostic> diagnostics = result.GetDiagnostics();
+  ASSERT_EQ(2u, diagnostics.size());
+  EXPECT_EQ(shaderc_diagnostic_severity_error, diagnostics[0].severity);
+  EXPECT_EQ("shader.vert", std::string(diagnostics[0].file,
+                                       diagnostics[0].file_length));
+  EXPECT_EQ(2u, diagnostics[1].line);
+  EXPECT_TRUE(SpvCompilationResult().GetDiagnostics().empty());
+}
+
+TEST_F(CppInterface, CompileGuardFailsLargeModule) {
+  options_.SetCompileGuard(shaderc_compile_guard_spirv_words, 20);
+  const SpvCompilationResult result = compiler_.CompileGlslToSpv(
+      kMinimalShader, shaderc_glsl_vertex_shader, "shader", options_);
+  EXPECT_EQ(shaderc_compilation_status_compilation_error,
+            result.GetCompilationStatus());
+  EXPECT_THAT(result.GetErrorMessage(), HasSubstr("past the limit of 20"));
+  options_.SetCompileGuard(shaderc_compile_guard_spirv_words, 0);
+  EXPECT_TRUE(IsValidSpv(compiler_.CompileGlslToSpv(
+      kMinimalShader, shaderc_glsl_vertex_shader, "shader", options_)));
+}
+
+TEST_F(CppInterface, CompileSessionRecompilesEdits) {
+  shaderc::CompileSession session(compiler_, shaderc_glsl_fragment_shader,
+                                  "shader", "main", options_);
+  ASSERT_TRUE(session.IsValid());
+  EXPECT_EQ(CompilerOutputAsString(compiler_.CompileGlslToSpv(
+                kGlslMultipleFnShader, shaderc_glsl_fragment_shader, "shader",
+                options_)),
+            CompilerOutputAsString(session.Recompile(kGlslMultipleFnShader)));
+  EXPECT_FALSE(CompilationResultIsSuccess(session.Recompile(kTwoErrorsShader)));
+  session.InvalidateIncludes();
+  EXPECT_TRUE(IsValidSpv(session.Recompile(kMinimalShader)));
+}
+
+#ifndef SHADERC_DISABLE_THREADED_TESTS
+TEST_F(CppInterface, TieredCompileDeliversOptimizedModule) {
+  shaderc::TieredCompiler tiers(1);
+  ASSERT_TRUE(tiers.IsValid());
+  options_.SetOptimizationLevel(shaderc_optimization_level_performance);
+  std::promise<SpvCompilationResult> optimized_promise;
+  uint64_t job_id = 0;
+  const SpvCompilationResult quick = tiers.CompileGlslToSpv(
+      compiler_, kGlslMultipleFnShader, shaderc_glsl_fragment_shader,
+      "shader", "main", options_, 0,
+      [&optimized_promise](uint64_t, SpvCompilationResult result) {
+        optimized_promise.set_value(std::move(result));
+      },
+      &job_id);
+  ASSERT_TRUE(IsValidSpv(quick));
+  EXPECT_NE(0u, job_id);
+  const SpvCompilationResult optimized = optimized_promise.get_future().get();
+  ASSERT_TRUE(IsValidSpv(optimized));
+  EXPECT_EQ(CompilerOutputAsString(compiler_.CompileGlslToSpv(
+                kGlslMultipleFnShader, shaderc_glsl_fragment_shader, "shader",
+                options_)),
+            CompilerOutputAsString(optimized));
+}
+
+TEST_F(CppInterface, CompileWithRecipesReturnsOneResultPerRecipe) {
+  const std::vector<AssemblyCompilationResult> results =
+      compiler_.CompileGlslToSpvAssemblyWithRecipes(
+          kGlslMultipleFnShader, shaderc_glsl_fragment_shader, "shader",
+          "main",
+          {{shaderc_optimization_level_zero, false},
+           {shaderc_optimization_level_performance, false}},
+          options_);
+  ASSERT_EQ(2u, results.size());
+  ASSERT_TRUE(CompilationResultIsSuccess(results[0]));
+  ASSERT_TRUE(CompilationResultIsSuccess(results[1]));
+  EXPECT_THAT(CompilerOutputAsString(results[0]), HasSubstr("OpFunctionCall"));
+  EXPECT_THAT(CompilerOutputAsString(results[1]),
+              Not(HasSubstr("OpFunctionCall")));
+}
+#endif  // SHADERC_DISABLE_THREADED_TESTS
+
 }  // anonymous namespace
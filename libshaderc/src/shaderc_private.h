@@ -36,6 +36,8 @@ struct shaderc_compilation_result {
   size_t output_data_size = 0;
   // Compilation messages.
   std::string messages;
+  // The warnings and errors in messages, as they were reported.
+  std::vector<shaderc_util::Diagnostic> diagnostics;
   // Number of errors.
   size_t num_errors = 0;
   // Number of warnings.
@@ -43,6 +45,29 @@ struct shaderc_compilation_result {
   // Compilation status.
   shaderc_compilation_status compilation_status =
       shaderc_compilation_status_null_result_object;
+  // The descriptor set layout of a compiled pipeline.
+  std::vector<shaderc_descriptor_binding> descriptor_bindings;
+  // Reflection data as a JSON object, if requested.
+  std::string reflection;
+  // The static cost report as a JSON object, if requested.
+  std::string cost_report;
+  // The size attribution as a JSON object, if requested.
+  std::string size_attribution;
+  // The include report as a JSON object, if requested.
+  std::string include_report;
+  // The descriptor bindings that baked uniforms left unused.
+  std::vector<shaderc_descriptor_binding> removed_bindings;
+  // The size of the module after each optimization stage, if measured.
+  std::vector<shaderc_optimization_stage> optimization_stages;
+
+  // Appends a message of shaderc's own, as "shaderc: error: <message>" or
+  // "shaderc: warning: <message>", to messages and to diagnostics.
+  void AddMessage(bool is_error, const std::string& message) {
+    messages += std::string("shaderc: ") + (is_error ? "error" : "warning") +
+                ": " + message + "\n";
+    shaderc_util::AddDiagnostic(&diagnostics, is_error, "shaderc", 0,
+                                message);
+  }
 };
 
 // Compilation result class using a vector for holding the compilation
@@ -17,6 +17,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <future>
 #include <memory>
 #include <thread>
 #include <unordered_map>
@@ -685,6 +687,154 @@ TEST_F(CompileStringWithOptionsTest, CompileAndOptimizeWithLevelSize) {
   EXPECT_THAT(disassembly_text, Not(HasSubstr("OpSource")));
 }
 
+TEST_F(CompileStringWithOptionsTest, CompileAndOptimizeWithLevelFastCompile) {
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_fast_compile);
+  const std::string disassembly_text =
+      CompilationOutput(kMinimalShader, shaderc_glsl_vertex_shader,
+                        options_.get(), OutputType::SpirvAssemblyText);
+  for (const auto& substring : kMinimalShaderDisassemblySubstrings) {
+    EXPECT_THAT(disassembly_text, HasSubstr(substring));
+  }
+  // Check that we do not have debug instructions.
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpName")));
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpSource")));
+}
+
+TEST_F(CompileStringWithOptionsTest, MobileProfileConvertsRelaxedToHalf) {
+  const std::string shader =
+      R"(#version 450
+         layout(location=0) in  mediump vec4 inColor;
+         layout(location=0) out mediump vec4 outColor;
+         void main() { outColor = inColor * inColor + inColor; })";
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  EXPECT_THAT(CompilationOutput(shader, shaderc_glsl_fragment_shader,
+                                options_.get(), OutputType::SpirvAssemblyText),
+              Not(HasSubstr("OpCapability Float16")));
+
+  shaderc_compile_options_set_optimization_profile(
+      options_.get(), shaderc_optimization_profile_mobile);
+  EXPECT_THAT(CompilationOutput(shader, shaderc_glsl_fragment_shader,
+                                options_.get(), OutputType::SpirvAssemblyText),
+              HasSubstr("OpCapability Float16"));
+}
+
+TEST_F(CompileStringWithOptionsTest, MinSizeReportsEachStage) {
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_min_size);
+  const Compilation comp(compiler_.get_compiler_handle(),
+                         kGlslMultipleFnShader, shaderc_glsl_fragment_shader,
+                         "shader", "main", options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+  const size_t num_stages =
+      shaderc_result_get_num_optimization_stages(comp.result());
+  ASSERT_LE(2u, num_stages);
+  const shaderc_optimization_stage* stages =
+      shaderc_result_get_optimization_stages(comp.result());
+  EXPECT_EQ(std::string("input"), stages[0].name);
+  EXPECT_EQ(std::string("recompaction"), stages[num_stages - 1].name);
+  EXPECT_EQ(shaderc_result_get_length(comp.result()),
+            stages[num_stages - 1].size_in_bytes);
+  EXPECT_GT(stages[0].size_in_bytes, stages[num_stages - 1].size_in_bytes);
+
+  // It is never larger than the size level.
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_size);
+  const Compilation size_comp(compiler_.get_compiler_handle(),
+                              kGlslMultipleFnShader,
+                              shaderc_glsl_fragment_shader, "shader", "main",
+                              options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(size_comp.result()));
+  EXPECT_GE(shaderc_result_get_length(size_comp.result()),
+            shaderc_result_get_length(comp.result()));
+  EXPECT_EQ(0u, shaderc_result_get_num_optimization_stages(size_comp.result()));
+}
+
+TEST_F(CompileStringWithOptionsTest, FastCompileRemovesDeadCodeButNotCalls) {
+  const std::string shader =
+      R"(#version 450
+         layout(location=0) flat in  int inVal;
+         layout(location=0)      out int outVal;
+         int foo(int a) { return a; }
+         void main() {
+           int unused = inVal * 7;
+           if (false) { outVal = 3; }
+           outVal = foo(inVal);
+         })";
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_fast_compile);
+  const std::string disassembly_text =
+      CompilationOutput(shader, shaderc_glsl_fragment_shader, options_.get(),
+                        OutputType::SpirvAssemblyText);
+  // Dead code and the constant branch are gone...
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpIMul")));
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpSelectionMerge")));
+  // ...but the inliner is one of the expensive passes this level skips.
+  EXPECT_THAT(disassembly_text, HasSubstr("OpFunctionCall"));
+}
+
+TEST_F(CompileStringWithOptionsTest, CompileWithCustomOptimizerPasses) {
+  const char* flags[] = {"--strip-debug"};
+  ASSERT_TRUE(shaderc_compile_options_set_optimizer_passes(options_.get(),
+                                                           flags, 1));
+  const std::string disassembly_text =
+      CompilationOutput(kMinimalShader, shaderc_glsl_vertex_shader,
+                        options_.get(), OutputType::SpirvAssemblyText);
+  for (const auto& substring : kMinimalShaderDisassemblySubstrings) {
+    EXPECT_THAT(disassembly_text, HasSubstr(substring));
+  }
+  // The custom pass runs even at optimization level zero.
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpName")));
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpSource")));
+}
+
+TEST_F(CompileStringWithOptionsTest, CustomOptimizerPassesRunAfterLevel) {
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  const std::string pass_list =
+      "# Extra cleanup after the performance recipe.\n"
+      "--eliminate-dead-code-aggressive  --compact-ids\n";
+  ASSERT_TRUE(shaderc_compile_options_set_optimizer_pass_list(
+      options_.get(), pass_list.data(), pass_list.size()));
+  const std::string disassembly_text =
+      CompilationOutput(kGlslMultipleFnShader, shaderc_glsl_fragment_shader,
+                        options_.get(), OutputType::SpirvAssemblyText);
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpFunctionCall")));
+}
+
+TEST_F(CompileStringWithOptionsTest, UnknownOptimizerPassIsRejected) {
+  const char* good_flags[] = {"--strip-debug"};
+  ASSERT_TRUE(shaderc_compile_options_set_optimizer_passes(options_.get(),
+                                                           good_flags, 1));
+  const char* bad_flags[] = {"--eliminate-dead-code-aggressive",
+                             "--no-such-pass"};
+  EXPECT_FALSE(shaderc_compile_options_set_optimizer_passes(options_.get(),
+                                                            bad_flags, 2));
+  EXPECT_THAT(
+      shaderc_compile_options_get_optimizer_passes_error(options_.get()),
+      HasSubstr("unknown optimizer flag '--no-such-pass'"));
+  // The previously set passes are kept.
+  const std::string disassembly_text =
+      CompilationOutput(kMinimalShader, shaderc_glsl_vertex_shader,
+                        options_.get(), OutputType::SpirvAssemblyText);
+  EXPECT_THAT(disassembly_text, Not(HasSubstr("OpName")));
+}
+
+TEST_F(CompileStringWithOptionsTest, EmptyOptimizerPassListClearsPasses) {
+  const char* flags[] = {"--strip-debug"};
+  ASSERT_TRUE(shaderc_compile_options_set_optimizer_passes(options_.get(),
+                                                           flags, 1));
+  ASSERT_TRUE(
+      shaderc_compile_options_set_optimizer_passes(options_.get(), nullptr, 0));
+  EXPECT_EQ(std::string(),
+            shaderc_compile_options_get_optimizer_passes_error(options_.get()));
+  const std::string disassembly_text =
+      CompilationOutput(kMinimalShader, shaderc_glsl_vertex_shader,
+                        options_.get(), OutputType::SpirvAssemblyText);
+  EXPECT_THAT(disassembly_text, HasSubstr("OpName"));
+}
+
 TEST_F(CompileStringWithOptionsTest, CompileAndOptimizeForVulkan10Failure) {
   shaderc_compile_options_set_source_language(options_.get(),
                                               shaderc_source_language_hlsl);
@@ -918,6 +1068,9 @@ class TestIncluder {
   // Response data is owned as private property, no need to release explicitly.
   void ReleaseInclude(shaderc_include_result*) {}
 
+  // Returns how many files were requested so far.
+  size_t num_requests() const { return responses_.size(); }
+
   // Wrapper for the corresponding member function.
   static shaderc_include_result* GetIncluderResponseWrapper(
       void* user_data, const char* filename, int, const char* includer,
@@ -1931,4 +2084,1159 @@ TEST_F(CompileStringWithOptionsTest, NanClampSurvivesCloning) {
   EXPECT_THAT(disassembly_text, HasSubstr("OpExtInst %v4float %1 NClamp"));
 }
 
+TEST_F(CompileStringWithOptionsTest, OptimizeSpvMatchesOptimizedCompile) {
+  const std::string unoptimized_bytes = CompilationOutput(
+      kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  const std::string optimized_bytes = CompilationOutput(
+      kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+
+  std::vector<uint32_t> words(unoptimized_bytes.size() / sizeof(uint32_t));
+  std::memcpy(words.data(), unoptimized_bytes.data(),
+              unoptimized_bytes.size());
+  shaderc_compilation_result_t result =
+      shaderc_optimize_spv(compiler_.get_compiler_handle(), words.data(),
+                           words.size(), options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(result))
+      << shaderc_result_get_error_message(result);
+  EXPECT_EQ(optimized_bytes, std::string(shaderc_result_get_bytes(result),
+                                         shaderc_result_get_length(result)));
+  shaderc_result_release(result);
+}
+
+TEST_F(CompileStringWithOptionsTest, OptimizeSpvRejectsInvalidModule) {
+  // The levels that skip the optimizer's own validation, or the optimizer,
+  // validate the module all the same.
+  const uint32_t not_spirv[] = {1, 2, 3, 4, 5};
+  for (const auto level : {shaderc_optimization_level_performance,
+                           shaderc_optimization_level_fast_compile,
+                           shaderc_optimization_level_zero}) {
+    shaderc_compile_options_set_optimization_level(options_.get(), level);
+    shaderc_compilation_result_t result = shaderc_optimize_spv(
+        compiler_.get_compiler_handle(), not_spirv, 5, options_.get());
+    EXPECT_EQ(shaderc_compilation_status_transformation_error,
+              shaderc_result_get_compilation_status(result));
+    EXPECT_EQ(1u, shaderc_result_get_num_errors(result));
+    EXPECT_EQ(0u, shaderc_result_get_length(result));
+    shaderc_result_release(result);
+  }
+}
+
+const char kReflectedComputeShader[] =
+    "#version 450\n"
+    "layout(local_size_x = 16, local_size_y = 2) in;\n"
+    "layout(constant_id = 4) const uint kScale = 3;\n"
+    "layout(push_constant) uniform Push { vec4 bias; } push;\n"
+    "layout(set = 1, binding = 6) buffer Out { vec4 v[]; } result;\n"
+    "void main() {\n"
+    "  result.v[gl_LocalInvocationIndex] = push.bias * float(kScale);\n"
+    "}\n";
+
+TEST_F(CompileStringWithOptionsTest, GenerateReflectionDescribesModule) {
+  shaderc_compile_options_set_generate_reflection(options_.get(), true);
+  for (const auto output_type :
+       {OutputType::SpirvBinary, OutputType::SpirvAssemblyText}) {
+    const Compilation comp(compiler_.get_compiler_handle(),
+                           kReflectedComputeShader, shaderc_glsl_compute_shader,
+                           "shader.comp", "main", options_.get(), output_type);
+    ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+    const std::string reflection = shaderc_result_get_reflection(comp.result());
+    EXPECT_THAT(reflection, HasSubstr("\"stage\": \"compute\", "
+                                      "\"workgroup_size\": [16, 2, 1]"));
+    EXPECT_THAT(reflection, HasSubstr("\"name\": \"result\", \"set\": 1, "
+                                      "\"binding\": 6, "
+                                      "\"type\": \"storage_buffer\""));
+    EXPECT_THAT(reflection,
+                HasSubstr("{\"name\": \"push\", \"size\": 16}"));
+    EXPECT_THAT(reflection, HasSubstr("{\"name\": \"kScale\", \"id\": 4, "
+                                      "\"type\": \"uint32\", "
+                                      "\"default\": 3}"));
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, ReportsAreEmptyUnlessRequested) {
+  const Compilation comp(compiler_.get_compiler_handle(),
+                         kReflectedComputeShader, shaderc_glsl_compute_shader,
+                         "shader.comp", "main", options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+  EXPECT_EQ(std::string(), shaderc_result_get_reflection(comp.result()));
+  EXPECT_EQ(std::string(), shaderc_result_get_cost_report(comp.result()));
+  EXPECT_EQ(std::string(), shaderc_result_get_size_attribution(comp.result()));
+  EXPECT_EQ(std::string(), shaderc_result_get_include_report(comp.result()));
+}
+
+TEST_F(CompileStringWithOptionsTest, GenerateCostReportCountsWork) {
+  const char kShader[] =
+      "#version 450\n"
+      "layout(binding = 0) uniform sampler2D tex;\n"
+      "layout(location = 0) in vec2 uv;\n"
+      "layout(location = 0) out vec4 color;\n"
+      "void main() { color = sin(texture(tex, uv)); }\n";
+  shaderc_compile_options_set_generate_cost_report(options_.get(), true);
+  for (const auto output_type :
+       {OutputType::SpirvBinary, OutputType::SpirvAssemblyText}) {
+    const Compilation comp(compiler_.get_compiler_handle(), kShader,
+                           shaderc_glsl_fragment_shader, "shader.frag",
+                           "main", options_.get(), output_type);
+    ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+    const std::string report = shaderc_result_get_cost_report(comp.result());
+    // The loads of the texture and the input, and the store to the output.
+    EXPECT_THAT(report, HasSubstr("{\"name\": \"main\", "
+                                  "\"stage\": \"fragment\", \"alu\": 0, "
+                                  "\"transcendental\": 1, \"texture\": 1, "
+                                  "\"memory\": 3, \"branches\": 0, "
+                                  "\"loops\": 0"));
+    EXPECT_EQ(std::string(), shaderc_result_get_reflection(comp.result()));
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, SizeAttributionCountsIncludes) {
+  const FakeFS fs = {
+      {"noise.glsl",
+       "float noise(float x) { return fract(sin(x) * 43758.5453); }\n"}};
+  TestIncluder includer(fs);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), TestIncluder::GetIncluderResponseWrapper,
+      TestIncluder::ReleaseIncluderResponseWrapper, &includer);
+  shaderc_compile_options_set_generate_size_attribution(options_.get(), true);
+  const std::string shader =
+      "#version 450\n"
+      "#extension GL_GOOGLE_include_directive : enable\n"
+      "#include \"noise.glsl\"\n"
+      "layout(location = 0) out vec4 color;\n"
+      "void main() { color = vec4(noise(gl_FragCoord.x)); }\n";
+  const Compilation comp(compiler_.get_compiler_handle(), shader,
+                         shaderc_glsl_fragment_shader, "shader.frag", "main",
+                         options_.get(), OutputType::SpirvAssemblyText);
+  ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+  const std::string attribution =
+      shaderc_result_get_size_attribution(comp.result());
+  EXPECT_THAT(attribution, HasSubstr("{\"name\": \"main\", \"words\": "));
+  EXPECT_THAT(attribution,
+              HasSubstr("{\"name\": \"noise(f1;\", \"words\": "));
+  EXPECT_THAT(attribution,
+              HasSubstr("{\"name\": \"shader.frag\", \"words\": "));
+  EXPECT_THAT(attribution,
+              HasSubstr("{\"name\": \"noise.glsl\", \"words\": "));
+  // The compile with debug info reuses the included file.
+  EXPECT_EQ(1u, includer.num_requests());
+  // The debug info generated for the attribution is not in the output.
+  const std::string assembly = shaderc_result_get_bytes(comp.result());
+  EXPECT_THAT(assembly, Not(HasSubstr("OpLine")));
+  EXPECT_THAT(assembly, Not(HasSubstr("OpString")));
+}
+
+TEST_F(CompileStringWithOptionsTest, SizeAttributionDoesNotChangeOutput) {
+  for (const auto level : {shaderc_optimization_level_zero,
+                           shaderc_optimization_level_performance}) {
+    shaderc_compile_options_set_optimization_level(options_.get(), level);
+    shaderc_compile_options_set_generate_size_attribution(options_.get(),
+                                                          false);
+    const std::string plain = CompilationOutput(
+        kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+    shaderc_compile_options_set_generate_size_attribution(options_.get(),
+                                                          true);
+    const std::string attributed = CompilationOutput(
+        kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+    EXPECT_EQ(plain, attributed) << "optimization level " << level;
+  }
+}
+
+// Returns the line of an include report that describes the named file, or an
+// empty string if there is none.
+std::string IncludeReportLine(const std::string& report,
+                              const std::string& file) {
+  const size_t start = report.find("{\"name\": \"" + file + "\"");
+  if (start == std::string::npos) return "";
+  return report.substr(start, report.find('}', start) + 1 - start);
+}
+
+TEST_F(CompileStringWithOptionsTest, IncludeReportFindsUnusedIncludes) {
+  const FakeFS fs = {
+      {"noise.glsl",
+       "float noise(float x) { return fract(sin(x) * 43758.5453); }\n"},
+      {"unused.glsl", "#define UNUSED_SCALE 2.0\n"}};
+  TestIncluder includer(fs);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), TestIncluder::GetIncluderResponseWrapper,
+      TestIncluder::ReleaseIncluderResponseWrapper, &includer);
+  shaderc_compile_options_set_generate_include_report(options_.get(), true);
+  const std::string shader =
+      "#version 450\n"
+      "#extension GL_GOOGLE_include_directive : enable\n"
+      "#include \"noise.glsl\"\n"
+      "#include \"unused.glsl\"\n"
+      "layout(location = 0) out vec4 color;\n"
+      "void main() { color = vec4(noise(gl_FragCoord.x)); }\n";
+  const Compilation comp(compiler_.get_compiler_handle(), shader,
+                         shaderc_glsl_fragment_shader, "shader.frag", "main",
+                         options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+  const std::string report = shaderc_result_get_include_report(comp.result());
+  const std::string noise = IncludeReportLine(report, "noise.glsl");
+  EXPECT_THAT(noise, HasSubstr("\"count\": 1, \"bytes\": 60, "));
+  EXPECT_THAT(noise, HasSubstr("\"words\": "));
+  EXPECT_THAT(noise, Not(HasSubstr("\"words\": 0}")));
+  EXPECT_THAT(noise, Not(HasSubstr("\"words\": null}")));
+  const std::string unused = IncludeReportLine(report, "unused.glsl");
+  EXPECT_THAT(unused, HasSubstr("\"count\": 1, \"bytes\": 25, "));
+  EXPECT_THAT(unused, HasSubstr("\"words\": 0}"));
+  // The report needs no size attribution in the result.
+  EXPECT_EQ(std::string(), shaderc_result_get_size_attribution(comp.result()));
+}
+
+TEST_F(CompileStringWithOptionsTest, IncludeReportCountsEachIncludeOnce) {
+  const FakeFS fs = {{"common.glsl", "float half_of(float x);\n"},
+                     {"noise.glsl", "float noise(float x);\n"}};
+  TestIncluder includer(fs);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), TestIncluder::GetIncluderResponseWrapper,
+      TestIncluder::ReleaseIncluderResponseWrapper, &includer);
+  shaderc_compile_options_set_generate_include_report(options_.get(), true);
+  const std::string prelude = "#include \"common.glsl\"\n";
+  shaderc_compile_options_set_prelude(options_.get(), prelude.data(),
+                                      prelude.size(), "prelude.glsl");
+  // The stage is inferred, so the source is preprocessed before the parse.
+  const std::string shader =
+      "#version 450\n"
+      "#pragma shader_stage(fragment)\n"
+      "#extension GL_GOOGLE_include_directive : enable\n"
+      "#include \"noise.glsl\"\n"
+      "void main() {}\n";
+  // The prelude is prepared by the first compile only, but its includes are
+  // in the report of every compile.
+  for (int i = 0; i < 2; ++i) {
+    const Compilation comp(compiler_.get_compiler_handle(), shader,
+                           shaderc_glsl_infer_from_source, "shader.glsl",
+                           "main", options_.get());
+    ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+    const std::string report =
+        shaderc_result_get_include_report(comp.result());
+    EXPECT_THAT(IncludeReportLine(report, "noise.glsl"),
+                HasSubstr("\"count\": 1, \"bytes\": 22, "))
+        << "compile " << i;
+    EXPECT_THAT(IncludeReportLine(report, "common.glsl"),
+                HasSubstr("\"count\": 1, \"bytes\": 24, "))
+        << "compile " << i;
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, PreludeIsPreparedOncePerContents) {
+  const FakeFS fs = {
+      {"common.glsl", "float half_of(float x) { return x * 0.5; }\n"}};
+  TestIncluder includer(fs);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), TestIncluder::GetIncluderResponseWrapper,
+      TestIncluder::ReleaseIncluderResponseWrapper, &includer);
+  const std::string shader =
+      "#version 450\n"
+      "layout(location = 0) out float o;\n"
+      "void main() { o = HALF_ONE; }\n";
+  // The includes of the prelude are requested only while preparing it.
+  auto prelude_was_read = [this, &shader, &includer]() {
+    const size_t requests = includer.num_requests();
+    const Compilation comp(compiler_.get_compiler_handle(), shader,
+                           shaderc_glsl_fragment_shader, "shader.frag",
+                           "main", options_.get());
+    EXPECT_TRUE(CompilationResultIsSuccess(comp.result()));
+    return includer.num_requests() != requests;
+  };
+
+  std::string prelude =
+      "#include \"common.glsl\"\n"
+      "#define HALF_ONE half_of(1.0)\n";
+  shaderc_compile_options_set_prelude(options_.get(), prelude.data(),
+                                      prelude.size(), "prelude.glsl");
+  EXPECT_TRUE(prelude_was_read());
+  EXPECT_FALSE(prelude_was_read());
+  // Setting the same prelude again keeps it prepared.
+  shaderc_compile_options_set_prelude(options_.get(), prelude.data(),
+                                      prelude.size(), "prelude.glsl");
+  EXPECT_FALSE(prelude_was_read());
+  prelude += "// Changed.\n";
+  shaderc_compile_options_set_prelude(options_.get(), prelude.data(),
+                                      prelude.size(), "prelude.glsl");
+  EXPECT_TRUE(prelude_was_read());
+}
+
+TEST_F(CompileStringWithOptionsTest, CancelledTokenStopsCompilation) {
+  shaderc_cancellation_token_t token = shaderc_cancellation_token_initialize();
+  ASSERT_NE(nullptr, token);
+  shaderc_compile_options_set_cancellation_token(options_.get(), token);
+  // An unused time limit changes nothing.
+  shaderc_compile_options_set_time_limit(options_.get(), 60000);
+  EXPECT_TRUE(CompilesToValidSpv(compiler_, kMinimalShader,
+                                 shaderc_glsl_vertex_shader, options_.get()));
+
+  shaderc_cancellation_token_cancel(token);
+  for (const OutputType output_type :
+       {OutputType::SpirvBinary, OutputType::PreprocessedText}) {
+    const Compilation comp(compiler_.get_compiler_handle(), kMinimalShader,
+                           shaderc_glsl_vertex_shader, "shader", "main",
+                           options_.get(), output_type);
+    EXPECT_EQ(shaderc_compilation_status_cancelled,
+              shaderc_result_get_compilation_status(comp.result()));
+    EXPECT_THAT(shaderc_result_get_error_message(comp.result()),
+                HasSubstr("shader: error: compilation cancelled"));
+    shaderc_diagnostic diagnostic;
+    ASSERT_EQ(1u,
+              shaderc_result_get_diagnostics(comp.result(), &diagnostic, 1));
+    EXPECT_EQ("compilation cancelled",
+              std::string(diagnostic.message, diagnostic.message_length));
+  }
+
+  shaderc_compile_options_set_cancellation_token(options_.get(), nullptr);
+  EXPECT_TRUE(CompilesToValidSpv(compiler_, kMinimalShader,
+                                 shaderc_glsl_vertex_shader, options_.get()));
+  shaderc_cancellation_token_release(token);
+}
+
+// Resolves every include to an empty file, and cancels a token on the first.
+struct CancellingResolver {
+  static shaderc_include_result* Resolve(void* user_data, const char* name,
+                                         int, const char*, size_t) {
+    auto* resolver = static_cast<CancellingResolver*>(user_data);
+    ++resolver->num_resolved;
+    shaderc_cancellation_token_cancel(resolver->token);
+    return new shaderc_include_result{name, strlen(name), "", 0, nullptr};
+  }
+  static void Release(void*, shaderc_include_result* result) {
+    delete result;
+  }
+
+  shaderc_cancellation_token_t token;
+  int num_resolved = 0;
+};
+
+TEST_F(CompileStringWithOptionsTest, CancellationStopsIncludes) {
+  CancellingResolver resolver{shaderc_cancellation_token_initialize()};
+  shaderc_compile_options_set_cancellation_token(options_.get(),
+                                                 resolver.token);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), CancellingResolver::Resolve, CancellingResolver::Release,
+      &resolver);
+  const Compilation comp(compiler_.get_compiler_handle(),
+                         "#version 450\n"
+                         "#include \"a.glsl\"\n"
+                         "#include \"b.glsl\"\n"
+                         "void main() {}\n",
+                         shaderc_glsl_vertex_shader, "shader", "main",
+                         options_.get());
+  EXPECT_EQ(shaderc_compilation_status_cancelled,
+            shaderc_result_get_compilation_status(comp.result()));
+  EXPECT_EQ(1, resolver.num_resolved);
+  shaderc_cancellation_token_release(resolver.token);
+}
+
+TEST_F(CompileStringWithOptionsTest, DiagnosticsMatchErrorMessage) {
+  const Compilation comp(compiler_.get_compiler_handle(),
+                         "#version 140\nint main() {}\n",
+                         shaderc_glsl_vertex_shader, "shader.vert", "main",
+                         options_.get());
+  ASSERT_EQ(2u, shaderc_result_get_diagnostics(comp.result(), nullptr, 0));
+  shaderc_diagnostic diagnostics[2];
+  EXPECT_EQ(2u, shaderc_result_get_diagnostics(comp.result(), diagnostics,
+                                               1));
+  EXPECT_EQ(2u, shaderc_result_get_diagnostics(comp.result(), diagnostics,
+                                               2));
+  for (const shaderc_diagnostic& diagnostic : diagnostics) {
+    EXPECT_EQ(shaderc_diagnostic_severity_error, diagnostic.severity);
+    EXPECT_EQ("shader.vert",
+              std::string(diagnostic.file, diagnostic.file_length));
+    EXPECT_EQ(2u, diagnostic.line);
+    EXPECT_THAT(shaderc_result_get_error_message(comp.result()),
+                HasSubstr("shader.vert:2: error: " +
+                          std::string(diagnostic.message,
+                                      diagnostic.message_length)));
+  }
+  EXPECT_EQ("'int' :  entry point cannot return a value",
+            std::string(diagnostics[0].message,
+                        diagnostics[0].message_length));
+  EXPECT_EQ("'' : function does not return a value: main",
+            std::string(diagnostics[1].message,
+                        diagnostics[1].message_length));
+
+  const Compilation success(compiler_.get_compiler_handle(), kMinimalShader,
+                            shaderc_glsl_vertex_shader, "shader", "main",
+                            options_.get());
+  EXPECT_EQ(0u, shaderc_result_get_diagnostics(success.result(), nullptr, 0));
+}
+
+TEST_F(CompileStringWithOptionsTest, StageAndTargetErrorsHaveDiagnostics) {
+  // Returns the only diagnostic of a failed compile, after checking that its
+  // error is counted.
+  auto only_diagnostic = [this](const char* source, shaderc_shader_kind kind) {
+    const Compilation comp(compiler_.get_compiler_handle(), source, kind,
+                           "shader", "main", options_.get());
+    EXPECT_EQ(1u, shaderc_result_get_num_errors(comp.result()));
+    shaderc_diagnostic diagnostic;
+    EXPECT_EQ(1u,
+              shaderc_result_get_diagnostics(comp.result(), &diagnostic, 1));
+    EXPECT_EQ(shaderc_diagnostic_severity_error, diagnostic.severity);
+    return std::make_pair(diagnostic.line,
+                          std::string(diagnostic.message,
+                                      diagnostic.message_length));
+  };
+  EXPECT_EQ(std::make_pair(2u, std::string("'#pragma': invalid stage for "
+                                           "'shader_stage' #pragma: 'x'")),
+            only_diagnostic("#version 450\n#pragma shader_stage(x)\n"
+                            "void main() {}\n",
+                            shaderc_glsl_infer_from_source));
+  EXPECT_EQ(std::make_pair(0u, std::string("the shader stage cannot be "
+                                           "determined; give it explicitly "
+                                           "or with '#pragma shader_stage'")),
+            only_diagnostic(kMinimalShader, shaderc_glsl_infer_from_source));
+  shaderc_compile_options_set_target_env(options_.get(),
+                                         shaderc_target_env_opengl_compat, 0);
+  EXPECT_EQ(std::make_pair(0u, std::string("OpenGL compatibility profile is "
+                                           "not supported")),
+            only_diagnostic(kMinimalShader, shaderc_glsl_vertex_shader));
+}
+
+TEST_F(CompileStringWithOptionsTest, IncludeGuardsFailTheInclude) {
+  const FakeFS fs = {{"a.glsl", "float a;\n"}, {"b.glsl", "float b;\n"}};
+  TestIncluder includer(fs);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), TestIncluder::GetIncluderResponseWrapper,
+      TestIncluder::ReleaseIncluderResponseWrapper, &includer);
+  const std::string shader =
+      "#version 450\n"
+      "#extension GL_GOOGLE_include_directive : enable\n"
+      "#include \"a.glsl\"\n"
+      "#include \"b.glsl\"\n"
+      "void main() {}\n";
+
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_include_count, 1);
+  const Compilation too_many(compiler_.get_compiler_handle(), shader,
+                             shaderc_glsl_vertex_shader, "shader", "main",
+                             options_.get());
+  EXPECT_EQ(shaderc_compilation_status_compilation_error,
+            shaderc_result_get_compilation_status(too_many.result()));
+  EXPECT_THAT(shaderc_result_get_error_message(too_many.result()),
+              HasSubstr("exceeded the limit of 1 includes"));
+
+  // Each pass over the source counts its includes afresh.
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_include_count, 2);
+  EXPECT_TRUE(CompilesToValidSpv(compiler_, shader, shaderc_glsl_vertex_shader,
+                                 options_.get()));
+
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_include_bytes, 10);
+  const Compilation too_large(compiler_.get_compiler_handle(), shader,
+                              shaderc_glsl_vertex_shader, "shader", "main",
+                              options_.get(), OutputType::PreprocessedText);
+  EXPECT_EQ(shaderc_compilation_status_compilation_error,
+            shaderc_result_get_compilation_status(too_large.result()));
+  EXPECT_THAT(shaderc_result_get_error_message(too_large.result()),
+              HasSubstr("exceeded the limit of 10 bytes of included source"));
+}
+
+TEST_F(CompileStringWithOptionsTest, SizeGuardsFailLargeShaders) {
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_preprocessed_bytes, 10);
+  const Compilation long_source(compiler_.get_compiler_handle(),
+                                kMinimalShader, shaderc_glsl_vertex_shader,
+                                "shader", "main", options_.get());
+  EXPECT_EQ(shaderc_compilation_status_compilation_error,
+            shaderc_result_get_compilation_status(long_source.result()));
+  EXPECT_THAT(shaderc_result_get_error_message(long_source.result()),
+              HasSubstr("shader: error: the preprocessed source is "));
+
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_preprocessed_bytes, 0);
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_spirv_words, 20);
+  const Compilation large_module(compiler_.get_compiler_handle(),
+                                 kMinimalShader, shaderc_glsl_vertex_shader,
+                                 "shader", "main", options_.get());
+  EXPECT_EQ(shaderc_compilation_status_compilation_error,
+            shaderc_result_get_compilation_status(large_module.result()));
+  EXPECT_THAT(shaderc_result_get_error_message(large_module.result()),
+              HasSubstr("words of SPIR-V before optimization, past the limit "
+                        "of 20"));
+
+  shaderc_compile_options_set_compile_guard(
+      options_.get(), shaderc_compile_guard_spirv_words, 0);
+  EXPECT_TRUE(CompilesToValidSpv(compiler_, kMinimalShader,
+                                 shaderc_glsl_vertex_shader, options_.get()));
+}
+
+// A fragment shader that samples a texture only for rough materials.
+const char kBakeableShader[] =
+    "#version 450\n"
+    "layout(binding = 1) uniform Material { float roughness; } material;\n"
+    "layout(binding = 2) uniform sampler2D detail;\n"
+    "layout(location = 0) out vec4 color;\n"
+    "void main() {\n"
+    "  color = vec4(1.0);\n"
+    "  if (material.roughness > 0.5) color = texture(detail, vec2(0.5));\n"
+    "}\n";
+
+TEST_F(CompileStringWithOptionsTest, BakedUniformRemovesUnusedBindings) {
+  shaderc_compile_options_add_baked_uniform(options_.get(), "material",
+                                            "roughness", "0.25");
+  const Compilation comp(compiler_.get_compiler_handle(), kBakeableShader,
+                         shaderc_glsl_fragment_shader, "shader.frag", "main",
+                         options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(comp.result()));
+  ASSERT_EQ(2u, shaderc_result_get_num_removed_bindings(comp.result()));
+  const shaderc_descriptor_binding* removed =
+      shaderc_result_get_removed_bindings(comp.result());
+  EXPECT_EQ(1u, removed[0].binding);
+  EXPECT_EQ(shaderc_descriptor_type_uniform_buffer, removed[0].descriptor_type);
+  EXPECT_EQ(2u, removed[1].binding);
+  EXPECT_EQ(shaderc_descriptor_type_combined_image_sampler,
+            removed[1].descriptor_type);
+}
+
+TEST_F(CompileStringWithOptionsTest, BadBakedValueIsCompilationError) {
+  shaderc_compile_options_add_baked_uniform(options_.get(), "Material",
+                                            "roughness", "1,2");
+  const Compilation comp(compiler_.get_compiler_handle(), kBakeableShader,
+                         shaderc_glsl_fragment_shader, "shader.frag", "main",
+                         options_.get());
+  EXPECT_EQ(shaderc_compilation_status_compilation_error,
+            shaderc_result_get_compilation_status(comp.result()));
+  EXPECT_THAT(shaderc_result_get_error_message(comp.result()),
+              HasSubstr("cannot bake 'Material.roughness': expected 1 "
+                        "component, got 2"));
+  EXPECT_EQ(0u, shaderc_result_get_num_removed_bindings(comp.result()));
+}
+
+// A vertex shader with an output that kPipelineFragShader does not read.
+const char kPipelineVertShader[] =
+    "#version 450\n"
+    "layout(location = 0) in vec4 pos;\n"
+    "layout(location = 0) out vec4 unused;\n"
+    "layout(location = 3) out vec4 color;\n"
+    "void main() { gl_Position = pos; unused = pos.wzyx; color = pos; }\n";
+
+const char kPipelineFragShader[] =
+    "#version 450\n"
+    "layout(location = 3) in vec4 color;\n"
+    "layout(location = 0) out vec4 frag;\n"
+    "void main() { frag = color; }\n";
+
+TEST_F(CompileStringWithOptionsTest, PipelineTrimsStageInterfaces) {
+  const shaderc_pipeline_stage stages[] = {
+      {kPipelineVertShader, strlen(kPipelineVertShader),
+       shaderc_glsl_vertex_shader, "shader.vert", "main"},
+      {kPipelineFragShader, strlen(kPipelineFragShader),
+       shaderc_glsl_fragment_shader, "shader.frag", "main"}};
+  shaderc_compilation_result_t results[2];
+  shaderc_compile_pipeline_into_spv_assembly(compiler_.get_compiler_handle(),
+                                             stages, 2, options_.get(),
+                                             results);
+  for (auto* result : results) {
+    ASSERT_TRUE(CompilationResultIsSuccess(result))
+        << shaderc_result_get_error_message(result);
+  }
+  const std::string vertex(shaderc_result_get_bytes(results[0]),
+                           shaderc_result_get_length(results[0]));
+  const std::string fragment(shaderc_result_get_bytes(results[1]),
+                             shaderc_result_get_length(results[1]));
+  EXPECT_THAT(vertex, Not(HasSubstr("%unused")));
+  EXPECT_THAT(vertex, HasSubstr("OpDecorate %color Location 0"));
+  EXPECT_THAT(fragment, HasSubstr("OpDecorate %color Location 0"));
+  for (auto* result : results) shaderc_result_release(result);
+}
+
+TEST_F(CompileStringWithOptionsTest, PipelineRequiresExplicitStages) {
+  const shaderc_pipeline_stage stages[] = {
+      {kPipelineVertShader, strlen(kPipelineVertShader),
+       shaderc_glsl_infer_from_source, "shader.vert", "main"},
+      {kPipelineFragShader, strlen(kPipelineFragShader),
+       shaderc_glsl_fragment_shader, "shader.frag", "main"}};
+  shaderc_compilation_result_t results[2];
+  shaderc_compile_pipeline_into_spv(compiler_.get_compiler_handle(), stages, 2,
+                                    options_.get(), results);
+  for (auto* result : results) {
+    EXPECT_EQ(shaderc_compilation_status_invalid_stage,
+              shaderc_result_get_compilation_status(result));
+    EXPECT_THAT(shaderc_result_get_error_message(result),
+                HasSubstr("shader.vert: error: the shader stage must be "
+                          "given explicitly"));
+    shaderc_result_release(result);
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, PipelineEmitsCompactDescriptorLayout) {
+  const char vertex[] =
+      "#version 450\n"
+      "layout(set = 2, binding = 5) uniform U { vec4 offset; } u;\n"
+      "void main() { gl_Position = u.offset; }\n";
+  const char fragment[] =
+      "#version 450\n"
+      "layout(set = 2, binding = 9) uniform sampler2D tex;\n"
+      "layout(set = 2, binding = 11) uniform sampler2D unused;\n"
+      "layout(location = 0) out vec4 frag;\n"
+      "void main() { frag = texture(tex, vec2(0.0)); }\n";
+  const shaderc_pipeline_stage stages[] = {
+      {vertex, strlen(vertex), shaderc_glsl_vertex_shader, "shader.vert",
+       "main"},
+      {fragment, strlen(fragment), shaderc_glsl_fragment_shader,
+       "shader.frag", "main"}};
+  shaderc_compile_options_set_compact_pipeline_bindings(options_.get(), true);
+  shaderc_compilation_result_t results[2];
+  shaderc_compile_pipeline_into_spv(compiler_.get_compiler_handle(), stages, 2,
+                                    options_.get(), results);
+  for (auto* result : results) {
+    ASSERT_TRUE(CompilationResultIsSuccess(result))
+        << shaderc_result_get_error_message(result);
+    ASSERT_EQ(2u, shaderc_result_get_num_descriptor_bindings(result));
+    const shaderc_descriptor_binding* bindings =
+        shaderc_result_get_descriptor_bindings(result);
+    EXPECT_EQ(0u, bindings[0].set);
+    EXPECT_EQ(0u, bindings[0].binding);
+    EXPECT_EQ(shaderc_descriptor_type_uniform_buffer,
+              bindings[0].descriptor_type);
+    EXPECT_EQ(1u, bindings[0].stage_flags);
+    EXPECT_EQ(0u, bindings[1].set);
+    EXPECT_EQ(1u, bindings[1].binding);
+    EXPECT_EQ(shaderc_descriptor_type_combined_image_sampler,
+              bindings[1].descriptor_type);
+    EXPECT_EQ(1u, bindings[1].descriptor_count);
+    EXPECT_EQ(0x10u, bindings[1].stage_flags);
+    shaderc_result_release(result);
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, PipelineRejectsConflictingBindings) {
+  const char vertex[] =
+      "#version 450\n"
+      "layout(binding = 1) uniform U { vec4 offset; } u;\n"
+      "void main() { gl_Position = u.offset; }\n";
+  const char fragment[] =
+      "#version 450\n"
+      "layout(binding = 1) uniform sampler2D tex;\n"
+      "layout(location = 0) out vec4 frag;\n"
+      "void main() { frag = texture(tex, vec2(0.0)); }\n";
+  const shaderc_pipeline_stage stages[] = {
+      {vertex, strlen(vertex), shaderc_glsl_vertex_shader, "shader.vert",
+       "main"},
+      {fragment, strlen(fragment), shaderc_glsl_fragment_shader,
+       "shader.frag", "main"}};
+  shaderc_compilation_result_t results[2];
+  shaderc_compile_pipeline_into_spv(compiler_.get_compiler_handle(), stages, 2,
+                                    options_.get(), results);
+  for (auto* result : results) {
+    EXPECT_EQ(shaderc_compilation_status_compilation_error,
+              shaderc_result_get_compilation_status(result));
+    EXPECT_THAT(shaderc_result_get_error_message(result),
+                HasSubstr("shader.vert: error: descriptor set 0 binding 1 is "
+                          "declared differently by different stages"));
+    EXPECT_EQ(0u, shaderc_result_get_num_descriptor_bindings(result));
+    shaderc_result_release(result);
+  }
+}
+
+// A compute shader library defining a function that kLinkKernelShader uses.
+const char kLinkLibraryShader[] =
+    "#version 450\n"
+    "float twice(float x) { return 2.0 * x; }\n"
+    "float unused(float x) { return x + 1.0; }\n";
+
+// A compute shader that calls a function it does not define.
+const char kLinkKernelShader[] =
+    "#version 450\n"
+    "layout(local_size_x = 1) in;\n"
+    "layout(std430, binding = 0) buffer B { float v; };\n"
+    "float twice(float x);\n"
+    "void main() { v = twice(v); }\n";
+
+// Links the given SPIR-V binaries, passed as bytes.
+shaderc_compilation_result_t LinkSpv(
+    const shaderc_compiler_t compiler,
+    const std::vector<std::string>& module_bytes,
+    const shaderc_compile_options_t options) {
+  std::vector<std::vector<uint32_t>> modules;
+  for (const auto& bytes : module_bytes) {
+    modules.emplace_back(bytes.size() / sizeof(uint32_t));
+    std::memcpy(modules.back().data(), bytes.data(), bytes.size());
+  }
+  std::vector<const uint32_t*> binaries;
+  std::vector<size_t> word_counts;
+  for (const auto& module : modules) {
+    binaries.push_back(module.data());
+    word_counts.push_back(module.size());
+  }
+  return shaderc_link_spv(compiler, binaries.data(), word_counts.data(),
+                          modules.size(), options);
+}
+
+// Returns the number of instructions with the given opcode, and first operand
+// if it is not zero, in the SPIR-V module held by the given result.
+size_t CountInstructions(const shaderc_compilation_result_t result, spv::Op op,
+                         uint32_t first_operand = 0) {
+  std::vector<uint32_t> words(shaderc_result_get_length(result) /
+                              sizeof(uint32_t));
+  std::memcpy(words.data(), shaderc_result_get_bytes(result),
+              words.size() * sizeof(uint32_t));
+  size_t count = 0;
+  for (size_t i = 5; i < words.size(); i += words[i] >> spv::WordCountShift) {
+    if (words[i] >> spv::WordCountShift == 0) break;
+    if ((words[i] & spv::OpCodeMask) != static_cast<uint32_t>(op)) {
+      continue;
+    }
+    if (first_operand == 0 || words[i + 1] == first_operand) ++count;
+  }
+  return count;
+}
+
+TEST_F(CompileStringWithOptionsTest, LinkSpvResolvesImportedFunction) {
+  shaderc_compile_options_set_compile_only(options_.get(), true);
+  const std::string library = CompilationOutput(
+      kLinkLibraryShader, shaderc_glsl_compute_shader, options_.get());
+  const std::string kernel = CompilationOutput(
+      kLinkKernelShader, shaderc_glsl_compute_shader, options_.get());
+  ASSERT_FALSE(library.empty());
+  ASSERT_FALSE(kernel.empty());
+
+  shaderc_compilation_result_t result = LinkSpv(
+      compiler_.get_compiler_handle(), {kernel, library}, options_.get());
+  ASSERT_TRUE(CompilationResultIsSuccess(result))
+      << shaderc_result_get_error_message(result);
+  EXPECT_EQ(1u, CountInstructions(result, spv::OpEntryPoint));
+  EXPECT_EQ(0u, CountInstructions(result, spv::OpCapability,
+                                  spv::CapabilityLinkage));
+  // main() and twice() remain; unused() is removed since no entry point
+  // reaches it.
+  EXPECT_EQ(2u, CountInstructions(result, spv::OpFunction));
+  shaderc_result_release(result);
+}
+
+TEST_F(CompileStringWithOptionsTest, LinkSpvRejectsUnresolvedImport) {
+  shaderc_compile_options_set_compile_only(options_.get(), true);
+  const std::string kernel = CompilationOutput(
+      kLinkKernelShader, shaderc_glsl_compute_shader, options_.get());
+  ASSERT_FALSE(kernel.empty());
+
+  shaderc_compilation_result_t result =
+      LinkSpv(compiler_.get_compiler_handle(), {kernel}, options_.get());
+  EXPECT_EQ(shaderc_compilation_status_transformation_error,
+            shaderc_result_get_compilation_status(result));
+  EXPECT_THAT(shaderc_result_get_error_message(result),
+              HasSubstr("shaderc: error: failed to link: "));
+  EXPECT_EQ(0u, shaderc_result_get_length(result));
+  shaderc_result_release(result);
+}
+
+TEST_F(CompileStringWithOptionsTest, LinkSpvRejectsWorkgroupSize) {
+  shaderc_compile_options_set_compile_only(options_.get(), true);
+  const std::string library = CompilationOutput(
+      kLinkLibraryShader, shaderc_glsl_compute_shader, options_.get());
+  const std::string kernel = CompilationOutput(
+      kLinkKernelShader, shaderc_glsl_compute_shader, options_.get());
+  ASSERT_FALSE(library.empty());
+  ASSERT_FALSE(kernel.empty());
+
+  shaderc_compile_options_set_workgroup_size(options_.get(), 64, 1, 1);
+  shaderc_compilation_result_t result = LinkSpv(
+      compiler_.get_compiler_handle(), {kernel, library}, options_.get());
+  EXPECT_EQ(shaderc_compilation_status_transformation_error,
+            shaderc_result_get_compilation_status(result));
+  EXPECT_THAT(shaderc_result_get_error_message(result),
+              HasSubstr("the workgroup size cannot be set when linking"));
+  shaderc_result_release(result);
+}
+
+// A fragment shader whose branch depends on a specialization constant.
+const char kSpecializableShader[] = R"(#version 450
+layout(constant_id = 3) const bool kFancy = false;
+layout(location = 0) out vec4 color;
+void main() {
+  if (kFancy) {
+    color = vec4(cos(gl_FragCoord.x));
+  } else {
+    color = vec4(1.0);
+  }
+}
+)";
+
+// Specializes the given module once per entry of specializations, and
+// returns the results.
+std::vector<shaderc_compilation_result_t> SpecializeSpv(
+    const shaderc_compiler_t compiler, const std::string& module,
+    const std::vector<std::vector<shaderc_specialization_constant>>&
+        specializations,
+    const shaderc_compile_options_t options) {
+  std::vector<uint32_t> words(module.size() / sizeof(uint32_t));
+  std::memcpy(words.data(), module.data(), module.size());
+  std::vector<shaderc_specialization> raw_specializations;
+  for (const auto& constants : specializations) {
+    raw_specializations.push_back({constants.data(), constants.size()});
+  }
+  std::vector<shaderc_compilation_result_t> results(specializations.size());
+  shaderc_specialize_spv(compiler, words.data(), words.size(),
+                         raw_specializations.data(),
+                         raw_specializations.size(), options, results.data());
+  return results;
+}
+
+TEST_F(CompileStringWithOptionsTest, SpecializeSpvRejectsUnknownSpecId) {
+  const std::string module = CompilationOutput(
+      kSpecializableShader, shaderc_glsl_fragment_shader, options_.get());
+  ASSERT_FALSE(module.empty());
+  const auto results = SpecializeSpv(compiler_.get_compiler_handle(), module,
+                                     {{{9, "1"}}}, options_.get());
+  ASSERT_EQ(1u, results.size());
+  EXPECT_EQ(shaderc_compilation_status_transformation_error,
+            shaderc_result_get_compilation_status(results[0]));
+  EXPECT_THAT(shaderc_result_get_error_message(results[0]),
+              HasSubstr("shaderc: error: failed to specialize: no "
+                        "specialization constant has SpecId 9"));
+  shaderc_result_release(results[0]);
+}
+
+#ifndef SHADERC_DISABLE_THREADED_TESTS
+TEST_F(CompileStringWithOptionsTest, OptimizeSpvBatchOptimizesEachModule) {
+  const std::string vertex_bytes = CompilationOutput(
+      kMinimalShader, shaderc_glsl_vertex_shader, options_.get());
+  const std::string fragment_bytes = CompilationOutput(
+      kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_size);
+
+  std::vector<std::vector<uint32_t>> inputs;
+  for (const std::string* bytes :
+       {&vertex_bytes, &fragment_bytes, &vertex_bytes}) {
+    inputs.emplace_back(bytes->size() / sizeof(uint32_t));
+    std::memcpy(inputs.back().data(), bytes->data(), bytes->size());
+  }
+  std::vector<const uint32_t*> binaries;
+  std::vector<size_t> word_counts;
+  for (const auto& input : inputs) {
+    binaries.push_back(input.data());
+    word_counts.push_back(input.size());
+  }
+  std::vector<shaderc_compilation_result_t> results(inputs.size());
+  shaderc_optimize_spv_batch(compiler_.get_compiler_handle(), binaries.data(),
+                             word_counts.data(), inputs.size(), options_.get(),
+                             results.data());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    ASSERT_TRUE(CompilationResultIsSuccess(results[i]));
+    shaderc_compilation_result_t single = shaderc_optimize_spv(
+        compiler_.get_compiler_handle(), binaries[i], word_counts[i],
+        options_.get());
+    EXPECT_EQ(std::string(shaderc_result_get_bytes(single),
+                          shaderc_result_get_length(single)),
+              std::string(shaderc_result_get_bytes(results[i]),
+                          shaderc_result_get_length(results[i])));
+    shaderc_result_release(single);
+    shaderc_result_release(results[i]);
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, SpecializeSpvFreezesEachVariant) {
+  const std::string module = CompilationOutput(
+      kSpecializableShader, shaderc_glsl_fragment_shader, options_.get());
+  ASSERT_FALSE(module.empty());
+  const auto results =
+      SpecializeSpv(compiler_.get_compiler_handle(), module,
+                    {{{3, "true"}}, {{3, "false"}}, {}}, options_.get());
+  ASSERT_EQ(3u, results.size());
+  for (const auto result : results) {
+    ASSERT_TRUE(CompilationResultIsSuccess(result))
+        << shaderc_result_get_error_message(result);
+    EXPECT_EQ(0u, CountInstructions(result, spv::OpSpecConstantTrue));
+    EXPECT_EQ(0u, CountInstructions(result, spv::OpSpecConstantFalse));
+  }
+  // Only the variant that takes the branch keeps the call to cos().
+  EXPECT_EQ(1u, CountInstructions(results[0], spv::OpExtInst));
+  EXPECT_EQ(0u, CountInstructions(results[1], spv::OpExtInst));
+  // A constant that is not given keeps its default value.
+  EXPECT_EQ(std::string(shaderc_result_get_bytes(results[1]),
+                        shaderc_result_get_length(results[1])),
+            std::string(shaderc_result_get_bytes(results[2]),
+                        shaderc_result_get_length(results[2])));
+  for (const auto result : results) shaderc_result_release(result);
+}
+
+// Compiles source once with the given recipes, and returns the results.
+std::vector<shaderc_compilation_result_t> CompileWithRecipes(
+    const shaderc_compiler_t compiler, const std::string& source,
+    shaderc_shader_kind kind, const shaderc_compile_options_t options,
+    const std::vector<shaderc_optimization_recipe>& recipes) {
+  std::vector<shaderc_compilation_result_t> results(recipes.size());
+  shaderc_compile_into_spv_with_recipes(
+      compiler, source.data(), source.size(), kind, "shader", "main", options,
+      recipes.data(), recipes.size(), results.data());
+  return results;
+}
+
+TEST_F(CompileStringWithOptionsTest, RecipesMatchSeparateCompiles) {
+  const std::vector<shaderc_compilation_result_t> results = CompileWithRecipes(
+      compiler_.get_compiler_handle(), kGlslMultipleFnShader,
+      shaderc_glsl_fragment_shader, options_.get(),
+      {{shaderc_optimization_level_zero, false},
+       {shaderc_optimization_level_performance, false}});
+  ASSERT_EQ(2u, results.size());
+  ASSERT_TRUE(CompilationResultIsSuccess(results[0]));
+  ASSERT_TRUE(CompilationResultIsSuccess(results[1]));
+
+  const std::string unoptimized_bytes = CompilationOutput(
+      kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  const std::string optimized_bytes = CompilationOutput(
+      kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+  EXPECT_EQ(unoptimized_bytes,
+            std::string(shaderc_result_get_bytes(results[0]),
+                        shaderc_result_get_length(results[0])));
+  EXPECT_EQ(optimized_bytes,
+            std::string(shaderc_result_get_bytes(results[1]),
+                        shaderc_result_get_length(results[1])));
+  for (auto result : results) shaderc_result_release(result);
+}
+
+TEST_F(CompileStringWithOptionsTest, RecipesWithoutDebugInfoAreStripped) {
+  const std::vector<shaderc_compilation_result_t> results = CompileWithRecipes(
+      compiler_.get_compiler_handle(), kMinimalDebugInfoShader,
+      shaderc_glsl_vertex_shader, options_.get(),
+      {{shaderc_optimization_level_zero, true},
+       {shaderc_optimization_level_zero, false}});
+  ASSERT_TRUE(CompilationResultIsSuccess(results[0]));
+  ASSERT_TRUE(CompilationResultIsSuccess(results[1]));
+  const std::string debug_bytes(shaderc_result_get_bytes(results[0]),
+                                shaderc_result_get_length(results[0]));
+  const std::string plain_bytes(shaderc_result_get_bytes(results[1]),
+                                shaderc_result_get_length(results[1]));
+  EXPECT_THAT(debug_bytes, HasSubstr(kMinimalDebugInfoShader));
+  EXPECT_THAT(plain_bytes, Not(HasSubstr(kMinimalDebugInfoShader)));
+
+  // The recipe with debug info gives what a compile of its own would.
+  shaderc_compile_options_set_generate_debug_info(options_.get());
+  EXPECT_EQ(CompilationOutput(kMinimalDebugInfoShader,
+                              shaderc_glsl_vertex_shader, options_.get()),
+            debug_bytes);
+  for (auto result : results) shaderc_result_release(result);
+}
+
+TEST_F(CompileStringWithOptionsTest, RecipesAllFailOnFrontEndError) {
+  const std::vector<shaderc_compilation_result_t> results = CompileWithRecipes(
+      compiler_.get_compiler_handle(), kTwoErrorsShader,
+      shaderc_glsl_vertex_shader, options_.get(),
+      {{shaderc_optimization_level_zero, false},
+       {shaderc_optimization_level_size, false}});
+  for (auto result : results) {
+    EXPECT_EQ(shaderc_compilation_status_compilation_error,
+              shaderc_result_get_compilation_status(result));
+    EXPECT_EQ(2u, shaderc_result_get_num_errors(result));
+    EXPECT_EQ(0u, shaderc_result_get_length(result));
+    shaderc_result_release(result);
+  }
+}
+
+TEST_F(CompileStringWithOptionsTest, RecipesOverrideWorkgroupSize) {
+  shaderc_compile_options_set_generate_reflection(options_.get(), true);
+  shaderc_compile_options_set_workgroup_size(options_.get(), 32, 0, 0);
+  const std::vector<shaderc_compilation_result_t> results = CompileWithRecipes(
+      compiler_.get_compiler_handle(), kReflectedComputeShader,
+      shaderc_glsl_compute_shader, options_.get(),
+      {{shaderc_optimization_level_zero, false, {0, 0, 0}},
+       {shaderc_optimization_level_zero, false, {64, 1, 1}}});
+  ASSERT_TRUE(CompilationResultIsSuccess(results[0]));
+  ASSERT_TRUE(CompilationResultIsSuccess(results[1]));
+  EXPECT_THAT(shaderc_result_get_reflection(results[0]),
+              HasSubstr("\"workgroup_size\": [32, 2, 1]"));
+  EXPECT_THAT(shaderc_result_get_reflection(results[1]),
+              HasSubstr("\"workgroup_size\": [64, 1, 1]"));
+  for (auto result : results) shaderc_result_release(result);
+}
+
+// Collects the result of one tiered compilation job.
+struct TieredJob {
+  static void Deliver(void* user_data, uint64_t job_id,
+                      shaderc_compilation_result_t result) {
+    auto* job = static_cast<TieredJob*>(user_data);
+    job->delivered_id = job_id;
+    job->result.set_value(result);
+  }
+
+  uint64_t delivered_id = 0;
+  std::promise<shaderc_compilation_result_t> result;
+};
+
+class TieredCompileTest : public CompileStringWithOptionsTest {
+ protected:
+  TieredCompileTest() : tiers_(shaderc_tiered_compiler_initialize(1)) {}
+  ~TieredCompileTest() { shaderc_tiered_compiler_release(tiers_); }
+
+  shaderc_tiered_compiler_t tiers_;
+};
+
+TEST_F(TieredCompileTest, ReturnsUnoptimizedThenOptimizedModule) {
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  TieredJob job;
+  uint64_t job_id = 0;
+  const std::string source = kGlslMultipleFnShader;
+  shaderc_compilation_result_t quick = shaderc_tiered_compile_into_spv(
+      tiers_, compiler_.get_compiler_handle(), source.data(), source.size(),
+      shaderc_glsl_fragment_shader, "shader", "main", options_.get(), 0,
+      &TieredJob::Deliver, &job, &job_id);
+  ASSERT_TRUE(CompilationResultIsSuccess(quick));
+  EXPECT_NE(0u, job_id);
+
+  shaderc_compilation_result_t optimized = job.result.get_future().get();
+  ASSERT_TRUE(CompilationResultIsSuccess(optimized))
+      << shaderc_result_get_error_message(optimized);
+  EXPECT_EQ(job_id, job.delivered_id);
+
+  // The first tier matches an unoptimized compile, and the second tier
+  // matches an ordinary optimized compile.
+  const std::string optimized_bytes =
+      CompilationOutput(source, shaderc_glsl_fragment_shader, options_.get());
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_zero);
+  const std::string unoptimized_bytes =
+      CompilationOutput(source, shaderc_glsl_fragment_shader, options_.get());
+  EXPECT_EQ(unoptimized_bytes,
+            std::string(shaderc_result_get_bytes(quick),
+                        shaderc_result_get_length(quick)));
+  EXPECT_EQ(optimized_bytes,
+            std::string(shaderc_result_get_bytes(optimized),
+                        shaderc_result_get_length(optimized)));
+  EXPECT_NE(unoptimized_bytes, optimized_bytes);
+
+  shaderc_result_release(quick);
+  shaderc_result_release(optimized);
+}
+
+TEST_F(TieredCompileTest, OptimizedModuleCarriesRequestedReports) {
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  shaderc_compile_options_set_generate_reflection(options_.get(), true);
+  shaderc_compile_options_set_generate_cost_report(options_.get(), true);
+  TieredJob job;
+  const std::string source = kGlslMultipleFnShader;
+  shaderc_compilation_result_t quick = shaderc_tiered_compile_into_spv(
+      tiers_, compiler_.get_compiler_handle(), source.data(), source.size(),
+      shaderc_glsl_fragment_shader, "shader", "main", options_.get(), 0,
+      &TieredJob::Deliver, &job, nullptr);
+  ASSERT_TRUE(CompilationResultIsSuccess(quick));
+  EXPECT_NE("", std::string(shaderc_result_get_reflection(quick)));
+  EXPECT_NE("", std::string(shaderc_result_get_cost_report(quick)));
+
+  shaderc_compilation_result_t optimized = job.result.get_future().get();
+  ASSERT_TRUE(CompilationResultIsSuccess(optimized));
+  EXPECT_NE("", std::string(shaderc_result_get_reflection(optimized)));
+  EXPECT_NE("", std::string(shaderc_result_get_cost_report(optimized)));
+
+  shaderc_result_release(quick);
+  shaderc_result_release(optimized);
+}
+
+TEST_F(TieredCompileTest, FailedCompilationQueuesNoJob) {
+  TieredJob job;
+  uint64_t job_id = 1234;
+  const std::string source = kTwoErrorsShader;
+  shaderc_compilation_result_t quick = shaderc_tiered_compile_into_spv(
+      tiers_, compiler_.get_compiler_handle(), source.data(), source.size(),
+      shaderc_glsl_vertex_shader, "shader", "main", options_.get(), 0,
+      &TieredJob::Deliver, &job, &job_id);
+  EXPECT_FALSE(CompilationResultIsSuccess(quick));
+  EXPECT_EQ(0u, job_id);
+  EXPECT_FALSE(shaderc_tiered_compiler_cancel(tiers_, job_id));
+  shaderc_result_release(quick);
+}
+
+TEST_F(TieredCompileTest, CancelledJobsDeliverNullExactlyOnce) {
+  shaderc_compile_options_set_optimization_level(
+      options_.get(), shaderc_optimization_level_performance);
+  const std::string source = kGlslMultipleFnShader;
+  std::vector<TieredJob> jobs(8);
+  std::vector<uint64_t> ids(jobs.size());
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    shaderc_result_release(shaderc_tiered_compile_into_spv(
+        tiers_, compiler_.get_compiler_handle(), source.data(), source.size(),
+        shaderc_glsl_fragment_shader, "shader", "main", options_.get(), 0,
+        &TieredJob::Deliver, &jobs[i], &ids[i]));
+  }
+  // With one worker, at least the last job is still queued, unless the
+  // worker has already run the others.  Either way, each job is delivered
+  // exactly once, and a successful cancel delivers a null result.
+  for (size_t i = 0; i < jobs.size(); ++i) {
+    const bool cancelled = shaderc_tiered_compiler_cancel(tiers_, ids[i]);
+    shaderc_compilation_result_t result = jobs[i].result.get_future().get();
+    if (cancelled) {
+      EXPECT_EQ(nullptr, result);
+    } else {
+      EXPECT_TRUE(CompilationResultIsSuccess(result));
+    }
+    EXPECT_FALSE(shaderc_tiered_compiler_cancel(tiers_, ids[i]));
+    shaderc_result_release(result);
+  }
+}
+
+TEST_F(TieredCompileTest, SetPriorityOnUnknownJobFails) {
+  EXPECT_FALSE(shaderc_tiered_compiler_set_priority(tiers_, 42, 1));
+  EXPECT_FALSE(shaderc_tiered_compiler_cancel(tiers_, 42));
+}
+#endif  // SHADERC_DISABLE_THREADED_TESTS
+
+// Recompiles source in session, and returns whether it compiled.
+bool RecompileSucceeds(shaderc_compile_session_t session,
+                       const std::string& source) {
+  shaderc_compilation_result_t result =
+      shaderc_compile_session_recompile(session, source.data(), source.size());
+  const bool succeeded = CompilationResultIsSuccess(result);
+  shaderc_result_release(result);
+  return succeeded;
+}
+
+TEST_F(CompileStringWithOptionsTest, CompileSessionReadsIncludesOnce) {
+  FakeFS fs = {{"common.glsl", "float scale() { return 2.0; }\n"}};
+  TestIncluder includer(fs);
+  shaderc_compile_options_set_include_callbacks(
+      options_.get(), TestIncluder::GetIncluderResponseWrapper,
+      TestIncluder::ReleaseIncluderResponseWrapper, &includer);
+  shaderc_compile_session_t session = shaderc_compile_session_initialize(
+      compiler_.get_compiler_handle(), shaderc_glsl_fragment_shader,
+      "shader.frag", "main", options_.get());
+  ASSERT_NE(nullptr, session);
+  const std::string shader =
+      "#version 450\n"
+      "#extension GL_GOOGLE_include_directive : enable\n"
+      "#include \"common.glsl\"\n"
+      "layout(location = 0) out float o;\n"
+      "void main() { o = scale(); }\n";
+  EXPECT_TRUE(RecompileSucceeds(session, shader));
+
+  // An edit to the include goes unseen until it is invalidated.
+  fs["common.glsl"] = "#error edited\n";
+  EXPECT_TRUE(RecompileSucceeds(session, shader + "// Edited.\n"));
+  shaderc_compile_session_invalidate_include(session, "common.glsl");
+  EXPECT_FALSE(RecompileSucceeds(session, shader));
+
+  fs["common.glsl"] = "float scale() { return 3.0; }\n";
+  shaderc_compile_session_invalidate_include(session, nullptr);
+  EXPECT_TRUE(RecompileSucceeds(session, shader));
+  shaderc_compile_session_release(session);
+}
+
+TEST_F(CompileStringWithOptionsTest, CompileSessionMatchesOrdinaryCompile) {
+  shaderc_compile_session_t session = shaderc_compile_session_initialize(
+      compiler_.get_compiler_handle(), shaderc_glsl_fragment_shader, "shader",
+      "main", options_.get());
+  ASSERT_NE(nullptr, session);
+  const std::string expected = CompilationOutput(
+      kGlslMultipleFnShader, shaderc_glsl_fragment_shader, options_.get());
+  // The second compile of the same source returns the first result again.
+  for (int i = 0; i < 2; ++i) {
+    shaderc_compilation_result_t result = shaderc_compile_session_recompile(
+        session, kGlslMultipleFnShader, strlen(kGlslMultipleFnShader));
+    ASSERT_TRUE(CompilationResultIsSuccess(result));
+    EXPECT_EQ(expected, std::string(shaderc_result_get_bytes(result),
+                                    shaderc_result_get_length(result)));
+    shaderc_result_release(result);
+  }
+  EXPECT_FALSE(RecompileSucceeds(session, kTwoErrorsShader));
+  EXPECT_FALSE(RecompileSucceeds(session, kTwoErrorsShader));
+  shaderc_compile_session_release(session);
+}
+
 }  // anonymous namespace
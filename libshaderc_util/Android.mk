@@ -19,14 +19,22 @@ LOCAL_MODULE:=shaderc_util
 LOCAL_CXXFLAGS:=-std=c++17 -fno-exceptions -fno-rtti -DENABLE_HLSL=1
 LOCAL_EXPORT_C_INCLUDES:=$(LOCAL_PATH)/include
 LOCAL_SRC_FILES:=src/args.cc \
+		src/cancellation.cc \
                 src/compiler.cc \
 		src/file_finder.cc \
+		src/include_report.cc \
 		src/io_shaderc.cc \
+		src/json.cc \
 		src/message.cc \
+		src/prelude.cc \
 		src/resources.cc \
 		src/shader_stage.cc \
+		src/spirv_cost.cc \
+		src/spirv_interface.cc \
+		src/spirv_size.cc \
 		src/spirv_tools_wrapper.cc \
-		src/version_profile.cc
-LOCAL_STATIC_LIBRARIES:=SPIRV SPIRV-Tools-opt glslang
+		src/version_profile.cc \
+		src/work_queue.cc
+LOCAL_STATIC_LIBRARIES:=SPIRV SPIRV-Tools-opt SPIRV-Tools-link glslang
 LOCAL_C_INCLUDES:=$(LOCAL_PATH)/include
 include $(BUILD_STATIC_LIBRARY)
@@ -0,0 +1,92 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_CANCELLATION_H
+#define LIBSHADERC_UTIL_INC_CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+
+#include "libshaderc_util/counting_includer.h"
+
+namespace shaderc_util {
+
+// Tells a compile to stop early, either because a flag was set, usually from
+// another thread, or because a deadline has passed.  The compile checks
+// between its phases, on each include request, and between optimizer passes.
+// A phase that is running, such as glslang's parse of a source, is not
+// interrupted.
+//
+// IsCancelled may be called from several threads at once.
+class Cancellation {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Never cancels.
+  Cancellation() : Cancellation(nullptr, Clock::time_point::max()) {}
+
+  // Cancels once *flag is true, unless flag is null, or once deadline has
+  // passed.  The flag must outlive this object.
+  Cancellation(const std::atomic<bool>* flag, Clock::time_point deadline)
+      : flag_(flag), deadline_(deadline) {
+    reason_.store(Reason::kNone);
+  }
+
+  // Returns true if either cancellation is possible.
+  bool is_active() const {
+    return flag_ != nullptr || deadline_ != Clock::time_point::max();
+  }
+
+  // Returns true if the compile should stop.  Once it has returned true, it
+  // keeps returning true.
+  bool IsCancelled() const;
+
+  // Returns true if IsCancelled has returned true.
+  bool was_cancelled() const { return reason_.load() != Reason::kNone; }
+
+  // Returns a message saying why the compile stopped, for an error.
+  const char* message() const;
+
+ private:
+  enum class Reason { kNone, kFlag, kDeadline };
+
+  const std::atomic<bool>* flag_;
+  const Clock::time_point deadline_;
+  mutable std::atomic<Reason> reason_;
+};
+
+// An includer that fails every request once a compile has been cancelled, so
+// that glslang stops preprocessing soon, and resolves and releases the other
+// requests with another includer.
+class CancellingIncluder : public CountingIncluder {
+ public:
+  CancellingIncluder(CountingIncluder& includer,
+                     const Cancellation& cancellation)
+      : includer_(includer), cancellation_(cancellation) {}
+
+ private:
+  glslang::TShader::Includer::IncludeResult* include_delegate(
+      const char* requested_source, const char* requesting_source,
+      IncludeType type, size_t include_depth) override;
+
+  void release_delegate(
+      glslang::TShader::Includer::IncludeResult* result) override;
+
+  CountingIncluder& includer_;
+  const Cancellation& cancellation_;
+};
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_CANCELLATION_H
@@ -18,17 +18,24 @@
 #include <array>
 #include <cassert>
 #include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
+#include "cancellation.h"
 #include "counting_includer.h"
 #include "file_finder.h"
 #include "glslang/Public/ShaderLang.h"
+#include "message.h"
 #include "mutex.h"
+#include "prelude.h"
 #include "resources.h"
+#include "spirv_interface.h"
+#include "spirv_size.h"
 #include "string_piece.h"
 
 // Fix a typo in glslang/Public/ShaderLang.h
@@ -40,6 +47,8 @@ namespace shaderc_util {
 // spirv_tools_wrapper.h, so cannot include spirv_tools_wrapper.h here.
 enum class PassId;
 
+struct GlslangClientInfo;
+
 // Initializes glslang on creation, and destroys it on completion.
 // Used to tie gslang process operations to object lifetimes.
 // Additionally initialization/finalization of glslang is not thread safe, so
@@ -57,6 +66,13 @@ class GlslangInitializer {
   static std::mutex* glslang_mutex_;
 };
 
+// The size of a module after one stage of OptimizationLevel::MinimumSize.
+struct OptimizationStage {
+  // A static string naming the stage, such as "compact-ids".
+  const char* name;
+  size_t size_in_bytes;
+};
+
 // Maps macro names to their definitions.  Stores string_pieces, so the
 // underlying strings must outlive it.
 using MacroDictionary = std::unordered_map<std::string, std::string>;
@@ -112,6 +128,54 @@ class Compiler {
     Zero,         // No optimization.
     Size,         // Optimization towards reducing code size.
     Performance,  // Optimization towards better performance.
+    FastCompile,  // Cheap optimizations only, for low compile latency.
+    MinimumSize,  // Every size reduction, for modules that are shipped.
+  };
+
+  // Kinds of GPU that OptimizationLevel::Performance can be tuned for.
+  enum class OptimizationProfile {
+    Generic,  // The standard performance recipe.
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES) NAME,
+#include "optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+  };
+
+  // One of the optimized outputs requested from CompileWithRecipes.
+  struct OptimizationRecipe {
+    OptimizationLevel level;
+    bool generate_debug_info;
+    // If not all zero, the workgroup size of this output, which replaces the
+    // size given with SetWorkgroupSize.
+    uint32_t workgroup_size[3];
+  };
+
+  // One of the modules produced by CompileWithRecipes or CompilePipeline.
+  // The first three fields mean the same as the fields of the tuple returned
+  // by Compile.  errors holds any message from optimizing or disassembling
+  // this module.
+  struct ModuleOutput {
+    bool succeeded = false;
+    std::vector<uint32_t> data;
+    size_t size_in_bytes = 0;
+    std::string errors;
+    // The diagnostics written to errors.
+    std::vector<Diagnostic> diagnostics;
+    // The module size after each stage, at OptimizationLevel::MinimumSize.
+    std::vector<OptimizationStage> optimization_stages;
+
+    // Replaces the errors with an internal error saying that the given
+    // action, such as "optimize", failed with the given errors.
+    void SetInternalError(const char* action, const std::string& errors);
+  };
+
+  // One of the shaders of a pipeline given to CompilePipeline.
+  struct PipelineStage {
+    string_piece source;
+    EShLanguage stage;
+    // The name used for the shader in messages.
+    std::string error_tag;
+    // The entry point name, for HLSL.
+    std::string entry_point_name;
   };
 
   // Resource limits.  These map to the "max*" fields in
@@ -122,6 +186,20 @@ class Compiler {
 #undef RESOURCE
   };
 
+  // Hard limits on what one compilation may cost, so that a hostile source
+  // fails early rather than exhausting the machine.
+  enum class Guard {
+    // The files included, counted afresh on each pass over the source.
+    IncludeCount,
+    // The bytes of included source, counted like IncludeCount.
+    IncludeBytes,
+    // The bytes of the preprocessed source.
+    PreprocessedBytes,
+    // The words of SPIR-V generated, before optimization.
+    SpirvWords,
+  };
+  static const size_t kNumGuards = 4;
+
   // Types of uniform variables.
   enum class UniformKind {
     // Image, and image buffer.
@@ -196,6 +274,7 @@ class Compiler {
         suppress_warnings_(false),
         generate_debug_info_(false),
         enabled_opt_passes_(),
+        opt_pass_flags_(),
         target_env_(TargetEnv::Vulkan),
         target_env_version_(TargetEnvVersion::Default),
         target_spirv_version_(SpirvVersion::v1_0),
@@ -224,9 +303,30 @@ class Compiler {
   // effect if multiple calls of this method exist.
   void SetOptimizationLevel(OptimizationLevel level);
 
+  // Sets the profile that OptimizationLevel::Performance is tuned for.  A
+  // profile other than Generic replaces the performance recipe with its own
+  // pass list.  It has no effect at other optimization levels.  It can be
+  // called before or after SetOptimizationLevel.
+  void SetOptimizationProfile(OptimizationProfile profile);
+
+  // Sets the optimizer passes to run after those selected by the
+  // optimization level, given as spirv-opt command line flags.  The flags are
+  // validated here, once, rather than on every compilation.  Returns true on
+  // success.  Otherwise, writes a message to *errors, keeps the previously set
+  // passes, and returns false.  An empty list removes any custom passes.
+  bool SetOptimizerPasses(const std::vector<std::string>& flags,
+                          std::string* errors);
+
   // Enables or disables HLSL legalization passes.
   void EnableHlslLegalization(bool hlsl_legalization_enabled);
 
+  // Sets whether GLSL is compiled without linking, for a module that will be
+  // linked later with LinkSpirv.  Such a module exports the functions it
+  // defines, imports the functions it only declares, and need not have an
+  // entry point.  It is not optimized; the optimizer runs after linking.
+  // Has no effect on HLSL.
+  void SetCompileOnly(bool compile_only) { compile_only_ = compile_only; }
+
   // Enables or disables extension SPV_GOOGLE_hlsl_functionality1
   void EnableHlslFunctionality1(bool enable);
 
@@ -247,6 +347,12 @@ class Compiler {
   // as a composition of max and min.
   void SetNanClamp(bool enable);
 
+  // Sets the prelude that each GLSL source is compiled with, or none if
+  // prelude is null.  See Prelude.  Has no effect on HLSL.
+  void SetPrelude(std::shared_ptr<Prelude> prelude) {
+    prelude_ = std::move(prelude);
+  }
+
   // When a warning is encountered it treat it as an error.
   void SetWarningsAsErrors();
 
@@ -286,6 +392,12 @@ class Compiler {
   // Returns the current limit.
   int GetLimit(Limit limit) const;
 
+  // Sets a guard on the cost of compilation, or removes it if value is zero.
+  // A compilation that would exceed it fails with an error naming it.
+  void SetGuard(Guard guard, size_t value) {
+    guards_[static_cast<size_t>(guard)] = value;
+  }
+
   // Set whether the compiler automatically assigns bindings to
   // uniform variables that don't have explicit bindings.
   void SetAutoBindUniforms(bool auto_bind) { auto_bind_uniforms_ = auto_bind; }
@@ -319,6 +431,42 @@ class Compiler {
     preserve_bindings_ = preserve_bindings;
   }
 
+  // Sets whether CompilePipeline removes the resources no stage uses, and
+  // renumbers the descriptor sets and bindings in use without gaps.
+  void SetCompactPipelineBindings(bool compact) {
+    compact_pipeline_bindings_ = compact;
+  }
+
+  // Sets the workgroup size of compiled compute, task and mesh shaders.  A
+  // zero component keeps the size the shader declares.  Other stages, and
+  // modules compiled with SetCompileOnly, are not affected, and LinkSpirv
+  // fails while a size is set, since whether the sources of the modules use
+  // gl_WorkGroupSize is not known by then.  See OverrideWorkgroupSize for the
+  // sizes that can be changed.
+  void SetWorkgroupSize(uint32_t x, uint32_t y, uint32_t z) {
+    workgroup_size_.size[0] = x;
+    workgroup_size_.size[1] = y;
+    workgroup_size_.size[2] = z;
+  }
+
+  // Makes the workgroup size of compiled compute, task and mesh shaders
+  // specializable, with the given SpecIds for the components that are not
+  // specialization constants yet.
+  void SetWorkgroupSizeSpecIds(uint32_t x, uint32_t y, uint32_t z) {
+    workgroup_size_.specializable = true;
+    workgroup_size_.spec_ids[0] = x;
+    workgroup_size_.spec_ids[1] = y;
+    workgroup_size_.spec_ids[2] = z;
+  }
+
+  // Adds a uniform block member whose loads are replaced by a constant value
+  // before optimization, so that code and resources depending only on it can
+  // be folded away.  Applies to Compile, CompileWithRecipes and
+  // CompilePipeline.  See BakeUniforms for what can be baked.
+  void AddBakedUniform(BakedUniform uniform) {
+    baked_uniforms_.push_back(std::move(uniform));
+  }
+
   // Sets whether the compiler automatically assigns locations to
   // uniform variables that don't have explicit locations.
   void SetAutoMapLocations(bool auto_map) { auto_map_locations_ = auto_map; }
@@ -364,8 +512,9 @@ class Compiler {
   //
   // The stage_callback function will be called if a shader_stage has
   // not been forced and the stage can not be determined
-  // from the shader text. Any #include directives are parsed with the given
-  // includer.
+  // from the shader text.  If it fails, returning EShLangCount, its messages
+  // make up the error, or a message of its own is written if it gave none.
+  // Any #include directives are parsed with the given includer.
   //
   // The initializer parameter must be a valid GlslangInitializer object.
   // Acquire will be called on the initializer and the result will be
@@ -386,6 +535,31 @@ class Compiler {
   // mode; 3) the size of the output data in bytes. When the output is SPIR-V
   // binary code, the size is the number of bytes of valid data in the vector.
   // If the output is a text string, the size equals the length of that string.
+  //
+  // If uniforms are baked, see AddBakedUniform, and removed_bindings is not
+  // null, it receives the descriptor bindings that were dropped because the
+  // baked values left them unused.  At OptimizationLevel::MinimumSize, if
+  // optimization_stages is not null, it receives the size of the module
+  // before and after each stage of optimization.
+  //
+  // If size_attribution is not null, it receives the words of the SPIR-V
+  // module attributed to functions and source files.  Without debug info, the
+  // source is compiled a second time with it for the line information, which
+  // takes its included files from the first compile rather than the includer;
+  // the module returned and the includer's stats are the same as without
+  // size_attribution.  A module that cannot be attributed gets a warning.
+  //
+  // If cancellation is not null, it is checked between the phases of the
+  // compile and between optimizer passes; the includer should also be
+  // wrapped in a CancellingIncluder.  A compile that it cancels fails with an
+  // error giving its message, and leaves it telling so.
+  //
+  // If diagnostics is not null, each warning and error written to
+  // error_stream is also appended to it.
+  //
+  // If workgroup_size_is_referenced is not null, it receives whether a
+  // compute, task or mesh shader uses gl_WorkGroupSize, which decides how
+  // OverrideWorkgroupSize may change the module's workgroup size.
   std::tuple<bool, std::vector<uint32_t>, size_t> Compile(
       const string_piece& input_source_string, EShLanguage forced_shader_stage,
       const std::string& error_tag, const char* entry_point_name,
@@ -393,8 +567,110 @@ class Compiler {
                                       const string_piece& error_tag)>&
           stage_callback,
       CountingIncluder& includer, OutputType output_type,
-      std::ostream* error_stream, size_t* total_warnings,
-      size_t* total_errors) const;
+      std::ostream* error_stream, size_t* total_warnings, size_t* total_errors,
+      std::vector<DescriptorBinding>* removed_bindings = nullptr,
+      std::vector<OptimizationStage>* optimization_stages = nullptr,
+      SizeAttribution* size_attribution = nullptr,
+      const Cancellation* cancellation = nullptr,
+      std::vector<Diagnostic>* diagnostics = nullptr,
+      bool* workgroup_size_is_referenced = nullptr) const;
+
+  // Like Compile, but runs the front end only once, and then optimizes a copy
+  // of the resulting module for each of the given recipes, in parallel.  Each
+  // recipe replaces this compiler's optimization level and debug info
+  // setting, and its workgroup size if the recipe gives one; passes set with
+  // SetOptimizerPasses run for every recipe.  If any recipe asks for debug
+  // information, the front end generates it, and it is stripped from the
+  // outputs of the recipes that do not ask for it; at OptimizationLevel::Zero
+  // such an output therefore also lacks the names Compile would keep.
+  //
+  // The output_type parameter must be SpirvBinary or SpirvAssemblyText.
+  // Front-end messages are written to error_stream and counted once, and
+  // collected in diagnostics as by Compile.  Returns one output per recipe,
+  // in the same order.  If the front end fails, none of the outputs
+  // succeeds.
+  std::vector<ModuleOutput> CompileWithRecipes(
+      const string_piece& input_source_string, EShLanguage forced_shader_stage,
+      const std::string& error_tag, const char* entry_point_name,
+      const std::function<EShLanguage(std::ostream* error_stream,
+                                      const string_piece& error_tag)>&
+          stage_callback,
+      CountingIncluder& includer,
+      const std::vector<OptimizationRecipe>& recipes, OutputType output_type,
+      std::ostream* error_stream, size_t* total_warnings, size_t* total_errors,
+      std::vector<Diagnostic>* diagnostics = nullptr) const;
+
+  // Compiles the shaders of a graphics pipeline together: all of them are
+  // parsed into one glslang program and linked, so that mismatches between
+  // the stages are reported, and then one module is generated per stage.
+  // Each stage must be given explicitly, at most once.
+  //
+  // After each module is optimized as by Compile, the interfaces between
+  // consecutive stages, from vertex to fragment, are trimmed: outputs the
+  // next stage never reads are removed with the code computing them, and
+  // inputs left unused are dropped.  Then the locations between the last
+  // stage before the fragment shader and the fragment shader are renumbered
+  // without gaps.  See CompactInterfaceLocations for when this is skipped.
+  //
+  // If SetCompactPipelineBindings is on, the resources no stage uses are
+  // removed and the descriptor bindings are renumbered, consistently across
+  // the stages, by AssignPipelineDescriptorBindings.  If descriptor_layout is
+  // not null, it receives the pipeline's descriptor set layout.
+  //
+  // The output_type parameter must be SpirvBinary or SpirvAssemblyText.
+  // Messages are written to error_stream, counted in total_warnings and
+  // total_errors, and collected in diagnostics as by Compile.  Returns one
+  // output per stage, in the same order.  The whole pipeline succeeds or
+  // fails together.
+  std::vector<ModuleOutput> CompilePipeline(
+      const std::vector<PipelineStage>& stages, CountingIncluder& includer,
+      OutputType output_type, std::vector<DescriptorBinding>* descriptor_layout,
+      std::ostream* error_stream, size_t* total_warnings, size_t* total_errors,
+      std::vector<Diagnostic>* diagnostics = nullptr) const;
+
+  // Runs the passes selected by the optimization level and by
+  // SetOptimizerPasses on a SPIR-V module produced earlier by Compile.  HLSL
+  // legalization is not repeated, so the module should come from a compiler
+  // with the same settings, apart from the optimization options.  This
+  // splits a compilation into a quick unoptimized tier and a later optimized
+  // one.  Returns true on success.  Otherwise, writes a message to *errors
+  // and returns false, and *spirv is in an unspecified state.  At
+  // OptimizationLevel::MinimumSize, if stages is not null, the module size
+  // before and after each stage is appended to it.
+  bool OptimizeSpirv(std::vector<uint32_t>* spirv, std::string* errors,
+                     std::vector<OptimizationStage>* stages = nullptr) const;
+
+  // Specializes a SPIR-V module produced earlier by Compile, without
+  // running the front end again.  The specialization constants whose SpecIds
+  // are keys of values get the corresponding values, written as in GLSL
+  // source, and the others keep their defaults.  All of them are then frozen
+  // into ordinary constants and folded, the code they make unreachable is
+  // removed, and the passes selected by the optimization level and by
+  // SetOptimizerPasses run as in OptimizeSpirv.  Returns true on success.
+  // Otherwise, writes a message to *errors and returns false, and *spirv is
+  // in an unspecified state.
+  bool SpecializeSpirv(const std::unordered_map<uint32_t, std::string>& values,
+                       std::vector<uint32_t>* spirv,
+                       std::string* errors) const;
+
+  // Links the given SPIR-V modules, such as modules compiled with
+  // SetCompileOnly, into one module, removes the functions that are no
+  // longer reachable, and then runs the passes selected by the optimization
+  // level and by SetOptimizerPasses.  The linked module is validated before
+  // any pass runs.  Fails if a workgroup size is set, see SetWorkgroupSize.
+  // Returns true and writes the module to *linked on success.  Otherwise,
+  // writes a message to *errors and returns false.
+  bool LinkSpirv(const std::vector<std::vector<uint32_t>>& modules,
+                 std::vector<uint32_t>* linked, std::string* errors) const;
+
+  // Validates a SPIR-V module for this compiler's target environment.  The
+  // optimizer skips validation at OptimizationLevel::FastCompile, and
+  // nothing validates a module at OptimizationLevel::Zero, so a module that
+  // does not come from Compile should be validated before OptimizeSpirv or
+  // SpecializeSpirv.  Returns true if it is valid.  Otherwise, writes the
+  // validator's messages to *errors and returns false.
+  bool ValidateSpirv(const std::vector<uint32_t>& spirv,
+                     std::string* errors) const;
 
   static EShMessages GetDefaultRules() {
     return static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules |
@@ -402,6 +678,47 @@ class Compiler {
   }
 
  protected:
+  // Applies this compiler's settings for the given stage to shader.  The
+  // preamble and the entry point name must outlive the parse.
+  void ConfigureShader(glslang::TShader* shader, EShLanguage stage,
+                       const char* entry_point_name,
+                       const std::string& preamble,
+                       const GlslangClientInfo& client_info) const;
+
+  // Generates the SPIR-V for a parsed and linked stage, bakes the uniforms
+  // added with AddBakedUniform, and optimizes it as requested, unless
+  // compile_only is true.  If removed_bindings is not null, the bindings that
+  // baking left unused are appended to it.  If optimization_stages is not
+  // null, the module sizes measured at OptimizationLevel::MinimumSize are
+  // appended to it.  Returns true on success.
+  // Otherwise, writes the message to *errors and returns false, and sets
+  // *input_at_fault if the input, such as the baked values or the size of
+  // the module, rather than the compiler, is at fault.
+  // See SpirvToolsOptimize for cancellation.
+  bool GenerateSpirv(const glslang::TIntermediate& intermediate,
+                     EShLanguage stage, bool compile_only,
+                     std::vector<uint32_t>* spirv,
+                     std::vector<DescriptorBinding>* removed_bindings,
+                     std::vector<OptimizationStage>* optimization_stages,
+                     bool* input_at_fault, std::string* errors,
+                     const Cancellation* cancellation = nullptr) const;
+
+  // Runs the given optimization passes, followed by any passes set with
+  // SetOptimizerPasses, on *spirv.  Returns true on success.  Otherwise,
+  // writes the optimizer's messages to *errors and returns false.  See
+  // SpirvToolsOptimize for stages and cancellation.
+  bool RunOptimizer(std::vector<PassId> passes, std::vector<uint32_t>* spirv,
+                    std::string* errors,
+                    std::vector<OptimizationStage>* stages = nullptr,
+                    const Cancellation* cancellation = nullptr) const;
+
+  // Returns true if the given GLSL source, once preprocessed, refers to
+  // gl_WorkGroupSize, or if it cannot be preprocessed.
+  bool SourceReferencesWorkgroupSize(const string_piece& source,
+                                     const std::string& error_tag,
+                                     const std::string& preamble,
+                                     CountingIncluder& includer) const;
+
   // Preprocesses a shader whose filename is filename and content is
   // shader_source. If preprocessing is successful, returns true, the
   // preprocessed shader, and any warning message as a tuple. Otherwise,
@@ -422,7 +739,30 @@ class Compiler {
       const std::string& error_tag, const string_piece& shader_source,
       const string_piece& shader_preamble, CountingIncluder& includer) const;
 
-  // Cleans up the preamble in a given preprocessed shader.
+  // Sets the IncludeCount and IncludeBytes guards on the includer, for a new
+  // pass over the source, and starts its include stats afresh from the given
+  // stats of the prelude's includes, which the pass does not read again.
+  void ApplyIncludeGuards(
+      CountingIncluder& includer,
+      const std::map<std::string, CountingIncluder::IncludeStats>&
+          prelude_include_stats = {}) const;
+
+  // Writes the given source to *spliced with the prelude set by SetPrelude
+  // spliced in.  The prelude is first prepared with the given preamble and
+  // includer unless it already was for the same options and #version.
+  // Returns true on success, leaving *spliced empty if there is no prelude
+  // or the source language is not GLSL.  Otherwise, writes the messages of
+  // the preprocessor to *errors and returns false.  If include_stats is not
+  // null, it receives the stats of the prelude's includes from when it was
+  // prepared, which must have been at the start of a pass, after
+  // ApplyIncludeGuards.
+  bool ApplyPrelude(const string_piece& source, const std::string& error_tag,
+                    const std::string& preamble, CountingIncluder& includer,
+                    std::string* spliced, std::string* errors,
+                    std::map<std::string, CountingIncluder::IncludeStats>*
+                        include_stats = nullptr) const;
+
+  // Cleans up the preamble in a given preprocessed shader, in place.
   //
   // The error_tag parameter is the name to be given for the main file.
   // The pound_extension parameter is the #extension directive we prepended to
@@ -436,37 +776,42 @@ class Compiler {
   // delete the #extension directive we injected via preamble. Otherwise, we
   // need to adjust it if there exists a #version directive in the original
   // shader source code.
-  std::string CleanupPreamble(const string_piece& preprocessed_shader,
-                              const string_piece& error_tag,
-                              const string_piece& pound_extension,
-                              int num_include_directives,
-                              bool is_for_next_line) const;
+  void CleanupPreamble(std::string* preprocessed_shader,
+                       const string_piece& error_tag,
+                       const string_piece& pound_extension,
+                       int num_include_directives,
+                       bool is_for_next_line) const;
 
   // Determines version and profile from command line, or the source code.
   // Returns the decoded version and profile pair on success. Otherwise,
   // returns (0, ENoProfile).
   std::pair<int, EProfile> DeduceVersionProfile(
-      const std::string& preprocessed_shader) const;
+      const string_piece& preprocessed_shader) const;
 
   // Determines the shader stage from pragmas embedded in the source text if
   // possible. In the returned pair, the glslang EShLanguage is the shader
   // stage deduced. If no #pragma directives for shader stage exist, it's
   // EShLangCount.  If errors occur, the second element in the pair is the
-  // error message.  Otherwise, it's an empty string.
+  // error message, one line for each error, and each error is also appended
+  // to diagnostics unless it is null.  Otherwise, it's an empty string.
+  // is_for_next_line is true if a #line directive numbers the line after it
+  // rather than itself, as it does for the version of the source.
   std::pair<EShLanguage, std::string> GetShaderStageFromSourceCode(
-      string_piece filename, const std::string& preprocessed_shader) const;
+      string_piece filename, const std::string& preprocessed_shader,
+      bool is_for_next_line,
+      std::vector<Diagnostic>* diagnostics = nullptr) const;
 
   // Determines version and profile from command line, or the source code.
   // Returns the decoded version and profile pair on success. Otherwise,
   // returns (0, ENoProfile).
   std::pair<int, EProfile> DeduceVersionProfile(
-      const std::string& preprocessed_shader);
+      const string_piece& preprocessed_shader);
 
   // Gets version and profile specification from the given preprocessedshader.
   // Returns the decoded version and profile pair on success. Otherwise,
   // returns (0, ENoProfile).
   std::pair<int, EProfile> GetVersionProfileFromSourceCode(
-      const std::string& preprocessed_shader) const;
+      const string_piece& preprocessed_shader) const;
 
   // Version to use when force_version_profile_ is true.
   int default_version_;
@@ -490,6 +835,13 @@ class Compiler {
   // Optimization passes to be applied.
   std::vector<PassId> enabled_opt_passes_;
 
+  // The profile selecting the passes of OptimizationLevel::Performance.
+  OptimizationProfile optimization_profile_ = OptimizationProfile::Generic;
+
+  // Validated spirv-opt flags for custom passes, run after
+  // enabled_opt_passes_.
+  std::vector<std::string> opt_pass_flags_;
+
   // The target environment to compile with. This controls the glslang
   // EshMessages bitmask, which determines which dialect of GLSL and which
   // SPIR-V codegen semantics are used. This impacts the warning & error
@@ -514,6 +866,9 @@ class Compiler {
   // The resource limits to be used.
   TBuiltInResource limits_;
 
+  // The value of each Guard, or zero if it is not set.
+  std::array<size_t, kNumGuards> guards_{};
+
   // True if the compiler should automatically bind uniforms that don't
   // have explicit bindings.
   bool auto_bind_uniforms_;
@@ -534,6 +889,15 @@ class Compiler {
   // True if the compiler should preserve all bindings, even when unused.
   bool preserve_bindings_;
 
+  // True if CompilePipeline renumbers the descriptor bindings of a pipeline.
+  bool compact_pipeline_bindings_ = false;
+
+  // The uniform block members baked into compiled modules.
+  std::vector<BakedUniform> baked_uniforms_;
+
+  // How to change the workgroup size of compiled modules.
+  WorkgroupSizeOverride workgroup_size_;
+
   // True if the compiler should use HLSL IO mapping rules when compiling HLSL.
   bool hlsl_iomap_;
 
@@ -559,12 +923,18 @@ class Compiler {
   // True if the compiler should invert position.Y output in vertex shader.
   bool invert_y_enabled_;
 
+  // True if GLSL is compiled without linking, to be linked by LinkSpirv.
+  bool compile_only_ = false;
+
   // True if the compiler generates code for max and min builtins which,
   // if given a NaN operand, will return the other operand.  Also, the clamp
   // builtin will favour the non-NaN operands, as if clamp were implemented
   // as a composition of max and min.
   bool nan_clamp_;
 
+  // The prelude of GLSL sources, shared by the copies of this compiler.
+  std::shared_ptr<Prelude> prelude_;
+
   // A sequence of triples, each triple representing a specific HLSL register
   // name, and the set and binding numbers it should be mapped to, but in
   // the form of strings.  This is how Glslang wants to consume the data.
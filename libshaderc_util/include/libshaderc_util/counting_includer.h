@@ -16,6 +16,11 @@
 #define LIBSHADERC_UTIL_COUNTING_INCLUDER_H
 
 #include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include "glslang/Public/ShaderLang.h"
 
@@ -23,9 +28,9 @@
 
 namespace shaderc_util {
 
-// An Includer that counts how many #include directives it saw.
-// Inclusions are internally serialized, but releasing a previous result
-// can occur concurrently.
+// An Includer that counts how many #include directives it saw, and what each
+// included file cost.  Inclusions are internally serialized, but releasing a
+// previous result can occur concurrently.
 class CountingIncluder : public glslang::TShader::Includer {
  public:
   // Done as .store(0) instead of in the initializer list for the following
@@ -42,6 +47,18 @@ class CountingIncluder : public glslang::TShader::Includer {
     Local,   // Only do " " include search
   };
 
+  // What one file cost to include, summed over each time it was included.
+  struct IncludeStats {
+    // The number of times the file was included.
+    int count = 0;
+    // The bytes of source it supplied.
+    size_t bytes = 0;
+    // The time from asking for the file until glslang released it, which
+    // covers resolving, preprocessing and parsing the file and the files it
+    // includes in turn.
+    std::chrono::nanoseconds time{0};
+  };
+
   // Resolves an include request for a source by name, type, and name of the
   // requesting source.  For the semantics of the result, see the base class.
   // Also increments num_include_directives and returns the results of
@@ -50,34 +67,125 @@ class CountingIncluder : public glslang::TShader::Includer {
   glslang::TShader::Includer::IncludeResult* includeSystem(
       const char* requested_source, const char* requesting_source,
       size_t include_depth) final {
-    ++num_include_directives_;
-    include_mutex_.lock();
-    auto result = include_delegate(requested_source, requesting_source,
-                                   IncludeType::System, include_depth);
-    include_mutex_.unlock();
-    return result;
+    return Include(requested_source, requesting_source, IncludeType::System,
+                   include_depth);
   }
 
   // Like includeSystem, but for "local" include search.
   glslang::TShader::Includer::IncludeResult* includeLocal(
       const char* requested_source, const char* requesting_source,
       size_t include_depth) final {
-    ++num_include_directives_;
-    include_mutex_.lock();
-    auto result = include_delegate(requested_source, requesting_source,
-                                   IncludeType::Local, include_depth);
-    include_mutex_.unlock();
-    return result;
+    return Include(requested_source, requesting_source, IncludeType::Local,
+                   include_depth);
   }
 
   // Releases the given IncludeResult.
   void releaseInclude(glslang::TShader::Includer::IncludeResult* result) final {
+    if (result && result->userData == this) {
+      // A request refused by SetLimits, which never reached the delegate.
+      delete[] result->headerData;
+      delete result;
+      return;
+    }
+    RecordRelease(result);
     release_delegate(result);
   }
 
+  // Limits the includes resolved from now on to max_includes files and
+  // max_bytes bytes of source in total, where zero means no limit, and starts
+  // counting them afresh.  A request past either limit fails, with a message
+  // saying which limit it exceeded, and a file that would exceed max_bytes is
+  // released unused.
+  void SetLimits(size_t max_includes, size_t max_bytes) {
+    const std::lock_guard<shaderc_util::mutex> lock(include_mutex_);
+    max_includes_ = max_includes;
+    max_bytes_ = max_bytes;
+    limited_includes_ = 0;
+    limited_bytes_ = 0;
+  }
+
   int num_include_directives() const { return num_include_directives_.load(); }
 
+  // Replaces the stats of the files included so far with the given ones, for
+  // a new pass over the source.
+  void ResetIncludeStats(
+      const std::map<std::string, IncludeStats>& stats = {}) {
+    const std::lock_guard<shaderc_util::mutex> lock(stats_mutex_);
+    include_stats_ = stats;
+    pending_includes_.clear();
+  }
+
+  // Returns the stats of every file included so far, keyed by its resolved
+  // name.  A file that is still being processed has its count and bytes but
+  // not yet its time.  Requests that failed to resolve are not recorded.
+  std::map<std::string, IncludeStats> include_stats() const {
+    const std::lock_guard<shaderc_util::mutex> lock(stats_mutex_);
+    return include_stats_;
+  }
+
  private:
+  // Resolves a request with include_delegate, within the limits set by
+  // SetLimits.
+  glslang::TShader::Includer::IncludeResult* Include(
+      const char* requested_source, const char* requesting_source,
+      IncludeType type, size_t include_depth) {
+    ++num_include_directives_;
+    const auto start = std::chrono::steady_clock::now();
+    glslang::TShader::Includer::IncludeResult* result = nullptr;
+    {
+      const std::lock_guard<shaderc_util::mutex> lock(include_mutex_);
+      if (max_includes_ && limited_includes_ >= max_includes_) {
+        return LimitFailure("exceeded the limit of " +
+                            std::to_string(max_includes_) + " includes");
+      }
+      result = include_delegate(requested_source, requesting_source, type,
+                                include_depth);
+      if (result && !result->headerName.empty()) {
+        ++limited_includes_;
+        limited_bytes_ += result->headerLength;
+        if (max_bytes_ && limited_bytes_ > max_bytes_) {
+          release_delegate(result);
+          return LimitFailure("exceeded the limit of " +
+                              std::to_string(max_bytes_) +
+                              " bytes of included source");
+        }
+      }
+    }
+    RecordInclude(result, start);
+    return result;
+  }
+
+  // Returns a failed result with the given message as its contents, marked
+  // as this includer's own by its user data.
+  glslang::TShader::Includer::IncludeResult* LimitFailure(
+      const std::string& message) {
+    char* contents = new char[message.size()];
+    message.copy(contents, message.size());
+    return new glslang::TShader::Includer::IncludeResult(
+        "", contents, message.size(), this);
+  }
+
+  // Records the count and bytes of a resolved file, and when it was asked
+  // for, so that its release can record its time.
+  void RecordInclude(glslang::TShader::Includer::IncludeResult* result,
+                     std::chrono::steady_clock::time_point start) {
+    if (!result || result->headerName.empty()) return;
+    const std::lock_guard<shaderc_util::mutex> lock(stats_mutex_);
+    IncludeStats& stats = include_stats_[result->headerName];
+    ++stats.count;
+    stats.bytes += result->headerLength;
+    pending_includes_[result] = start;
+  }
+
+  // Adds the time since the given result was asked for to its file.
+  void RecordRelease(glslang::TShader::Includer::IncludeResult* result) {
+    const std::lock_guard<shaderc_util::mutex> lock(stats_mutex_);
+    auto pending = pending_includes_.find(result);
+    if (pending == pending_includes_.end()) return;
+    include_stats_[result->headerName].time +=
+        std::chrono::steady_clock::now() - pending->second;
+    pending_includes_.erase(pending);
+  }
 
   // Invoked by this class to provide results to
   // glslang::TShader::Includer::include.
@@ -95,6 +203,23 @@ class CountingIncluder : public glslang::TShader::Includer {
   // A mutex to protect against concurrent inclusions.  We can't trust
   // our delegates to be safe for concurrent inclusions.
   shaderc_util::mutex include_mutex_;
+
+  // The limits set by SetLimits, and the includes and bytes counted against
+  // them, all guarded by include_mutex_.
+  size_t max_includes_ = 0;
+  size_t max_bytes_ = 0;
+  size_t limited_includes_ = 0;
+  size_t limited_bytes_ = 0;
+
+  // Guards include_stats_ and pending_includes_, which releases update
+  // concurrently with inclusions.
+  mutable shaderc_util::mutex stats_mutex_;
+  // The stats of each included file, by resolved name.
+  std::map<std::string, IncludeStats> include_stats_;
+  // When each result not yet released was asked for.
+  std::unordered_map<glslang::TShader::Includer::IncludeResult*,
+                     std::chrono::steady_clock::time_point>
+      pending_includes_;
 };
 }
 
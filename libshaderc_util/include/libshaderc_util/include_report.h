@@ -0,0 +1,40 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_INCLUDE_REPORT_H
+#define LIBSHADERC_UTIL_INC_INCLUDE_REPORT_H
+
+#include <map>
+#include <string>
+
+#include "libshaderc_util/counting_includer.h"
+#include "libshaderc_util/spirv_size.h"
+
+namespace shaderc_util {
+
+// Returns what each file included by a module cost, as a JSON object with an
+// "includes" array holding one file per line, from the slowest down.  Each
+// file has its resolved name, how many times it was included, the bytes it
+// supplied, the microseconds spent on it, and the words of function code it
+// contributed to the final module according to attribution.  A file with no
+// words contributed nothing that survived into the module, though it may
+// still hold macros or types used elsewhere.  If attribution has no line
+// information, the words are null.
+std::string IncludeReportToJson(
+    const std::map<std::string, CountingIncluder::IncludeStats>& stats,
+    const SizeAttribution& attribution);
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_INCLUDE_REPORT_H
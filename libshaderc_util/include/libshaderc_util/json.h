@@ -0,0 +1,57 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_JSON_H_
+#define LIBSHADERC_UTIL_JSON_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libshaderc_util/string_piece.h"
+
+namespace shaderc_util {
+
+// Returns value as a quoted JSON string, with quotes, backslashes and
+// control characters escaped.
+std::string QuoteJson(const string_piece& value);
+
+// A JSON value, as far as the reports glslc reads back need.  Numbers other
+// than non-negative integers, and the literals true and false, are read but
+// their values are not kept.
+struct JsonValue {
+  enum class Kind { Null, String, Number, Array, Object, Other };
+  Kind kind = Kind::Null;
+  std::string string;
+  uint64_t number = 0;
+  std::vector<JsonValue> items;
+  std::vector<std::pair<std::string, JsonValue>> members;
+
+  // Returns the member of an object with the given name, or nullptr.
+  const JsonValue* Find(const std::string& name) const {
+    for (const auto& member : members) {
+      if (member.first == name) return &member.second;
+    }
+    return nullptr;
+  }
+};
+
+// Parses text as one JSON value into *value.  Returns false, and the offset
+// at which reading stopped in *error_offset, if the text is not valid JSON.
+bool ParseJson(const std::string& text, JsonValue* value, size_t* error_offset);
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_JSON_H_
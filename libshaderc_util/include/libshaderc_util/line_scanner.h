@@ -0,0 +1,80 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_LINE_SCANNER_H
+#define LIBSHADERC_UTIL_INC_LINE_SCANNER_H
+
+#include <cassert>
+#include <cstring>
+
+#include "libshaderc_util/string_piece.h"
+
+namespace shaderc_util {
+
+// Returns the position of the first character c in text at or after pos, or
+// string_piece::npos if there is none.  Uses memchr, which C libraries
+// implement with vector instructions, so long runs of text without c are
+// skipped many bytes at a time.
+inline size_t FindByte(const string_piece& text, char c, size_t pos = 0) {
+  if (pos >= text.size()) return string_piece::npos;
+  const void* found = memchr(text.data() + pos, c, text.size() - pos);
+  return found ? static_cast<const char*>(found) - text.data()
+               : string_piece::npos;
+}
+
+// Returns the position of the first line of text that starts with prefix,
+// which must start with '#', or string_piece::npos if there is none.  As in
+// preprocessed source, the '#' must be the first character of the line.
+inline size_t FindLineStartingWith(const string_piece& text,
+                                   const string_piece& prefix) {
+  assert(!prefix.empty() && prefix.front() == '#');
+  for (size_t pound = FindByte(text, '#'); pound != string_piece::npos;
+       pound = FindByte(text, '#', pound + 1)) {
+    if ((pound == 0 || text.data()[pound - 1] == '\n') &&
+        text.substr(pound).starts_with(prefix)) {
+      return pound;
+    }
+  }
+  return string_piece::npos;
+}
+
+// Iterates over the lines of a text, one at a time, without copying them or
+// storing them all.  Each line keeps its newline, if it has one.  A text
+// that ends with a newline has no empty line after it.
+class LineScanner {
+ public:
+  explicit LineScanner(const string_piece& text) : rest_(text) {}
+
+  // Sets *line to the next line and returns true, or returns false once
+  // every line has been read.
+  bool Next(string_piece* line) {
+    if (rest_.empty()) return false;
+    const size_t newline = FindByte(rest_, '\n');
+    const size_t length =
+        newline == string_piece::npos ? rest_.size() : newline + 1;
+    *line = rest_.substr(0, length);
+    rest_ = rest_.substr(length);
+    return true;
+  }
+
+  // Returns the text after the lines read so far.
+  const string_piece& rest() const { return rest_; }
+
+ private:
+  string_piece rest_;
+};
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_LINE_SCANNER_H
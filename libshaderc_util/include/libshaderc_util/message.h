@@ -15,6 +15,10 @@
 #ifndef LIBSHADERC_UTIL_SRC_MESSAGE_H_
 #define LIBSHADERC_UTIL_SRC_MESSAGE_H_
 
+#include <ostream>
+#include <string>
+#include <vector>
+
 #include "libshaderc_util/string_piece.h"
 
 namespace shaderc_util {
@@ -62,19 +66,45 @@ MessageType ParseGlslangOutput(const shaderc_util::string_piece& message,
                                shaderc_util::string_piece* line_number,
                                shaderc_util::string_piece* rest);
 
+// A warning or an error reported by a compilation, as written to its
+// messages: "<file>:<line>: error: <message>", or without the line for a
+// message about a whole file.
+struct Diagnostic {
+  // True for an error, false for a warning.
+  bool is_error = false;
+  // The file, or the tool for an internal error, such as "shaderc".
+  std::string file;
+  // The line, or zero if there is none.
+  int line = 0;
+  // The message, which may span several lines.
+  std::string message;
+};
+
+// Appends a diagnostic with the given fields to *diagnostics, unless
+// diagnostics is null.  Whitespace around the message is dropped.
+void AddDiagnostic(std::vector<Diagnostic>* diagnostics, bool is_error,
+                   const string_piece& file, int line,
+                   const string_piece& message);
+
 // Filters error_messages received from glslang, and outputs, to error_stream,
 // any that are not ignored in a clang like format. If the warnings_as_errors
 // boolean is set, then all warnings will be treated as errors. If the
 // suppress_warnings boolean is set then any warning messages are ignored. This
 // takes precedence over warnings_as_errors. Increments total_warnings and
-// total_errors based on the message types.
+// total_errors based on the message types.  If diagnostics is not null, each
+// warning and error written is also appended to it.
 // Returns true if no new errors were found when parsing the messages.
 // "<command line>" will substitute "-1" appearing at the string name/number
 // segment.
 bool PrintFilteredErrors(const shaderc_util::string_piece& file_name,
                          std::ostream* error_stream, bool warnings_as_errors,
                          bool suppress_warnings, const char* error_list,
-                         size_t* total_warnings, size_t* total_errors);
+                         size_t* total_warnings, size_t* total_errors,
+                         std::vector<Diagnostic>* diagnostics = nullptr);
+
+// Writes the diagnostic to out as a JSON object, on one line, with its
+// "severity", "file", "line" (null if there is none) and "message".
+void WriteDiagnosticJson(const Diagnostic& diagnostic, std::ostream* out);
 
 // Outputs, to error_stream,  the number of warnings and errors if there are
 // any.
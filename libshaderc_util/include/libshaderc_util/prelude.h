@@ -0,0 +1,141 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_PRELUDE_H
+#define LIBSHADERC_UTIL_INC_PRELUDE_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libshaderc_util/counting_includer.h"
+#include "libshaderc_util/mutex.h"
+#include "libshaderc_util/string_piece.h"
+
+namespace shaderc_util {
+
+// A prefix that many GLSL shaders share, such as a long list of common
+// includes.  Each source compiled with a prelude is treated as if it included
+// the prelude right after its #version directive and the #extension and
+// #pragma directives that follow it.
+//
+// Glslang cannot resume from a saved preprocessor state, so the prelude is
+// instead preprocessed once for each set of options and #version it is used
+// with.  The preprocessed text, followed by the #define and #undef directives
+// that were in effect at its end, is spliced into each source.  A compile
+// then spends no time resolving, reading or preprocessing the prelude and
+// its includes, only scanning its preprocessed text.  The included files are
+// read when a version of the prelude is first prepared, and not again.
+//
+// A Prelude is safe to share between threads.
+class Prelude {
+ public:
+  Prelude(std::string source, std::string name);
+
+  const std::string& source() const { return source_; }
+  const std::string& name() const { return name_; }
+  // A hash of the name and source, by which a changed prelude is told apart.
+  uint64_t hash() const { return hash_; }
+
+  // Looks up the prepared text stored for the given key, which identifies the
+  // options and version it was prepared with.  Returns true and sets
+  // *prepared, and *include_stats if it is not null, if there is one.
+  bool FindPrepared(const std::string& key, std::string* prepared,
+                    std::map<std::string, CountingIncluder::IncludeStats>*
+                        include_stats = nullptr) const;
+
+  // Stores the prepared text for the given key, with the stats of the files
+  // included while preparing it.
+  void StorePrepared(
+      const std::string& key, const std::string& prepared,
+      const std::map<std::string, CountingIncluder::IncludeStats>&
+          include_stats = {});
+
+ private:
+  const std::string source_;
+  const std::string name_;
+  const uint64_t hash_;
+
+  mutable shaderc_util::mutex mutex_;
+  // The prepared text and include stats for each key, guarded by mutex_.
+  std::map<std::string,
+           std::pair<std::string,
+                     std::map<std::string, CountingIncluder::IncludeStats>>>
+      prepared_;
+};
+
+// Returns text with a marker line, and then a #line directive restoring the
+// line number, after each #define and #undef directive, and a #line directive
+// after each #elif, #else and #endif, so that preprocessing the result keeps
+// the line numbers of text.  The marker names the index in *directives where
+// the directive, including its continuation lines, is appended.  Markers
+// that survive preprocessing show which directives took effect.  The #line
+// directives follow the GLSL 330 semantics if is_for_next_line is true.
+std::string MarkMacroDirectives(const string_piece& text, bool is_for_next_line,
+                                std::vector<std::string>* directives);
+
+// Returns the preprocessed output of a prelude marked by MarkMacroDirectives
+// as the text to splice into sources.  The lines up to the given #extension
+// line and the #version line after it, which came from the preamble and
+// version used to prepare the prelude, are dropped.  The markers are removed,
+// and the directives they name are appended in order.
+std::string FinishPrelude(const string_piece& preprocessed,
+                          const string_piece& pound_extension,
+                          const std::vector<std::string>& directives);
+
+// Returns the position of the line of source holding its #version directive,
+// or string_piece::npos if there is none.  Only whitespace may come before
+// the directive on its line, so text such as comments that mention #version
+// is not mistaken for it.
+size_t FindVersionDirective(const string_piece& source);
+
+// Returns source with a prepared prelude spliced in after its #version
+// directive and the #extension and #pragma directives that follow it, or at
+// its start if it has no #version directive.  The prelude is preceded by a
+// #line directive naming prelude_name, and followed by one restoring the
+// lines of source, named error_tag.
+std::string SplicePrelude(const string_piece& source,
+                          const string_piece& prepared,
+                          const std::string& prelude_name,
+                          const std::string& error_tag, bool is_for_next_line);
+
+// An includer that marks the macro directives of each file it includes with
+// MarkMacroDirectives, resolving and releasing the files with another
+// includer.
+class MacroMarkingIncluder : public CountingIncluder {
+ public:
+  MacroMarkingIncluder(CountingIncluder& includer, bool is_for_next_line,
+                       std::vector<std::string>* directives)
+      : includer_(includer),
+        is_for_next_line_(is_for_next_line),
+        directives_(directives) {}
+
+ private:
+  glslang::TShader::Includer::IncludeResult* include_delegate(
+      const char* requested_source, const char* requesting_source,
+      IncludeType type, size_t include_depth) override;
+
+  void release_delegate(
+      glslang::TShader::Includer::IncludeResult* result) override;
+
+  CountingIncluder& includer_;
+  const bool is_for_next_line_;
+  std::vector<std::string>* directives_;
+};
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_PRELUDE_H
@@ -0,0 +1,72 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_SPIRV_COST_H
+#define LIBSHADERC_UTIL_INC_SPIRV_COST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaderc_util {
+
+// Static metrics estimating the work a SPIR-V module does, computed without
+// running it.  They are meant for comparing two builds of the same shader,
+// not two different shaders, and not for predicting time on a given GPU.
+struct ShaderCost {
+  // The metrics of one entry point.  Functions it calls are counted once per
+  // call site, as if they were inlined.
+  struct EntryPoint {
+    std::string name;
+    // The stage, named as in reflection, e.g. "vertex", or "compute".
+    std::string stage;
+    // Arithmetic, logical, comparison, bit, conversion and derivative
+    // instructions, and extended instructions that are not transcendental.
+    uint64_t alu = 0;
+    // Trigonometric, exponential, logarithm and square root extended
+    // instructions.
+    uint64_t transcendental = 0;
+    // Image sample, fetch, gather, read and write instructions.
+    uint64_t texture = 0;
+    // Loads, stores, copies and atomics on memory other than Function and
+    // Private variables, which usually live in registers.
+    uint64_t memory = 0;
+    // Conditional branches and switches.
+    uint64_t branches = 0;
+    uint64_t loops = 0;
+    // An estimate of the most values live at once in any function the entry
+    // point runs, a hint of register pressure.
+    uint64_t max_live_ids = 0;
+    // The ALU, transcendental, texture and memory instructions, each
+    // multiplied by 8 for every loop around it, as if every loop ran eight
+    // times.
+    uint64_t weighted_ops = 0;
+  };
+
+  // In the order of the OpEntryPoint instructions.
+  std::vector<EntryPoint> entry_points;
+};
+
+// Computes the static cost metrics of each entry point of a SPIR-V module
+// into *cost.  Returns true on success.  Otherwise, writes a message to
+// *errors and returns false.
+bool AnalyzeSpirvCost(const std::vector<uint32_t>& spirv, ShaderCost* cost,
+                      std::string* errors);
+
+// Returns the cost metrics as a JSON object, one entry point per line.
+std::string CostToJson(const ShaderCost& cost);
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_SPIRV_COST_H
@@ -0,0 +1,181 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_SPIRV_INTERFACE_H
+#define LIBSHADERC_UTIL_INC_SPIRV_INTERFACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaderc_util {
+
+// The kinds of descriptor a resource variable can need.
+enum class DescriptorType {
+  Sampler,
+  CombinedImageSampler,
+  SampledImage,
+  StorageImage,
+  UniformTexelBuffer,
+  StorageTexelBuffer,
+  UniformBuffer,
+  StorageBuffer,
+  InputAttachment,
+  AccelerationStructure,
+};
+
+// One binding of a pipeline's descriptor set layout.
+struct DescriptorBinding {
+  uint32_t set;
+  uint32_t binding;
+  DescriptorType type;
+  // The array length, 1 for a single descriptor, or 0 for a runtime array.
+  uint32_t count;
+  // The stage flags, as in VkShaderStageFlags, of the stages using it.
+  uint32_t stage_flags;
+};
+
+// Collects the descriptor bindings that the given modules of a pipeline
+// declare, whose stages are given by stage_flags, into *layout, sorted by set
+// and binding.  A resource used by several stages appears once.  If compact
+// is true, first renumbers the sets in use, and the bindings in use within
+// each set, from zero without gaps, keeping their order, and rewrites the
+// modules to match.  Returns true on success.  Otherwise, writes a message to
+// *errors and returns false, and the modules are unchanged.
+bool AssignPipelineDescriptorBindings(
+    const std::vector<std::vector<uint32_t>*>& modules,
+    const std::vector<uint32_t>& stage_flags, bool compact,
+    std::vector<DescriptorBinding>* layout, std::string* errors);
+
+// Renumbers the Location decorations of the user-defined outputs of producer
+// and of the user-defined inputs of consumer, so that the locations in use
+// are packed from zero, in their original order.  Both modules are changed
+// the same way, so the stages still match.  The producer must be a vertex,
+// tessellation evaluation or geometry shader, and the consumer a fragment
+// shader, so that neither side of the interface is arrayed per vertex.
+//
+// Interfaces that use Component decorations, Location decorations on block
+// members, or variables of the two stages that overlap without matching are
+// left alone.  Returns true if any location changed.
+bool CompactInterfaceLocations(std::vector<uint32_t>* producer,
+                               std::vector<uint32_t>* consumer);
+
+// What a SPIR-V module exposes to the application that runs it.
+struct ShaderReflection {
+  struct EntryPoint {
+    std::string name;
+    // The stage, named as in the -fshader-stage option of glslc, e.g.
+    // "vertex", or "compute".
+    std::string stage;
+    // The workgroup size, or zeros if the stage has none.
+    uint32_t workgroup_size[3];
+  };
+  struct Resource {
+    std::string name;
+    uint32_t set;
+    uint32_t binding;
+    DescriptorType type;
+    // The array length, 1 for a single descriptor, or 0 for a runtime array.
+    uint32_t count;
+  };
+  struct PushConstantBlock {
+    std::string name;
+    // The size in bytes, up to the end of the last member.
+    uint32_t size;
+  };
+  struct SpecConstant {
+    std::string name;
+    uint32_t spec_id;
+    // "bool", or "int", "uint" or "float" followed by the width in bits.
+    std::string type;
+    // The default value as a JSON literal, or "null" if it is not known.
+    std::string default_value;
+  };
+  struct InterfaceVariable {
+    std::string name;
+    uint32_t location;
+    uint32_t component;
+  };
+
+  std::vector<EntryPoint> entry_points;
+  // Sorted by set and then binding.
+  std::vector<Resource> resources;
+  std::vector<PushConstantBlock> push_constants;
+  // Sorted by SpecId.
+  std::vector<SpecConstant> spec_constants;
+  // The user-defined inputs and outputs, sorted by location.
+  std::vector<InterfaceVariable> inputs;
+  std::vector<InterfaceVariable> outputs;
+};
+
+// Returns the name of a SPIR-V execution model as used for the stage of an
+// entry point, e.g. "vertex" or "compute", or "unknown".
+const char* GetExecutionModelName(uint32_t model);
+
+// Collects the reflection data of a SPIR-V module into *reflection.  Names
+// come from OpName, so they are empty in a module stripped of debug names.
+// Returns true on success.  Otherwise, writes a message to *errors and
+// returns false.
+bool ReflectSpirv(const std::vector<uint32_t>& spirv,
+                  ShaderReflection* reflection, std::string* errors);
+
+// Returns the reflection data as a JSON object, one array element per line.
+std::string ReflectionToJson(const ShaderReflection& reflection);
+
+// A member of a uniform block with a value fixed at compile time.
+struct BakedUniform {
+  // The block's type name, or its instance name.
+  std::string block;
+  std::string member;
+  // The value as written in GLSL, with vector components separated by
+  // commas, e.g. "0.5" or "1,0,0".
+  std::string value;
+};
+
+// Replaces every load of a baked uniform member, or of one component of it,
+// by a constant holding its value, so that the optimizer can fold it.
+// Only members of Uniform and PushConstant blocks whose type is a 32-bit
+// scalar or vector can be baked.  Members that the module does not declare
+// are ignored.  Returns true on success.  Otherwise, writes a message to
+// *errors and returns false, and the module is unchanged.
+bool BakeUniforms(const std::vector<BakedUniform>& uniforms,
+                  std::vector<uint32_t>* spirv, std::string* errors);
+
+// How to change the workgroup size of a compute, task or mesh shader.
+struct WorkgroupSizeOverride {
+  // The new size.  A zero component keeps the size the shader declares.
+  uint32_t size[3] = {0, 0, 0};
+  // If true, every component of the size becomes the default value of a
+  // specialization constant, so that it can still be changed when the
+  // pipeline is created.  Components that are not specialization constants
+  // yet get the SpecIds in spec_ids; the others keep theirs.
+  bool specializable = false;
+  uint32_t spec_ids[3] = {0, 0, 0};
+};
+
+// Changes the workgroup size of the entry points of a module as described by
+// size_override.  The front end folds the components of gl_WorkGroupSize
+// that are not specialization constants into the code using them, so if
+// size_is_referenced tells that the source uses gl_WorkGroupSize, changing
+// such a component, or making it specializable, is an error.  A module
+// without a workgroup size, or one given with LocalSizeId, is an error too.
+// Returns true on success.  Otherwise, writes a message to *errors and
+// returns false, and the module is unchanged.
+bool OverrideWorkgroupSize(const WorkgroupSizeOverride& size_override,
+                           bool size_is_referenced,
+                           std::vector<uint32_t>* spirv, std::string* errors);
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_SPIRV_INTERFACE_H
@@ -0,0 +1,61 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_SPIRV_SIZE_H
+#define LIBSHADERC_UTIL_INC_SPIRV_SIZE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaderc_util {
+
+// Where the words of a SPIR-V module come from.  Debug instructions are not
+// counted anywhere, so the counts describe the module once it is stripped.
+struct SizeAttribution {
+  // A function or a source file, and the words attributed to it.
+  struct Contributor {
+    std::string name;
+    uint64_t words = 0;
+  };
+
+  // All the words counted: the declarations and every function.
+  uint64_t total_words = 0;
+  // The header, capabilities, decorations, types, constants and global
+  // variables.
+  uint64_t declaration_words = 0;
+  // Every function, named by its OpName, or as "%<id>" without one, from
+  // the largest down.
+  std::vector<Contributor> functions;
+  // The source files that the words of functions come from, as named by
+  // OpString and given by OpLine, from the largest down.  An instruction
+  // with no line is attributed to the file of the first line in its
+  // function.  Functions without any line are attributed to a file with an
+  // empty name.
+  std::vector<Contributor> files;
+};
+
+// Attributes the words of a SPIR-V module to its functions and, through its
+// line information, to source files, into *attribution.  Returns true on
+// success.  Otherwise, writes a message to *errors and returns false.
+bool AttributeSpirvSize(const std::vector<uint32_t>& spirv,
+                        SizeAttribution* attribution, std::string* errors);
+
+// Returns the attribution as a JSON object, one contributor per line.  A file
+// with an empty name is written with a null name.
+std::string SizeAttributionToJson(const SizeAttribution& attribution);
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_SPIRV_SIZE_H
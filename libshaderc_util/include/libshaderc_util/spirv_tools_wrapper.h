@@ -16,10 +16,13 @@
 #define LIBSHADERC_UTIL_INC_SPIRV_TOOLS_WRAPPER_H
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "spirv-tools/libspirv.hpp"
 
+#include "libshaderc_util/cancellation.h"
 #include "libshaderc_util/compiler.h"
 #include "libshaderc_util/string_piece.h"
 
@@ -40,6 +43,50 @@ bool SpirvToolsDisassemble(Compiler::TargetEnv env,
                            const std::vector<uint32_t>& binary,
                            std::string* text_or_error);
 
+// Links the given SPIR-V modules into a single module.  Every import must be
+// resolved by an export of another module.  Returns true and writes the
+// linked module to *linked if successful.  Otherwise, writes the error
+// message to *errors.
+bool SpirvToolsLink(Compiler::TargetEnv env,
+                    Compiler::TargetEnvVersion version,
+                    const std::vector<std::vector<uint32_t>>& modules,
+                    std::vector<uint32_t>* linked, std::string* errors);
+
+// Finds the input locations and the input built-ins that the given module,
+// a tessellation, geometry or fragment shader, actually reads.  Returns true
+// and inserts them into *live_locations and *live_builtins if successful.
+// Otherwise, writes the error message to *errors.
+bool SpirvToolsAnalyzeLiveInputs(Compiler::TargetEnv env,
+                                 Compiler::TargetEnvVersion version,
+                                 const std::vector<uint32_t>& binary,
+                                 std::unordered_set<uint32_t>* live_locations,
+                                 std::unordered_set<uint32_t>* live_builtins,
+                                 std::string* errors);
+
+// Removes the stores to outputs of the given module that the next stage does
+// not read, as found by SpirvToolsAnalyzeLiveInputs on that stage, together
+// with the code computing the stored values and the output variables left
+// unused.  Returns true and writes the result back to *binary if successful.
+// Otherwise, writes the error message to *errors.
+bool SpirvToolsEliminateDeadOutputs(
+    Compiler::TargetEnv env, Compiler::TargetEnvVersion version,
+    const std::unordered_set<uint32_t>& live_locations,
+    const std::unordered_set<uint32_t>& live_builtins,
+    std::vector<uint32_t>* binary, std::string* errors);
+
+// Specializes the given module.  The specialization constants whose SpecIds
+// are keys of values are given the corresponding values, written as in GLSL
+// source, such as "true", "-3", "0x10" or "0.5".  Then every specialization
+// constant, set or not, is frozen into an ordinary constant, the operations
+// on them are folded, and the code made unreachable by their values is
+// removed.  The module is validated first.  Returns true and writes the
+// result back to *binary if successful.  Otherwise, writes the error message
+// to *errors.
+bool SpirvToolsSpecialize(
+    Compiler::TargetEnv env, Compiler::TargetEnvVersion version,
+    const std::unordered_map<uint32_t, std::string>& values,
+    std::vector<uint32_t>* binary, std::string* errors);
+
 // The ids of a list of supported optimization passes.
 enum class PassId {
   // SPIRV-Tools standard recipes
@@ -47,21 +94,92 @@ enum class PassId {
   kPerformancePasses,
   kSizePasses,
 
+  // Cheap, local passes for low compile latency. Their presence also turns off
+  // validation of the input, which is trusted front-end output, unless user
+  // passes are also present.
+  kFastCompilePasses,
+
+  // The size recipe, followed by the removal of duplicate types, decorations
+  // and constants, ID compaction, and a final round of all of these that is
+  // kept only if it makes the module smaller.  Its presence makes every pass
+  // run on its own, so that the size after each can be measured, and the
+  // result is validated.
+  kMinimumSizePasses,
+
+  // Replacements for the performance recipe, one per optimization profile.
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES) k##NAME##ProfilePasses,
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+
   // SPIRV-Tools specific passes
   kNullPass,
   kStripDebugInfo,
+  // Removes non-semantic instructions and decorations, such as reflection
+  // data for HLSL.
+  kStripNonSemanticInfo,
   kCompactIds,
+  // Merges duplicate types, decorations and constants.
+  kRemoveDuplicates,
+  kEliminateDeadFunctions,
+  // Drops interface variables the entry points no longer use.
+  kRemoveUnusedInterfaceVariables,
+  // Folds constants, such as baked uniform values, into the code using them,
+  // and removes the branches, code and resources this leaves dead.
+  kFoldBakedConstants,
+
+  // Passes given as spirv-opt command line flags
+  kUserPasses,
 };
 
+// Checks that each of the given spirv-opt command line flags, such as
+// "--loop-unroll" or "--scalar-replacement=100", names a known optimization
+// pass or recipe. Returns true if so. Otherwise, writes a message naming the
+// first offending flag to *errors and returns false.
+bool SpirvToolsValidatePassFlags(const std::vector<std::string>& flags,
+                                 std::string* errors);
+
+// Returns the spirv-opt command line flags that run the same passes as the
+// given id, such as kPerformancePasses, in the same order.  kUserPasses has no
+// flags of its own and gives an empty list.
+std::vector<std::string> SpirvToolsGetPassFlags(PassId pass);
+
+// Splits the text of a pass-list file into spirv-opt command line flags.
+// Flags are separated by whitespace, and a '#' starts a comment that runs to
+// the end of the line.
+std::vector<std::string> ParseSpirvOptPassList(const string_piece& text);
+
+// Validates the given binary with the rules used for the optimizer's input.
+// Returns true if it is valid.  Otherwise, writes the validator's messages to
+// *errors and returns false.
+bool SpirvToolsValidate(Compiler::TargetEnv env,
+                        Compiler::TargetEnvVersion version,
+                        const std::vector<uint32_t>& binary,
+                        std::string* errors);
+
 // Optimizes the given binary. Passes are registered in the exact order as shown
-// in enabled_passes, without de-duplication. Returns true and writes the
-// optimized binary back to *binary if successful. Otherwise, writes errors to
-// *errors and the content of binary may be in an invalid state.
+// in enabled_passes, without de-duplication. Each kUserPasses entry registers
+// the passes in user_pass_flags, which must already have been validated with
+// SpirvToolsValidatePassFlags. Returns true and writes the optimized binary
+// back to *binary if successful. Otherwise, writes errors to *errors and the
+// content of binary may be in an invalid state.
+//
+// If enabled_passes contains kMinimumSizePasses and stages is not null, an
+// entry named "input" with the size of the given binary is appended to
+// *stages, followed by one entry per pass with the size after it.
+//
+// If cancellation is not null and can cancel, it is checked between groups
+// of a few passes, and once it cancels, SpirvToolsOptimize fails with its
+// message.  Each group parses the module again, which slows the optimizer.  A
+// recipe with a pass that cannot be registered from its name runs in one
+// step, and the error for a cancel noticed right after it names that pass.
 bool SpirvToolsOptimize(Compiler::TargetEnv env,
                         Compiler::TargetEnvVersion version,
                         const std::vector<PassId>& enabled_passes,
+                        const std::vector<std::string>& user_pass_flags,
                         spvtools::OptimizerOptions& optimizer_options,
-                        std::vector<uint32_t>* binary, std::string* errors);
+                        std::vector<uint32_t>* binary, std::string* errors,
+                        std::vector<OptimizationStage>* stages = nullptr,
+                        const Cancellation* cancellation = nullptr);
 
 }  // namespace shaderc_util
 
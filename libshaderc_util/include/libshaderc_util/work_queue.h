@@ -0,0 +1,105 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERC_UTIL_INC_WORK_QUEUE_H
+#define LIBSHADERC_UTIL_INC_WORK_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace shaderc_util {
+
+// A pool of worker threads that run jobs in priority order.  Jobs with a
+// higher priority run first; jobs with equal priority run in the order they
+// were pushed.  A job that has not started yet can be reprioritized or
+// cancelled.  All methods are thread-safe.
+class PriorityWorkQueue {
+ public:
+  // A unit of work, given its own id.  Each job is called exactly once: with
+  // cancelled == false on a worker thread to do its work, or with
+  // cancelled == true if it was cancelled, or the queue was destroyed, before
+  // it started.  In the latter case it should only release what it holds.
+  using Job = std::function<void(uint64_t id, bool cancelled)>;
+
+  // Starts num_threads worker threads.  Zero means one per hardware thread.
+  explicit PriorityWorkQueue(size_t num_threads);
+
+  // Cancels all jobs that have not started, and waits for running jobs to
+  // finish.
+  ~PriorityWorkQueue();
+
+  PriorityWorkQueue(const PriorityWorkQueue&) = delete;
+  PriorityWorkQueue& operator=(const PriorityWorkQueue&) = delete;
+
+  // Queues a job and returns its id.  Ids are never zero.
+  uint64_t Push(int priority, Job job);
+
+  // Changes the priority of the given job.  Returns false if the job has
+  // already started or does not exist.
+  bool SetPriority(uint64_t id, int priority);
+
+  // Removes the given job from the queue and calls it with cancelled == true
+  // on the calling thread.  Returns false, and does nothing, if the job has
+  // already started or does not exist.
+  bool Cancel(uint64_t id);
+
+  // Blocks until no job is queued or running.
+  void WaitIdle();
+
+ private:
+  // Orders pending jobs by descending priority, then by ascending id.
+  struct PendingOrder {
+    bool operator()(const std::pair<int, uint64_t>& a,
+                    const std::pair<int, uint64_t>& b) const {
+      if (a.first != b.first) return a.first > b.first;
+      return a.second < b.second;
+    }
+  };
+
+  struct PendingJob {
+    int priority;
+    Job job;
+  };
+
+  // The body of each worker thread.
+  void WorkerLoop();
+
+  std::mutex mutex_;
+  // Signalled when a job is pushed or the queue shuts down.
+  std::condition_variable work_available_;
+  // Signalled when the queue becomes idle.
+  std::condition_variable idle_;
+  // (priority, id) of each pending job, in the order they will run.
+  std::set<std::pair<int, uint64_t>, PendingOrder> order_;
+  std::unordered_map<uint64_t, PendingJob> pending_;
+  size_t num_running_ = 0;
+  uint64_t next_id_ = 1;
+  bool shutting_down_ = false;
+  std::vector<std::thread> workers_;
+};
+
+// Calls job(i) for every i below count, spread over the available hardware
+// threads, and returns when all of them are done.
+void RunInParallel(size_t count, const std::function<void(size_t)>& job);
+
+}  // namespace shaderc_util
+
+#endif  // LIBSHADERC_UTIL_INC_WORK_QUEUE_H
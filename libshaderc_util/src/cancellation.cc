@@ -0,0 +1,82 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/cancellation.h"
+
+#include <cstring>
+
+namespace shaderc_util {
+
+bool Cancellation::IsCancelled() const {
+  if (reason_.load() != Reason::kNone) return true;
+  Reason reason = Reason::kNone;
+  if (flag_ && flag_->load()) {
+    reason = Reason::kFlag;
+  } else if (deadline_ != Clock::time_point::max() &&
+             Clock::now() >= deadline_) {
+    reason = Reason::kDeadline;
+  } else {
+    return false;
+  }
+  // The first reason found is the one reported.
+  Reason none = Reason::kNone;
+  reason_.compare_exchange_strong(none, reason);
+  return true;
+}
+
+const char* Cancellation::message() const {
+  switch (reason_.load()) {
+    case Reason::kFlag:
+      return "compilation cancelled";
+    case Reason::kDeadline:
+      return "compilation exceeded its deadline";
+    case Reason::kNone:
+      break;
+  }
+  return "compilation not cancelled";
+}
+
+glslang::TShader::Includer::IncludeResult*
+CancellingIncluder::include_delegate(const char* requested_source,
+                                     const char* requesting_source,
+                                     IncludeType type, size_t include_depth) {
+  if (cancellation_.IsCancelled()) {
+    // A failed result carries its error message as its contents.
+    const char* message = cancellation_.message();
+    return new glslang::TShader::Includer::IncludeResult(
+        "", message, strlen(message), nullptr);
+  }
+  glslang::TShader::Includer::IncludeResult* original =
+      type == IncludeType::Local
+          ? includer_.includeLocal(requested_source, requesting_source,
+                                   include_depth)
+          : includer_.includeSystem(requested_source, requesting_source,
+                                    include_depth);
+  if (!original) return nullptr;
+  return new glslang::TShader::Includer::IncludeResult(
+      original->headerName, original->headerData, original->headerLength,
+      original);
+}
+
+void CancellingIncluder::release_delegate(
+    glslang::TShader::Includer::IncludeResult* result) {
+  if (result->userData) {
+    includer_.releaseInclude(
+        static_cast<glslang::TShader::Includer::IncludeResult*>(
+            result->userData));
+  }
+  delete result;
+}
+
+}  // namespace shaderc_util
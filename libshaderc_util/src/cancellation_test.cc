@@ -0,0 +1,104 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/cancellation.h"
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+
+namespace {
+
+using shaderc_util::Cancellation;
+using Clock = Cancellation::Clock;
+
+// A CountingIncluder that resolves every request to a file of that name,
+// and counts the results it has not had released.
+class ResolvingIncluder : public shaderc_util::CountingIncluder {
+ public:
+  using IncludeResult = glslang::TShader::Includer::IncludeResult;
+
+  int outstanding = 0;
+
+ private:
+  IncludeResult* include_delegate(const char* requested, const char*,
+                                  IncludeType, size_t) override {
+    ++outstanding;
+    return new IncludeResult{requested, requested, strlen(requested),
+                             nullptr};
+  }
+  void release_delegate(IncludeResult* include_result) override {
+    --outstanding;
+    delete include_result;
+  }
+};
+
+TEST(Cancellation, DefaultNeverCancels) {
+  const Cancellation cancellation;
+  EXPECT_FALSE(cancellation.is_active());
+  EXPECT_FALSE(cancellation.IsCancelled());
+  EXPECT_FALSE(cancellation.was_cancelled());
+}
+
+TEST(Cancellation, CancelsOnceFlagIsSet) {
+  std::atomic<bool> flag(false);
+  const Cancellation cancellation(&flag, Clock::time_point::max());
+  EXPECT_TRUE(cancellation.is_active());
+  EXPECT_FALSE(cancellation.IsCancelled());
+  flag.store(true);
+  EXPECT_TRUE(cancellation.IsCancelled());
+  EXPECT_TRUE(cancellation.was_cancelled());
+  EXPECT_EQ(std::string("compilation cancelled"), cancellation.message());
+  // Cancelling cannot be undone.
+  flag.store(false);
+  EXPECT_TRUE(cancellation.IsCancelled());
+}
+
+TEST(Cancellation, CancelsOnceDeadlineHasPassed) {
+  const Cancellation passed(nullptr, Clock::now());
+  EXPECT_TRUE(passed.IsCancelled());
+  EXPECT_EQ(std::string("compilation exceeded its deadline"),
+            passed.message());
+
+  const Cancellation future(nullptr, Clock::now() + std::chrono::hours(1));
+  EXPECT_TRUE(future.is_active());
+  EXPECT_FALSE(future.IsCancelled());
+}
+
+TEST(CancellingIncluder, FailsRequestsOnceCancelled) {
+  std::atomic<bool> flag(false);
+  const Cancellation cancellation(&flag, Clock::time_point::max());
+  ResolvingIncluder resolver;
+  shaderc_util::CancellingIncluder includer(resolver, cancellation);
+
+  auto* resolved = includer.includeLocal("a.glsl", "main.frag", 1);
+  ASSERT_NE(nullptr, resolved);
+  EXPECT_EQ("a.glsl", resolved->headerName);
+  EXPECT_EQ(1, resolver.outstanding);
+  includer.releaseInclude(resolved);
+  EXPECT_EQ(0, resolver.outstanding);
+
+  flag.store(true);
+  auto* failed = includer.includeSystem("b.glsl", "main.frag", 1);
+  ASSERT_NE(nullptr, failed);
+  EXPECT_EQ("", failed->headerName);
+  EXPECT_EQ("compilation cancelled",
+            std::string(failed->headerData, failed->headerLength));
+  EXPECT_EQ(0, resolver.outstanding);
+  includer.releaseInclude(failed);
+}
+
+}  // anonymous namespace
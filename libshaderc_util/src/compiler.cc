@@ -14,21 +14,30 @@
 
 #include "libshaderc_util/compiler.h"
 
+#include <algorithm>
+#include <cctype>
 #include <cstdint>
 #include <iomanip>
+#include <limits>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <thread>
 #include <tuple>
+#include <unordered_set>
 
 #include "SPIRV/GlslangToSpv.h"
 #include "libshaderc_util/format.h"
 #include "libshaderc_util/io_shaderc.h"
+#include "libshaderc_util/line_scanner.h"
 #include "libshaderc_util/message.h"
 #include "libshaderc_util/resources.h"
 #include "libshaderc_util/shader_stage.h"
+#include "libshaderc_util/spirv_interface.h"
 #include "libshaderc_util/spirv_tools_wrapper.h"
 #include "libshaderc_util/string_piece.h"
 #include "libshaderc_util/version_profile.h"
+#include "libshaderc_util/work_queue.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace {
@@ -105,6 +114,154 @@ EShMessages GetMessageRules(shaderc_util::Compiler::TargetEnv env,
   return result;
 }
 
+// Returns the VkShaderStageFlagBits value of the given stage.
+uint32_t GetShaderStageFlag(EShLanguage stage) {
+  switch (stage) {
+    case EShLangVertex:
+      return 0x1;
+    case EShLangTessControl:
+      return 0x2;
+    case EShLangTessEvaluation:
+      return 0x4;
+    case EShLangGeometry:
+      return 0x8;
+    case EShLangFragment:
+      return 0x10;
+    case EShLangCompute:
+      return 0x20;
+    case EShLangRayGen:
+      return 0x100;
+    case EShLangAnyHit:
+      return 0x200;
+    case EShLangClosestHit:
+      return 0x400;
+    case EShLangMiss:
+      return 0x800;
+    case EShLangIntersect:
+      return 0x1000;
+    case EShLangCallable:
+      return 0x2000;
+    case EShLangTask:
+      return 0x40;
+    case EShLangMesh:
+      return 0x80;
+    default:
+      break;
+  }
+  return 0;
+}
+
+// Returns true if text contains the given identifier as a whole token.
+bool ContainsIdentifier(const std::string& text, const std::string& name) {
+  auto is_identifier_char = [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  };
+  for (size_t at = text.find(name); at != std::string::npos;
+       at = text.find(name, at + 1)) {
+    const size_t end = at + name.size();
+    if ((at == 0 || !is_identifier_char(text[at - 1])) &&
+        (end == text.size() || !is_identifier_char(text[end]))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if the workgroup size override asks for any change.
+bool IsActive(const shaderc_util::WorkgroupSizeOverride& size_override) {
+  return size_override.specializable || size_override.size[0] ||
+         size_override.size[1] || size_override.size[2];
+}
+
+// An includer that resolves requests with another includer and keeps a copy
+// of each file resolved, so that a second compile of the same source can be
+// answered from the copies, without asking the other includer again.
+class ReplayingIncluder : public shaderc_util::CountingIncluder {
+ public:
+  explicit ReplayingIncluder(shaderc_util::CountingIncluder& includer)
+      : includer_(includer) {}
+
+  // Answers the requests from now on with the files resolved so far, and
+  // asks the other includer only for the rest.
+  void StartReplay() { replaying_ = true; }
+
+ private:
+  glslang::TShader::Includer::IncludeResult* include_delegate(
+      const char* requested_source, const char* requesting_source,
+      IncludeType type, size_t include_depth) override {
+    std::string key = type == IncludeType::Local ? "\"" : "<";
+    key += requesting_source;
+    key += '\0';
+    key += requested_source;
+    if (replaying_) {
+      auto file = files_.find(key);
+      if (file != files_.end()) {
+        return new glslang::TShader::Includer::IncludeResult(
+            file->second.first, file->second.second.data(),
+            file->second.second.size(), nullptr);
+      }
+    }
+    glslang::TShader::Includer::IncludeResult* original =
+        type == IncludeType::Local
+            ? includer_.includeLocal(requested_source, requesting_source,
+                                     include_depth)
+            : includer_.includeSystem(requested_source, requesting_source,
+                                      include_depth);
+    if (!original) return nullptr;
+    if (!replaying_ && !original->headerName.empty()) {
+      files_.emplace(key, std::make_pair(original->headerName,
+                                         std::string(original->headerData,
+                                                     original->headerLength)));
+    }
+    return new glslang::TShader::Includer::IncludeResult(
+        original->headerName, original->headerData, original->headerLength,
+        original);
+  }
+
+  void release_delegate(
+      glslang::TShader::Includer::IncludeResult* result) override {
+    if (result->userData) {
+      includer_.releaseInclude(
+          static_cast<glslang::TShader::Includer::IncludeResult*>(
+              result->userData));
+    }
+    delete result;
+  }
+
+  shaderc_util::CountingIncluder& includer_;
+  bool replaying_ = false;
+  // The name and contents of each file resolved, by request.
+  std::map<std::string, std::pair<std::string, std::string>> files_;
+};
+
+// Returns the message of an error from GetGlslangClientInfo without the
+// "error:" and the error tag that start it.
+std::string TargetEnvErrorMessage(const std::string& error,
+                                  const std::string& error_tag) {
+  string_piece message(error);
+  if (message.starts_with("error:")) message = message.substr(6);
+  if (message.starts_with(error_tag + ": ")) {
+    message = message.substr(error_tag.size() + 2);
+  }
+  return message.strip_whitespace().str();
+}
+
+// Returns the passes that the given profile runs for
+// OptimizationLevel::Performance.
+shaderc_util::PassId GetPerformancePasses(
+    shaderc_util::Compiler::OptimizationProfile profile) {
+  switch (profile) {
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES)         \
+  case shaderc_util::Compiler::OptimizationProfile::NAME: \
+    return shaderc_util::PassId::k##NAME##ProfilePasses;
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+    case shaderc_util::Compiler::OptimizationProfile::Generic:
+      break;
+  }
+  return shaderc_util::PassId::kPerformancePasses;
+}
+
 }  // anonymous namespace
 
 namespace shaderc_util {
@@ -178,8 +335,54 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
                                     const string_piece& error_tag)>&
         stage_callback,
     CountingIncluder& includer, OutputType output_type,
-    std::ostream* error_stream, size_t* total_warnings,
-    size_t* total_errors) const {
+    std::ostream* error_stream, size_t* total_warnings, size_t* total_errors,
+    std::vector<DescriptorBinding>* removed_bindings,
+    std::vector<OptimizationStage>* optimization_stages,
+    SizeAttribution* size_attribution, const Cancellation* cancellation,
+    std::vector<Diagnostic>* diagnostics,
+    bool* workgroup_size_is_referenced) const {
+  // A compile-only module is attributed to functions only, because the
+  // optimizer would fail to validate one with debug info.
+  if (size_attribution && !generate_debug_info_ &&
+      output_type != OutputType::PreprocessedText &&
+      !(compile_only_ && source_language_ == SourceLanguage::GLSL)) {
+    // Debug info would change the module that is returned, so the lines are
+    // taken from a second compile that has it.  Its messages repeat those of
+    // the first compile, so they are dropped, and its includes are answered
+    // with the files of the first compile, whose stats are the ones kept.
+    ReplayingIncluder replaying_includer(includer);
+    auto result_tuple = Compile(
+        input_source_string, forced_shader_stage, error_tag, entry_point_name,
+        stage_callback, replaying_includer, output_type, error_stream,
+        total_warnings, total_errors, removed_bindings, optimization_stages,
+        nullptr, cancellation, diagnostics, workgroup_size_is_referenced);
+    includer.ResetIncludeStats(replaying_includer.include_stats());
+    if (!std::get<0>(result_tuple)) return result_tuple;
+    replaying_includer.StartReplay();
+
+    Compiler with_lines(*this);
+    with_lines.SetGenerateDebugInfo();
+    std::ostringstream repeated_messages;
+    size_t repeated_warnings = 0;
+    size_t repeated_errors = 0;
+    if (!std::get<0>(with_lines.Compile(
+            input_source_string, forced_shader_stage, error_tag,
+            entry_point_name, stage_callback, replaying_includer,
+            OutputType::SpirvBinary, &repeated_messages, &repeated_warnings,
+            &repeated_errors, nullptr, nullptr, size_attribution,
+            cancellation)) &&
+        !(cancellation && cancellation->was_cancelled())) {
+      *error_stream << "shaderc: warning: cannot attribute the size of the "
+                       "module: the compile with debug info failed\n";
+      ++*total_warnings;
+      AddDiagnostic(diagnostics, false, "shaderc", 0,
+                    "cannot attribute the size of the module: the compile "
+                    "with debug info failed");
+      *size_attribution = SizeAttribution();
+    }
+    return result_tuple;
+  }
+
   // Compilation results to be returned:
   // Initialize the result tuple as a failed compilation. In error cases, we
   // should return result_tuple directly without setting its members.
@@ -191,6 +394,16 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
   std::vector<uint32_t>& compilation_output_data = std::get<1>(result_tuple);
   size_t& compilation_output_data_size_in_bytes = std::get<2>(result_tuple);
 
+  // Returns true, after writing an error, if the compile has been cancelled.
+  auto is_cancelled = [&]() {
+    if (!cancellation || !cancellation->IsCancelled()) return false;
+    *error_stream << error_tag << ": error: " << cancellation->message()
+                  << "\n";
+    ++*total_errors;
+    AddDiagnostic(diagnostics, true, error_tag, 0, cancellation->message());
+    return true;
+  };
+
   // Check target environment.
   const auto target_client_info = GetGlslangClientInfo(
       error_tag, target_env_, target_env_version_, target_spirv_version_,
@@ -199,6 +412,8 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
     *error_stream << target_client_info.error;
     *total_warnings = 0;
     *total_errors = 1;
+    AddDiagnostic(diagnostics, true, error_tag, 0,
+                  TargetEnvErrorMessage(target_client_info.error, error_tag));
     return result_tuple;
   }
 
@@ -209,23 +424,46 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
       "#extension GL_GOOGLE_include_directive : enable\n";
   const std::string preamble = macro_definitions + pound_extension;
 
+  // The source with the prelude spliced in, if there is one, and the files
+  // the prelude included.
+  std::string source_with_prelude;
+  std::map<std::string, CountingIncluder::IncludeStats> prelude_include_stats;
+  std::string prelude_errors;
+  ApplyIncludeGuards(includer);
+  if (!ApplyPrelude(input_source_string, error_tag, preamble, includer,
+                    &source_with_prelude, &prelude_errors,
+                    &prelude_include_stats)) {
+    PrintFilteredErrors(error_tag, error_stream, warnings_as_errors_,
+                        /* suppress_warnings = */ true, prelude_errors.c_str(),
+                        total_warnings, total_errors, diagnostics);
+    is_cancelled();
+    return result_tuple;
+  }
+  if (is_cancelled()) return result_tuple;
+  const bool has_prelude = !source_with_prelude.empty();
+  const string_piece source_string =
+      has_prelude ? string_piece(source_with_prelude) : input_source_string;
+
   std::string preprocessed_shader;
 
   // If only preprocessing, we definitely need to preprocess. Otherwise, if
   // we don't know the stage until now, we need the preprocessed shader to
-  // deduce the shader stage.
+  // deduce the shader stage, and if its size is guarded, to measure it.
+  const size_t max_preprocessed_bytes =
+      guards_[static_cast<size_t>(Guard::PreprocessedBytes)];
   if (output_type == OutputType::PreprocessedText ||
-      used_shader_stage == EShLangCount) {
+      used_shader_stage == EShLangCount || max_preprocessed_bytes) {
     bool success;
     std::string glslang_errors;
+    ApplyIncludeGuards(includer, prelude_include_stats);
     std::tie(success, preprocessed_shader, glslang_errors) =
-        PreprocessShader(error_tag, input_source_string, preamble, includer);
+        PreprocessShader(error_tag, source_string, preamble, includer);
 
     success &= PrintFilteredErrors(error_tag, error_stream, warnings_as_errors_,
                                    /* suppress_warnings = */ true,
                                    glslang_errors.c_str(), total_warnings,
-                                   total_errors);
-    if (!success) return result_tuple;
+                                   total_errors, diagnostics);
+    if (is_cancelled() || !success) return result_tuple;
     // Because of the behavior change of the #line directive, the #line
     // directive introducing each file's content must use the syntax for the
     // specified version. So we need to probe this shader's version and
@@ -235,9 +473,23 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
     std::tie(version, profile) = DeduceVersionProfile(preprocessed_shader);
     const bool is_for_next_line = LineDirectiveIsForNextLine(version, profile);
 
-    preprocessed_shader =
-        CleanupPreamble(preprocessed_shader, error_tag, pound_extension,
-                        includer.num_include_directives(), is_for_next_line);
+    // The #line directives around a prelude need the #extension as much as
+    // those of an #include.
+    CleanupPreamble(&preprocessed_shader, error_tag, pound_extension,
+                    includer.num_include_directives() + (has_prelude ? 1 : 0),
+                    is_for_next_line);
+    if (max_preprocessed_bytes &&
+        preprocessed_shader.size() > max_preprocessed_bytes) {
+      const std::string message =
+          "the preprocessed source is " +
+          std::to_string(preprocessed_shader.size()) +
+          " bytes, past the limit of " +
+          std::to_string(max_preprocessed_bytes);
+      *error_stream << error_tag << ": error: " << message << "\n";
+      ++*total_errors;
+      AddDiagnostic(diagnostics, true, error_tag, 0, message);
+      return result_tuple;
+    }
 
     if (output_type == OutputType::PreprocessedText) {
       // Set the values of the result tuple.
@@ -248,113 +500,601 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
     } else if (used_shader_stage == EShLangCount) {
       std::string errors;
       std::tie(used_shader_stage, errors) =
-          GetShaderStageFromSourceCode(error_tag, preprocessed_shader);
+          GetShaderStageFromSourceCode(error_tag, preprocessed_shader,
+                                       is_for_next_line, diagnostics);
       if (!errors.empty()) {
         *error_stream << errors;
+        // Each error takes one line.
+        *total_errors +=
+            static_cast<size_t>(std::count(errors.begin(), errors.end(), '\n'));
         return result_tuple;
       }
       if (used_shader_stage == EShLangCount) {
-        if ((used_shader_stage = stage_callback(error_stream, error_tag)) ==
-            EShLangCount) {
+        std::ostringstream stage_errors;
+        used_shader_stage = stage_callback(&stage_errors, error_tag);
+        std::string stage_message = stage_errors.str();
+        *error_stream << stage_message;
+        if (used_shader_stage == EShLangCount) {
+          // A callback that fails without a word is given a message.
+          if (stage_message.empty()) {
+            stage_message =
+                "the shader stage cannot be determined; give it explicitly "
+                "or with '#pragma shader_stage'";
+            *error_stream << error_tag << ": error: " << stage_message
+                          << "\n";
+          }
+          ++*total_errors;
+          AddDiagnostic(diagnostics, true, error_tag, 0, stage_message);
           return result_tuple;
         }
       }
     }
   }
 
+  // The front end folds uses of gl_WorkGroupSize, so whether there are any
+  // decides how the workgroup size may be changed.
+  const bool has_workgroup_size = used_shader_stage == EShLangCompute ||
+                                  used_shader_stage == EShLangTask ||
+                                  used_shader_stage == EShLangMesh;
+  const bool override_workgroup_size =
+      IsActive(workgroup_size_) && has_workgroup_size;
+  ApplyIncludeGuards(includer);
+  const bool references_workgroup_size =
+      (override_workgroup_size || workgroup_size_is_referenced) &&
+      has_workgroup_size &&
+      (preprocessed_shader.empty()
+           ? SourceReferencesWorkgroupSize(source_string, error_tag,
+                                           preamble, includer)
+           : ContainsIdentifier(preprocessed_shader, "gl_WorkGroupSize"));
+  if (workgroup_size_is_referenced) {
+    *workgroup_size_is_referenced = references_workgroup_size;
+  }
+  // The parse preprocesses the source again, so the text is not kept through
+  // it.
+  preprocessed_shader.clear();
+  preprocessed_shader.shrink_to_fit();
+
   // Parsing requires its own Glslang symbol tables.
   glslang::TShader shader(used_shader_stage);
-  const char* shader_strings = input_source_string.data();
-  const int shader_lengths = static_cast<int>(input_source_string.size());
+  const char* shader_strings = source_string.data();
+  const int shader_lengths = static_cast<int>(source_string.size());
   const char* string_names = error_tag.c_str();
   shader.setStringsWithLengthsAndNames(&shader_strings, &shader_lengths,
                                        &string_names, 1);
-  shader.setPreamble(preamble.c_str());
-  shader.setEntryPoint(entry_point_name);
-  shader.setAutoMapBindings(auto_bind_uniforms_);
-  if (auto_combined_image_sampler_) {
-    shader.setTextureSamplerTransformMode(
-        EShTexSampTransUpgradeTextureRemoveSampler);
-  }
-  shader.setAutoMapLocations(auto_map_locations_);
-  const auto& bases = auto_binding_base_[static_cast<int>(used_shader_stage)];
-  shader.setShiftImageBinding(bases[static_cast<int>(UniformKind::Image)]);
-  shader.setShiftSamplerBinding(bases[static_cast<int>(UniformKind::Sampler)]);
-  shader.setShiftTextureBinding(bases[static_cast<int>(UniformKind::Texture)]);
-  shader.setShiftUboBinding(bases[static_cast<int>(UniformKind::Buffer)]);
-  shader.setShiftSsboBinding(
-      bases[static_cast<int>(UniformKind::StorageBuffer)]);
-  shader.setShiftUavBinding(
-      bases[static_cast<int>(UniformKind::UnorderedAccessView)]);
-  shader.setHlslIoMapping(hlsl_iomap_);
-  shader.setResourceSetBinding(
-      hlsl_explicit_bindings_[static_cast<int>(used_shader_stage)]);
-  shader.setEnvClient(target_client_info.client,
-                      target_client_info.client_version);
-  shader.setEnvTarget(target_client_info.target_language,
-                      target_client_info.target_language_version);
-  if (hlsl_functionality1_enabled_) {
-    shader.setEnvTargetHlslFunctionality1();
-  }
-  if (vulkan_rules_relaxed_) {
-    glslang::EShSource language = glslang::EShSourceNone;
-    switch (source_language_) {
-      case SourceLanguage::GLSL:
-        language = glslang::EShSourceGlsl;
-        break;
-      case SourceLanguage::HLSL:
-        language = glslang::EShSourceHlsl;
-        break;
-    }
-    // This option will only be used if the Vulkan client is used.
-    // If new versions of GL_KHR_vulkan_glsl come out, it would make sense to
-    // let callers specify which version to use. For now, just use 100.
-    shader.setEnvInput(language, used_shader_stage, glslang::EShClientVulkan,
-                       100);
-    shader.setEnvInputVulkanRulesRelaxed();
-  }
-  shader.setInvertY(invert_y_enabled_);
-  shader.setNanMinMaxClamp(nan_clamp_);
+  ConfigureShader(&shader, used_shader_stage, entry_point_name, preamble,
+                  target_client_info);
+  const bool compile_only =
+      compile_only_ && source_language_ == SourceLanguage::GLSL;
+  if (compile_only) shader.setCompileOnly();
 
   const EShMessages rules =
       GetMessageRules(target_env_, source_language_, hlsl_offsets_,
                       hlsl_16bit_types_enabled_, generate_debug_info_);
 
+  if (is_cancelled()) return result_tuple;
+  ApplyIncludeGuards(includer, prelude_include_stats);
   bool success = shader.parse(&limits_, default_version_, default_profile_,
                               force_version_profile_, kNotForwardCompatible,
                               rules, includer);
 
   success &= PrintFilteredErrors(error_tag, error_stream, warnings_as_errors_,
                                  suppress_warnings_, shader.getInfoLog(),
-                                 total_warnings, total_errors);
-  if (!success) return result_tuple;
+                                 total_warnings, total_errors, diagnostics);
+  if (is_cancelled() || !success) return result_tuple;
 
+  // A compile-only shader skips the glslang link step, which would require
+  // every function to be defined and an entry point to exist.
   glslang::TProgram program;
-  program.addShader(&shader);
-  success = program.link(EShMsgDefault) && program.mapIO();
-  success &= PrintFilteredErrors(error_tag, error_stream, warnings_as_errors_,
-                                 suppress_warnings_, program.getInfoLog(),
-                                 total_warnings, total_errors);
-  if (!success) return result_tuple;
+  glslang::TIntermediate* intermediate = shader.getIntermediate();
+  if (!compile_only) {
+    program.addShader(&shader);
+    success = program.link(EShMsgDefault) && program.mapIO();
+    success &= PrintFilteredErrors(error_tag, error_stream, warnings_as_errors_,
+                                   suppress_warnings_, program.getInfoLog(),
+                                   total_warnings, total_errors, diagnostics);
+    if (is_cancelled() || !success) return result_tuple;
+    intermediate = program.getIntermediate(used_shader_stage);
+  }
 
   // 'spirv' is an alias for the compilation_output_data. This alias is added
   // to serve as an input for the call to DissassemblyBinary.
   std::vector<uint32_t>& spirv = compilation_output_data;
+  std::string opt_errors;
+  bool input_at_fault;
+  if (!GenerateSpirv(*intermediate, used_shader_stage, compile_only, &spirv,
+                     removed_bindings, optimization_stages, &input_at_fault,
+                     &opt_errors, cancellation)) {
+    if (cancellation && cancellation->was_cancelled()) {
+      is_cancelled();
+      return result_tuple;
+    }
+    if (input_at_fault) {
+      *error_stream << error_tag << ": error: " << opt_errors << "\n";
+      ++*total_errors;
+      AddDiagnostic(diagnostics, true, error_tag, 0, opt_errors);
+      return result_tuple;
+    }
+    *error_stream << "shaderc: internal error: compilation succeeded but "
+                     "failed to optimize: "
+                  << opt_errors << "\n";
+    AddDiagnostic(diagnostics, true, "shaderc", 0,
+                  "compilation succeeded but failed to optimize: " +
+                      opt_errors);
+    return result_tuple;
+  }
+  // A compile-only module keeps the size it declares; LinkSpirv rejects a
+  // size, since it cannot tell whether the sources use gl_WorkGroupSize.
+  if (override_workgroup_size && !compile_only &&
+      !OverrideWorkgroupSize(workgroup_size_, references_workgroup_size,
+                             &spirv, &opt_errors)) {
+    *error_stream << error_tag << ": error: " << opt_errors << "\n";
+    ++*total_errors;
+    AddDiagnostic(diagnostics, true, error_tag, 0, opt_errors);
+    return result_tuple;
+  }
+
+  if (size_attribution) {
+    if (!AttributeSpirvSize(spirv, size_attribution, &opt_errors)) {
+      *error_stream << "shaderc: warning: cannot attribute the size of the "
+                       "module: "
+                    << opt_errors << "\n";
+      ++*total_warnings;
+      AddDiagnostic(diagnostics, false, "shaderc", 0,
+                    "cannot attribute the size of the module: " + opt_errors);
+    }
+  }
+
+  if (is_cancelled()) return result_tuple;
+  if (output_type == OutputType::SpirvAssemblyText) {
+    std::string text_or_error;
+    if (!SpirvToolsDisassemble(target_env_, target_env_version_, spirv,
+                               &text_or_error)) {
+      *error_stream << "shaderc: internal error: compilation succeeded but "
+                       "failed to disassemble: "
+                    << text_or_error << "\n";
+      AddDiagnostic(diagnostics, true, "shaderc", 0,
+                    "compilation succeeded but failed to disassemble: " +
+                        text_or_error);
+      return result_tuple;
+    }
+    succeeded = true;
+    compilation_output_data = ConvertStringToVector(text_or_error);
+    compilation_output_data_size_in_bytes = text_or_error.size();
+    return result_tuple;
+  } else {
+    succeeded = true;
+    // Note compilation_output_data is already populated in GlslangToSpv().
+    compilation_output_data_size_in_bytes = spirv.size() * sizeof(spirv[0]);
+    return result_tuple;
+  }
+}
+
+void Compiler::ModuleOutput::SetInternalError(const char* action,
+                                              const std::string& errors) {
+  const std::string message =
+      std::string("compilation succeeded but failed to ") + action + ": " +
+      errors;
+  this->errors = "shaderc: internal error: " + message + "\n";
+  diagnostics.clear();
+  AddDiagnostic(&diagnostics, true, "shaderc", 0, message);
+}
+
+std::vector<Compiler::ModuleOutput> Compiler::CompileWithRecipes(
+    const string_piece& input_source_string, EShLanguage forced_shader_stage,
+    const std::string& error_tag, const char* entry_point_name,
+    const std::function<EShLanguage(std::ostream* error_stream,
+                                    const string_piece& error_tag)>&
+        stage_callback,
+    CountingIncluder& includer, const std::vector<OptimizationRecipe>& recipes,
+    OutputType output_type, std::ostream* error_stream, size_t* total_warnings,
+    size_t* total_errors, std::vector<Diagnostic>* diagnostics) const {
+  assert(output_type != OutputType::PreprocessedText);
+  std::vector<ModuleOutput> outputs(recipes.size());
+
+  // The front end runs once, with only the passes needed for correctness,
+  // such as HLSL legalization.  If any recipe asks for debug information, the
+  // front end generates it, and the recipes that do not ask for it strip it.
+  Compiler front_end(*this);
+  front_end.enabled_opt_passes_.clear();
+  front_end.opt_pass_flags_.clear();
+  front_end.workgroup_size_ = WorkgroupSizeOverride();
+  front_end.generate_debug_info_ =
+      std::any_of(recipes.begin(), recipes.end(),
+                  [](const OptimizationRecipe& recipe) {
+                    return recipe.generate_debug_info;
+                  });
+  const bool any_workgroup_size =
+      IsActive(workgroup_size_) ||
+      std::any_of(recipes.begin(), recipes.end(),
+                  [](const OptimizationRecipe& recipe) {
+                    const uint32_t* size = recipe.workgroup_size;
+                    return size[0] || size[1] || size[2];
+                  });
+  bool workgroup_size_is_referenced = false;
+  bool succeeded;
+  std::vector<uint32_t> spirv;
+  size_t size_in_bytes;
+  std::tie(succeeded, spirv, size_in_bytes) = front_end.Compile(
+      input_source_string, forced_shader_stage, error_tag, entry_point_name,
+      stage_callback, includer, OutputType::SpirvBinary, error_stream,
+      total_warnings, total_errors, nullptr, nullptr, nullptr, nullptr,
+      diagnostics,
+      any_workgroup_size ? &workgroup_size_is_referenced : nullptr);
+  if (!succeeded) return outputs;
+
+  // Give each recipe its workgroup size up front, so that mistakes are
+  // reported once, as errors in the source.
+  std::vector<std::vector<uint32_t>> modules(recipes.size(), spirv);
+  ShaderReflection reflection;
+  std::string errors;
+  const bool has_workgroup_size =
+      ReflectSpirv(spirv, &reflection, &errors) &&
+      !reflection.entry_points.empty() &&
+      reflection.entry_points[0].workgroup_size[0] != 0;
+  for (size_t i = 0; i < recipes.size(); ++i) {
+    WorkgroupSizeOverride size_override = workgroup_size_;
+    const uint32_t* size = recipes[i].workgroup_size;
+    if (size[0] || size[1] || size[2]) {
+      std::copy(size, size + 3, size_override.size);
+    } else if (!IsActive(size_override) || !has_workgroup_size) {
+      continue;
+    }
+    if (!OverrideWorkgroupSize(size_override, workgroup_size_is_referenced,
+                               &modules[i], &errors)) {
+      *error_stream << error_tag << ": error: " << errors << "\n";
+      ++*total_errors;
+      AddDiagnostic(diagnostics, true, error_tag, 0, errors);
+      return outputs;
+    }
+  }
+
+  const bool front_end_has_debug_info = front_end.generate_debug_info_;
+  auto run_recipe = [this, &recipes, &modules, output_type, &outputs,
+                     front_end_has_debug_info](size_t index) {
+    const OptimizationRecipe& recipe = recipes[index];
+    ModuleOutput& output = outputs[index];
+
+    Compiler optimizer(*this);
+    optimizer.generate_debug_info_ = recipe.generate_debug_info;
+    optimizer.SetOptimizationLevel(recipe.level);
+    // The optimizing levels strip debug information already.
+    if (front_end_has_debug_info && !recipe.generate_debug_info &&
+        recipe.level == OptimizationLevel::Zero) {
+      optimizer.enabled_opt_passes_ = {PassId::kStripDebugInfo};
+    }
+
+    std::vector<uint32_t>& module = modules[index];
+    std::string errors;
+    if (!optimizer.OptimizeSpirv(&module, &errors,
+                                 &output.optimization_stages)) {
+      output.SetInternalError("optimize", errors);
+      return;
+    }
+    if (output_type == OutputType::SpirvAssemblyText) {
+      std::string text_or_error;
+      if (!SpirvToolsDisassemble(target_env_, target_env_version_, module,
+                                 &text_or_error)) {
+        output.SetInternalError("disassemble", text_or_error);
+        return;
+      }
+      output.data = ConvertStringToVector(text_or_error);
+      output.size_in_bytes = text_or_error.size();
+    } else {
+      output.size_in_bytes = module.size() * sizeof(uint32_t);
+      output.data = std::move(module);
+    }
+    output.succeeded = true;
+  };
+
+  // Optimization does not touch glslang, so the recipes can run side by side.
+  RunInParallel(recipes.size(), run_recipe);
+  return outputs;
+}
+
+std::vector<Compiler::ModuleOutput> Compiler::CompilePipeline(
+    const std::vector<PipelineStage>& stages, CountingIncluder& includer,
+    OutputType output_type, std::vector<DescriptorBinding>* descriptor_layout,
+    std::ostream* error_stream, size_t* total_warnings, size_t* total_errors,
+    std::vector<Diagnostic>* diagnostics) const {
+  assert(output_type != OutputType::PreprocessedText);
+  std::vector<ModuleOutput> outputs(stages.size());
+  if (stages.empty()) return outputs;
+
+  // Messages about the pipeline as a whole name its first shader.
+  const std::string& pipeline_tag = stages.front().error_tag;
+  const auto target_client_info = GetGlslangClientInfo(
+      pipeline_tag, target_env_, target_env_version_, target_spirv_version_,
+      target_spirv_version_is_forced_);
+  if (!target_client_info.error.empty()) {
+    *error_stream << target_client_info.error;
+    *total_warnings = 0;
+    *total_errors = 1;
+    AddDiagnostic(
+        diagnostics, true, pipeline_tag, 0,
+        TargetEnvErrorMessage(target_client_info.error, pipeline_tag));
+    return outputs;
+  }
+
+  const std::string macro_definitions =
+      shaderc_util::format(predefined_macros_, "#define ", " ", "\n");
+  const std::string pound_extension =
+      "#extension GL_GOOGLE_include_directive : enable\n";
+  const std::string preamble = macro_definitions + pound_extension;
+  const EShMessages rules =
+      GetMessageRules(target_env_, source_language_, hlsl_offsets_,
+                      hlsl_16bit_types_enabled_, generate_debug_info_);
+
+  // The shaders must outlive the program that links them, and their sources
+  // the parse.
+  std::vector<std::unique_ptr<glslang::TShader>> shaders;
+  std::vector<std::string> sources_with_prelude(stages.size());
+  glslang::TProgram program;
+  bool success = true;
+  for (const auto& stage : stages) {
+    for (const auto& shader : shaders) {
+      if (shader->getStage() == stage.stage) {
+        *error_stream << stage.error_tag
+                      << ": error: the pipeline has more than one shader for "
+                         "this stage\n";
+        ++*total_errors;
+        AddDiagnostic(diagnostics, true, stage.error_tag, 0,
+                      "the pipeline has more than one shader for this stage");
+        return outputs;
+      }
+    }
+    std::string& source_with_prelude = sources_with_prelude[shaders.size()];
+    std::string prelude_errors;
+    ApplyIncludeGuards(includer);
+    if (!ApplyPrelude(stage.source, stage.error_tag, preamble, includer,
+                      &source_with_prelude, &prelude_errors)) {
+      PrintFilteredErrors(stage.error_tag, error_stream, warnings_as_errors_,
+                          /* suppress_warnings = */ true,
+                          prelude_errors.c_str(), total_warnings,
+                          total_errors, diagnostics);
+      return outputs;
+    }
+    const string_piece source = source_with_prelude.empty()
+                                    ? string_piece(stage.source)
+                                    : string_piece(source_with_prelude);
+    shaders.emplace_back(new glslang::TShader(stage.stage));
+    glslang::TShader& shader = *shaders.back();
+    const char* shader_strings = source.data();
+    const int shader_lengths = static_cast<int>(source.size());
+    const char* string_names = stage.error_tag.c_str();
+    shader.setStringsWithLengthsAndNames(&shader_strings, &shader_lengths,
+                                         &string_names, 1);
+    ConfigureShader(&shader, stage.stage, stage.entry_point_name.c_str(),
+                    preamble, target_client_info);
+    ApplyIncludeGuards(includer);
+    bool parsed = shader.parse(&limits_, default_version_, default_profile_,
+                               force_version_profile_, kNotForwardCompatible,
+                               rules, includer);
+    parsed &= PrintFilteredErrors(stage.error_tag, error_stream,
+                                  warnings_as_errors_, suppress_warnings_,
+                                  shader.getInfoLog(), total_warnings,
+                                  total_errors, diagnostics);
+    success &= parsed;
+    program.addShader(&shader);
+  }
+  if (!success) return outputs;
+
+  // Linking the stages together checks that their interfaces match.
+  success = program.link(EShMsgDefault) && program.mapIO();
+  success &= PrintFilteredErrors(pipeline_tag, error_stream,
+                                 warnings_as_errors_, suppress_warnings_,
+                                 program.getInfoLog(), total_warnings,
+                                 total_errors, diagnostics);
+  if (!success) return outputs;
+
+  // Past the front end, a failure fails every stage with the same message.
+  auto fail = [&outputs](const char* action, const std::string& errors) {
+    for (auto& output : outputs) {
+      output.data.clear();
+      output.size_in_bytes = 0;
+      output.SetInternalError(action, errors);
+    }
+    return outputs;
+  };
+
+  std::vector<std::vector<uint32_t>> modules(stages.size());
+  std::string errors;
+  for (size_t i = 0; i < stages.size(); ++i) {
+    bool input_at_fault;
+    if (!GenerateSpirv(*program.getIntermediate(stages[i].stage),
+                       stages[i].stage, /* compile_only = */ false, &modules[i],
+                       /* removed_bindings = */ nullptr,
+                       /* optimization_stages = */ nullptr, &input_at_fault,
+                       &errors)) {
+      if (input_at_fault) {
+        *error_stream << stages[i].error_tag << ": error: " << errors << "\n";
+        ++*total_errors;
+        AddDiagnostic(diagnostics, true, stages[i].error_tag, 0, errors);
+        return outputs;
+      }
+      return fail("optimize", errors);
+    }
+  }
+
+  // Trim the interfaces from the fragment stage backwards, so that outputs
+  // removed from one stage make its own inputs dead in turn.
+  std::vector<size_t> order;
+  for (size_t i = 0; i < stages.size(); ++i) {
+    if (stages[i].stage <= EShLangFragment) order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&stages](size_t a, size_t b) {
+    return stages[a].stage < stages[b].stage;
+  });
+  for (size_t k = order.size(); k-- > 1;) {
+    const EShLanguage producer_stage = stages[order[k - 1]].stage;
+    std::vector<uint32_t>& producer = modules[order[k - 1]];
+    std::vector<uint32_t>& consumer = modules[order[k]];
+    std::unordered_set<uint32_t> live_locations;
+    std::unordered_set<uint32_t> live_builtins;
+    spvtools::OptimizerOptions opt_options;
+    opt_options.set_preserve_bindings(preserve_bindings_);
+    if (!SpirvToolsAnalyzeLiveInputs(target_env_, target_env_version_,
+                                     consumer, &live_locations,
+                                     &live_builtins, &errors) ||
+        !SpirvToolsEliminateDeadOutputs(target_env_, target_env_version_,
+                                        live_locations, live_builtins,
+                                        &producer, &errors) ||
+        !SpirvToolsOptimize(target_env_, target_env_version_,
+                            {PassId::kRemoveUnusedInterfaceVariables}, {},
+                            opt_options, &consumer, &errors)) {
+      return fail("trim the interfaces between stages", errors);
+    }
+    if (stages[order[k]].stage == EShLangFragment &&
+        producer_stage != EShLangTessControl) {
+      CompactInterfaceLocations(&producer, &consumer);
+    }
+  }
+
+  if (compact_pipeline_bindings_) {
+    spvtools::OptimizerOptions opt_options;
+    opt_options.set_preserve_bindings(false);
+    for (auto& module : modules) {
+      if (!SpirvToolsOptimize(target_env_, target_env_version_,
+                              {PassId::kRemoveUnusedInterfaceVariables}, {},
+                              opt_options, &module, &errors)) {
+        return fail("remove unused resources", errors);
+      }
+    }
+  }
+  std::vector<std::vector<uint32_t>*> module_pointers;
+  std::vector<uint32_t> stage_flags;
+  for (size_t i = 0; i < stages.size(); ++i) {
+    module_pointers.push_back(&modules[i]);
+    stage_flags.push_back(GetShaderStageFlag(stages[i].stage));
+  }
+  std::vector<DescriptorBinding> layout;
+  if (!AssignPipelineDescriptorBindings(module_pointers, stage_flags,
+                                        compact_pipeline_bindings_, &layout,
+                                        &errors)) {
+    // The stages disagree about a resource, which is the user's error.
+    *error_stream << pipeline_tag << ": error: " << errors << "\n";
+    ++*total_errors;
+    AddDiagnostic(diagnostics, true, pipeline_tag, 0, errors);
+    return outputs;
+  }
+  if (descriptor_layout) *descriptor_layout = std::move(layout);
+
+  for (size_t i = 0; i < stages.size(); ++i) {
+    if (output_type == OutputType::SpirvAssemblyText) {
+      std::string text_or_error;
+      if (!SpirvToolsDisassemble(target_env_, target_env_version_, modules[i],
+                                 &text_or_error)) {
+        return fail("disassemble", text_or_error);
+      }
+      outputs[i].data = ConvertStringToVector(text_or_error);
+      outputs[i].size_in_bytes = text_or_error.size();
+    } else {
+      outputs[i].size_in_bytes = modules[i].size() * sizeof(uint32_t);
+      outputs[i].data = std::move(modules[i]);
+    }
+  }
+  for (auto& output : outputs) output.succeeded = true;
+  return outputs;
+}
+
+bool Compiler::OptimizeSpirv(std::vector<uint32_t>* spirv,
+                             std::string* errors,
+                             std::vector<OptimizationStage>* stages) const {
+  return RunOptimizer(enabled_opt_passes_, spirv, errors, stages);
+}
+
+bool Compiler::SpecializeSpirv(
+    const std::unordered_map<uint32_t, std::string>& values,
+    std::vector<uint32_t>* spirv, std::string* errors) const {
+  // The passes silently skip unknown SpecIds, which would hide typos.
+  ShaderReflection reflection;
+  if (!ReflectSpirv(*spirv, &reflection, errors)) return false;
+  for (const auto& value : values) {
+    if (std::none_of(reflection.spec_constants.begin(),
+                     reflection.spec_constants.end(),
+                     [&value](const ShaderReflection::SpecConstant& constant) {
+                       return constant.spec_id == value.first;
+                     })) {
+      *errors = "no specialization constant has SpecId " +
+                std::to_string(value.first);
+      return false;
+    }
+  }
+  if (!SpirvToolsSpecialize(target_env_, target_env_version_, values, spirv,
+                            errors)) {
+    return false;
+  }
+  return RunOptimizer(enabled_opt_passes_, spirv, errors);
+}
+
+bool Compiler::LinkSpirv(const std::vector<std::vector<uint32_t>>& modules,
+                         std::vector<uint32_t>* linked,
+                         std::string* errors) const {
+  if (IsActive(workgroup_size_)) {
+    *errors =
+        "the workgroup size cannot be set when linking; set it when "
+        "compiling a module that is not compile-only";
+    return false;
+  }
+  if (!SpirvToolsLink(target_env_, target_env_version_, modules, linked,
+                      errors) ||
+      !ValidateSpirv(*linked, errors)) {
+    return false;
+  }
+  std::vector<PassId> passes(1, PassId::kEliminateDeadFunctions);
+  passes.insert(passes.end(), enabled_opt_passes_.begin(),
+                enabled_opt_passes_.end());
+  return RunOptimizer(std::move(passes), linked, errors);
+}
+
+bool Compiler::ValidateSpirv(const std::vector<uint32_t>& spirv,
+                             std::string* errors) const {
+  return SpirvToolsValidate(target_env_, target_env_version_, spirv, errors);
+}
+
+bool Compiler::GenerateSpirv(
+    const glslang::TIntermediate& intermediate, EShLanguage stage,
+    bool compile_only, std::vector<uint32_t>* spirv,
+    std::vector<DescriptorBinding>* removed_bindings,
+    std::vector<OptimizationStage>* optimization_stages, bool* input_at_fault,
+    std::string* errors, const Cancellation* cancellation) const {
+  *input_at_fault = false;
   glslang::SpvOptions options;
   options.generateDebugInfo = generate_debug_info_;
   options.disableOptimizer = true;
   options.optimizeSize = false;
-  // Note the call to GlslangToSpv also populates compilation_output_data.
-  glslang::GlslangToSpv(*program.getIntermediate(used_shader_stage), spirv,
-                        &options);
+  glslang::GlslangToSpv(intermediate, *spirv, &options);
+  const size_t max_spirv_words =
+      guards_[static_cast<size_t>(Guard::SpirvWords)];
+  if (max_spirv_words && spirv->size() > max_spirv_words) {
+    *errors = "the module is " + std::to_string(spirv->size()) +
+              " words of SPIR-V before optimization, past the limit of " +
+              std::to_string(max_spirv_words);
+    *input_at_fault = true;
+    return false;
+  }
 
   // Set the tool field (the top 16-bits) in the generator word to
   // 'Shaderc over Glslang'.
   const uint32_t shaderc_generator_word = 13;  // From SPIR-V XML Registry
   const uint32_t generator_word_index = 2;     // SPIR-V 2.3: Physical layout
-  assert(spirv.size() > generator_word_index);
-  spirv[generator_word_index] =
-      (spirv[generator_word_index] & 0xffff) | (shaderc_generator_word << 16);
+  assert(spirv->size() > generator_word_index);
+  (*spirv)[generator_word_index] =
+      ((*spirv)[generator_word_index] & 0xffff) |
+      (shaderc_generator_word << 16);
+
+  ShaderReflection unbaked;
+  if (!baked_uniforms_.empty()) {
+    if (!ReflectSpirv(*spirv, &unbaked, errors)) return false;
+    if (!BakeUniforms(baked_uniforms_, spirv, errors)) {
+      *input_at_fault = true;
+      return false;
+    }
+  }
+
+  // A compile-only module is optimized after it is linked.  Before that, it
+  // does not pass validation for the target environment anyway, because of
+  // its Linkage capability.
+  if (compile_only) return true;
 
   std::vector<PassId> opt_passes;
 
@@ -363,43 +1103,103 @@ std::tuple<bool, std::vector<uint32_t>, size_t> Compiler::Compile(
     // eg. forward and remove memory writes of opaque types.
     opt_passes.push_back(PassId::kLegalizationPasses);
   }
+  if (!baked_uniforms_.empty()) {
+    // Even without optimization, the baked values are folded, so that the
+    // resources they replace can go.
+    opt_passes.push_back(PassId::kFoldBakedConstants);
+  }
 
   opt_passes.insert(opt_passes.end(), enabled_opt_passes_.begin(),
                     enabled_opt_passes_.end());
+  if (!RunOptimizer(std::move(opt_passes), spirv, errors,
+                    optimization_stages, cancellation)) {
+    return false;
+  }
 
-  if (!opt_passes.empty()) {
-    spvtools::OptimizerOptions opt_options;
-    opt_options.set_preserve_bindings(preserve_bindings_);
-
-    std::string opt_errors;
-    if (!SpirvToolsOptimize(target_env_, target_env_version_, opt_passes,
-                            opt_options, &spirv, &opt_errors)) {
-      *error_stream << "shaderc: internal error: compilation succeeded but "
-                       "failed to optimize: "
-                    << opt_errors << "\n";
-      return result_tuple;
+  if (removed_bindings && !baked_uniforms_.empty()) {
+    ShaderReflection baked;
+    if (!ReflectSpirv(*spirv, &baked, errors)) return false;
+    for (const auto& resource : unbaked.resources) {
+      if (std::none_of(baked.resources.begin(), baked.resources.end(),
+                       [&resource](const ShaderReflection::Resource& kept) {
+                         return kept.set == resource.set &&
+                                kept.binding == resource.binding;
+                       })) {
+        removed_bindings->push_back(
+            {resource.set, resource.binding, resource.type, resource.count,
+             GetShaderStageFlag(stage)});
+      }
     }
   }
+  return true;
+}
 
-  if (output_type == OutputType::SpirvAssemblyText) {
-    std::string text_or_error;
-    if (!SpirvToolsDisassemble(target_env_, target_env_version_, spirv,
-                               &text_or_error)) {
-      *error_stream << "shaderc: internal error: compilation succeeded but "
-                       "failed to disassemble: "
-                    << text_or_error << "\n";
-      return result_tuple;
+void Compiler::ConfigureShader(glslang::TShader* shader, EShLanguage stage,
+                               const char* entry_point_name,
+                               const std::string& preamble,
+                               const GlslangClientInfo& client_info) const {
+  shader->setPreamble(preamble.c_str());
+  shader->setEntryPoint(entry_point_name);
+  shader->setAutoMapBindings(auto_bind_uniforms_);
+  if (auto_combined_image_sampler_) {
+    shader->setTextureSamplerTransformMode(
+        EShTexSampTransUpgradeTextureRemoveSampler);
+  }
+  shader->setAutoMapLocations(auto_map_locations_);
+  const auto& bases = auto_binding_base_[static_cast<int>(stage)];
+  shader->setShiftImageBinding(bases[static_cast<int>(UniformKind::Image)]);
+  shader->setShiftSamplerBinding(
+      bases[static_cast<int>(UniformKind::Sampler)]);
+  shader->setShiftTextureBinding(
+      bases[static_cast<int>(UniformKind::Texture)]);
+  shader->setShiftUboBinding(bases[static_cast<int>(UniformKind::Buffer)]);
+  shader->setShiftSsboBinding(
+      bases[static_cast<int>(UniformKind::StorageBuffer)]);
+  shader->setShiftUavBinding(
+      bases[static_cast<int>(UniformKind::UnorderedAccessView)]);
+  shader->setHlslIoMapping(hlsl_iomap_);
+  shader->setResourceSetBinding(
+      hlsl_explicit_bindings_[static_cast<int>(stage)]);
+  shader->setEnvClient(client_info.client, client_info.client_version);
+  shader->setEnvTarget(client_info.target_language,
+                       client_info.target_language_version);
+  if (hlsl_functionality1_enabled_) {
+    shader->setEnvTargetHlslFunctionality1();
+  }
+  if (vulkan_rules_relaxed_) {
+    glslang::EShSource language = glslang::EShSourceNone;
+    switch (source_language_) {
+      case SourceLanguage::GLSL:
+        language = glslang::EShSourceGlsl;
+        break;
+      case SourceLanguage::HLSL:
+        language = glslang::EShSourceHlsl;
+        break;
     }
-    succeeded = true;
-    compilation_output_data = ConvertStringToVector(text_or_error);
-    compilation_output_data_size_in_bytes = text_or_error.size();
-    return result_tuple;
-  } else {
-    succeeded = true;
-    // Note compilation_output_data is already populated in GlslangToSpv().
-    compilation_output_data_size_in_bytes = spirv.size() * sizeof(spirv[0]);
-    return result_tuple;
+    // This option will only be used if the Vulkan client is used.
+    // If new versions of GL_KHR_vulkan_glsl come out, it would make sense to
+    // let callers specify which version to use. For now, just use 100.
+    shader->setEnvInput(language, stage, glslang::EShClientVulkan, 100);
+    shader->setEnvInputVulkanRulesRelaxed();
   }
+  shader->setInvertY(invert_y_enabled_);
+  shader->setNanMinMaxClamp(nan_clamp_);
+}
+
+bool Compiler::RunOptimizer(std::vector<PassId> passes,
+                            std::vector<uint32_t>* spirv, std::string* errors,
+                            std::vector<OptimizationStage>* stages,
+                            const Cancellation* cancellation) const {
+  if (!opt_pass_flags_.empty()) {
+    passes.push_back(PassId::kUserPasses);
+  }
+  if (passes.empty()) return true;
+
+  spvtools::OptimizerOptions opt_options;
+  opt_options.set_preserve_bindings(preserve_bindings_);
+  return SpirvToolsOptimize(target_env_, target_env_version_, passes,
+                            opt_pass_flags_, opt_options, spirv, errors,
+                            stages, cancellation);
 }
 
 void Compiler::AddMacroDefinition(const char* macro, size_t macro_length,
@@ -435,7 +1235,8 @@ void Compiler::SetWarningsAsErrors() { warnings_as_errors_ = true; }
 void Compiler::SetGenerateDebugInfo() {
   generate_debug_info_ = true;
   for (size_t i = 0; i < enabled_opt_passes_.size(); ++i) {
-    if (enabled_opt_passes_[i] == PassId::kStripDebugInfo) {
+    if (enabled_opt_passes_[i] == PassId::kStripDebugInfo ||
+        enabled_opt_passes_[i] == PassId::kStripNonSemanticInfo) {
       enabled_opt_passes_[i] = PassId::kNullPass;
     }
   }
@@ -456,13 +1257,43 @@ void Compiler::SetOptimizationLevel(Compiler::OptimizationLevel level) {
       if (!generate_debug_info_) {
         enabled_opt_passes_.push_back(PassId::kStripDebugInfo);
       }
-      enabled_opt_passes_.push_back(PassId::kPerformancePasses);
+      enabled_opt_passes_.push_back(
+          GetPerformancePasses(optimization_profile_));
+      break;
+    case OptimizationLevel::FastCompile:
+      if (!generate_debug_info_) {
+        enabled_opt_passes_.push_back(PassId::kStripDebugInfo);
+      }
+      enabled_opt_passes_.push_back(PassId::kFastCompilePasses);
+      break;
+    case OptimizationLevel::MinimumSize:
+      if (!generate_debug_info_) {
+        enabled_opt_passes_.push_back(PassId::kStripDebugInfo);
+        enabled_opt_passes_.push_back(PassId::kStripNonSemanticInfo);
+      }
+      enabled_opt_passes_.push_back(PassId::kMinimumSizePasses);
       break;
     default:
       break;
   }
 }
 
+void Compiler::SetOptimizationProfile(OptimizationProfile profile) {
+  for (auto& pass : enabled_opt_passes_) {
+    if (pass == GetPerformancePasses(optimization_profile_)) {
+      pass = GetPerformancePasses(profile);
+    }
+  }
+  optimization_profile_ = profile;
+}
+
+bool Compiler::SetOptimizerPasses(const std::vector<std::string>& flags,
+                                  std::string* errors) {
+  if (!SpirvToolsValidatePassFlags(flags, errors)) return false;
+  opt_pass_flags_ = flags;
+  return true;
+}
+
 void Compiler::EnableHlslLegalization(bool hlsl_legalization_enabled) {
   hlsl_legalization_enabled_ = hlsl_legalization_enabled;
 }
@@ -485,6 +1316,20 @@ void Compiler::SetNanClamp(bool enable) { nan_clamp_ = enable; }
 
 void Compiler::SetSuppressWarnings() { suppress_warnings_ = true; }
 
+bool Compiler::SourceReferencesWorkgroupSize(const string_piece& source,
+                                             const std::string& error_tag,
+                                             const std::string& preamble,
+                                             CountingIncluder& includer) const {
+  // HLSL has no such built-in.
+  if (source_language_ != SourceLanguage::GLSL) return false;
+  bool success;
+  std::string preprocessed;
+  std::tie(success, preprocessed, std::ignore) =
+      PreprocessShader(error_tag, source, preamble, includer);
+  // When in doubt, assume the worst.
+  return !success || ContainsIdentifier(preprocessed, "gl_WorkGroupSize");
+}
+
 std::tuple<bool, std::string, std::string> Compiler::PreprocessShader(
     const std::string& error_tag, const string_piece& shader_source,
     const string_piece& shader_preamble, CountingIncluder& includer) const {
@@ -524,16 +1369,84 @@ std::tuple<bool, std::string, std::string> Compiler::PreprocessShader(
       kNotForwardCompatible, rules, &preprocessed_shader, includer);
 
   if (success) {
-    return std::make_tuple(true, preprocessed_shader, shader.getInfoLog());
+    return std::make_tuple(true, std::move(preprocessed_shader),
+                           shader.getInfoLog());
   }
   return std::make_tuple(false, "", shader.getInfoLog());
 }
 
-std::string Compiler::CleanupPreamble(const string_piece& preprocessed_shader,
-                                      const string_piece& error_tag,
-                                      const string_piece& pound_extension,
-                                      int num_include_directives,
-                                      bool is_for_next_line) const {
+void Compiler::ApplyIncludeGuards(
+    CountingIncluder& includer,
+    const std::map<std::string, CountingIncluder::IncludeStats>&
+        prelude_include_stats) const {
+  includer.SetLimits(guards_[static_cast<size_t>(Guard::IncludeCount)],
+                     guards_[static_cast<size_t>(Guard::IncludeBytes)]);
+  includer.ResetIncludeStats(prelude_include_stats);
+}
+
+bool Compiler::ApplyPrelude(
+    const string_piece& source, const std::string& error_tag,
+    const std::string& preamble, CountingIncluder& includer,
+    std::string* spliced, std::string* errors,
+    std::map<std::string, CountingIncluder::IncludeStats>* include_stats)
+    const {
+  spliced->clear();
+  if (!prelude_ || source_language_ != SourceLanguage::GLSL) return true;
+
+  int version;
+  EProfile profile;
+  std::tie(version, profile) = DeduceVersionProfile(source);
+  const bool is_for_next_line = LineDirectiveIsForNextLine(version, profile);
+
+  // The preamble, version and target decide the predefined macros, and so
+  // the preprocessed prelude.
+  const std::string key =
+      preamble + std::to_string(version) + " " + std::to_string(profile) +
+      " " + std::to_string(static_cast<int>(target_env_)) + " " +
+      std::to_string(static_cast<int>(target_env_version_)) + " " +
+      std::to_string(static_cast<int>(target_spirv_version_));
+  std::string prepared;
+  std::map<std::string, CountingIncluder::IncludeStats> prepared_include_stats;
+  if (!prelude_->FindPrepared(key, &prepared, &prepared_include_stats)) {
+    // The prelude is preprocessed under the #version of the source.
+    std::string prelude_source;
+    const size_t version_at = FindVersionDirective(source);
+    if (version_at != string_piece::npos) {
+      string_piece version_line = source.substr(version_at);
+      version_line = version_line.substr(0, FindByte(version_line, '\n'));
+      prelude_source = version_line.str();
+      prelude_source += "\n";
+    }
+    prelude_source += GetLineDirective(is_for_next_line, prelude_->name());
+    std::vector<std::string> directives;
+    prelude_source += MarkMacroDirectives(prelude_->source(),
+                                          is_for_next_line, &directives);
+
+    MacroMarkingIncluder marking_includer(includer, is_for_next_line,
+                                          &directives);
+    bool success;
+    std::string preprocessed;
+    std::tie(success, preprocessed, *errors) = PreprocessShader(
+        prelude_->name(), prelude_source, preamble, marking_includer);
+    if (!success) return false;
+    errors->clear();
+    prepared = FinishPrelude(
+        preprocessed, "#extension GL_GOOGLE_include_directive : enable\n",
+        directives);
+    prepared_include_stats = includer.include_stats();
+    prelude_->StorePrepared(key, prepared, prepared_include_stats);
+  }
+  if (include_stats) *include_stats = std::move(prepared_include_stats);
+  *spliced = SplicePrelude(source, prepared, prelude_->name(), error_tag,
+                           is_for_next_line);
+  return true;
+}
+
+void Compiler::CleanupPreamble(std::string* preprocessed_shader,
+                               const string_piece& error_tag,
+                               const string_piece& pound_extension,
+                               int num_include_directives,
+                               bool is_for_next_line) const {
   // Those #define directives in preamble will become empty lines after
   // preprocessing. We also injected an #extension directive to turn on #include
   // directive support. In the original preprocessing output from glslang, it
@@ -545,79 +1458,75 @@ std::string Compiler::CleanupPreamble(const string_piece& preprocessed_shader,
   //   placed at the first line. Its original line will be filled with an empty
   //   line as placeholder to maintain the code structure.
 
-  const std::vector<string_piece> lines =
-      preprocessed_shader.get_fields('\n', /* keep_delimiter = */ true);
-
-  std::ostringstream output_stream;
-
-  size_t pound_extension_index = lines.size();
-  size_t pound_version_index = lines.size();
-  for (size_t i = 0; i < lines.size(); ++i) {
-    if (lines[i] == pound_extension) {
-      pound_extension_index = std::min(i, pound_extension_index);
-    } else if (lines[i].starts_with("#version")) {
-      // In a preprocessed shader, directives are in a canonical format, so we
-      // can confidently compare to '#version' verbatim, without worrying about
-      // whitespace.
-      pound_version_index = i;
-      if (num_include_directives > 0) output_stream << lines[i];
-      break;
-    }
-  }
+  // Split the text at the line of the #extension directive.  The preamble
+  // comes before it.
+  const string_piece text(*preprocessed_shader);
+  LineScanner scanner(text);
+  string_piece line;
+  while (scanner.Next(&line) && line != pound_extension) {}
   // We know that #extension directive exists and appears before #version
   // directive (if any).
-  assert(pound_extension_index < lines.size());
+  assert(line == pound_extension);
+  const string_piece before_extension(text.data(), line.data());
+  const size_t body_offset = text.size() - scanner.rest().size();
+
+  // In a preprocessed shader, directives are in a canonical format, so we can
+  // confidently compare to '#version' verbatim, without worrying about
+  // whitespace.
+  size_t pound_version_offset =
+      FindLineStartingWith(scanner.rest(), "#version");
+  string_piece pound_version;
+  if (pound_version_offset != string_piece::npos) {
+    pound_version_offset += body_offset;
+    LineScanner(text.substr(pound_version_offset)).Next(&pound_version);
+  }
 
-  for (size_t i = 0; i < pound_extension_index; ++i) {
+  // The text up to and including the #extension directive is replaced by a
+  // short head, and the rest is edited where it is, so that a large shader is
+  // not copied.
+  std::string head;
+  if (num_include_directives > 0) {
+    head.append(pound_version.data(), pound_version.size());
+  }
+  for (LineScanner preamble(before_extension); preamble.Next(&line);) {
     // All empty lines before the #line directive we injected are generated by
     // preprocessing preamble. Do not output them.
-    if (lines[i].strip_whitespace().empty()) continue;
-    output_stream << lines[i];
+    if (line.strip_whitespace().empty()) continue;
+    head.append(line.data(), line.size());
   }
 
   if (num_include_directives > 0) {
-    output_stream << pound_extension;
+    head.append(pound_extension.data(), pound_extension.size());
     // Also output a #line directive for the main file.
-    output_stream << GetLineDirective(is_for_next_line, error_tag);
-  }
-
-  for (size_t i = pound_extension_index + 1; i < lines.size(); ++i) {
-    if (i == pound_version_index) {
-      if (num_include_directives > 0) {
-        output_stream << "\n";
-      } else {
-        output_stream << lines[i];
-      }
-    } else {
-      output_stream << lines[i];
+    head += GetLineDirective(is_for_next_line, error_tag);
+    // The #version directive was moved to the top, so its line is left empty
+    // to keep the line numbers.  This goes first, while the offset is valid.
+    if (!pound_version.empty()) {
+      preprocessed_shader->replace(pound_version_offset, pound_version.size(),
+                                   "\n");
     }
   }
-
-  return output_stream.str();
+  preprocessed_shader->replace(0, body_offset, head);
 }
 
 std::pair<EShLanguage, std::string> Compiler::GetShaderStageFromSourceCode(
-    string_piece filename, const std::string& preprocessed_shader) const {
+    string_piece filename, const std::string& preprocessed_shader,
+    bool is_for_next_line, std::vector<Diagnostic>* diagnostics) const {
   const string_piece kPragmaShaderStageDirective = "#pragma shader_stage";
   const string_piece kLineDirective = "#line";
 
-  int version;
-  EProfile profile;
-  std::tie(version, profile) = DeduceVersionProfile(preprocessed_shader);
-  const bool is_for_next_line = LineDirectiveIsForNextLine(version, profile);
-
-  std::vector<string_piece> lines =
-      string_piece(preprocessed_shader).get_fields('\n');
   // The filename, logical line number (which starts from 1 and is sensitive to
   // #line directives), and stage value for #pragma shader_stage() directives.
   std::vector<std::tuple<string_piece, size_t, string_piece>> stages;
   // The physical line numbers of the first #pragma shader_stage() line and
   // first non-preprocessing line in the preprocessed shader text.
-  size_t first_pragma_physical_line = lines.size() + 1;
-  size_t first_non_pp_line = lines.size() + 1;
+  size_t first_pragma_physical_line = std::numeric_limits<size_t>::max();
+  size_t first_non_pp_line = std::numeric_limits<size_t>::max();
 
-  for (size_t i = 0, logical_line_no = 1; i < lines.size(); ++i) {
-    const string_piece current_line = lines[i].strip_whitespace();
+  LineScanner scanner(preprocessed_shader);
+  string_piece line;
+  for (size_t i = 0, logical_line_no = 1; scanner.Next(&line); ++i) {
+    const string_piece current_line = line.strip_whitespace();
     if (current_line.starts_with(kPragmaShaderStageDirective)) {
       const string_piece stage_value =
           current_line.substr(kPragmaShaderStageDirective.size()).strip("()");
@@ -644,37 +1553,40 @@ std::pair<EShLanguage, std::string> Compiler::GetShaderStageFromSourceCode(
   if (stages.empty()) return std::make_pair(EShLangCount, "");
 
   std::string error_message;
+  auto add_error = [&error_message, diagnostics](
+                       const string_piece& file, size_t line,
+                       const std::string& message) {
+    error_message += file.str() + ":" + std::to_string(line) + ": error: " +
+                     message + "\n";
+    AddDiagnostic(diagnostics, true, file, static_cast<int>(line), message);
+  };
 
   const string_piece& first_pragma_filename = std::get<0>(stages[0]);
-  const std::string first_pragma_line = std::to_string(std::get<1>(stages[0]));
+  const size_t first_pragma_line = std::get<1>(stages[0]);
   const string_piece& first_pragma_stage = std::get<2>(stages[0]);
 
   if (first_pragma_physical_line > first_non_pp_line) {
-    error_message += first_pragma_filename.str() + ":" + first_pragma_line +
-                     ": error: '#pragma': the first 'shader_stage' #pragma "
-                     "must appear before any non-preprocessing code\n";
+    add_error(first_pragma_filename, first_pragma_line,
+              "'#pragma': the first 'shader_stage' #pragma must appear "
+              "before any non-preprocessing code");
   }
 
   EShLanguage stage = MapStageNameToLanguage(first_pragma_stage);
   if (stage == EShLangCount) {
-    error_message +=
-        first_pragma_filename.str() + ":" + first_pragma_line +
-        ": error: '#pragma': invalid stage for 'shader_stage' #pragma: '" +
-        first_pragma_stage.str() + "'\n";
+    add_error(first_pragma_filename, first_pragma_line,
+              "'#pragma': invalid stage for 'shader_stage' #pragma: '" +
+                  first_pragma_stage.str() + "'");
   }
 
   for (size_t i = 1; i < stages.size(); ++i) {
     const string_piece& current_stage = std::get<2>(stages[i]);
     if (current_stage != first_pragma_stage) {
-      const string_piece& current_filename = std::get<0>(stages[i]);
-      const std::string current_line = std::to_string(std::get<1>(stages[i]));
-      error_message += current_filename.str() + ":" + current_line +
-                       ": error: '#pragma': conflicting stages for "
-                       "'shader_stage' #pragma: '" +
-                       current_stage.str() + "' (was '" +
-                       first_pragma_stage.str() + "' at " +
-                       first_pragma_filename.str() + ":" + first_pragma_line +
-                       ")\n";
+      add_error(std::get<0>(stages[i]), std::get<1>(stages[i]),
+                "'#pragma': conflicting stages for 'shader_stage' #pragma: '" +
+                    current_stage.str() + "' (was '" +
+                    first_pragma_stage.str() + "' at " +
+                    first_pragma_filename.str() + ":" +
+                    std::to_string(first_pragma_line) + ")");
     }
   }
 
@@ -683,7 +1595,7 @@ std::pair<EShLanguage, std::string> Compiler::GetShaderStageFromSourceCode(
 }
 
 std::pair<int, EProfile> Compiler::DeduceVersionProfile(
-    const std::string& preprocessed_shader) const {
+    const string_piece& preprocessed_shader) const {
   int version = default_version_;
   EProfile profile = default_profile_;
   if (!force_version_profile_) {
@@ -698,15 +1610,20 @@ std::pair<int, EProfile> Compiler::DeduceVersionProfile(
 }
 
 std::pair<int, EProfile> Compiler::GetVersionProfileFromSourceCode(
-    const std::string& preprocessed_shader) const {
+    const string_piece& preprocessed_shader) const {
   string_piece pound_version = preprocessed_shader;
-  const size_t pound_version_loc = pound_version.find("#version");
+  // Jumps from '#' to '#' rather than comparing at every character.
+  size_t pound_version_loc = FindByte(pound_version, '#');
+  while (pound_version_loc != string_piece::npos &&
+         !pound_version.substr(pound_version_loc).starts_with("#version")) {
+    pound_version_loc = FindByte(pound_version, '#', pound_version_loc + 1);
+  }
   if (pound_version_loc == string_piece::npos) {
     return std::make_pair(0, ENoProfile);
   }
   pound_version =
       pound_version.substr(pound_version_loc + std::strlen("#version"));
-  pound_version = pound_version.substr(0, pound_version.find_first_of("\n"));
+  pound_version = pound_version.substr(0, FindByte(pound_version, '\n'));
 
   std::string version_profile;
   for (const auto character : pound_version) {
@@ -0,0 +1,285 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks how much memory compiling a large shader takes, to catch changes
+// that copy the source or the preprocessed text more than once, and that the
+// scans of the preprocessed text do not allocate per line.  These tests
+// replace the global operator new, so they have a program of their own.
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "libshaderc_util/compiler.h"
+#include "libshaderc_util/counting_includer.h"
+
+namespace {
+
+// The bytes allocated through operator new and not yet freed, and the most
+// there have been since peak_bytes was last reset.
+std::atomic<size_t> live_bytes(0);
+std::atomic<size_t> peak_bytes(0);
+// The number of allocations made so far.
+std::atomic<size_t> allocations(0);
+
+// Each allocation starts with its size, so that it can be subtracted again.
+constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+}  // anonymous namespace
+
+void* operator new(size_t size) {
+  char* memory = static_cast<char*>(std::malloc(size + kHeaderSize));
+  if (!memory) throw std::bad_alloc();
+  *reinterpret_cast<size_t*>(memory) = size;
+  ++allocations;
+  const size_t live = live_bytes.fetch_add(size) + size;
+  size_t peak = peak_bytes.load();
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live)) {}
+  return memory + kHeaderSize;
+}
+
+void operator delete(void* memory) noexcept {
+  if (!memory) return;
+  char* start = static_cast<char*>(memory) - kHeaderSize;
+  live_bytes.fetch_sub(*reinterpret_cast<size_t*>(start));
+  std::free(start);
+}
+
+void operator delete(void* memory, size_t) noexcept { operator delete(memory); }
+
+namespace {
+
+using shaderc_util::Compiler;
+
+// A CountingIncluder that never returns valid content for a requested
+// file inclusion.
+class DummyCountingIncluder : public shaderc_util::CountingIncluder {
+ private:
+  glslang::TShader::Includer::IncludeResult* include_delegate(
+      const char*, const char*, IncludeType, size_t) override {
+    return nullptr;
+  }
+  void release_delegate(glslang::TShader::Includer::IncludeResult*) override {}
+};
+
+// Returns a vertex shader of about the given size, made of copies of line.
+std::string LargeShader(const std::string& line, size_t size) {
+  std::string source = "#version 450\n";
+  source.reserve(size + line.size());
+  while (source.size() < size) source += line;
+  return source + "void main() {}\n";
+}
+
+// Returns a vertex shader of about the given size, whose main function is
+// made of copies of statement.
+std::string LargeMain(const std::string& statement, size_t size) {
+  std::string source =
+      "#version 450\n"
+      "layout(location = 0) out vec4 color;\n"
+      "void main() {\n"
+      "  vec4 v = vec4(0.0);\n";
+  source.reserve(size + statement.size());
+  while (source.size() < size) source += statement;
+  return source + "  color = v;\n}\n";
+}
+
+// Returns the most memory needed to write text of the given size by
+// appending to a string, and to copy the string into a result.
+size_t WriteAndCopyPeak(size_t size) {
+  const size_t before = live_bytes.load();
+  peak_bytes.store(before);
+  {
+    std::string text;
+    while (text.size() < size) text += "vec4(1.0, 2.0);\n";
+    const std::vector<uint32_t> result =
+        shaderc_util::ConvertStringToVector(text);
+  }
+  return peak_bytes.load() - before;
+}
+
+class CompilerMemoryTest : public testing::Test {
+ public:
+  CompilerMemoryTest() {
+    // The first compiles set up glslang's built-in symbol tables, which are
+    // kept for later ones.
+    size_t output_size;
+    size_t retained_bytes;
+    Compile(LargeShader("\n", 0), Compiler::OutputType::PreprocessedText,
+            &output_size, &retained_bytes);
+    Compile(LargeMain("\n", 0), Compiler::OutputType::SpirvAssemblyText,
+            &output_size, &retained_bytes);
+  }
+
+  // Compiles the given source and returns the most memory in use during the
+  // compile beyond what was in use before it.  Writes the size of the output
+  // to *output_size, and the memory still in use while the result is held to
+  // *retained_bytes.
+  size_t Compile(const std::string& source, Compiler::OutputType output_type,
+                 size_t* output_size, size_t* retained_bytes) {
+    std::stringstream errors;
+    size_t total_warnings = 0;
+    size_t total_errors = 0;
+    bool succeeded = false;
+    const size_t before = live_bytes.load();
+    peak_bytes.store(before);
+    {
+      const auto result = compiler_.Compile(
+          source, EShLangVertex, "shader", "main", stage_callback_, includer_,
+          output_type, &errors, &total_warnings, &total_errors);
+      succeeded = std::get<0>(result);
+      *output_size = std::get<2>(result);
+      *retained_bytes = live_bytes.load() - before;
+    }
+    EXPECT_TRUE(succeeded) << errors.str();
+    return peak_bytes.load() - before;
+  }
+
+ protected:
+  shaderc_util::GlslangInitializer initializer_;
+  Compiler compiler_;
+  DummyCountingIncluder includer_;
+  std::function<EShLanguage(std::ostream*, const shaderc_util::string_piece&)>
+      stage_callback_ = [](std::ostream*, const shaderc_util::string_piece&) {
+        return EShLangCount;
+      };
+};
+
+// About 8 MB, big enough that the fixed costs of a compile do not matter.
+const size_t kLargeSize = 8 << 20;
+// What the fixed costs of a compile are allowed to be.
+const size_t kFixedBytes = 1 << 20;
+
+TEST_F(CompilerMemoryTest, PreprocessedTextIsNotCopiedAgain) {
+  const std::string source =
+      LargeShader("vec4 v = vec4(1.0, 2.0, 3.0, 4.0) * 2.0;\n", kLargeSize);
+  size_t output_size = 0;
+  size_t retained_bytes = 0;
+  const size_t peak = Compile(source, Compiler::OutputType::PreprocessedText,
+                              &output_size, &retained_bytes);
+  ASSERT_GT(output_size, source.size() / 2);
+  // Allows for the preprocessor's output as it grows, and for the result
+  // copied from it, which is about twice the size of the text, but not for
+  // further copies of the text.
+  EXPECT_LT(peak, WriteAndCopyPeak(output_size) + kFixedBytes);
+  EXPECT_LT(retained_bytes, output_size + kFixedBytes);
+}
+
+TEST_F(CompilerMemoryTest, SourceIsNotCopied) {
+  // Comments are removed, so little text is left after preprocessing.
+  const std::string source = LargeShader(
+      "// A comment that the preprocessor drops, leaving its line empty.\n",
+      kLargeSize);
+  size_t output_size = 0;
+  size_t retained_bytes = 0;
+  const size_t peak = Compile(source, Compiler::OutputType::PreprocessedText,
+                              &output_size, &retained_bytes);
+  ASSERT_LT(output_size, source.size() / 8);
+  EXPECT_LT(peak, source.size() / 2);
+}
+
+// Parsing takes far more memory than the module it produces, so for SPIR-V
+// output what is checked is that only the result is kept once the compile
+// is done.  The shader is smaller, since parsing it also takes longer.
+const size_t kLargeMainSize = 1 << 20;
+const char kStatement[] = "  v += vec4(1.0, 2.0, 3.0, 4.0) * v;\n";
+
+TEST_F(CompilerMemoryTest, OnlySpirvBinaryIsKept) {
+  size_t output_size = 0;
+  size_t retained_bytes = 0;
+  Compile(LargeMain(kStatement, kLargeMainSize),
+          Compiler::OutputType::SpirvBinary, &output_size, &retained_bytes);
+  ASSERT_GT(output_size, kLargeMainSize);
+  // The module is written an instruction at a time, so the result may have
+  // room left over.
+  EXPECT_LT(retained_bytes, 2 * output_size + kFixedBytes);
+}
+
+TEST_F(CompilerMemoryTest, OnlySpirvAssemblyTextIsKept) {
+  size_t output_size = 0;
+  size_t retained_bytes = 0;
+  Compile(LargeMain(kStatement, kLargeMainSize),
+          Compiler::OutputType::SpirvAssemblyText, &output_size,
+          &retained_bytes);
+  ASSERT_GT(output_size, kLargeMainSize);
+  EXPECT_LT(retained_bytes, output_size + kFixedBytes);
+}
+
+// Exposes the members that scan the preprocessed text line by line.
+class ScanningCompiler : public Compiler {
+ public:
+  using Compiler::CleanupPreamble;
+  using Compiler::GetShaderStageFromSourceCode;
+  using Compiler::GetVersionProfileFromSourceCode;
+};
+
+const char kPoundExtension[] =
+    "#extension GL_GOOGLE_include_directive : enable\n";
+
+// Returns text as the preprocessor writes it for a shader with a preamble
+// and the given number of lines of code, each after a #line directive.
+std::string PreprocessedShader(size_t num_lines) {
+  std::string text = std::string("\n\n") + kPoundExtension +
+                     "#version 450\n#pragma shader_stage(compute)\n";
+  for (size_t i = 0; i < num_lines; ++i) {
+    text += "#line 2 \"a.glsl\"\nshared float x;\n";
+  }
+  return text + "void main() {}\n";
+}
+
+// Returns the number of allocations scan makes on the text of a shader with
+// the given number of lines.
+size_t CountAllocations(const std::function<void(std::string*)>& scan,
+                        size_t num_lines) {
+  std::string text = PreprocessedShader(num_lines);
+  // Room for any growth, so that it does not depend on the text's size.
+  text.reserve(text.size() + 1024);
+  const size_t before = allocations.load();
+  scan(&text);
+  return allocations.load() - before;
+}
+
+TEST(CompilerScanTest, ScansDoNotAllocatePerLine) {
+  const ScanningCompiler compiler;
+  const std::string text = PreprocessedShader(1);
+  EXPECT_EQ(450, compiler.GetVersionProfileFromSourceCode(text).first);
+  EXPECT_EQ(EShLangCompute,
+            compiler.GetShaderStageFromSourceCode("shader", text, true).first);
+
+  const std::function<void(std::string*)> scans[] = {
+      [&compiler](std::string* text) {
+        compiler.GetVersionProfileFromSourceCode(*text);
+      },
+      [&compiler](std::string* text) {
+        compiler.GetShaderStageFromSourceCode("shader", *text, true);
+      },
+      [&compiler](std::string* text) {
+        compiler.CleanupPreamble(text, "shader", kPoundExtension, 0, true);
+      },
+      [&compiler](std::string* text) {
+        compiler.CleanupPreamble(text, "shader", kPoundExtension, 1, true);
+      }};
+  for (const auto& scan : scans) {
+    EXPECT_EQ(CountAllocations(scan, 10), CountAllocations(scan, 10000));
+  }
+}
+
+}  // anonymous namespace
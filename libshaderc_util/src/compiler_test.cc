@@ -16,7 +16,10 @@
 
 #include <gmock/gmock.h>
 
+#include <chrono>
+#include <memory>
 #include <sstream>
+#include <thread>
 
 #include "death_test.h"
 #include "libshaderc_util/counting_includer.h"
@@ -26,6 +29,7 @@ namespace {
 
 using shaderc_util::Compiler;
 using shaderc_util::GlslangClientInfo;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::HasSubstr;
 using ::testing::Not;
@@ -172,6 +176,19 @@ layout(location=0) out vec4 o;
 void main() { o = clamp(i, vec4(0.5), vec4(1.0)); }
 )";
 
+// A fragment shader with mediump arithmetic in a loop marked for unrolling.
+const char kGlslShaderWithRelaxedLoop[] = R"(#version 450
+  #extension GL_EXT_control_flow_attributes : require
+  layout(location = 0) in mediump vec4 in_color;
+  layout(location = 0) out mediump vec4 out_color;
+  void main() {
+    mediump vec4 sum = vec4(0.0);
+    [[unroll]] for (int i = 0; i < 4; ++i) {
+      sum = sum * in_color + in_color;
+    }
+    out_color = sum;
+  })";
+
 // Returns the disassembly of the given SPIR-V binary, as a string.
 // Assumes the disassembly will be successful when targeting Vulkan.
 std::string Disassemble(const std::vector<uint32_t> binary) {
@@ -182,6 +199,16 @@ std::string Disassemble(const std::vector<uint32_t> binary) {
   return result;
 }
 
+// Returns the number of times substr occurs in text.
+size_t CountOccurrences(const std::string& text, const std::string& substr) {
+  size_t count = 0;
+  for (size_t at = text.find(substr); at != std::string::npos;
+       at = text.find(substr, at + substr.size())) {
+    ++count;
+  }
+  return count;
+}
+
 // A CountingIncluder that never returns valid content for a requested
 // file inclusion.
 class DummyCountingIncluder : public shaderc_util::CountingIncluder {
@@ -244,6 +271,25 @@ class CompilerTest : public testing::Test {
     return words;
   }
 
+  // Returns true if the given shader compiles, checking the given
+  // cancellation, and writes the binary to *words.
+  bool CancellableCompilation(std::string source, EShLanguage stage,
+                              const shaderc_util::Cancellation& cancellation,
+                              std::vector<uint32_t>* words) {
+    shaderc_util::GlslangInitializer initializer;
+    std::stringstream errors;
+    size_t total_warnings = 0;
+    size_t total_errors = 0;
+    bool result = false;
+    DummyCountingIncluder dummy_includer;
+    std::tie(result, *words, std::ignore) = compiler_.Compile(
+        source, stage, "shader", "main", dummy_stage_callback_, dummy_includer,
+        Compiler::OutputType::SpirvBinary, &errors, &total_warnings,
+        &total_errors, nullptr, nullptr, nullptr, &cancellation);
+    errors_ = errors.str();
+    return result;
+  }
+
  protected:
   Compiler compiler_;
   // The error string from the most recent compilation.
@@ -801,6 +847,116 @@ TEST_F(CompilerTest, HlslLegalizationEnabledWithSizeOpt) {
   EXPECT_THAT(disassembly, Not(HasSubstr("OpName"))) << disassembly;
 }
 
+TEST_F(CompilerTest, HlslLegalizationEnabledWithFastCompileOpt) {
+  compiler_.SetSourceLanguage(Compiler::SourceLanguage::HLSL);
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::FastCompile);
+  const auto words =
+      SimpleCompilationBinary(kHlslShaderForLegalizationTest, EShLangFragment);
+  const auto disassembly = Disassemble(words);
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpFunctionCall"))) << disassembly;
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpName"))) << disassembly;
+}
+
+TEST_F(CompilerTest, HlslLegalizationEnabledWithMinimumSizeOpt) {
+  compiler_.SetSourceLanguage(Compiler::SourceLanguage::HLSL);
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::MinimumSize);
+  const auto words =
+      SimpleCompilationBinary(kHlslShaderForLegalizationTest, EShLangFragment);
+  const auto disassembly = Disassemble(words);
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpFunctionCall"))) << disassembly;
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpName"))) << disassembly;
+}
+
+TEST_F(CompilerTest, MinimumSizeOptStripsNonSemanticInfo) {
+  compiler_.SetSourceLanguage(Compiler::SourceLanguage::HLSL);
+  compiler_.EnableHlslFunctionality1(true);
+  compiler_.SetAutoBindUniforms(true);  // Counter variable needs a binding.
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::MinimumSize);
+  const auto words =
+      SimpleCompilationBinary(kHlslShaderWithCounterBuffer, EShLangFragment);
+  const auto disassembly = Disassemble(words);
+  EXPECT_THAT(disassembly, Not(HasSubstr("SPV_GOOGLE_hlsl_functionality1")))
+      << disassembly;
+  EXPECT_THAT(disassembly, Not(HasSubstr("UserSemantic"))) << disassembly;
+}
+
+TEST_F(CompilerTest, MinimumSizeOptRecordsStages) {
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::MinimumSize);
+  compiler_.SetGenerateDebugInfo();
+  shaderc_util::GlslangInitializer initializer;
+  DummyCountingIncluder includer;
+  std::stringstream errors;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  bool result = false;
+  std::vector<uint32_t> words;
+  std::vector<shaderc_util::OptimizationStage> stages;
+  std::tie(result, words, std::ignore) = compiler_.Compile(
+      kVertexShader, EShLangVertex, "shader", "main", dummy_stage_callback_,
+      includer, Compiler::OutputType::SpirvBinary, &errors, &total_warnings,
+      &total_errors, nullptr, &stages);
+  ASSERT_TRUE(result) << errors.str();
+  // Debug information is kept, so nothing is stripped.
+  EXPECT_THAT(Disassemble(words), HasSubstr("OpName"));
+  std::vector<std::string> names;
+  for (const auto& stage : stages) names.push_back(stage.name);
+  EXPECT_THAT(names, ElementsAre("input", "size", "remove-duplicates",
+                                 "compact-ids", "recompaction"));
+  EXPECT_EQ(words.size() * sizeof(uint32_t), stages.back().size_in_bytes);
+}
+
+TEST_F(CompilerTest, GenericProfileUnrollsAndKeeps32BitFloats) {
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::Performance);
+  compiler_.SetOptimizationProfile(Compiler::OptimizationProfile::Generic);
+  const auto disassembly = Disassemble(
+      SimpleCompilationBinary(kGlslShaderWithRelaxedLoop, EShLangFragment));
+  EXPECT_EQ(0u, CountOccurrences(disassembly, "OpLoopMerge")) << disassembly;
+  EXPECT_EQ(0u, CountOccurrences(disassembly, "OpTypeFloat 16"))
+      << disassembly;
+  EXPECT_EQ(0u, CountOccurrences(disassembly, "OpFConvert")) << disassembly;
+}
+
+TEST_F(CompilerTest, MobileProfileKeepsLoopsAndUses16BitFloats) {
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::Performance);
+  compiler_.SetOptimizationProfile(Compiler::OptimizationProfile::Mobile);
+  const auto disassembly = Disassemble(
+      SimpleCompilationBinary(kGlslShaderWithRelaxedLoop, EShLangFragment));
+  EXPECT_EQ(1u, CountOccurrences(disassembly, "OpLoopMerge")) << disassembly;
+  EXPECT_EQ(1u, CountOccurrences(disassembly, "OpCapability Float16"))
+      << disassembly;
+  EXPECT_EQ(1u, CountOccurrences(disassembly, "OpTypeFloat 16"))
+      << disassembly;
+  // The input is converted to half precision, and the result back.
+  EXPECT_LE(2u, CountOccurrences(disassembly, "OpFConvert")) << disassembly;
+}
+
+TEST_F(CompilerTest, OptimizationProfileCanBeSetBeforeLevel) {
+  compiler_.SetOptimizationProfile(Compiler::OptimizationProfile::Mobile);
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::Performance);
+  const auto disassembly = Disassemble(
+      SimpleCompilationBinary(kGlslShaderWithRelaxedLoop, EShLangFragment));
+  EXPECT_EQ(1u, CountOccurrences(disassembly, "OpLoopMerge")) << disassembly;
+}
+
+TEST_F(CompilerTest, OptimizationProfileHasNoEffectAtOtherLevels) {
+  compiler_.SetOptimizationProfile(Compiler::OptimizationProfile::Mobile);
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::Size);
+  const auto disassembly = Disassemble(
+      SimpleCompilationBinary(kGlslShaderWithRelaxedLoop, EShLangFragment));
+  EXPECT_EQ(0u, CountOccurrences(disassembly, "OpTypeFloat 16"))
+      << disassembly;
+}
+
+TEST(OptimizationProfileTest, PassListsAreValid) {
+  std::string errors;
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES)                            \
+  EXPECT_TRUE(shaderc_util::SpirvToolsValidatePassFlags(                     \
+      shaderc_util::ParseSpirvOptPassList(PASSES), &errors))                 \
+      << #CNAME ": " << errors;
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+}
+
 TEST_F(CompilerTest, HlslLegalizationDisabled) {
   compiler_.SetSourceLanguage(Compiler::SourceLanguage::HLSL);
   compiler_.EnableHlslLegalization(false);
@@ -854,6 +1010,409 @@ TEST_F(CompilerTest, ClampMapsToFClampWithNanClamp) {
       << disassembly;
 }
 
+TEST_F(CompilerTest, OptimizerPassesRunWithoutOptimizationLevel) {
+  std::string errors;
+  ASSERT_TRUE(compiler_.SetOptimizerPasses({"--strip-debug"}, &errors))
+      << errors;
+  const auto words =
+      SimpleCompilationBinary(kGlslShaderWithClamp, EShLangFragment);
+  const auto disassembly = Disassemble(words);
+  EXPECT_THAT(disassembly, Not(HasSubstr("OpName"))) << disassembly;
+}
+
+TEST_F(CompilerTest, OptimizerPassesRejectUnknownFlag) {
+  std::string errors;
+  EXPECT_FALSE(compiler_.SetOptimizerPasses({"--no-such-pass"}, &errors));
+  EXPECT_THAT(errors, HasSubstr("--no-such-pass"));
+}
+
+TEST_F(CompilerTest, OptimizerPassesRejectMalformedFlag) {
+  std::string errors;
+  EXPECT_FALSE(compiler_.SetOptimizerPasses({"strip-debug"}, &errors));
+  EXPECT_THAT(errors, HasSubstr("invalid optimizer flag 'strip-debug'"));
+}
+
+TEST_F(CompilerTest, OptimizeSpirvMatchesOptimizedCompile) {
+  const auto unoptimized =
+      SimpleCompilationBinary(kGlslShaderWithClamp, EShLangFragment);
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::Performance);
+  const auto optimized =
+      SimpleCompilationBinary(kGlslShaderWithClamp, EShLangFragment);
+  auto words = unoptimized;
+  std::string errors;
+  ASSERT_TRUE(compiler_.OptimizeSpirv(&words, &errors)) << errors;
+  EXPECT_EQ(optimized, words);
+  EXPECT_NE(unoptimized, words);
+}
+
+// A fragment shader whose branch depends on a specialization constant.
+const char kSpecializableShader[] = R"(#version 450
+layout(constant_id = 3) const bool kFancy = false;
+layout(constant_id = 5) const int kCount = 2;
+layout(location = 0) out vec4 color;
+void main() {
+  if (kFancy) {
+    color = vec4(cos(float(kCount)));
+  } else {
+    color = vec4(1.0);
+  }
+}
+)";
+
+TEST_F(CompilerTest, SpecializeSpirvFreezesConstantsAndRemovesDeadCode) {
+  const auto unspecialized =
+      SimpleCompilationBinary(kSpecializableShader, EShLangFragment);
+  std::string errors;
+  auto fancy = unspecialized;
+  ASSERT_TRUE(compiler_.SpecializeSpirv({{3, "true"}, {5, "7"}}, &fancy,
+                                        &errors))
+      << errors;
+  EXPECT_THAT(Disassemble(fancy), Not(HasSubstr("OpSpecConstant")));
+  EXPECT_THAT(Disassemble(fancy), HasSubstr("Cos"));
+
+  // Constants that are not given keep their default values.
+  auto plain = unspecialized;
+  ASSERT_TRUE(compiler_.SpecializeSpirv({}, &plain, &errors)) << errors;
+  EXPECT_THAT(Disassemble(plain), Not(HasSubstr("OpSpecConstant")));
+  EXPECT_THAT(Disassemble(plain), Not(HasSubstr("Cos")));
+}
+
+TEST_F(CompilerTest, SpecializeSpirvRejectsUnknownSpecId) {
+  auto words = SimpleCompilationBinary(kSpecializableShader, EShLangFragment);
+  std::string errors;
+  EXPECT_FALSE(compiler_.SpecializeSpirv({{9, "1"}}, &words, &errors));
+  EXPECT_THAT(errors, HasSubstr("no specialization constant has SpecId 9"));
+}
+
+// A fragment shader that samples a texture only for rough materials.
+const char kBakeableShader[] = R"(#version 450
+layout(set = 0, binding = 1) uniform Material { float roughness; vec4 tint; };
+layout(set = 0, binding = 2) uniform sampler2D detail;
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 color;
+void main() {
+  color = tint;
+  if (roughness > 0.5) color *= texture(detail, uv);
+}
+)";
+
+TEST_F(CompilerTest, CompileBakesUniformsAndReportsRemovedBindings) {
+  compiler_.AddBakedUniform({"Material", "roughness", "0.25"});
+  compiler_.AddBakedUniform({"Material", "tint", "1,0,0,1"});
+  shaderc_util::GlslangInitializer initializer;
+  DummyCountingIncluder includer;
+  std::stringstream errors;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  bool result = false;
+  std::vector<uint32_t> words;
+  std::vector<shaderc_util::DescriptorBinding> removed;
+  std::tie(result, words, std::ignore) = compiler_.Compile(
+      kBakeableShader, EShLangFragment, "shader", "main",
+      dummy_stage_callback_, includer, Compiler::OutputType::SpirvBinary,
+      &errors, &total_warnings, &total_errors, &removed);
+  ASSERT_TRUE(result) << errors.str();
+  const std::string text = Disassemble(words);
+  EXPECT_THAT(text, Not(HasSubstr("ImageSampleImplicitLod")));
+  EXPECT_THAT(text, Not(HasSubstr("Binding")));
+  ASSERT_EQ(2u, removed.size());
+  EXPECT_EQ(1u, removed[0].binding);
+  EXPECT_EQ(shaderc_util::DescriptorType::UniformBuffer, removed[0].type);
+  EXPECT_EQ(2u, removed[1].binding);
+  EXPECT_EQ(shaderc_util::DescriptorType::CombinedImageSampler,
+            removed[1].type);
+  EXPECT_EQ(0x10u, removed[1].stage_flags);
+}
+
+TEST_F(CompilerTest, CompileRejectsBadBakedValue) {
+  compiler_.AddBakedUniform({"Material", "roughness", "rough"});
+  EXPECT_FALSE(SimpleCompilationSucceeds(kBakeableShader, EShLangFragment));
+  EXPECT_THAT(errors_, HasSubstr("shader: error: cannot bake "
+                                 "'Material.roughness': invalid value"));
+}
+
+// A compute shader with a fixed workgroup size.
+const char kComputeShader[] = R"(#version 450
+layout(local_size_x = 8, local_size_y = 8) in;
+layout(set = 0, binding = 0) buffer Data { uint values[]; };
+void main() { values[gl_LocalInvocationIndex] = 1u; }
+)";
+
+TEST_F(CompilerTest, CompileOverridesWorkgroupSize) {
+  compiler_.SetWorkgroupSize(64, 1, 0);
+  compiler_.SetWorkgroupSizeSpecIds(0, 1, 2);
+  const std::string text =
+      Disassemble(SimpleCompilationBinary(kComputeShader, EShLangCompute));
+  EXPECT_THAT(text, HasSubstr("LocalSize 64 1 1"));
+  EXPECT_THAT(text, HasSubstr("BuiltIn WorkgroupSize"));
+  EXPECT_THAT(text, HasSubstr("SpecId 2"));
+}
+
+TEST_F(CompilerTest, CompileRejectsOverridingFoldedWorkgroupSize) {
+  compiler_.SetWorkgroupSize(64, 1, 1);
+  EXPECT_FALSE(SimpleCompilationSucceeds(
+      R"(#version 450
+         layout(local_size_x = 8) in;
+         layout(set = 0, binding = 0) buffer Data { uint values[]; };
+         void main() { values[0] = gl_WorkGroupSize.x; })",
+      EShLangCompute));
+  EXPECT_THAT(errors_, HasSubstr("shader: error: cannot change workgroup "
+                                 "size component x"));
+}
+
+// A vertex shader with an output that kPipelineFragShader does not read.
+const char kPipelineVertShader[] = R"(#version 450
+layout(location = 0) in vec4 pos;
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec4 unused;
+layout(location = 2) out vec2 uv;
+void main() {
+  gl_Position = pos;
+  color = pos * 2.0;
+  unused = pos.yxzw;
+  uv = pos.xy;
+}
+)";
+
+const char kPipelineFragShader[] = R"(#version 450
+layout(location = 0) in vec4 color;
+layout(location = 2) in vec2 uv;
+layout(location = 0) out vec4 frag;
+void main() { frag = color + vec4(uv, 0.0, 0.0); }
+)";
+
+TEST_F(CompilerTest, CompilePipelineRemovesDeadOutputsAndPacksLocations) {
+  shaderc_util::GlslangInitializer initializer;
+  DummyCountingIncluder includer;
+  std::stringstream errors;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  const auto outputs = compiler_.CompilePipeline(
+      {{kPipelineVertShader, EShLangVertex, "vert", "main"},
+       {kPipelineFragShader, EShLangFragment, "frag", "main"}},
+      includer, Compiler::OutputType::SpirvAssemblyText, nullptr, &errors,
+      &total_warnings, &total_errors);
+  ASSERT_EQ(2u, outputs.size());
+  ASSERT_TRUE(outputs[0].succeeded) << errors.str() << outputs[0].errors;
+  ASSERT_TRUE(outputs[1].succeeded);
+  const std::string vertex(
+      reinterpret_cast<const char*>(outputs[0].data.data()),
+      outputs[0].size_in_bytes);
+  const std::string fragment(
+      reinterpret_cast<const char*>(outputs[1].data.data()),
+      outputs[1].size_in_bytes);
+  EXPECT_THAT(vertex, Not(HasSubstr("%unused")));
+  EXPECT_THAT(vertex, HasSubstr("BuiltIn Position"));
+  EXPECT_THAT(vertex, HasSubstr("OpDecorate %color Location 0"));
+  EXPECT_THAT(vertex, HasSubstr("OpDecorate %uv Location 1"));
+  EXPECT_THAT(fragment, HasSubstr("OpDecorate %color Location 0"));
+  EXPECT_THAT(fragment, HasSubstr("OpDecorate %uv Location 1"));
+}
+
+TEST_F(CompilerTest, CompilePipelineRejectsRepeatedStage) {
+  shaderc_util::GlslangInitializer initializer;
+  DummyCountingIncluder includer;
+  std::stringstream errors;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  const auto outputs = compiler_.CompilePipeline(
+      {{kPipelineFragShader, EShLangFragment, "a.frag", "main"},
+       {kPipelineFragShader, EShLangFragment, "b.frag", "main"}},
+      includer, Compiler::OutputType::SpirvBinary, nullptr, &errors,
+      &total_warnings, &total_errors);
+  ASSERT_EQ(2u, outputs.size());
+  EXPECT_FALSE(outputs[0].succeeded);
+  EXPECT_FALSE(outputs[1].succeeded);
+  EXPECT_EQ(1u, total_errors);
+  EXPECT_THAT(errors.str(), HasSubstr("b.frag: error: the pipeline has more "
+                                      "than one shader for this stage"));
+}
+
+const char kBindingsVertShader[] = R"(#version 450
+layout(set = 2, binding = 5) uniform Transform { mat4 mvp; } transform;
+layout(set = 2, binding = 7) uniform Unused { vec4 value; } unused;
+void main() { gl_Position = transform.mvp * vec4(1.0); }
+)";
+
+const char kBindingsFragShader[] = R"(#version 450
+layout(set = 2, binding = 5) uniform Transform { mat4 mvp; } transform;
+layout(set = 4, binding = 3) uniform sampler2D textures[4];
+layout(location = 0) out vec4 color;
+void main() { color = texture(textures[1], vec2(0.5)) + transform.mvp[0]; }
+)";
+
+TEST_F(CompilerTest, CompilePipelineCompactsDescriptorBindings) {
+  shaderc_util::GlslangInitializer initializer;
+  DummyCountingIncluder includer;
+  std::stringstream errors;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  std::vector<shaderc_util::DescriptorBinding> layout;
+  compiler_.SetCompactPipelineBindings(true);
+  const auto outputs = compiler_.CompilePipeline(
+      {{kBindingsVertShader, EShLangVertex, "vert", "main"},
+       {kBindingsFragShader, EShLangFragment, "frag", "main"}},
+      includer, Compiler::OutputType::SpirvAssemblyText, &layout, &errors,
+      &total_warnings, &total_errors);
+  ASSERT_EQ(2u, outputs.size());
+  ASSERT_TRUE(outputs[0].succeeded) << errors.str() << outputs[0].errors;
+  const std::string vertex(
+      reinterpret_cast<const char*>(outputs[0].data.data()),
+      outputs[0].size_in_bytes);
+  const std::string fragment(
+      reinterpret_cast<const char*>(outputs[1].data.data()),
+      outputs[1].size_in_bytes);
+  EXPECT_THAT(vertex, Not(HasSubstr("%unused")));
+  EXPECT_THAT(vertex, HasSubstr("OpDecorate %transform DescriptorSet 0"));
+  EXPECT_THAT(vertex, HasSubstr("OpDecorate %transform Binding 0"));
+  EXPECT_THAT(fragment, HasSubstr("OpDecorate %transform DescriptorSet 0"));
+  EXPECT_THAT(fragment, HasSubstr("OpDecorate %textures DescriptorSet 1"));
+  EXPECT_THAT(fragment, HasSubstr("OpDecorate %textures Binding 0"));
+
+  ASSERT_EQ(2u, layout.size());
+  EXPECT_EQ(0u, layout[0].set);
+  EXPECT_EQ(0u, layout[0].binding);
+  EXPECT_EQ(shaderc_util::DescriptorType::UniformBuffer, layout[0].type);
+  EXPECT_EQ(1u, layout[0].count);
+  EXPECT_EQ(0x11u, layout[0].stage_flags);
+  EXPECT_EQ(1u, layout[1].set);
+  EXPECT_EQ(0u, layout[1].binding);
+  EXPECT_EQ(shaderc_util::DescriptorType::CombinedImageSampler,
+            layout[1].type);
+  EXPECT_EQ(4u, layout[1].count);
+  EXPECT_EQ(0x10u, layout[1].stage_flags);
+}
+
+TEST_F(CompilerTest, CompilePipelineReportsLayoutWithoutCompacting) {
+  shaderc_util::GlslangInitializer initializer;
+  DummyCountingIncluder includer;
+  std::stringstream errors;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  std::vector<shaderc_util::DescriptorBinding> layout;
+  const auto outputs = compiler_.CompilePipeline(
+      {{kBindingsVertShader, EShLangVertex, "vert", "main"},
+       {kBindingsFragShader, EShLangFragment, "frag", "main"}},
+      includer, Compiler::OutputType::SpirvBinary, &layout, &errors,
+      &total_warnings, &total_errors);
+  ASSERT_TRUE(outputs[0].succeeded) << errors.str() << outputs[0].errors;
+  ASSERT_FALSE(layout.empty());
+  EXPECT_EQ(2u, layout.front().set);
+  EXPECT_EQ(5u, layout.front().binding);
+  EXPECT_EQ(4u, layout.back().set);
+  EXPECT_EQ(3u, layout.back().binding);
+}
+
+// A prelude declaring a function and leaving one of its two macros defined.
+const char kPrelude[] =
+    "#define SCALE 2.0\n"
+    "#define OFFSET 1.0\n"
+    "float scaled(float x) { return x * SCALE + OFFSET; }\n"
+    "#undef OFFSET\n";
+
+TEST_F(CompilerTest, PreludeDeclarationsAndMacrosReachSource) {
+  compiler_.SetPrelude(
+      std::make_shared<shaderc_util::Prelude>(kPrelude, "prelude.glsl"));
+  const std::string source =
+      "#version 450\n"
+      "layout(location = 0) out float o;\n"
+      "#ifdef OFFSET\n"
+      "#error OFFSET was left defined\n"
+      "#endif\n"
+      "void main() { o = scaled(SCALE); }\n";
+  EXPECT_TRUE(SimpleCompilationSucceeds(source, EShLangFragment)) << errors_;
+  // The second compile uses the prepared prelude.
+  EXPECT_TRUE(SimpleCompilationSucceeds(source, EShLangFragment)) << errors_;
+}
+
+TEST_F(CompilerTest, PreludeKeepsLinesOfPreludeAndSource) {
+  compiler_.SetPrelude(std::make_shared<shaderc_util::Prelude>(
+      "float x;\n#error in prelude\n", "prelude.glsl"));
+  EXPECT_FALSE(SimpleCompilationSucceeds("#version 450\nvoid main() {}\n",
+                                         EShLangFragment));
+  EXPECT_THAT(errors_, HasSubstr("prelude.glsl:2:"));
+
+  compiler_.SetPrelude(std::make_shared<shaderc_util::Prelude>(
+      kPrelude, "prelude.glsl"));
+  EXPECT_FALSE(SimpleCompilationSucceeds(
+      "#version 450\n\nvoid main() { bogus; }\n", EShLangFragment));
+  EXPECT_THAT(errors_, HasSubstr("shader:3:"));
+}
+
+TEST_F(CompilerTest, CancelledCompileFailsWithMessage) {
+  std::atomic<bool> flag(true);
+  const shaderc_util::Cancellation cancellation(
+      &flag, shaderc_util::Cancellation::Clock::time_point::max());
+  std::vector<uint32_t> words;
+  EXPECT_FALSE(CancellableCompilation(kVulkanVertexShader, EShLangVertex,
+                                      cancellation, &words));
+  EXPECT_TRUE(cancellation.was_cancelled());
+  EXPECT_THAT(errors_, HasSubstr("shader: error: compilation cancelled"));
+}
+
+TEST_F(CompilerTest, PassedDeadlineFailsCompile) {
+  const shaderc_util::Cancellation cancellation(
+      nullptr, shaderc_util::Cancellation::Clock::now());
+  std::vector<uint32_t> words;
+  EXPECT_FALSE(CancellableCompilation(kVulkanVertexShader, EShLangVertex,
+                                      cancellation, &words));
+  EXPECT_THAT(errors_,
+              HasSubstr("shader: error: compilation exceeded its deadline"));
+}
+
+TEST_F(CompilerTest, CancellableCompileRunsEveryOptimizerPass) {
+  // The optimizer passes then run in small groups.
+  compiler_.SetOptimizationLevel(Compiler::OptimizationLevel::Performance);
+  std::atomic<bool> flag(false);
+  const shaderc_util::Cancellation cancellation(
+      &flag, shaderc_util::Cancellation::Clock::time_point::max());
+  std::vector<uint32_t> words;
+  EXPECT_TRUE(CancellableCompilation(kGlslShaderWithRelaxedLoop,
+                                     EShLangFragment, cancellation, &words))
+      << errors_;
+  EXPECT_FALSE(cancellation.was_cancelled());
+  const auto disassembly = Disassemble(words);
+  EXPECT_EQ(0u, CountOccurrences(disassembly, "OpLoopMerge")) << disassembly;
+  EXPECT_EQ(0u, CountOccurrences(disassembly, "OpFConvert")) << disassembly;
+}
+
+TEST_F(CompilerTest, CancelBetweenOptimizerPassesStopsOptimizing) {
+  std::vector<uint32_t> binary =
+      SimpleCompilationBinary(kGlslShaderWithRelaxedLoop, EShLangFragment);
+  // More copies of -O than can run before the flag is set.
+  const std::vector<shaderc_util::PassId> passes(
+      1000, shaderc_util::PassId::kPerformancePasses);
+  std::atomic<bool> flag(false);
+  const shaderc_util::Cancellation cancellation(
+      &flag, shaderc_util::Cancellation::Clock::time_point::max());
+  std::thread canceller([&flag] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    flag = true;
+  });
+  spvtools::OptimizerOptions options;
+  std::string errors;
+  const bool succeeded = shaderc_util::SpirvToolsOptimize(
+      Compiler::TargetEnv::Vulkan, Compiler::TargetEnvVersion::Vulkan_1_0,
+      passes, {}, options, &binary, &errors, nullptr, &cancellation);
+  canceller.join();
+  EXPECT_FALSE(succeeded);
+  EXPECT_TRUE(cancellation.was_cancelled());
+  // -O is split into groups of passes, so the cancel is noticed at the next
+  // group.
+  EXPECT_EQ("compilation cancelled", errors);
+}
+
+TEST(ParseSpirvOptPassList, SplitsOnWhitespaceAndSkipsComments) {
+  EXPECT_THAT(shaderc_util::ParseSpirvOptPassList(""),
+              Eq(std::vector<std::string>{}));
+  EXPECT_THAT(shaderc_util::ParseSpirvOptPassList(
+                  "# A comment.\n--loop-unroll\t--scalar-replacement=100\n"
+                  "  -O # trailing comment --not-a-flag\n--compact-ids"),
+              Eq(std::vector<std::string>{"--loop-unroll",
+                                          "--scalar-replacement=100", "-O",
+                                          "--compact-ids"}));
+}
+
 // A test coase for Glslang
 // expected vector after the conversion.
 struct GetGlslangClientInfoCase {
@@ -14,6 +14,7 @@
 
 #include "libshaderc_util/counting_includer.h"
 
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -48,6 +49,23 @@ class ConcreteCountingIncluder : public shaderc_util::CountingIncluder {
   std::vector<IncludeResult*> results_;
 };
 
+// A CountingIncluder that resolves every request to a file of that name,
+// whose contents are the name repeated twice.
+class ResolvingIncluder : public shaderc_util::CountingIncluder {
+ public:
+  using IncludeResult = glslang::TShader::Includer::IncludeResult;
+  virtual IncludeResult* include_delegate(const char* requested, const char*,
+                                          IncludeType, size_t) override {
+    auto* contents = new std::string(std::string(requested) + requested);
+    return new IncludeResult{requested, contents->data(), contents->size(),
+                             contents};
+  }
+  virtual void release_delegate(IncludeResult* include_result) override {
+    delete static_cast<std::string*>(include_result->userData);
+    delete include_result;
+  }
+};
+
 TEST(CountingIncluderTest, InitialCount) {
   EXPECT_EQ(0, ConcreteCountingIncluder().num_include_directives());
 }
@@ -74,6 +92,86 @@ TEST(CountingIncluderTest, ManyIncludes) {
   EXPECT_EQ(200, includer.num_include_directives());
 }
 
+TEST(CountingIncluderTest, NoStatsForUnresolvedIncludes) {
+  ConcreteCountingIncluder includer;
+  includer.includeLocal("random file name", "from me", 0);
+  EXPECT_TRUE(includer.include_stats().empty());
+}
+
+TEST(CountingIncluderTest, StatsPerResolvedFile) {
+  ResolvingIncluder includer;
+  includer.releaseInclude(includer.includeLocal("a.h", "main.vert", 0));
+  includer.releaseInclude(includer.includeSystem("bb.h", "main.vert", 0));
+  includer.releaseInclude(includer.includeLocal("a.h", "bb.h", 1));
+  const auto stats = includer.include_stats();
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_EQ(2, stats.at("a.h").count);
+  EXPECT_EQ(12u, stats.at("a.h").bytes);
+  EXPECT_EQ(1, stats.at("bb.h").count);
+  EXPECT_EQ(8u, stats.at("bb.h").bytes);
+}
+
+TEST(CountingIncluderTest, TimeCoversNestedIncludes) {
+  ResolvingIncluder includer;
+  auto* outer = includer.includeLocal("outer.h", "main.vert", 0);
+  auto* inner = includer.includeLocal("inner.h", "outer.h", 1);
+  // Neither is timed until it is released.
+  EXPECT_EQ(0, includer.include_stats().at("outer.h").time.count());
+  includer.releaseInclude(inner);
+  includer.releaseInclude(outer);
+  const auto stats = includer.include_stats();
+  EXPECT_GE(stats.at("outer.h").time, stats.at("inner.h").time);
+}
+
+TEST(CountingIncluderTest, ResetReplacesStats) {
+  ResolvingIncluder includer;
+  includer.releaseInclude(includer.includeLocal("a.h", "main.vert", 0));
+  shaderc_util::CountingIncluder::IncludeStats prelude_stats;
+  prelude_stats.count = 1;
+  prelude_stats.bytes = 20;
+  includer.ResetIncludeStats({{"prelude.h", prelude_stats}});
+  includer.releaseInclude(includer.includeLocal("bb.h", "main.vert", 0));
+  const auto stats = includer.include_stats();
+  ASSERT_EQ(2u, stats.size());
+  EXPECT_EQ(20u, stats.at("prelude.h").bytes);
+  EXPECT_EQ(1, stats.at("bb.h").count);
+  EXPECT_EQ(0u, stats.count("a.h"));
+}
+
+TEST(CountingIncluderTest, FailsRequestsPastIncludeLimit) {
+  ResolvingIncluder includer;
+  includer.SetLimits(2, 0);
+  includer.releaseInclude(includer.includeLocal("a.h", "main.vert", 0));
+  includer.releaseInclude(includer.includeLocal("b.h", "main.vert", 0));
+  auto* failed = includer.includeLocal("c.h", "main.vert", 0);
+  EXPECT_EQ("", failed->headerName);
+  EXPECT_EQ("exceeded the limit of 2 includes",
+            std::string(failed->headerData, failed->headerLength));
+  includer.releaseInclude(failed);
+  EXPECT_EQ(0u, includer.include_stats().count("c.h"));
+
+  // Setting the limits again starts the count afresh.
+  includer.SetLimits(2, 0);
+  auto* resolved = includer.includeLocal("c.h", "main.vert", 0);
+  EXPECT_EQ("c.h", resolved->headerName);
+  includer.releaseInclude(resolved);
+}
+
+TEST(CountingIncluderTest, FailsRequestsPastByteLimit) {
+  ResolvingIncluder includer;
+  includer.SetLimits(0, 10);
+  includer.releaseInclude(includer.includeLocal("a.h", "main.vert", 0));
+  includer.releaseInclude(includer.includeLocal("b.h", "main.vert", 0));
+  // 6 + 6 bytes is past the limit, so the second file is released unused.
+  const auto stats = includer.include_stats();
+  EXPECT_EQ(1u, stats.count("a.h"));
+  EXPECT_EQ(0u, stats.count("b.h"));
+  auto* failed = includer.includeLocal("b.h", "main.vert", 0);
+  EXPECT_EQ("exceeded the limit of 10 bytes of included source",
+            std::string(failed->headerData, failed->headerLength));
+  includer.releaseInclude(failed);
+}
+
 #ifndef SHADERC_DISABLE_THREADED_TESTS
 TEST(CountingIncluderTest, ThreadedIncludes) {
   ConcreteCountingIncluder includer;
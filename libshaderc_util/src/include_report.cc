@@ -0,0 +1,67 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/include_report.h"
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "libshaderc_util/json.h"
+
+namespace shaderc_util {
+
+std::string IncludeReportToJson(
+    const std::map<std::string, CountingIncluder::IncludeStats>& stats,
+    const SizeAttribution& attribution) {
+  // Without any named file, the module had no lines to attribute words by.
+  std::map<std::string, uint64_t> file_words;
+  for (const SizeAttribution::Contributor& file : attribution.files) {
+    if (!file.name.empty()) file_words[file.name] = file.words;
+  }
+  const bool has_lines = !file_words.empty();
+
+  using Entry = std::pair<const std::string, CountingIncluder::IncludeStats>;
+  std::vector<const Entry*> entries;
+  for (const Entry& entry : stats) entries.push_back(&entry);
+  // The map is ordered by name, which breaks ties.
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry* a, const Entry* b) {
+                     return a->second.time > b->second.time;
+                   });
+
+  std::ostringstream out;
+  out << "{\n  \"includes\": [";
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const std::string& name = entries[i]->first;
+    const CountingIncluder::IncludeStats& file = entries[i]->second;
+    const auto microseconds =
+        std::chrono::duration_cast<std::chrono::microseconds>(file.time);
+    out << (i ? ",\n" : "\n") << "    {\"name\": " << QuoteJson(name)
+        << ", \"count\": " << file.count << ", \"bytes\": " << file.bytes
+        << ", \"microseconds\": " << microseconds.count() << ", \"words\": ";
+    if (has_lines) {
+      auto words = file_words.find(name);
+      out << (words == file_words.end() ? 0 : words->second);
+    } else {
+      out << "null";
+    }
+    out << "}";
+  }
+  out << (entries.empty() ? "]" : "\n  ]") << "\n}";
+  return out.str();
+}
+
+}  // namespace shaderc_util
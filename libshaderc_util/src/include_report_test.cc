@@ -0,0 +1,74 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/include_report.h"
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <map>
+#include <string>
+
+namespace {
+
+using shaderc_util::CountingIncluder;
+using shaderc_util::IncludeReportToJson;
+using shaderc_util::SizeAttribution;
+
+using IncludeStatsMap = std::map<std::string, CountingIncluder::IncludeStats>;
+
+CountingIncluder::IncludeStats Stats(int count, size_t bytes,
+                                     int microseconds) {
+  CountingIncluder::IncludeStats stats;
+  stats.count = count;
+  stats.bytes = bytes;
+  stats.time = std::chrono::microseconds(microseconds);
+  return stats;
+}
+
+TEST(IncludeReportToJson, WritesSlowestFirstWithContributedWords) {
+  const IncludeStatsMap stats = {{"lighting.glsl", Stats(1, 900, 40)},
+                                 {"noise.glsl", Stats(2, 300, 75)},
+                                 {"unused.glsl", Stats(1, 50, 40)}};
+  SizeAttribution attribution;
+  attribution.files = {{"main.frag", 30}, {"noise.glsl", 12}};
+  EXPECT_EQ(
+      "{\n  \"includes\": [\n"
+      "    {\"name\": \"noise.glsl\", \"count\": 2, \"bytes\": 300, "
+      "\"microseconds\": 75, \"words\": 12},\n"
+      "    {\"name\": \"lighting.glsl\", \"count\": 1, \"bytes\": 900, "
+      "\"microseconds\": 40, \"words\": 0},\n"
+      "    {\"name\": \"unused.glsl\", \"count\": 1, \"bytes\": 50, "
+      "\"microseconds\": 40, \"words\": 0}\n  ]\n}",
+      IncludeReportToJson(stats, attribution));
+}
+
+TEST(IncludeReportToJson, WordsAreNullWithoutLines) {
+  const IncludeStatsMap stats = {{"a.glsl", Stats(1, 10, 3)}};
+  SizeAttribution attribution;
+  // The words of functions without any line.
+  attribution.files = {{"", 40}};
+  EXPECT_EQ(
+      "{\n  \"includes\": [\n"
+      "    {\"name\": \"a.glsl\", \"count\": 1, \"bytes\": 10, "
+      "\"microseconds\": 3, \"words\": null}\n  ]\n}",
+      IncludeReportToJson(stats, attribution));
+}
+
+TEST(IncludeReportToJson, EmptyWithoutIncludes) {
+  EXPECT_EQ("{\n  \"includes\": []\n}",
+            IncludeReportToJson(IncludeStatsMap(), SizeAttribution()));
+}
+
+}  // anonymous namespace
@@ -93,8 +93,26 @@ bool ReadFile(const std::string& input_file_name,
       return false;
     }
   }
-  *input_data = std::vector<char>((std::istreambuf_iterator<char>(*stream)),
-                                  std::istreambuf_iterator<char>());
+  input_data->clear();
+  // A file whose size is known is read into a buffer of that size at once,
+  // rather than into one that grows as it goes and is copied each time.
+  // Some files, such as those in /proc, have content but report a size of
+  // 0, so whatever the size, the file is read from its beginning again.
+  if (stream == &input_file) {
+    const std::streamoff size = input_file.seekg(0, std::ios_base::end)
+                                    ? std::streamoff(input_file.tellg())
+                                    : -1;
+    input_file.clear();
+    if (input_file.seekg(0, std::ios_base::beg) && size > 0) {
+      input_data->resize(static_cast<size_t>(size));
+      input_file.read(input_data->data(), size);
+      input_data->resize(static_cast<size_t>(input_file.gcount()));
+    }
+  }
+  // Anything else, such as std::cin, is read until it ends.
+  input_data->insert(input_data->end(),
+                     std::istreambuf_iterator<char>(stream->rdbuf()),
+                     std::istreambuf_iterator<char>());
   return true;
 }
 
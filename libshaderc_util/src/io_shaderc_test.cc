@@ -98,6 +98,14 @@ TEST_F(ReadFileTest, EmptyContent) {
   EXPECT_TRUE(read_data.empty());
 }
 
+#ifdef __linux__
+TEST_F(ReadFileTest, FileWithContentButNoSize) {
+  // Files in /proc report a size of 0.
+  ASSERT_TRUE(ReadFile("/proc/self/status", &read_data));
+  EXPECT_THAT(ToString(read_data), HasSubstr("Name:"));
+}
+#endif
+
 TEST_F(ReadFileTest, FileNotFound) {
   EXPECT_FALSE(ReadFile("garbage garbage vjoiarhiupo hrfewi", &read_data));
 }
@@ -0,0 +1,235 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/json.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+using shaderc_util::JsonValue;
+
+// The most arrays and objects that may be nested in a report.
+const int kMaxJsonDepth = 32;
+
+// Reads a JSON document.
+class JsonReader {
+ public:
+  explicit JsonReader(const std::string& text) : text_(text) {}
+
+  // Reads the whole text as one value into *value.  Returns false if it is
+  // not valid JSON.
+  bool Read(JsonValue* value) {
+    if (!ReadValue(value, 0)) return false;
+    SkipSpace();
+    return at_ == text_.size();
+  }
+
+  // The offset at which reading stopped.
+  size_t offset() const { return at_; }
+
+ private:
+  void SkipSpace() {
+    while (at_ < text_.size() &&
+           std::isspace(static_cast<unsigned char>(text_[at_]))) {
+      ++at_;
+    }
+  }
+
+  // Skips spaces, then consumes c if it comes next.
+  bool Consume(char c) {
+    SkipSpace();
+    if (at_ < text_.size() && text_[at_] == c) {
+      ++at_;
+      return true;
+    }
+    return false;
+  }
+
+  // Consumes the given literal if it comes next.
+  bool ConsumeWord(const char* word) {
+    const std::string expected(word);
+    if (text_.compare(at_, expected.size(), expected) != 0) return false;
+    at_ += expected.size();
+    return true;
+  }
+
+  bool ReadString(std::string* out) {
+    if (!Consume('"')) return false;
+    while (at_ < text_.size() && text_[at_] != '"') {
+      char c = text_[at_++];
+      if (static_cast<unsigned char>(c) < 0x20) return false;
+      if (c != '\\') {
+        out->push_back(c);
+        continue;
+      }
+      if (at_ >= text_.size()) return false;
+      c = text_[at_++];
+      switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+          out->push_back(c);
+          break;
+        case 'b':
+          out->push_back('\b');
+          break;
+        case 'f':
+          out->push_back('\f');
+          break;
+        case 'n':
+          out->push_back('\n');
+          break;
+        case 'r':
+          out->push_back('\r');
+          break;
+        case 't':
+          out->push_back('\t');
+          break;
+        case 'u': {
+          if (at_ + 4 > text_.size()) return false;
+          uint32_t code = 0;
+          for (int i = 0; i < 4; ++i) {
+            const char digit = text_[at_++];
+            if (!std::isxdigit(static_cast<unsigned char>(digit))) {
+              return false;
+            }
+            code = code * 16 + (digit <= '9' ? digit - '0'
+                                             : (digit | 0x20) - 'a' + 10);
+          }
+          // Encode as UTF-8.  Surrogate pairs are kept as two code points.
+          if (code < 0x80) {
+            out->push_back(static_cast<char>(code));
+          } else if (code < 0x800) {
+            out->push_back(static_cast<char>(0xc0 | (code >> 6)));
+            out->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+          } else {
+            out->push_back(static_cast<char>(0xe0 | (code >> 12)));
+            out->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+            out->push_back(static_cast<char>(0x80 | (code & 0x3f)));
+          }
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+    return Consume('"');
+  }
+
+  bool ReadNumber(JsonValue* value) {
+    const size_t start = at_;
+    bool is_integer = true;
+    uint64_t number = 0;
+    while (at_ < text_.size() &&
+           (std::isdigit(static_cast<unsigned char>(text_[at_])) ||
+            std::strchr("+-.eE", text_[at_]))) {
+      const char c = text_[at_++];
+      if (!std::isdigit(static_cast<unsigned char>(c)) ||
+          number > (std::numeric_limits<uint64_t>::max() - 9) / 10) {
+        is_integer = false;
+      } else {
+        number = number * 10 + (c - '0');
+      }
+    }
+    if (at_ == start) return false;
+    value->kind = is_integer ? JsonValue::Kind::Number : JsonValue::Kind::Other;
+    value->number = number;
+    return true;
+  }
+
+  bool ReadValue(JsonValue* value, int depth) {
+    if (depth > kMaxJsonDepth) return false;
+    SkipSpace();
+    if (at_ >= text_.size()) return false;
+    switch (text_[at_]) {
+      case '{':
+        ++at_;
+        value->kind = JsonValue::Kind::Object;
+        if (Consume('}')) return true;
+        do {
+          std::string name;
+          JsonValue member;
+          if (!ReadString(&name) || !Consume(':') ||
+              !ReadValue(&member, depth + 1)) {
+            return false;
+          }
+          value->members.emplace_back(std::move(name), std::move(member));
+        } while (Consume(','));
+        return Consume('}');
+      case '[':
+        ++at_;
+        value->kind = JsonValue::Kind::Array;
+        if (Consume(']')) return true;
+        do {
+          value->items.emplace_back();
+          if (!ReadValue(&value->items.back(), depth + 1)) return false;
+        } while (Consume(','));
+        return Consume(']');
+      case '"':
+        value->kind = JsonValue::Kind::String;
+        return ReadString(&value->string);
+      case 'n':
+        value->kind = JsonValue::Kind::Null;
+        return ConsumeWord("null");
+      case 't':
+        value->kind = JsonValue::Kind::Other;
+        return ConsumeWord("true");
+      case 'f':
+        value->kind = JsonValue::Kind::Other;
+        return ConsumeWord("false");
+      default:
+        return ReadNumber(value);
+    }
+  }
+
+  const std::string& text_;
+  size_t at_ = 0;
+};
+
+}  // anonymous namespace
+
+namespace shaderc_util {
+
+std::string QuoteJson(const string_piece& value) {
+  std::string result = "\"";
+  result.reserve(value.size() + 2);
+  for (const char c : value) {
+    if (c == '"' || c == '\\') {
+      result.push_back('\\');
+      result.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      result += escaped;
+    } else {
+      result.push_back(c);
+    }
+  }
+  return result + "\"";
+}
+
+bool ParseJson(const std::string& text, JsonValue* value,
+               size_t* error_offset) {
+  *value = JsonValue();
+  JsonReader reader(text);
+  if (reader.Read(value)) return true;
+  *error_offset = reader.offset();
+  return false;
+}
+
+}  // namespace shaderc_util
@@ -0,0 +1,67 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/json.h"
+
+#include <gmock/gmock.h>
+
+#include <string>
+
+namespace {
+
+using shaderc_util::JsonValue;
+using shaderc_util::ParseJson;
+using shaderc_util::QuoteJson;
+
+TEST(QuoteJson, EscapesQuotesBackslashesAndControlCharacters) {
+  EXPECT_EQ("\"\"", QuoteJson(""));
+  EXPECT_EQ("\"a.glsl\"", QuoteJson("a.glsl"));
+  EXPECT_EQ("\"say \\\"hi\\\"\"", QuoteJson("say \"hi\""));
+  EXPECT_EQ("\"c:\\\\shaders\"", QuoteJson("c:\\shaders"));
+  EXPECT_EQ("\"a\\u000ab\\u0009\"", QuoteJson("a\nb\t"));
+  EXPECT_EQ("\"\xc3\xa9\"", QuoteJson("\xc3\xa9"));
+}
+
+TEST(QuoteJson, RoundTripsThroughParseJson) {
+  const std::string text("tab\t, quote \", backslash \\, nul \0.", 34);
+  JsonValue value;
+  size_t error_offset = 0;
+  ASSERT_TRUE(ParseJson(QuoteJson(text), &value, &error_offset));
+  EXPECT_EQ(JsonValue::Kind::String, value.kind);
+  EXPECT_EQ(text, value.string);
+}
+
+TEST(ParseJson, ReadsObjectsArraysAndNumbers) {
+  JsonValue value;
+  size_t error_offset = 0;
+  ASSERT_TRUE(ParseJson("{\"files\": [{\"name\": \"a\", \"words\": 12}]}",
+                        &value, &error_offset));
+  const JsonValue* files = value.Find("files");
+  ASSERT_NE(nullptr, files);
+  ASSERT_EQ(1u, files->items.size());
+  const JsonValue* words = files->items[0].Find("words");
+  ASSERT_NE(nullptr, words);
+  EXPECT_EQ(JsonValue::Kind::Number, words->kind);
+  EXPECT_EQ(12u, words->number);
+  EXPECT_EQ(nullptr, value.Find("missing"));
+}
+
+TEST(ParseJson, ReportsWhereReadingStopped) {
+  JsonValue value;
+  size_t error_offset = 0;
+  EXPECT_FALSE(ParseJson("[1, 2,, 3]", &value, &error_offset));
+  EXPECT_EQ(6u, error_offset);
+}
+
+}  // anonymous namespace
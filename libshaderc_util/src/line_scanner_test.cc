@@ -0,0 +1,115 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/line_scanner.h"
+
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The number of allocations made so far by this test program.
+size_t allocations = 0;
+
+}  // anonymous namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* memory = std::malloc(size ? size : 1)) return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+
+namespace {
+
+using shaderc_util::FindByte;
+using shaderc_util::FindLineStartingWith;
+using shaderc_util::LineScanner;
+using shaderc_util::string_piece;
+
+std::vector<std::string> ScanLines(const string_piece& text) {
+  std::vector<std::string> lines;
+  LineScanner scanner(text);
+  for (string_piece line; scanner.Next(&line);) lines.push_back(line.str());
+  return lines;
+}
+
+TEST(FindByte, FindsFirstAtOrAfterPosition) {
+  const string_piece text = "a#b#c";
+  EXPECT_EQ(1u, FindByte(text, '#'));
+  EXPECT_EQ(3u, FindByte(text, '#', 2));
+  EXPECT_EQ(string_piece::npos, FindByte(text, '#', 4));
+  EXPECT_EQ(string_piece::npos, FindByte(text, '#', 10));
+  EXPECT_EQ(string_piece::npos, FindByte(string_piece(), '#'));
+}
+
+TEST(FindLineStartingWith, NeedsPrefixAtLineStart) {
+  EXPECT_EQ(0u, FindLineStartingWith("#version 450\n", "#version"));
+  EXPECT_EQ(18u, FindLineStartingWith("int x; //#version\n#version 450",
+                                     "#version"));
+  EXPECT_EQ(string_piece::npos,
+            FindLineStartingWith("int x; //#version\n", "#version"));
+  EXPECT_EQ(string_piece::npos, FindLineStartingWith("#vers", "#version"));
+}
+
+TEST(LineScanner, KeepsNewlines) {
+  std::vector<std::string> expected_lines;
+  EXPECT_EQ(expected_lines, ScanLines(""));
+  expected_lines = {"one"};
+  EXPECT_EQ(expected_lines, ScanLines("one"));
+  expected_lines = {"one\n"};
+  EXPECT_EQ(expected_lines, ScanLines("one\n"));
+  expected_lines = {"\n", "one\n", "\n", "two"};
+  EXPECT_EQ(expected_lines, ScanLines("\none\n\ntwo"));
+}
+
+TEST(LineScanner, RestIsTheUnreadText) {
+  LineScanner scanner("one\ntwo\n");
+  string_piece line;
+  ASSERT_TRUE(scanner.Next(&line));
+  EXPECT_EQ("two\n", scanner.rest());
+  ASSERT_TRUE(scanner.Next(&line));
+  EXPECT_TRUE(scanner.rest().empty());
+  EXPECT_FALSE(scanner.Next(&line));
+}
+
+TEST(LineScanner, ScansWithoutAllocating) {
+  std::string text = "#version 450\n#extension GL_GOOGLE_include_directive\n";
+  for (int i = 0; i < 10000; ++i) text += "  float x = 1.0; // #line\n";
+  text += "#pragma shader_stage(compute)\n";
+
+  const size_t before = allocations;
+  size_t lines = 0;
+  size_t pounds = 0;
+  LineScanner scanner(text);
+  for (string_piece line; scanner.Next(&line);) {
+    ++lines;
+    if (FindByte(line, '#') != string_piece::npos) ++pounds;
+  }
+  const size_t pragma = FindLineStartingWith(text, "#pragma");
+  EXPECT_EQ(before, allocations);
+
+  EXPECT_EQ(10003u, lines);
+  EXPECT_EQ(10003u, pounds);
+  EXPECT_EQ("#pragma", string_piece(text).substr(pragma, 7));
+}
+
+}  // anonymous namespace
@@ -15,10 +15,15 @@
 #include "libshaderc_util/message.h"
 
 #include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <iterator>
 
+#include "libshaderc_util/json.h"
+#include "libshaderc_util/line_scanner.h"
+
 namespace shaderc_util {
 
 namespace {
@@ -197,7 +202,8 @@ MessageType ParseGlslangOutput(const string_piece& message,
 bool PrintFilteredErrors(const string_piece& file_name,
                          std::ostream* error_stream, bool warnings_as_errors,
                          bool suppress_warnings, const char* error_list,
-                         size_t* total_warnings, size_t* total_errors) {
+                         size_t* total_warnings, size_t* total_errors,
+                         std::vector<Diagnostic>* diagnostics) {
   const char* ignored_error_strings[] = {
       "Warning, version 310 is not yet complete; most version-specific "
       "features are present, but some are missing.",
@@ -219,7 +225,9 @@ bool PrintFilteredErrors(const string_piece& file_name,
       "Linked compute stage:", ""};
   size_t existing_total_errors = *total_errors;
   string_piece error_messages(error_list);
-  for (const string_piece& message : error_messages.get_fields('\n')) {
+  LineScanner scanner(error_messages);
+  for (string_piece message; scanner.Next(&message);) {
+    if (message.back() == '\n') message = message.substr(0, message.size() - 1);
     if (std::find(std::begin(ignored_error_strings),
                   std::end(ignored_error_strings),
                   message) == std::end(ignored_error_strings)) {
@@ -241,9 +249,11 @@ bool PrintFilteredErrors(const string_piece& file_name,
           *error_stream << name << ":" << line_number << ": "
                         << (type == MessageType::Error ? "error: "
                                                        : "warning: ")
-                        << rest.strip_whitespace() << std::endl;
+                        << rest.strip_whitespace() << '\n';
           *total_errors += type == MessageType::Error;
           *total_warnings += type == MessageType::Warning;
+          AddDiagnostic(diagnostics, type == MessageType::Error, name,
+                        std::atoi(line_number.str().c_str()), rest);
           break;
         case MessageType::ErrorSummary:
         case MessageType::WarningSummary:
@@ -256,11 +266,13 @@ bool PrintFilteredErrors(const string_piece& file_name,
           *error_stream << name << ": "
                         << (type == MessageType::GlobalError ? "error"
                                                              : "warning")
-                        << ": " << rest.strip_whitespace() << std::endl;
+                        << ": " << rest.strip_whitespace() << '\n';
+          AddDiagnostic(diagnostics, type == MessageType::GlobalError, name, 0,
+                        rest);
           break;
         case MessageType::Unknown:
           *error_stream << name << ":";
-          *error_stream << " " << message << std::endl;
+          *error_stream << " " << message << '\n';
           break;
         case MessageType::Ignored:
           break;
@@ -270,6 +282,25 @@ bool PrintFilteredErrors(const string_piece& file_name,
   return (existing_total_errors == *total_errors);
 }
 
+void AddDiagnostic(std::vector<Diagnostic>* diagnostics, bool is_error,
+                   const string_piece& file, int line,
+                   const string_piece& message) {
+  if (!diagnostics) return;
+  diagnostics->push_back(
+      {is_error, file.str(), line, message.strip_whitespace().str()});
+}
+
+void WriteDiagnosticJson(const Diagnostic& diagnostic, std::ostream* out) {
+  *out << "{\"severity\": \"" << (diagnostic.is_error ? "error" : "warning")
+       << "\", \"file\": " << QuoteJson(diagnostic.file) << ", \"line\": ";
+  if (diagnostic.line) {
+    *out << diagnostic.line;
+  } else {
+    *out << "null";
+  }
+  *out << ", \"message\": " << QuoteJson(diagnostic.message) << "}\n";
+}
+
 // Outputs the number of warnings and errors if there are any.
 void OutputMessages(std::ostream* error_stream, size_t total_warnings,
                     size_t total_errors) {
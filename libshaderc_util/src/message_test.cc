@@ -21,6 +21,10 @@
 
 #include <gtest/gtest.h>
 
+#include <sstream>
+#include <vector>
+
+using shaderc_util::Diagnostic;
 using shaderc_util::MessageType;
 using shaderc_util::ParseGlslangOutput;
 using shaderc_util::string_piece;
@@ -278,4 +282,67 @@ TEST(ParseGlslangOutputTest, WindowsPath) {
   EXPECT_EQ("wa:ha:ha", rest.str());
 }
 
+TEST(PrintFilteredErrorsTest, CollectsEachDiagnosticWritten) {
+  std::ostringstream errors;
+  std::vector<Diagnostic> diagnostics;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  EXPECT_FALSE(shaderc_util::PrintFilteredErrors(
+      "shader", &errors, false, false,
+      "ERROR: a.frag:3: 'x' : undeclared identifier\n"
+      "WARNING: C:\\b.glsl:12: unused\n"
+      "Warning, version 450 is not yet complete; most version-specific "
+      "features are present, but some are missing.\n"
+      "ERROR: -1:2: bad define\n"
+      "ERROR: 2 compilation errors.  No code generated.\n"
+      "Warning, whole file\n",
+      &total_warnings, &total_errors, &diagnostics));
+  EXPECT_EQ(2u, total_warnings);
+  EXPECT_EQ(2u, total_errors);
+  ASSERT_EQ(4u, diagnostics.size());
+
+  EXPECT_TRUE(diagnostics[0].is_error);
+  EXPECT_EQ("a.frag", diagnostics[0].file);
+  EXPECT_EQ(3, diagnostics[0].line);
+  EXPECT_EQ("'x' : undeclared identifier", diagnostics[0].message);
+
+  EXPECT_FALSE(diagnostics[1].is_error);
+  EXPECT_EQ("C:\\b.glsl", diagnostics[1].file);
+  EXPECT_EQ(12, diagnostics[1].line);
+  EXPECT_EQ("unused", diagnostics[1].message);
+
+  EXPECT_EQ("<command line>", diagnostics[2].file);
+  EXPECT_EQ(2, diagnostics[2].line);
+
+  // A message about the whole file has no line.
+  EXPECT_FALSE(diagnostics[3].is_error);
+  EXPECT_EQ("shader", diagnostics[3].file);
+  EXPECT_EQ(0, diagnostics[3].line);
+  EXPECT_EQ("whole file", diagnostics[3].message);
+}
+
+TEST(PrintFilteredErrorsTest, SuppressedWarningsAreNotCollected) {
+  std::ostringstream errors;
+  std::vector<Diagnostic> diagnostics;
+  size_t total_warnings = 0;
+  size_t total_errors = 0;
+  EXPECT_TRUE(shaderc_util::PrintFilteredErrors(
+      "shader", &errors, false, true, "WARNING: a.frag:1: w\n",
+      &total_warnings, &total_errors, &diagnostics));
+  EXPECT_TRUE(diagnostics.empty());
+}
+
+TEST(WriteDiagnosticJsonTest, QuotesFileAndMessage) {
+  std::ostringstream json;
+  shaderc_util::WriteDiagnosticJson({true, "a\"b.frag", 7, "'c' : bad\\\nline"},
+                                    &json);
+  shaderc_util::WriteDiagnosticJson({false, "d.frag", 0, "w"}, &json);
+  EXPECT_EQ(
+      "{\"severity\": \"error\", \"file\": \"a\\\"b.frag\", \"line\": 7, "
+      "\"message\": \"'c' : bad\\\\\\u000aline\"}\n"
+      "{\"severity\": \"warning\", \"file\": \"d.frag\", \"line\": null, "
+      "\"message\": \"w\"}\n",
+      json.str());
+}
+
 }  // anonymous namespace
@@ -0,0 +1,334 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/prelude.h"
+
+#include <cctype>
+#include <mutex>
+#include <utility>
+
+#include "libshaderc_util/line_scanner.h"
+
+namespace {
+
+using shaderc_util::LineScanner;
+using shaderc_util::string_piece;
+
+// The identifier starting each marker line, followed by the index of the
+// directive it marks.
+const string_piece kMarker = "shaderc_prelude_macro_";
+
+// Returns a 64-bit FNV-1a hash of the name and source, separated by a NUL.
+uint64_t HashPrelude(const std::string& name, const std::string& source) {
+  uint64_t hash = 14695981039346656037ull;
+  auto add = [&hash](unsigned char c) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  };
+  for (const char c : name) add(static_cast<unsigned char>(c));
+  add(0);
+  for (const char c : source) add(static_cast<unsigned char>(c));
+  return hash;
+}
+
+// Returns the offset of the first character of line that is neither space nor
+// part of a comment, or npos if there is none.  *in_comment tells whether
+// line starts inside a block comment, and is updated to tell whether it ends
+// inside one.
+size_t ScanLine(const string_piece& line, bool* in_comment) {
+  size_t first_code = string_piece::npos;
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    const char next = i + 1 < line.size() ? line[i + 1] : '\0';
+    if (*in_comment) {
+      if (c == '*' && next == '/') {
+        *in_comment = false;
+        ++i;
+      }
+    } else if (c == '/' && next == '*') {
+      *in_comment = true;
+      ++i;
+    } else if (c == '/' && next == '/') {
+      break;
+    } else if (first_code == string_piece::npos &&
+               !std::isspace(static_cast<unsigned char>(c))) {
+      first_code = i;
+    }
+  }
+  return first_code;
+}
+
+// Returns the name of the directive starting with the '#' at line[at].
+string_piece DirectiveName(const string_piece& line, size_t at) {
+  size_t begin = at + 1;
+  while (begin < line.size() && (line[begin] == ' ' || line[begin] == '\t')) {
+    ++begin;
+  }
+  size_t end = begin;
+  while (end < line.size() &&
+         std::isalpha(static_cast<unsigned char>(line[end]))) {
+    ++end;
+  }
+  return line.substr(begin, end - begin);
+}
+
+// Returns true if line ends with a backslash, before its line break.
+bool EndsWithBackslash(const string_piece& line) {
+  const string_piece content = line.rstrip("\r\n");
+  return !content.empty() && content.back() == '\\';
+}
+
+// Returns true if line, with surrounding whitespace removed, is the named
+// directive.
+bool IsDirective(const string_piece& line, const string_piece& name) {
+  const string_piece stripped = line.strip_whitespace();
+  return !stripped.empty() && stripped[0] == '#' &&
+         DirectiveName(stripped, 0) == name;
+}
+
+// Returns a #line directive giving the next line the given number.
+std::string LineDirective(size_t next_line, bool is_for_next_line) {
+  return "#line " +
+         std::to_string(is_for_next_line ? next_line : next_line - 1) + "\n";
+}
+
+// Returns a #line directive giving the next line the given number and naming
+// its source.
+std::string LineDirective(size_t next_line, bool is_for_next_line,
+                          const std::string& name) {
+  return "#line " +
+         std::to_string(is_for_next_line ? next_line : next_line - 1) +
+         " \"" + name + "\"\n";
+}
+
+// The text an includer returned, before and after marking.
+struct MarkedInclude {
+  glslang::TShader::Includer::IncludeResult* original;
+  std::string text;
+};
+
+}  // anonymous namespace
+
+namespace shaderc_util {
+
+Prelude::Prelude(std::string source, std::string name)
+    : source_(std::move(source)),
+      name_(std::move(name)),
+      hash_(HashPrelude(name_, source_)) {}
+
+bool Prelude::FindPrepared(
+    const std::string& key, std::string* prepared,
+    std::map<std::string, CountingIncluder::IncludeStats>* include_stats)
+    const {
+  const std::lock_guard<shaderc_util::mutex> lock(mutex_);
+  auto found = prepared_.find(key);
+  if (found == prepared_.end()) return false;
+  *prepared = found->second.first;
+  if (include_stats) *include_stats = found->second.second;
+  return true;
+}
+
+void Prelude::StorePrepared(
+    const std::string& key, const std::string& prepared,
+    const std::map<std::string, CountingIncluder::IncludeStats>&
+        include_stats) {
+  const std::lock_guard<shaderc_util::mutex> lock(mutex_);
+  prepared_[key] = {prepared, include_stats};
+}
+
+std::string MarkMacroDirectives(const string_piece& text, bool is_for_next_line,
+                                std::vector<std::string>* directives) {
+  const std::vector<string_piece> lines =
+      text.get_fields('\n', /* keep_delimiter = */ true);
+  std::string result;
+  result.reserve(text.size());
+  // Appends a line, ending it if it is the last one and has no newline.
+  auto append = [&result](const string_piece& line) {
+    result.append(line.begin(), line.end());
+    if (line.empty() || line.back() != '\n') result.push_back('\n');
+  };
+
+  bool in_comment = false;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const size_t code = ScanLine(lines[i], &in_comment);
+    if (code == string_piece::npos || lines[i][code] != '#') {
+      append(lines[i]);
+      continue;
+    }
+    const string_piece name = DirectiveName(lines[i], code);
+    if (name == "define" || name == "undef") {
+      // The directive goes on while its lines end with a backslash or inside
+      // a block comment.
+      std::string directive = lines[i].str();
+      size_t last = i;
+      while (last + 1 < lines.size() &&
+             (in_comment || EndsWithBackslash(lines[last]))) {
+        ++last;
+        ScanLine(lines[last], &in_comment);
+        directive += lines[last].str();
+      }
+      for (size_t j = i; j <= last; ++j) append(lines[j]);
+      while (!directive.empty() &&
+             (directive.back() == '\n' || directive.back() == '\r')) {
+        directive.pop_back();
+      }
+      result += kMarker.str() + std::to_string(directives->size()) + "\n";
+      result += LineDirective(last + 2, is_for_next_line);
+      directives->push_back(directive);
+      i = last;
+    } else if (name == "elif" || name == "else" || name == "endif") {
+      // Lines skipped by a conditional lose their markers, but the #line
+      // directives that follow them must still count.
+      append(lines[i]);
+      result += LineDirective(i + 2, is_for_next_line);
+    } else {
+      append(lines[i]);
+    }
+  }
+  return result;
+}
+
+std::string FinishPrelude(const string_piece& preprocessed,
+                          const string_piece& pound_extension,
+                          const std::vector<std::string>& directives) {
+  // The text after the line of pound_extension, or all of it if there is no
+  // such line.
+  string_piece body = preprocessed;
+  LineScanner scanner(preprocessed);
+  string_piece line_piece;
+  while (scanner.Next(&line_piece)) {
+    if (line_piece == pound_extension) {
+      body = scanner.rest();
+      break;
+    }
+  }
+
+  std::string result;
+  std::vector<size_t> executed;
+  bool version_dropped = false;
+  for (LineScanner lines(body); lines.Next(&line_piece);) {
+    if (!version_dropped && line_piece.starts_with("#version")) {
+      version_dropped = true;
+      continue;
+    }
+    std::string line = line_piece.str();
+    // Markers stand alone on their lines, which become empty.
+    for (size_t at = line.find(kMarker.str()); at != std::string::npos;
+         at = line.find(kMarker.str(), at)) {
+      size_t end = at + kMarker.size();
+      size_t index = 0;
+      while (end < line.size() &&
+             std::isdigit(static_cast<unsigned char>(line[end]))) {
+        index = index * 10 + (line[end++] - '0');
+      }
+      executed.push_back(index);
+      line.erase(at, end - at);
+    }
+    result += line;
+  }
+  if (!result.empty() && result.back() != '\n') result.push_back('\n');
+
+  for (const size_t index : executed) {
+    if (index < directives.size()) result += directives[index] + "\n";
+  }
+  return result;
+}
+
+size_t FindVersionDirective(const string_piece& source) {
+  LineScanner scanner(source);
+  for (string_piece line; scanner.Next(&line);) {
+    if (IsDirective(line, "version")) return line.data() - source.data();
+  }
+  return string_piece::npos;
+}
+
+std::string SplicePrelude(const string_piece& source,
+                          const string_piece& prepared,
+                          const std::string& prelude_name,
+                          const std::string& error_tag,
+                          bool is_for_next_line) {
+  size_t splice = 0;
+  const size_t version = FindVersionDirective(source);
+  if (version != string_piece::npos) {
+    const size_t version_end = source.find_first_of('\n', version);
+    splice = version_end == string_piece::npos ? source.size()
+                                               : version_end + 1;
+    while (splice < source.size()) {
+      const size_t line_end = source.find_first_of('\n', splice);
+      const size_t next =
+          line_end == string_piece::npos ? source.size() : line_end + 1;
+      const string_piece line = source.substr(splice, next - splice);
+      const string_piece stripped = line.strip_whitespace();
+      if (!stripped.empty() && !stripped.starts_with("//") &&
+          !IsDirective(stripped, "extension") &&
+          !IsDirective(stripped, "pragma")) {
+        break;
+      }
+      splice = next;
+    }
+  }
+
+  size_t next_line = 1;
+  for (size_t i = 0; i < splice; ++i) {
+    if (source[i] == '\n') ++next_line;
+  }
+  std::string result(source.begin(), source.begin() + splice);
+  if (!result.empty() && result.back() != '\n') {
+    result.push_back('\n');
+    ++next_line;
+  }
+  result += LineDirective(1, is_for_next_line, prelude_name);
+  result.append(prepared.begin(), prepared.end());
+  if (!prepared.empty() && prepared.back() != '\n') result.push_back('\n');
+  result += LineDirective(next_line, is_for_next_line, error_tag);
+  result.append(source.begin() + splice, source.end());
+  return result;
+}
+
+glslang::TShader::Includer::IncludeResult*
+MacroMarkingIncluder::include_delegate(const char* requested_source,
+                                       const char* requesting_source,
+                                       IncludeType type,
+                                       size_t include_depth) {
+  glslang::TShader::Includer::IncludeResult* original =
+      type == IncludeType::Local
+          ? includer_.includeLocal(requested_source, requesting_source,
+                                   include_depth)
+          : includer_.includeSystem(requested_source, requesting_source,
+                                    include_depth);
+  auto* marked = new MarkedInclude{original, std::string()};
+  std::string header_name;
+  if (original) {
+    header_name = original->headerName;
+    const string_piece text(original->headerData,
+                            original->headerData + original->headerLength);
+    // A failed include carries its error message, which is left as it is.
+    marked->text = header_name.empty()
+                       ? text.str()
+                       : MarkMacroDirectives(text, is_for_next_line_,
+                                             directives_);
+  }
+  return new glslang::TShader::Includer::IncludeResult(
+      header_name, marked->text.data(), marked->text.size(), marked);
+}
+
+void MacroMarkingIncluder::release_delegate(
+    glslang::TShader::Includer::IncludeResult* result) {
+  auto* marked = static_cast<MarkedInclude*>(result->userData);
+  if (marked->original) includer_.releaseInclude(marked->original);
+  delete marked;
+  delete result;
+}
+
+}  // namespace shaderc_util
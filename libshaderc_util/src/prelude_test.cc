@@ -0,0 +1,187 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/prelude.h"
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using shaderc_util::FindVersionDirective;
+using shaderc_util::FinishPrelude;
+using shaderc_util::MarkMacroDirectives;
+using shaderc_util::Prelude;
+using shaderc_util::SplicePrelude;
+using shaderc_util::string_piece;
+using testing::ElementsAre;
+
+const char kPoundExtension[] =
+    "#extension GL_GOOGLE_include_directive : enable\n";
+
+TEST(Prelude, HashTellsChangesApart) {
+  EXPECT_EQ(Prelude("float x;", "a.glsl").hash(),
+            Prelude("float x;", "a.glsl").hash());
+  EXPECT_NE(Prelude("float x;", "a.glsl").hash(),
+            Prelude("float y;", "a.glsl").hash());
+  EXPECT_NE(Prelude("float x;", "a.glsl").hash(),
+            Prelude("float x;", "b.glsl").hash());
+}
+
+TEST(Prelude, StoresPreparedTextByKey) {
+  Prelude prelude("float x;", "a.glsl");
+  std::string prepared;
+  EXPECT_FALSE(prelude.FindPrepared("450", &prepared));
+  prelude.StorePrepared("450", "float x;\n");
+  EXPECT_TRUE(prelude.FindPrepared("450", &prepared));
+  EXPECT_EQ("float x;\n", prepared);
+  EXPECT_FALSE(prelude.FindPrepared("310 es", &prepared));
+}
+
+TEST(MarkMacroDirectives, MarksDefinesAndRestoresLines) {
+  std::vector<std::string> directives;
+  EXPECT_EQ(
+      "#define A 1\n"
+      "shaderc_prelude_macro_0\n"
+      "#line 2\n"
+      "float x;\n"
+      "  #  undef A\n"
+      "shaderc_prelude_macro_1\n"
+      "#line 4\n",
+      MarkMacroDirectives("#define A 1\nfloat x;\n  #  undef A", true,
+                          &directives));
+  EXPECT_THAT(directives, ElementsAre("#define A 1", "  #  undef A"));
+}
+
+TEST(MarkMacroDirectives, KeepsContinuationLinesTogether) {
+  std::vector<std::string> directives;
+  EXPECT_EQ(
+      "#define F(x) \\\n"
+      "  (x)\n"
+      "shaderc_prelude_macro_0\n"
+      "#line 3\n"
+      "#define G /* a\n"
+      "  b */ 2\n"
+      "shaderc_prelude_macro_1\n"
+      "#line 5\n",
+      MarkMacroDirectives("#define F(x) \\\n  (x)\n#define G /* a\n  b */ 2\n",
+                          true, &directives));
+  EXPECT_THAT(directives, ElementsAre("#define F(x) \\\n  (x)",
+                                      "#define G /* a\n  b */ 2"));
+}
+
+TEST(MarkMacroDirectives, RestoresLinesAfterConditionals) {
+  std::vector<std::string> directives;
+  // Lines before GLSL 330 number the #line directive itself.
+  EXPECT_EQ(
+      "#ifdef B\n"
+      "#define A\n"
+      "shaderc_prelude_macro_0\n"
+      "#line 2\n"
+      "#else\n"
+      "#line 3\n"
+      "// #define C\n"
+      "/* #define D */\n"
+      "#endif\n"
+      "#line 6\n",
+      MarkMacroDirectives(
+          "#ifdef B\n#define A\n#else\n// #define C\n/* #define D */\n#endif\n",
+          false, &directives));
+  EXPECT_THAT(directives, ElementsAre("#define A"));
+}
+
+TEST(FinishPrelude, ReplaysTheDirectivesThatTookEffect) {
+  // The preprocessed text of
+  //   #ifdef B, #define A 1, #else, #define A 2, #endif, float x = A;
+  // once marked, following a preamble that defines no macros.
+  const std::string preprocessed = std::string(kPoundExtension) +
+                                   "#version 450\n"
+                                   "#line 1 \"prelude.glsl\"\n"
+                                   "\n\n\n\n\n"
+                                   "#line 4\n"
+                                   "\n"
+                                   "shaderc_prelude_macro_1\n"
+                                   "#line 5\n"
+                                   "\n"
+                                   "#line 6\n"
+                                   "float x = 2;\n";
+  EXPECT_EQ(
+      "#line 1 \"prelude.glsl\"\n"
+      "\n\n\n\n\n"
+      "#line 4\n"
+      "\n"
+      "\n"
+      "#line 5\n"
+      "\n"
+      "#line 6\n"
+      "float x = 2;\n"
+      "#define A 2\n",
+      FinishPrelude(preprocessed, kPoundExtension,
+                    {"#define A 1", "#define A 2"}));
+}
+
+TEST(FindVersionDirective, NeedsDirectiveAtLineStart) {
+  EXPECT_EQ(0u, FindVersionDirective("#version 450\nvoid main() {}\n"));
+  EXPECT_EQ(23u,
+            FindVersionDirective("// Needs #version 450.\n  # version 450\n"));
+  EXPECT_EQ(string_piece::npos,
+            FindVersionDirective("// Needs #version 450.\nvoid main() {}\n"));
+  EXPECT_EQ(string_piece::npos, FindVersionDirective("#versions\n"));
+}
+
+TEST(SplicePrelude, SkipsVersionInComments) {
+  EXPECT_EQ(
+      "// Written for #version 450.\n"
+      "#version 450\n"
+      "#line 1 \"prelude.glsl\"\n"
+      "float x;\n"
+      "#line 3 \"main.frag\"\n"
+      "void main() {}\n",
+      SplicePrelude("// Written for #version 450.\n"
+                    "#version 450\n"
+                    "void main() {}\n",
+                    "float x;\n", "prelude.glsl", "main.frag", true));
+}
+
+TEST(SplicePrelude, SplicesAfterVersionAndExtensions) {
+  EXPECT_EQ(
+      "#version 450\n"
+      "#extension GL_EXT_scalar_block_layout : require\n"
+      "\n"
+      "// Lighting.\n"
+      "#line 1 \"prelude.glsl\"\n"
+      "float x;\n"
+      "#line 5 \"main.frag\"\n"
+      "void main() {}\n",
+      SplicePrelude("#version 450\n"
+                    "#extension GL_EXT_scalar_block_layout : require\n"
+                    "\n"
+                    "// Lighting.\n"
+                    "void main() {}\n",
+                    "float x;\n", "prelude.glsl", "main.frag", true));
+}
+
+TEST(SplicePrelude, SplicesAtStartWithoutVersion) {
+  EXPECT_EQ(
+      "#line 0 \"prelude.glsl\"\n"
+      "float x;\n"
+      "#line 0 \"main.vert\"\n"
+      "void main() {}",
+      SplicePrelude("void main() {}", "float x;", "prelude.glsl", "main.vert",
+                    false));
+}
+
+}  // anonymous namespace
@@ -0,0 +1,633 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/spirv_cost.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "libshaderc_util/json.h"
+#include "libshaderc_util/spirv_interface.h"
+#include "spirv-tools/libspirv.h"
+
+namespace {
+
+using shaderc_util::ShaderCost;
+
+// The parts of the SPIR-V grammar the cost model needs.
+const uint32_t kOpExtInst = 12;
+const uint32_t kOpEntryPoint = 15;
+const uint32_t kOpTypePointer = 32;
+const uint32_t kOpFunction = 54;
+const uint32_t kOpFunctionParameter = 55;
+const uint32_t kOpFunctionEnd = 56;
+const uint32_t kOpFunctionCall = 57;
+const uint32_t kOpVariable = 59;
+const uint32_t kOpLoad = 61;
+const uint32_t kOpStore = 62;
+const uint32_t kOpCopyMemory = 63;
+const uint32_t kOpCopyMemorySized = 64;
+const uint32_t kOpAtomicLoad = 227;
+const uint32_t kOpAtomicXor = 242;
+const uint32_t kOpPhi = 245;
+const uint32_t kOpLoopMerge = 246;
+const uint32_t kOpLabel = 248;
+const uint32_t kOpBranch = 249;
+const uint32_t kOpBranchConditional = 250;
+const uint32_t kOpSwitch = 251;
+const uint32_t kOpAtomicFlagTestAndSet = 318;
+const uint32_t kOpAtomicFlagClear = 319;
+const uint32_t kOpAtomicFMinEXT = 5614;
+const uint32_t kOpAtomicFMaxEXT = 5615;
+const uint32_t kOpAtomicFAddEXT = 6035;
+const uint32_t kStorageClassPrivate = 6;
+const uint32_t kStorageClassFunction = 7;
+const uint32_t kGlslStd450Sin = 13;
+const uint32_t kGlslStd450InverseSqrt = 32;
+
+// The assumed number of iterations of every loop.
+const uint64_t kLoopWeight = 8;
+
+// The parts of an instruction the cost model needs.
+struct Instruction {
+  uint32_t opcode = 0;
+  uint32_t type_id = 0;
+  uint32_t result_id = 0;
+  // The ids the instruction reads, in order, not counting its result type.
+  std::vector<uint32_t> operand_ids;
+  // For OpExtInst: whether the set is GLSL.std.450, and the instruction.
+  bool is_glsl_std_450 = false;
+  uint32_t ext_inst = 0;
+  // For OpTypePointer and OpVariable.
+  uint32_t storage_class = 0;
+};
+
+struct ParsedModule {
+  struct EntryPoint {
+    uint32_t execution_model;
+    uint32_t function;
+    std::string name;
+  };
+  std::vector<EntryPoint> entry_points;
+  std::vector<Instruction> instructions;
+};
+
+// Returns the literal string held by the given words.
+std::string ReadString(const uint32_t* words, size_t count) {
+  std::string result;
+  for (size_t i = 0; i < count; ++i) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      const char c = static_cast<char>((words[i] >> shift) & 0xff);
+      if (c == 0) return result;
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+// Appends an instruction parsed by spvBinaryParse to the ParsedModule given
+// as user data.
+spv_result_t AddInstruction(void* user_data,
+                            const spv_parsed_instruction_t* parsed) {
+  auto* module = static_cast<ParsedModule*>(user_data);
+  const uint32_t* words = parsed->words;
+  if (parsed->opcode == kOpEntryPoint) {
+    module->entry_points.push_back(
+        {words[1], words[2], ReadString(words + 3, parsed->num_words - 3)});
+    return SPV_SUCCESS;
+  }
+  Instruction instruction;
+  instruction.opcode = parsed->opcode;
+  instruction.type_id = parsed->type_id;
+  instruction.result_id = parsed->result_id;
+  for (uint16_t i = 0; i < parsed->num_operands; ++i) {
+    if (parsed->operands[i].type == SPV_OPERAND_TYPE_ID) {
+      instruction.operand_ids.push_back(words[parsed->operands[i].offset]);
+    }
+  }
+  if (parsed->opcode == kOpExtInst) {
+    instruction.is_glsl_std_450 =
+        parsed->ext_inst_type == SPV_EXT_INST_TYPE_GLSL_STD_450;
+    instruction.ext_inst = words[4];
+  } else if (parsed->opcode == kOpTypePointer) {
+    instruction.storage_class = words[2];
+  } else if (parsed->opcode == kOpVariable) {
+    instruction.storage_class = words[3];
+  }
+  module->instructions.push_back(std::move(instruction));
+  return SPV_SUCCESS;
+}
+
+// A basic block: its label, and the range of its instructions after the
+// label in ParsedModule::instructions.
+struct Block {
+  uint32_t label;
+  size_t begin;
+  size_t end;
+  std::vector<size_t> successors;
+  std::vector<size_t> predecessors;
+};
+
+struct Function {
+  std::vector<uint32_t> parameters;
+  std::vector<Block> blocks;
+};
+
+// What the cost model counts an instruction as.
+enum class OpKind { Other, Alu, Transcendental, Texture, Memory };
+
+// Returns what the given instruction counts as.  storage_classes maps
+// pointers to the storage class they point into.
+OpKind Classify(const Instruction& instruction,
+                const std::unordered_map<uint32_t, uint32_t>& storage_classes) {
+  // Returns true if the pointer is to a variable that usually lives in
+  // registers.
+  auto is_local = [&storage_classes](uint32_t pointer) {
+    auto it = storage_classes.find(pointer);
+    return it != storage_classes.end() &&
+           (it->second == kStorageClassFunction ||
+            it->second == kStorageClassPrivate);
+  };
+  const uint32_t opcode = instruction.opcode;
+  const auto& ids = instruction.operand_ids;
+  switch (opcode) {
+    case kOpExtInst:
+      if (!instruction.is_glsl_std_450) return OpKind::Other;
+      return instruction.ext_inst >= kGlslStd450Sin &&
+                     instruction.ext_inst <= kGlslStd450InverseSqrt
+                 ? OpKind::Transcendental
+                 : OpKind::Alu;
+    case kOpLoad:
+    case kOpStore:
+      return !ids.empty() && is_local(ids[0]) ? OpKind::Other
+                                              : OpKind::Memory;
+    case kOpCopyMemory:
+    case kOpCopyMemorySized:
+      return ids.size() >= 2 && is_local(ids[0]) && is_local(ids[1])
+                 ? OpKind::Other
+                 : OpKind::Memory;
+    case kOpAtomicFlagTestAndSet:
+    case kOpAtomicFlagClear:
+    case kOpAtomicFMinEXT:
+    case kOpAtomicFMaxEXT:
+    case kOpAtomicFAddEXT:
+      return OpKind::Memory;
+    default:
+      break;
+  }
+  if (opcode >= kOpAtomicLoad && opcode <= kOpAtomicXor) {
+    return OpKind::Memory;
+  }
+  // Image sampling, fetches, gathers, reads and writes, and their sparse
+  // forms.
+  if ((opcode >= 87 && opcode <= 99) || (opcode >= 305 && opcode <= 315) ||
+      opcode == 320) {
+    return OpKind::Texture;
+  }
+  // Numeric conversions, arithmetic, relational and logical instructions,
+  // bit instructions, and derivatives.
+  if ((opcode >= 109 && opcode <= 116) || opcode == 118 || opcode == 119 ||
+      opcode == 124 || (opcode >= 126 && opcode <= 152) ||
+      (opcode >= 154 && opcode <= 191) || (opcode >= 194 && opcode <= 205) ||
+      (opcode >= 207 && opcode <= 215)) {
+    return OpKind::Alu;
+  }
+  return OpKind::Other;
+}
+
+// Returns a * b, or the largest value if that overflows.
+uint64_t SaturatingMultiply(uint64_t a, uint64_t b) {
+  if (a != 0 && b > std::numeric_limits<uint64_t>::max() / a) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return a * b;
+}
+
+// Returns the immediate dominator of each block, given by index, with the
+// first block as the entry.  The entry is its own immediate dominator, and
+// unreachable blocks get SIZE_MAX.
+std::vector<size_t> FindImmediateDominators(const std::vector<Block>& blocks) {
+  const size_t kNone = std::numeric_limits<size_t>::max();
+  // Reverse postorder, by an iterative depth-first search.
+  std::vector<size_t> postorder;
+  std::vector<bool> visited(blocks.size(), false);
+  std::vector<std::pair<size_t, size_t>> stack = {{0, 0}};
+  visited[0] = true;
+  while (!stack.empty()) {
+    const size_t block = stack.back().first;
+    const size_t next = stack.back().second++;
+    if (next < blocks[block].successors.size()) {
+      const size_t successor = blocks[block].successors[next];
+      if (!visited[successor]) {
+        visited[successor] = true;
+        stack.push_back({successor, 0});
+      }
+    } else {
+      postorder.push_back(block);
+      stack.pop_back();
+    }
+  }
+  std::vector<size_t> order(blocks.size(), kNone);
+  for (size_t i = 0; i < postorder.size(); ++i) order[postorder[i]] = i;
+
+  // Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm".
+  std::vector<size_t> idom(blocks.size(), kNone);
+  idom[0] = 0;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (auto it = postorder.rbegin(); it != postorder.rend(); ++it) {
+      if (*it == 0) continue;
+      size_t new_idom = kNone;
+      for (const size_t pred : blocks[*it].predecessors) {
+        if (idom[pred] == kNone) continue;
+        if (new_idom == kNone) {
+          new_idom = pred;
+          continue;
+        }
+        size_t a = pred;
+        size_t b = new_idom;
+        while (a != b) {
+          while (order[a] < order[b]) a = idom[a];
+          while (order[b] < order[a]) b = idom[b];
+        }
+        new_idom = a;
+      }
+      if (idom[*it] != new_idom) {
+        idom[*it] = new_idom;
+        changed = true;
+      }
+    }
+  }
+  return idom;
+}
+
+// Returns the number of loops around each block of a function.  A loop is
+// the natural loop of each back edge into a block with an OpLoopMerge.
+std::vector<uint32_t> FindLoopDepths(
+    const std::vector<Block>& blocks,
+    const std::vector<Instruction>& instructions) {
+  std::vector<uint32_t> depths(blocks.size(), 0);
+  if (blocks.empty()) return depths;
+  const std::vector<size_t> idom = FindImmediateDominators(blocks);
+  auto dominates = [&idom](size_t a, size_t b) {
+    if (idom[b] == std::numeric_limits<size_t>::max()) return false;
+    while (b != a && b != 0) b = idom[b];
+    return b == a;
+  };
+  for (size_t header = 0; header < blocks.size(); ++header) {
+    const Block& block = blocks[header];
+    if (std::none_of(instructions.begin() + block.begin,
+                     instructions.begin() + block.end,
+                     [](const Instruction& instruction) {
+                       return instruction.opcode == kOpLoopMerge;
+                     })) {
+      continue;
+    }
+    std::vector<bool> in_loop(blocks.size(), false);
+    in_loop[header] = true;
+    std::vector<size_t> work;
+    for (const size_t pred : block.predecessors) {
+      if (dominates(header, pred) && !in_loop[pred]) {
+        in_loop[pred] = true;
+        work.push_back(pred);
+      }
+    }
+    while (!work.empty()) {
+      const size_t member = work.back();
+      work.pop_back();
+      for (const size_t pred : blocks[member].predecessors) {
+        if (!in_loop[pred]) {
+          in_loop[pred] = true;
+          work.push_back(pred);
+        }
+      }
+    }
+    for (size_t i = 0; i < blocks.size(); ++i) depths[i] += in_loop[i];
+  }
+  return depths;
+}
+
+// Returns the most values of a function live at once, by a backward
+// liveness analysis over its blocks.  Parameters and instruction results
+// are values; labels and variables are not.
+uint64_t CountMaxLiveIds(const Function& function,
+                         const std::vector<Instruction>& instructions) {
+  std::unordered_map<uint32_t, size_t> values;
+  for (const uint32_t parameter : function.parameters) {
+    values.emplace(parameter, values.size());
+  }
+  std::unordered_map<uint32_t, size_t> block_indices;
+  for (size_t b = 0; b < function.blocks.size(); ++b) {
+    const Block& block = function.blocks[b];
+    block_indices[block.label] = b;
+    for (size_t i = block.begin; i < block.end; ++i) {
+      const Instruction& instruction = instructions[i];
+      if (instruction.result_id && instruction.opcode != kOpVariable) {
+        values.emplace(instruction.result_id, values.size());
+      }
+    }
+  }
+
+  // The values each block passes to the OpPhi instructions of its
+  // successors.
+  std::vector<std::vector<size_t>> phi_uses(function.blocks.size());
+  for (const Block& block : function.blocks) {
+    for (size_t i = block.begin; i < block.end; ++i) {
+      const Instruction& instruction = instructions[i];
+      if (instruction.opcode != kOpPhi) continue;
+      const auto& ids = instruction.operand_ids;
+      for (size_t o = 0; o + 1 < ids.size(); o += 2) {
+        auto value = values.find(ids[o]);
+        auto parent = block_indices.find(ids[o + 1]);
+        if (value != values.end() && parent != block_indices.end()) {
+          phi_uses[parent->second].push_back(value->second);
+        }
+      }
+    }
+  }
+
+  // Walks a block backwards from the values live at its end, leaving the
+  // values live at its start in *live.  Returns the most values live at
+  // once within the block.
+  auto scan_block = [&](const Block& block, std::vector<bool>* live) {
+    uint64_t count = std::count(live->begin(), live->end(), true);
+    uint64_t max_count = count;
+    for (size_t i = block.end; i-- > block.begin;) {
+      const Instruction& instruction = instructions[i];
+      auto def = values.find(instruction.result_id);
+      if (def != values.end() && (*live)[def->second]) {
+        (*live)[def->second] = false;
+        --count;
+      }
+      if (instruction.opcode == kOpPhi) continue;
+      for (const uint32_t id : instruction.operand_ids) {
+        auto use = values.find(id);
+        if (use != values.end() && !(*live)[use->second]) {
+          (*live)[use->second] = true;
+          ++count;
+        }
+      }
+      max_count = std::max(max_count, count);
+    }
+    return max_count;
+  };
+
+  const size_t num_blocks = function.blocks.size();
+  std::vector<std::vector<bool>> live_in(num_blocks,
+                                         std::vector<bool>(values.size()));
+  auto live_out = [&](size_t b) {
+    std::vector<bool> live(values.size(), false);
+    for (const size_t successor : function.blocks[b].successors) {
+      for (size_t v = 0; v < values.size(); ++v) {
+        if (live_in[successor][v]) live[v] = true;
+      }
+    }
+    for (const size_t value : phi_uses[b]) live[value] = true;
+    return live;
+  };
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t b = num_blocks; b-- > 0;) {
+      std::vector<bool> live = live_out(b);
+      scan_block(function.blocks[b], &live);
+      if (live != live_in[b]) {
+        live_in[b] = std::move(live);
+        changed = true;
+      }
+    }
+  }
+  uint64_t max_live = 0;
+  for (size_t b = 0; b < num_blocks; ++b) {
+    std::vector<bool> live = live_out(b);
+    max_live = std::max(max_live, scan_block(function.blocks[b], &live));
+  }
+  return max_live;
+}
+
+// The metrics of one function, not counting the functions it calls, and the
+// functions it calls with the loop weight of each call.
+struct FunctionCost {
+  ShaderCost::EntryPoint own;
+  std::vector<std::pair<uint32_t, uint64_t>> calls;
+};
+
+FunctionCost AnalyzeFunction(
+    const Function& function, const std::vector<Instruction>& instructions,
+    const std::unordered_map<uint32_t, uint32_t>& storage_classes) {
+  FunctionCost cost;
+  const std::vector<uint32_t> depths =
+      FindLoopDepths(function.blocks, instructions);
+  for (size_t b = 0; b < function.blocks.size(); ++b) {
+    uint64_t weight = 1;
+    for (uint32_t d = 0; d < depths[b]; ++d) {
+      weight = SaturatingMultiply(weight, kLoopWeight);
+    }
+    const Block& block = function.blocks[b];
+    for (size_t i = block.begin; i < block.end; ++i) {
+      const Instruction& instruction = instructions[i];
+      switch (instruction.opcode) {
+        case kOpBranchConditional:
+        case kOpSwitch:
+          ++cost.own.branches;
+          break;
+        case kOpLoopMerge:
+          ++cost.own.loops;
+          break;
+        case kOpFunctionCall:
+          cost.calls.emplace_back(instruction.operand_ids[0], weight);
+          break;
+        default:
+          break;
+      }
+      switch (Classify(instruction, storage_classes)) {
+        case OpKind::Alu:
+          ++cost.own.alu;
+          break;
+        case OpKind::Transcendental:
+          ++cost.own.transcendental;
+          break;
+        case OpKind::Texture:
+          ++cost.own.texture;
+          break;
+        case OpKind::Memory:
+          ++cost.own.memory;
+          break;
+        case OpKind::Other:
+          continue;
+      }
+      cost.own.weighted_ops += weight;
+    }
+  }
+  cost.own.max_live_ids = CountMaxLiveIds(function, instructions);
+  return cost;
+}
+
+}  // anonymous namespace
+
+namespace shaderc_util {
+
+bool AnalyzeSpirvCost(const std::vector<uint32_t>& spirv, ShaderCost* cost,
+                      std::string* errors) {
+  *cost = ShaderCost();
+  ParsedModule module;
+  spv_context context = spvContextCreate(SPV_ENV_UNIVERSAL_1_6);
+  spv_diagnostic diagnostic = nullptr;
+  const bool parsed =
+      spvBinaryParse(context, &module, spirv.data(), spirv.size(), nullptr,
+                     AddInstruction, &diagnostic) == SPV_SUCCESS;
+  if (!parsed) {
+    *errors = diagnostic ? diagnostic->error : "malformed SPIR-V module";
+  }
+  spvDiagnosticDestroy(diagnostic);
+  spvContextDestroy(context);
+  if (!parsed) return false;
+
+  const std::vector<Instruction>& instructions = module.instructions;
+  std::unordered_map<uint32_t, uint32_t> pointer_types;
+  std::unordered_map<uint32_t, uint32_t> storage_classes;
+  std::unordered_map<uint32_t, Function> functions;
+  Function* function = nullptr;
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    const Instruction& instruction = instructions[i];
+    if (instruction.opcode == kOpTypePointer) {
+      pointer_types[instruction.result_id] = instruction.storage_class;
+    }
+    auto pointer_type = pointer_types.find(instruction.type_id);
+    if (instruction.result_id && pointer_type != pointer_types.end()) {
+      storage_classes[instruction.result_id] = pointer_type->second;
+    }
+    switch (instruction.opcode) {
+      case kOpFunction:
+        function = &functions[instruction.result_id];
+        break;
+      case kOpFunctionParameter:
+        if (function) function->parameters.push_back(instruction.result_id);
+        break;
+      case kOpLabel:
+        if (function) {
+          if (!function->blocks.empty()) function->blocks.back().end = i;
+          function->blocks.push_back({instruction.result_id, i + 1, i + 1});
+        }
+        break;
+      case kOpFunctionEnd:
+        if (function && !function->blocks.empty()) {
+          function->blocks.back().end = i;
+        }
+        function = nullptr;
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::unordered_map<uint32_t, FunctionCost> function_costs;
+  for (auto& entry : functions) {
+    std::vector<Block>& blocks = entry.second.blocks;
+    std::unordered_map<uint32_t, size_t> block_indices;
+    for (size_t b = 0; b < blocks.size(); ++b) {
+      block_indices[blocks[b].label] = b;
+    }
+    for (size_t b = 0; b < blocks.size(); ++b) {
+      if (blocks[b].begin == blocks[b].end) continue;
+      const Instruction& terminator = instructions[blocks[b].end - 1];
+      std::vector<uint32_t> targets;
+      if (terminator.opcode == kOpBranch) {
+        targets = terminator.operand_ids;
+      } else if (terminator.opcode == kOpBranchConditional ||
+                 terminator.opcode == kOpSwitch) {
+        // Skip the condition or the selector.
+        targets.assign(terminator.operand_ids.begin() + 1,
+                       terminator.operand_ids.end());
+      }
+      for (const uint32_t target : targets) {
+        auto it = block_indices.find(target);
+        if (it == block_indices.end()) continue;
+        blocks[b].successors.push_back(it->second);
+        blocks[it->second].predecessors.push_back(b);
+      }
+    }
+    function_costs[entry.first] =
+        AnalyzeFunction(entry.second, instructions, storage_classes);
+  }
+
+  // The totals of each function including the functions it calls.
+  std::unordered_map<uint32_t, ShaderCost::EntryPoint> totals;
+  std::unordered_set<uint32_t> active;
+  std::function<bool(uint32_t)> add_total = [&](uint32_t id) {
+    if (totals.count(id)) return true;
+    auto it = function_costs.find(id);
+    if (it == function_costs.end()) {
+      *errors = "call to undefined function %" + std::to_string(id);
+      return false;
+    }
+    if (!active.insert(id).second) {
+      *errors = "recursive call to function %" + std::to_string(id);
+      return false;
+    }
+    ShaderCost::EntryPoint total = it->second.own;
+    for (const auto& call : it->second.calls) {
+      if (!add_total(call.first)) return false;
+      const ShaderCost::EntryPoint& callee = totals[call.first];
+      total.alu += callee.alu;
+      total.transcendental += callee.transcendental;
+      total.texture += callee.texture;
+      total.memory += callee.memory;
+      total.branches += callee.branches;
+      total.loops += callee.loops;
+      total.max_live_ids = std::max(total.max_live_ids, callee.max_live_ids);
+      total.weighted_ops += SaturatingMultiply(call.second,
+                                               callee.weighted_ops);
+    }
+    active.erase(id);
+    totals[id] = total;
+    return true;
+  };
+
+  for (const auto& entry_point : module.entry_points) {
+    if (!add_total(entry_point.function)) return false;
+    ShaderCost::EntryPoint metrics = totals[entry_point.function];
+    metrics.name = entry_point.name;
+    metrics.stage = GetExecutionModelName(entry_point.execution_model);
+    cost->entry_points.push_back(std::move(metrics));
+  }
+  return true;
+}
+
+std::string CostToJson(const ShaderCost& cost) {
+  std::ostringstream out;
+  out << "{\n  \"entry_points\": [";
+  for (size_t i = 0; i < cost.entry_points.size(); ++i) {
+    const auto& entry_point = cost.entry_points[i];
+    out << (i ? ",\n" : "\n") << "    {\"name\": "
+        << QuoteJson(entry_point.name)
+        << ", \"stage\": " << QuoteJson(entry_point.stage)
+        << ", \"alu\": " << entry_point.alu
+        << ", \"transcendental\": " << entry_point.transcendental
+        << ", \"texture\": " << entry_point.texture
+        << ", \"memory\": " << entry_point.memory
+        << ", \"branches\": " << entry_point.branches
+        << ", \"loops\": " << entry_point.loops
+        << ", \"max_live_ids\": " << entry_point.max_live_ids
+        << ", \"weighted_ops\": " << entry_point.weighted_ops << "}";
+  }
+  out << (cost.entry_points.empty() ? "]\n}" : "\n  ]\n}");
+  return out.str();
+}
+
+}  // namespace shaderc_util
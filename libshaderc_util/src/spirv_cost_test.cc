@@ -0,0 +1,201 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/spirv_cost.h"
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include "libshaderc_util/spirv_tools_wrapper.h"
+
+namespace {
+
+using shaderc_util::AnalyzeSpirvCost;
+using shaderc_util::Compiler;
+using shaderc_util::ShaderCost;
+
+std::vector<uint32_t> Assemble(const std::string& text) {
+  spv_binary binary = nullptr;
+  std::string errors;
+  EXPECT_TRUE(shaderc_util::SpirvToolsAssemble(
+      Compiler::TargetEnv::Vulkan, Compiler::TargetEnvVersion::Vulkan_1_0,
+      text, &binary, &errors))
+      << errors;
+  std::vector<uint32_t> words;
+  if (binary) {
+    words.assign(binary->code, binary->code + binary->wordCount);
+    spvBinaryDestroy(binary);
+  }
+  return words;
+}
+
+// A fragment shader that samples a texture, then takes the sine of the
+// color four times in a loop.  The color is kept in a Function variable.
+const char kLoopingFragmentShader[] = R"(
+               OpCapability Shader
+       %glsl = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %in %out
+               OpExecutionMode %main OriginUpperLeft
+               OpDecorate %in Location 0
+               OpDecorate %out Location 0
+               OpDecorate %tex DescriptorSet 0
+               OpDecorate %tex Binding 0
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %v2float = OpTypeVector %float 2
+    %v4float = OpTypeVector %float 4
+        %int = OpTypeInt 32 1
+       %bool = OpTypeBool
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_4 = OpConstant %int 4
+      %image = OpTypeImage %float 2D 0 0 0 1 Unknown
+    %sampled = OpTypeSampledImage %image
+    %ptr_tex = OpTypePointer UniformConstant %sampled
+        %tex = OpVariable %ptr_tex UniformConstant
+     %ptr_in = OpTypePointer Input %v2float
+         %in = OpVariable %ptr_in Input
+    %ptr_out = OpTypePointer Output %v4float
+        %out = OpVariable %ptr_out Output
+   %ptr_func = OpTypePointer Function %v4float
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+        %acc = OpVariable %ptr_func Function
+         %uv = OpLoad %v2float %in
+    %sampler = OpLoad %sampled %tex
+      %color = OpImageSampleImplicitLod %v4float %sampler %uv
+               OpStore %acc %color
+               OpBranch %header
+     %header = OpLabel
+          %i = OpPhi %int %int_0 %entry %next %continue
+       %cond = OpSLessThan %bool %i %int_4
+               OpLoopMerge %merge %continue None
+               OpBranchConditional %cond %body %merge
+       %body = OpLabel
+      %value = OpLoad %v4float %acc
+        %sin = OpExtInst %v4float %glsl Sin %value
+               OpStore %acc %sin
+               OpBranch %continue
+   %continue = OpLabel
+       %next = OpIAdd %int %i %int_1
+               OpBranch %header
+      %merge = OpLabel
+     %result = OpLoad %v4float %acc
+               OpStore %out %result
+               OpReturn
+               OpFunctionEnd
+)";
+
+// A vertex shader whose entry point calls a helper twice.
+const char kCallingVertexShader[] = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Vertex %main "main" %out
+               OpDecorate %out Location 0
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+      %float = OpTypeFloat 32
+   %float_fn = OpTypeFunction %float %float
+    %ptr_out = OpTypePointer Output %float
+        %out = OpVariable %ptr_out Output
+    %float_2 = OpConstant %float 2
+     %double = OpFunction %float None %float_fn
+          %x = OpFunctionParameter %float
+         %10 = OpLabel
+    %product = OpFMul %float %x %float_2
+               OpReturnValue %product
+               OpFunctionEnd
+       %main = OpFunction %void None %fn
+         %20 = OpLabel
+      %twice = OpFunctionCall %float %double %float_2
+   %fourfold = OpFunctionCall %float %double %twice
+               OpStore %out %fourfold
+               OpReturn
+               OpFunctionEnd
+)";
+
+TEST(AnalyzeSpirvCost, CountsInstructionKinds) {
+  ShaderCost cost;
+  std::string errors;
+  ASSERT_TRUE(
+      AnalyzeSpirvCost(Assemble(kLoopingFragmentShader), &cost, &errors))
+      << errors;
+  ASSERT_EQ(1u, cost.entry_points.size());
+  const ShaderCost::EntryPoint& entry_point = cost.entry_points[0];
+  EXPECT_EQ("main", entry_point.name);
+  EXPECT_EQ("fragment", entry_point.stage);
+  // The comparison and the increment.
+  EXPECT_EQ(2u, entry_point.alu);
+  EXPECT_EQ(1u, entry_point.transcendental);
+  EXPECT_EQ(1u, entry_point.texture);
+  // The loads of the input and the texture, and the store to the output.
+  // The Function variable does not count.
+  EXPECT_EQ(3u, entry_point.memory);
+  EXPECT_EQ(1u, entry_point.branches);
+  EXPECT_EQ(1u, entry_point.loops);
+  // The loop counter stays live next to each value computed in the loop.
+  EXPECT_EQ(2u, entry_point.max_live_ids);
+  // Four operations outside the loop, and three inside it.
+  EXPECT_EQ(4u + 3u * 8u, entry_point.weighted_ops);
+}
+
+TEST(AnalyzeSpirvCost, CountsCalledFunctionsAtEachCall) {
+  ShaderCost cost;
+  std::string errors;
+  ASSERT_TRUE(
+      AnalyzeSpirvCost(Assemble(kCallingVertexShader), &cost, &errors))
+      << errors;
+  ASSERT_EQ(1u, cost.entry_points.size());
+  EXPECT_EQ("vertex", cost.entry_points[0].stage);
+  EXPECT_EQ(2u, cost.entry_points[0].alu);
+  EXPECT_EQ(1u, cost.entry_points[0].memory);
+  EXPECT_EQ(3u, cost.entry_points[0].weighted_ops);
+}
+
+TEST(AnalyzeSpirvCost, FailsOnMalformedModule) {
+  std::vector<uint32_t> words = Assemble(kCallingVertexShader);
+  // Make the final OpFunctionEnd claim more words than the module has.
+  words.back() = (5u << 16) | 56u;
+  ShaderCost cost;
+  std::string errors;
+  EXPECT_FALSE(AnalyzeSpirvCost(words, &cost, &errors));
+  EXPECT_FALSE(errors.empty());
+}
+
+TEST(CostToJson, WritesOneEntryPointPerLine) {
+  ShaderCost cost;
+  ShaderCost::EntryPoint entry_point;
+  entry_point.name = "main";
+  entry_point.stage = "compute";
+  entry_point.alu = 5;
+  entry_point.memory = 2;
+  entry_point.max_live_ids = 4;
+  entry_point.weighted_ops = 7;
+  cost.entry_points.push_back(entry_point);
+  EXPECT_EQ(
+      "{\n  \"entry_points\": [\n"
+      "    {\"name\": \"main\", \"stage\": \"compute\", \"alu\": 5, "
+      "\"transcendental\": 0, \"texture\": 0, \"memory\": 2, "
+      "\"branches\": 0, \"loops\": 0, \"max_live_ids\": 4, "
+      "\"weighted_ops\": 7}\n  ]\n}",
+      shaderc_util::CostToJson(cost));
+  EXPECT_EQ("{\n  \"entry_points\": []\n}",
+            shaderc_util::CostToJson(ShaderCost()));
+}
+
+}  // anonymous namespace
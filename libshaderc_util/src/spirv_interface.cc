@@ -0,0 +1,1451 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/spirv_interface.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "libshaderc_util/json.h"
+
+namespace {
+
+// The parts of the SPIR-V grammar the interface walker needs.
+const size_t kHeaderWordCount = 5;
+const uint32_t kOpSourceContinued = 2;
+const uint32_t kOpSource = 3;
+const uint32_t kOpSourceExtension = 4;
+const uint32_t kOpName = 5;
+const uint32_t kOpMemberName = 6;
+const uint32_t kOpString = 7;
+const uint32_t kOpExtension = 10;
+const uint32_t kOpExtInstImport = 11;
+const uint32_t kOpMemoryModel = 14;
+const uint32_t kOpEntryPoint = 15;
+const uint32_t kOpExecutionMode = 16;
+const uint32_t kOpCapability = 17;
+const uint32_t kOpTypeBool = 20;
+const uint32_t kOpTypeInt = 21;
+const uint32_t kOpTypeFloat = 22;
+const uint32_t kOpTypeVector = 23;
+const uint32_t kOpTypeMatrix = 24;
+const uint32_t kOpTypeImage = 25;
+const uint32_t kOpTypeSampler = 26;
+const uint32_t kOpTypeSampledImage = 27;
+const uint32_t kOpTypeArray = 28;
+const uint32_t kOpTypeRuntimeArray = 29;
+const uint32_t kOpTypeStruct = 30;
+const uint32_t kOpTypePointer = 32;
+const uint32_t kOpConstant = 43;
+const uint32_t kOpConstantComposite = 44;
+const uint32_t kOpSpecConstantTrue = 48;
+const uint32_t kOpSpecConstantFalse = 49;
+const uint32_t kOpSpecConstant = 50;
+const uint32_t kOpSpecConstantComposite = 51;
+const uint32_t kOpFunction = 54;
+const uint32_t kOpVariable = 59;
+const uint32_t kOpLoad = 61;
+const uint32_t kOpAccessChain = 65;
+const uint32_t kOpInBoundsAccessChain = 66;
+const uint32_t kOpDecorate = 71;
+const uint32_t kOpMemberDecorate = 72;
+const uint32_t kOpDecorationGroup = 73;
+const uint32_t kOpGroupDecorate = 74;
+const uint32_t kOpGroupMemberDecorate = 75;
+const uint32_t kOpCopyObject = 83;
+const uint32_t kOpModuleProcessed = 330;
+const uint32_t kOpExecutionModeId = 331;
+const uint32_t kOpDecorateId = 332;
+const uint32_t kOpTypeAccelerationStructureKHR = 5341;
+const uint32_t kOpDecorateString = 5632;
+const uint32_t kOpMemberDecorateString = 5633;
+const uint32_t kDecorationSpecId = 1;
+const uint32_t kDecorationBufferBlock = 3;
+const uint32_t kDecorationRowMajor = 4;
+const uint32_t kDecorationArrayStride = 6;
+const uint32_t kDecorationMatrixStride = 7;
+const uint32_t kDecorationBuiltIn = 11;
+const uint32_t kDecorationLocation = 30;
+const uint32_t kDecorationComponent = 31;
+const uint32_t kDecorationBinding = 33;
+const uint32_t kDecorationDescriptorSet = 34;
+const uint32_t kDecorationOffset = 35;
+const uint32_t kBuiltInWorkgroupSize = 25;
+const uint32_t kExecutionModeLocalSize = 17;
+const uint32_t kExecutionModeLocalSizeId = 38;
+const uint32_t kStorageClassUniformConstant = 0;
+const uint32_t kStorageClassInput = 1;
+const uint32_t kStorageClassUniform = 2;
+const uint32_t kStorageClassOutput = 3;
+const uint32_t kStorageClassPushConstant = 9;
+const uint32_t kStorageClassStorageBuffer = 12;
+const uint32_t kDimBuffer = 5;
+const uint32_t kDimSubpassData = 6;
+
+// A user-defined interface variable: the index of the word holding its
+// Location, and the number of locations it occupies.
+struct InterfaceVariable {
+  size_t location_word;
+  uint32_t num_locations;
+};
+
+// The user-defined interface variables of one storage class in a module.
+// Returns false if the interface cannot be compacted safely.
+bool FindInterfaceVariables(const std::vector<uint32_t>& words,
+                            uint32_t storage_class,
+                            std::map<uint32_t, InterfaceVariable>* variables) {
+  // Type id -> the instruction's word index, for sizing types.
+  std::unordered_map<uint32_t, size_t> types;
+  std::unordered_map<uint32_t, uint32_t> constants;
+  // Pointer type id -> pointee type id, for the given storage class.
+  std::unordered_map<uint32_t, uint32_t> pointers;
+  std::unordered_map<uint32_t, uint32_t> variable_types;
+  std::unordered_map<uint32_t, size_t> location_words;
+  std::unordered_set<uint32_t> builtins;
+  std::unordered_set<uint32_t> structs_with_builtins;
+  std::unordered_set<uint32_t> unsupported;
+
+  for (size_t i = kHeaderWordCount; i < words.size();) {
+    const uint32_t word_count = words[i] >> 16;
+    const uint32_t opcode = words[i] & 0xffff;
+    if (word_count == 0 || i + word_count > words.size()) return false;
+    switch (opcode) {
+      case kOpTypeInt:
+      case kOpTypeFloat:
+      case kOpTypeVector:
+      case kOpTypeMatrix:
+      case kOpTypeArray:
+      case kOpTypeStruct:
+        types[words[i + 1]] = i;
+        break;
+      case kOpTypePointer:
+        if (words[i + 2] == storage_class) {
+          pointers[words[i + 1]] = words[i + 3];
+        }
+        break;
+      case kOpConstant:
+        constants[words[i + 2]] = words[i + 3];
+        break;
+      case kOpVariable:
+        if (words[i + 3] == storage_class) {
+          variable_types[words[i + 2]] = pointers[words[i + 1]];
+        }
+        break;
+      case kOpDecorate:
+        if (words[i + 2] == kDecorationLocation) {
+          location_words[words[i + 1]] = i + 3;
+        } else if (words[i + 2] == kDecorationBuiltIn) {
+          builtins.insert(words[i + 1]);
+        } else if (words[i + 2] == kDecorationComponent) {
+          unsupported.insert(words[i + 1]);
+        }
+        break;
+      case kOpMemberDecorate:
+        if (words[i + 3] == kDecorationBuiltIn) {
+          structs_with_builtins.insert(words[i + 1]);
+        } else if (words[i + 3] == kDecorationLocation ||
+                   words[i + 3] == kDecorationComponent) {
+          unsupported.insert(words[i + 1]);
+        }
+        break;
+      default:
+        break;
+    }
+    i += word_count;
+  }
+
+  // Returns the number of locations the given type occupies, or zero if the
+  // type cannot be sized.
+  std::function<uint32_t(uint32_t)> count_locations =
+      [&](uint32_t type) -> uint32_t {
+    if (unsupported.count(type)) return 0;
+    auto it = types.find(type);
+    if (it == types.end()) return 0;
+    const size_t at = it->second;
+    switch (words[at] & 0xffff) {
+      case kOpTypeInt:
+      case kOpTypeFloat:
+        return 1;
+      case kOpTypeVector: {
+        // 64-bit vectors of three or four components take two locations.
+        auto component = types.find(words[at + 2]);
+        if (component == types.end()) return 0;
+        const bool is_64_bit = words[component->second + 2] == 64;
+        return is_64_bit && words[at + 3] > 2 ? 2 : 1;
+      }
+      case kOpTypeMatrix:
+        return words[at + 3] * count_locations(words[at + 2]);
+      case kOpTypeArray: {
+        auto length = constants.find(words[at + 3]);
+        if (length == constants.end()) return 0;
+        return length->second * count_locations(words[at + 2]);
+      }
+      case kOpTypeStruct: {
+        uint32_t total = 0;
+        for (size_t m = at + 2; m < at + (words[at] >> 16); ++m) {
+          const uint32_t member = count_locations(words[m]);
+          if (member == 0) return 0;
+          total += member;
+        }
+        return total;
+      }
+    }
+    return 0;
+  };
+
+  for (const auto& variable : variable_types) {
+    const uint32_t id = variable.first;
+    const uint32_t type = variable.second;
+    if (builtins.count(id) || structs_with_builtins.count(type)) continue;
+    if (unsupported.count(id)) return false;
+    auto location = location_words.find(id);
+    if (location == location_words.end()) return false;
+    const uint32_t num_locations = count_locations(type);
+    if (num_locations == 0) return false;
+    const uint32_t start = words[location->second];
+    // Two variables of one stage never share a location.
+    if (!variables->emplace(start, InterfaceVariable{location->second,
+                                                     num_locations})
+             .second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// A resource variable of one module: where its set and binding are stored,
+// and the descriptors it needs.  set_word is zero if the variable has no
+// DescriptorSet decoration, which means set 0.
+struct ResourceVariable {
+  uint32_t id;
+  size_t set_word;
+  size_t binding_word;
+  shaderc_util::DescriptorType type;
+  uint32_t count;
+};
+
+// Finds the resource variables of a module.  Returns false, and writes a
+// message to *errors, if one of them has a type that needs no known kind of
+// descriptor.
+bool FindResourceVariables(const std::vector<uint32_t>& words,
+                           std::vector<ResourceVariable>* variables,
+                           std::string* errors) {
+  using shaderc_util::DescriptorType;
+  std::unordered_map<uint32_t, size_t> types;
+  std::unordered_map<uint32_t, uint32_t> constants;
+  // Pointer type id -> pointee type id.
+  std::unordered_map<uint32_t, uint32_t> pointers;
+  // Variable id -> (storage class, pointee type id).
+  std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> resources;
+  std::unordered_map<uint32_t, size_t> set_words;
+  std::unordered_map<uint32_t, size_t> binding_words;
+  std::unordered_set<uint32_t> buffer_blocks;
+
+  for (size_t i = kHeaderWordCount; i < words.size();) {
+    const uint32_t word_count = words[i] >> 16;
+    const uint32_t opcode = words[i] & 0xffff;
+    if (word_count == 0 || i + word_count > words.size()) {
+      *errors = "malformed SPIR-V module";
+      return false;
+    }
+    switch (opcode) {
+      case kOpTypeImage:
+      case kOpTypeSampler:
+      case kOpTypeSampledImage:
+      case kOpTypeArray:
+      case kOpTypeRuntimeArray:
+      case kOpTypeStruct:
+      case kOpTypeAccelerationStructureKHR:
+        types[words[i + 1]] = i;
+        break;
+      case kOpTypePointer:
+        pointers[words[i + 1]] = words[i + 3];
+        break;
+      case kOpConstant:
+        constants[words[i + 2]] = words[i + 3];
+        break;
+      case kOpVariable:
+        if (words[i + 3] == kStorageClassUniformConstant ||
+            words[i + 3] == kStorageClassUniform ||
+            words[i + 3] == kStorageClassStorageBuffer) {
+          resources[words[i + 2]] = {words[i + 3], pointers[words[i + 1]]};
+        }
+        break;
+      case kOpDecorate:
+        if (words[i + 2] == kDecorationDescriptorSet) {
+          set_words[words[i + 1]] = i + 3;
+        } else if (words[i + 2] == kDecorationBinding) {
+          binding_words[words[i + 1]] = i + 3;
+        } else if (words[i + 2] == kDecorationBufferBlock) {
+          buffer_blocks.insert(words[i + 1]);
+        }
+        break;
+      default:
+        break;
+    }
+    i += word_count;
+  }
+
+  for (const auto& resource : resources) {
+    auto binding = binding_words.find(resource.first);
+    if (binding == binding_words.end()) continue;
+    const uint32_t storage_class = resource.second.first;
+    uint32_t type = resource.second.second;
+    uint32_t count = 1;
+    auto it = types.find(type);
+    if (it != types.end() && ((words[it->second] & 0xffff) == kOpTypeArray ||
+                              (words[it->second] & 0xffff) ==
+                                  kOpTypeRuntimeArray)) {
+      if ((words[it->second] & 0xffff) == kOpTypeArray) {
+        count = constants[words[it->second + 3]];
+      } else {
+        count = 0;
+      }
+      type = words[it->second + 2];
+      it = types.find(type);
+    }
+
+    bool known = it != types.end();
+    DescriptorType descriptor_type = DescriptorType::Sampler;
+    if (known && storage_class == kStorageClassStorageBuffer) {
+      descriptor_type = DescriptorType::StorageBuffer;
+    } else if (known && storage_class == kStorageClassUniform) {
+      descriptor_type = buffer_blocks.count(type)
+                            ? DescriptorType::StorageBuffer
+                            : DescriptorType::UniformBuffer;
+    } else if (known) {
+      const size_t at = it->second;
+      switch (words[at] & 0xffff) {
+        case kOpTypeSampler:
+          descriptor_type = DescriptorType::Sampler;
+          break;
+        case kOpTypeSampledImage:
+          descriptor_type = DescriptorType::CombinedImageSampler;
+          break;
+        case kOpTypeAccelerationStructureKHR:
+          descriptor_type = DescriptorType::AccelerationStructure;
+          break;
+        case kOpTypeImage: {
+          // OpTypeImage: result, sampled type, dim, depth, arrayed, MS,
+          // sampled, format.
+          const uint32_t dim = words[at + 3];
+          const bool sampled = words[at + 7] == 1;
+          if (dim == kDimSubpassData) {
+            descriptor_type = DescriptorType::InputAttachment;
+          } else if (dim == kDimBuffer) {
+            descriptor_type = sampled ? DescriptorType::UniformTexelBuffer
+                                      : DescriptorType::StorageTexelBuffer;
+          } else {
+            descriptor_type = sampled ? DescriptorType::SampledImage
+                                      : DescriptorType::StorageImage;
+          }
+          break;
+        }
+        default:
+          known = false;
+          break;
+      }
+    }
+    if (!known) {
+      *errors = "binding " + std::to_string(words[binding->second]) +
+                " is not of a type that descriptors can hold";
+      return false;
+    }
+
+    auto set = set_words.find(resource.first);
+    variables->push_back({resource.first,
+                          set == set_words.end() ? 0 : set->second,
+                          binding->second, descriptor_type, count});
+  }
+  return true;
+}
+
+// Returns the literal string starting at words[at], which must end before
+// words[end].
+std::string ReadString(const std::vector<uint32_t>& words, size_t at,
+                       size_t end) {
+  std::string result;
+  for (; at < end; ++at) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      const char c = static_cast<char>((words[at] >> shift) & 0xff);
+      if (c == 0) return result;
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+// Returns the name used in reflection for the given descriptor type.
+const char* GetDescriptorTypeName(shaderc_util::DescriptorType type) {
+  using shaderc_util::DescriptorType;
+  switch (type) {
+    case DescriptorType::Sampler:
+      return "sampler";
+    case DescriptorType::CombinedImageSampler:
+      return "combined_image_sampler";
+    case DescriptorType::SampledImage:
+      return "sampled_image";
+    case DescriptorType::StorageImage:
+      return "storage_image";
+    case DescriptorType::UniformTexelBuffer:
+      return "uniform_texel_buffer";
+    case DescriptorType::StorageTexelBuffer:
+      return "storage_texel_buffer";
+    case DescriptorType::UniformBuffer:
+      return "uniform_buffer";
+    case DescriptorType::StorageBuffer:
+      return "storage_buffer";
+    case DescriptorType::InputAttachment:
+      return "input_attachment";
+    case DescriptorType::AccelerationStructure:
+      return "acceleration_structure";
+  }
+  return "unknown";
+}
+
+
+// Parses one component of a baked uniform value, written as in GLSL source,
+// into the bits of a 32-bit scalar of the type declared at words[type_at].
+// Returns false if the text is not a valid value of that type.
+bool ParseBakedComponent(const std::vector<uint32_t>& words, size_t type_at,
+                         std::string text, uint32_t* bits) {
+  const size_t first = text.find_first_not_of(" \t");
+  const size_t last = text.find_last_not_of(" \t");
+  if (first == std::string::npos) return false;
+  text = text.substr(first, last - first + 1);
+  const uint32_t opcode = words[type_at] & 0xffff;
+  if (words[type_at + 2] != 32) return false;
+  if (opcode == kOpTypeInt && (text == "true" || text == "false")) {
+    // Bools in blocks are stored as integers.
+    *bits = text == "true";
+    return true;
+  }
+  char* end = nullptr;
+  errno = 0;
+  if (opcode == kOpTypeFloat) {
+    const float value = std::strtof(text.c_str(), &end);
+    std::memcpy(bits, &value, sizeof(value));
+  } else if (opcode == kOpTypeInt && words[type_at + 3]) {
+    const long long value = std::strtoll(text.c_str(), &end, 0);
+    if (value < INT32_MIN || value > INT32_MAX) return false;
+    *bits = static_cast<uint32_t>(static_cast<int32_t>(value));
+  } else if (opcode == kOpTypeInt && text[0] != '-') {
+    const unsigned long long value = std::strtoull(text.c_str(), &end, 0);
+    if (value > UINT32_MAX) return false;
+    *bits = static_cast<uint32_t>(value);
+  } else {
+    return false;
+  }
+  // Allow the suffixes of GLSL literals.
+  if (*end == 'f' || *end == 'F' || *end == 'u' || *end == 'U') ++end;
+  return errno == 0 && *end == 0;
+}
+
+
+// Returns true if the opcode belongs to the sections of a module that come
+// before its type declarations: capabilities, extensions, the memory model,
+// entry points, execution modes, debug instructions and annotations.
+bool IsBeforeTypes(uint32_t opcode) {
+  switch (opcode) {
+    case kOpSourceContinued:
+    case kOpSource:
+    case kOpSourceExtension:
+    case kOpName:
+    case kOpMemberName:
+    case kOpString:
+    case kOpExtension:
+    case kOpExtInstImport:
+    case kOpMemoryModel:
+    case kOpEntryPoint:
+    case kOpExecutionMode:
+    case kOpCapability:
+    case kOpDecorate:
+    case kOpMemberDecorate:
+    case kOpDecorationGroup:
+    case kOpGroupDecorate:
+    case kOpGroupMemberDecorate:
+    case kOpModuleProcessed:
+    case kOpExecutionModeId:
+    case kOpDecorateId:
+    case kOpDecorateString:
+    case kOpMemberDecorateString:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // anonymous namespace
+
+namespace shaderc_util {
+
+const char* GetExecutionModelName(uint32_t model) {
+  switch (model) {
+    case 0:
+      return "vertex";
+    case 1:
+      return "tesscontrol";
+    case 2:
+      return "tesseval";
+    case 3:
+      return "geometry";
+    case 4:
+      return "fragment";
+    case 5:
+      return "compute";
+    case 5267:
+    case 5364:
+      return "task";
+    case 5268:
+    case 5365:
+      return "mesh";
+    case 5313:
+      return "raygen";
+    case 5314:
+      return "intersection";
+    case 5315:
+      return "anyhit";
+    case 5316:
+      return "closesthit";
+    case 5317:
+      return "miss";
+    case 5318:
+      return "callable";
+    default:
+      break;
+  }
+  return "unknown";
+}
+
+bool AssignPipelineDescriptorBindings(
+    const std::vector<std::vector<uint32_t>*>& modules,
+    const std::vector<uint32_t>& stage_flags, bool compact,
+    std::vector<DescriptorBinding>* layout, std::string* errors) {
+  std::vector<std::vector<ResourceVariable>> variables(modules.size());
+  // (set, binding) -> the pipeline's binding.
+  std::map<std::pair<uint32_t, uint32_t>, DescriptorBinding> bindings;
+  for (size_t m = 0; m < modules.size(); ++m) {
+    const std::vector<uint32_t>& words = *modules[m];
+    if (!FindResourceVariables(words, &variables[m], errors)) return false;
+    for (const auto& variable : variables[m]) {
+      const uint32_t set = variable.set_word ? words[variable.set_word] : 0;
+      const uint32_t binding = words[variable.binding_word];
+      auto inserted = bindings.emplace(
+          std::make_pair(set, binding),
+          DescriptorBinding{set, binding, variable.type, variable.count, 0});
+      DescriptorBinding& entry = inserted.first->second;
+      if (entry.type != variable.type || entry.count != variable.count) {
+        *errors = "descriptor set " + std::to_string(set) + " binding " +
+                  std::to_string(binding) +
+                  " is declared differently by different stages";
+        return false;
+      }
+      entry.stage_flags |= stage_flags[m];
+    }
+  }
+
+  if (compact) {
+    // The sets keep their order, and so do the bindings within each set.
+    std::map<uint32_t, uint32_t> new_sets;
+    std::map<std::pair<uint32_t, uint32_t>, uint32_t> new_bindings;
+    for (auto& entry : bindings) {
+      const uint32_t set = entry.first.first;
+      const uint32_t new_set =
+          new_sets.emplace(set, static_cast<uint32_t>(new_sets.size()))
+              .first->second;
+      uint32_t new_binding = 0;
+      if (!new_bindings.empty()) {
+        const auto& last = *new_bindings.rbegin();
+        if (last.first.first == set) new_binding = last.second + 1;
+      }
+      new_bindings[entry.first] = new_binding;
+      entry.second.set = new_set;
+      entry.second.binding = new_binding;
+    }
+    for (size_t m = 0; m < modules.size(); ++m) {
+      std::vector<uint32_t>& words = *modules[m];
+      for (const auto& variable : variables[m]) {
+        const uint32_t set = variable.set_word ? words[variable.set_word] : 0;
+        const uint32_t binding = words[variable.binding_word];
+        // A variable without a set decoration is in set 0, which, being the
+        // lowest set, is renumbered to 0 anyway.
+        if (variable.set_word) words[variable.set_word] = new_sets[set];
+        words[variable.binding_word] = new_bindings[{set, binding}];
+      }
+    }
+  }
+
+  layout->clear();
+  for (const auto& entry : bindings) layout->push_back(entry.second);
+  return true;
+}
+
+bool CompactInterfaceLocations(std::vector<uint32_t>* producer,
+                               std::vector<uint32_t>* consumer) {
+  std::map<uint32_t, InterfaceVariable> outputs;
+  std::map<uint32_t, InterfaceVariable> inputs;
+  if (!FindInterfaceVariables(*producer, kStorageClassOutput, &outputs) ||
+      !FindInterfaceVariables(*consumer, kStorageClassInput, &inputs)) {
+    return false;
+  }
+
+  // The ranges of locations in use, by their first location.  Matching
+  // variables of the two stages must cover the same range.
+  std::map<uint32_t, uint32_t> ranges;
+  for (const auto* variables : {&outputs, &inputs}) {
+    for (const auto& variable : *variables) {
+      auto inserted =
+          ranges.emplace(variable.first, variable.second.num_locations);
+      if (inserted.first->second != variable.second.num_locations) {
+        return false;
+      }
+    }
+  }
+
+  std::unordered_map<uint32_t, uint32_t> new_locations;
+  uint32_t next = 0;
+  uint32_t end_of_previous = 0;
+  bool changed = false;
+  for (const auto& range : ranges) {
+    if (range.first < end_of_previous) return false;
+    end_of_previous = range.first + range.second;
+    new_locations[range.first] = next;
+    changed |= next != range.first;
+    next += range.second;
+  }
+  if (!changed) return false;
+
+  for (const auto& variable : outputs) {
+    (*producer)[variable.second.location_word] = new_locations[variable.first];
+  }
+  for (const auto& variable : inputs) {
+    (*consumer)[variable.second.location_word] = new_locations[variable.first];
+  }
+  return true;
+}
+
+bool ReflectSpirv(const std::vector<uint32_t>& words,
+                  ShaderReflection* reflection, std::string* errors) {
+  *reflection = ShaderReflection();
+  std::vector<ResourceVariable> resource_variables;
+  if (!FindResourceVariables(words, &resource_variables, errors)) {
+    return false;
+  }
+
+  std::unordered_map<uint32_t, std::string> names;
+  std::unordered_map<uint32_t, size_t> types;
+  // Constant id -> the instruction's word index, for both normal and
+  // specialization constants.
+  std::unordered_map<uint32_t, size_t> constants;
+  std::unordered_map<uint32_t, uint32_t> pointers;
+  // Variable id -> (storage class, pointee type id).
+  std::map<uint32_t, std::pair<uint32_t, uint32_t>> variables;
+  std::unordered_map<uint32_t, uint32_t> spec_ids;
+  std::unordered_map<uint32_t, uint32_t> locations;
+  std::unordered_map<uint32_t, uint32_t> components;
+  std::unordered_map<uint32_t, uint32_t> array_strides;
+  std::unordered_set<uint32_t> builtins;
+  std::unordered_set<uint32_t> structs_with_builtins;
+  // (struct id, member) -> Offset, MatrixStride and RowMajor decorations.
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> offsets;
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> matrix_strides;
+  std::set<std::pair<uint32_t, uint32_t>> row_major;
+  uint32_t workgroup_size_id = 0;
+  // Entry point id -> LocalSize operands, or LocalSizeId operands.
+  std::unordered_map<uint32_t, size_t> local_sizes;
+  std::unordered_map<uint32_t, size_t> local_size_ids;
+  std::vector<std::pair<uint32_t, size_t>> entry_points;
+
+  for (size_t i = kHeaderWordCount; i < words.size();) {
+    const uint32_t word_count = words[i] >> 16;
+    const uint32_t opcode = words[i] & 0xffff;
+    const size_t end = i + word_count;
+    switch (opcode) {
+      case kOpName:
+        names[words[i + 1]] = ReadString(words, i + 2, end);
+        break;
+      case kOpEntryPoint:
+        entry_points.emplace_back(words[i + 2], i);
+        break;
+      case kOpExecutionMode:
+        if (words[i + 2] == kExecutionModeLocalSize) {
+          local_sizes[words[i + 1]] = i + 3;
+        }
+        break;
+      case kOpExecutionModeId:
+        if (words[i + 2] == kExecutionModeLocalSizeId) {
+          local_size_ids[words[i + 1]] = i + 3;
+        }
+        break;
+      case kOpTypeBool:
+      case kOpTypeInt:
+      case kOpTypeFloat:
+      case kOpTypeVector:
+      case kOpTypeMatrix:
+      case kOpTypeArray:
+      case kOpTypeRuntimeArray:
+      case kOpTypeStruct:
+        types[words[i + 1]] = i;
+        break;
+      case kOpTypePointer:
+        pointers[words[i + 1]] = words[i + 3];
+        break;
+      case kOpConstant:
+      case kOpConstantComposite:
+      case kOpSpecConstantTrue:
+      case kOpSpecConstantFalse:
+      case kOpSpecConstant:
+      case kOpSpecConstantComposite:
+        constants[words[i + 2]] = i;
+        break;
+      case kOpVariable:
+        variables[words[i + 2]] = {words[i + 3], pointers[words[i + 1]]};
+        break;
+      case kOpDecorate:
+        switch (words[i + 2]) {
+          case kDecorationSpecId:
+            spec_ids[words[i + 1]] = words[i + 3];
+            break;
+          case kDecorationLocation:
+            locations[words[i + 1]] = words[i + 3];
+            break;
+          case kDecorationComponent:
+            components[words[i + 1]] = words[i + 3];
+            break;
+          case kDecorationArrayStride:
+            array_strides[words[i + 1]] = words[i + 3];
+            break;
+          case kDecorationBuiltIn:
+            builtins.insert(words[i + 1]);
+            if (words[i + 3] == kBuiltInWorkgroupSize) {
+              workgroup_size_id = words[i + 1];
+            }
+            break;
+          default:
+            break;
+        }
+        break;
+      case kOpMemberDecorate: {
+        const auto member = std::make_pair(words[i + 1], words[i + 2]);
+        if (words[i + 3] == kDecorationOffset) {
+          offsets[member] = words[i + 4];
+        } else if (words[i + 3] == kDecorationMatrixStride) {
+          matrix_strides[member] = words[i + 4];
+        } else if (words[i + 3] == kDecorationRowMajor) {
+          row_major.insert(member);
+        } else if (words[i + 3] == kDecorationBuiltIn) {
+          structs_with_builtins.insert(words[i + 1]);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    i = end;
+  }
+
+  // Returns the name of a variable, or else of the type it points to, as
+  // for an unnamed block instance.
+  auto name_of = [&names](uint32_t variable, uint32_t type) {
+    auto name = names.find(variable);
+    if (name != names.end() && !name->second.empty()) return name->second;
+    name = names.find(type);
+    return name != names.end() ? name->second : std::string();
+  };
+  auto scalar_value = [&words, &constants](uint32_t id) -> uint32_t {
+    auto constant = constants.find(id);
+    if (constant == constants.end()) return 0;
+    const uint32_t opcode = words[constant->second] & 0xffff;
+    return opcode == kOpConstant || opcode == kOpSpecConstant
+               ? words[constant->second + 3]
+               : 0;
+  };
+
+  // Returns the size in bytes of a type in an explicitly laid out block.
+  std::function<uint32_t(uint32_t, uint32_t, bool)> size_of =
+      [&](uint32_t type, uint32_t matrix_stride, bool is_row_major) {
+        auto it = types.find(type);
+        if (it == types.end()) return 0u;
+        const size_t at = it->second;
+        switch (words[at] & 0xffff) {
+          case kOpTypeBool:
+            return 4u;
+          case kOpTypeInt:
+          case kOpTypeFloat:
+            return words[at + 2] / 8;
+          case kOpTypeVector:
+            return words[at + 3] * size_of(words[at + 2], 0, false);
+          case kOpTypeMatrix: {
+            const uint32_t columns = words[at + 3];
+            if (matrix_stride == 0) {
+              return columns * size_of(words[at + 2], 0, false);
+            }
+            auto column = types.find(words[at + 2]);
+            const uint32_t rows =
+                column == types.end() ? 0 : words[column->second + 3];
+            return matrix_stride * (is_row_major ? rows : columns);
+          }
+          case kOpTypeArray: {
+            auto stride = array_strides.find(type);
+            const uint32_t element =
+                stride != array_strides.end()
+                    ? stride->second
+                    : size_of(words[at + 2], matrix_stride, is_row_major);
+            return scalar_value(words[at + 3]) * element;
+          }
+          case kOpTypeStruct: {
+            uint32_t size = 0;
+            for (uint32_t m = 0; m + 2 < (words[at] >> 16); ++m) {
+              const auto member = std::make_pair(type, m);
+              auto stride = matrix_strides.find(member);
+              const uint32_t member_end =
+                  (offsets.count(member) ? offsets[member] : 0) +
+                  size_of(words[at + 2 + m],
+                          stride == matrix_strides.end() ? 0 : stride->second,
+                          row_major.count(member) != 0);
+              size = std::max(size, member_end);
+            }
+            return size;
+          }
+          default:
+            break;
+        }
+        return 0u;
+      };
+
+  for (const auto& entry_point : entry_points) {
+    const size_t at = entry_point.second;
+    ShaderReflection::EntryPoint reflected;
+    reflected.name = ReadString(words, at + 3, at + (words[at] >> 16));
+    reflected.stage = GetExecutionModelName(words[at + 1]);
+    reflected.workgroup_size[0] = reflected.workgroup_size[1] =
+        reflected.workgroup_size[2] = 0;
+    auto local_size = local_sizes.find(entry_point.first);
+    auto local_size_id = local_size_ids.find(entry_point.first);
+    auto workgroup_size = constants.find(workgroup_size_id);
+    for (int d = 0; d < 3; ++d) {
+      if (workgroup_size != constants.end()) {
+        // The WorkgroupSize built-in overrides the execution mode.
+        reflected.workgroup_size[d] =
+            scalar_value(words[workgroup_size->second + 3 + d]);
+      } else if (local_size != local_sizes.end()) {
+        reflected.workgroup_size[d] = words[local_size->second + d];
+      } else if (local_size_id != local_size_ids.end()) {
+        reflected.workgroup_size[d] =
+            scalar_value(words[local_size_id->second + d]);
+      }
+    }
+    reflection->entry_points.push_back(reflected);
+  }
+
+  for (const auto& variable : resource_variables) {
+    reflection->resources.push_back(
+        {name_of(variable.id, variables[variable.id].second),
+         variable.set_word ? words[variable.set_word] : 0,
+         words[variable.binding_word], variable.type, variable.count});
+  }
+  std::sort(reflection->resources.begin(), reflection->resources.end(),
+            [](const ShaderReflection::Resource& a,
+               const ShaderReflection::Resource& b) {
+              return std::make_pair(a.set, a.binding) <
+                     std::make_pair(b.set, b.binding);
+            });
+
+  for (const auto& variable : variables) {
+    const uint32_t id = variable.first;
+    const uint32_t storage_class = variable.second.first;
+    const uint32_t type = variable.second.second;
+    if (storage_class == kStorageClassPushConstant) {
+      reflection->push_constants.push_back(
+          {name_of(id, type), size_of(type, 0, false)});
+    } else if ((storage_class == kStorageClassInput ||
+                storage_class == kStorageClassOutput) &&
+               !builtins.count(id) && !structs_with_builtins.count(type) &&
+               locations.count(id)) {
+      auto& list = storage_class == kStorageClassInput ? reflection->inputs
+                                                       : reflection->outputs;
+      list.push_back({name_of(id, type), locations[id],
+                      components.count(id) ? components[id] : 0});
+    }
+  }
+  for (auto* list : {&reflection->inputs, &reflection->outputs}) {
+    std::sort(list->begin(), list->end(),
+              [](const ShaderReflection::InterfaceVariable& a,
+                 const ShaderReflection::InterfaceVariable& b) {
+                return std::make_pair(a.location, a.component) <
+                       std::make_pair(b.location, b.component);
+              });
+  }
+
+  for (const auto& spec_id : spec_ids) {
+    auto constant = constants.find(spec_id.first);
+    if (constant == constants.end()) continue;
+    const size_t at = constant->second;
+    ShaderReflection::SpecConstant reflected;
+    reflected.name = name_of(spec_id.first, 0);
+    reflected.spec_id = spec_id.second;
+    const uint32_t opcode = words[at] & 0xffff;
+    auto type = types.find(words[at + 1]);
+    reflected.default_value = "null";
+    if (opcode == kOpSpecConstantTrue || opcode == kOpSpecConstantFalse) {
+      reflected.type = "bool";
+      reflected.default_value =
+          opcode == kOpSpecConstantTrue ? "true" : "false";
+    } else if (opcode == kOpSpecConstant && type != types.end()) {
+      const size_t type_at = type->second;
+      const uint32_t width = words[type_at + 2];
+      const uint64_t bits =
+          width > 32
+              ? (static_cast<uint64_t>(words[at + 4]) << 32) | words[at + 3]
+              : words[at + 3];
+      std::ostringstream value;
+      if ((words[type_at] & 0xffff) == kOpTypeFloat) {
+        reflected.type = "float" + std::to_string(width);
+        if (width == 32) {
+          float f;
+          const uint32_t w = static_cast<uint32_t>(bits);
+          std::memcpy(&f, &w, sizeof(f));
+          value << std::setprecision(9) << f;
+        } else if (width == 64) {
+          double d;
+          std::memcpy(&d, &bits, sizeof(d));
+          value << std::setprecision(17) << d;
+        } else {
+          value << "null";
+        }
+      } else {
+        const bool is_signed = words[type_at + 3] != 0;
+        reflected.type =
+            (is_signed ? "int" : "uint") + std::to_string(width);
+        if (!is_signed) {
+          value << bits;
+        } else if (width > 32) {
+          value << static_cast<int64_t>(bits);
+        } else {
+          // Narrower values are sign-extended into the low word.
+          value << static_cast<int32_t>(bits);
+        }
+      }
+      reflected.default_value = value.str();
+    }
+    reflection->spec_constants.push_back(reflected);
+  }
+  std::sort(reflection->spec_constants.begin(),
+            reflection->spec_constants.end(),
+            [](const ShaderReflection::SpecConstant& a,
+               const ShaderReflection::SpecConstant& b) {
+              return a.spec_id < b.spec_id;
+            });
+  return true;
+}
+
+std::string ReflectionToJson(const ShaderReflection& reflection) {
+  const std::string pad(2, ' ');
+  const std::string item_pad(4, ' ');
+  std::ostringstream out;
+  // Writes a named array, one object per element, each built by write_item.
+  auto write_list = [&](const char* name, size_t size, bool last,
+                        const std::function<void(size_t)>& write_item) {
+    out << pad << QuoteJson(name) << ": [";
+    for (size_t i = 0; i < size; ++i) {
+      out << (i ? ",\n" : "\n") << item_pad << "{";
+      write_item(i);
+      out << "}";
+    }
+    out << (size ? "\n" + pad : "") << "]" << (last ? "\n" : ",\n");
+  };
+
+  out << "{\n";
+  write_list("entry_points", reflection.entry_points.size(), false,
+             [&](size_t i) {
+               const auto& entry_point = reflection.entry_points[i];
+               out << "\"name\": " << QuoteJson(entry_point.name)
+                   << ", \"stage\": " << QuoteJson(entry_point.stage);
+               if (entry_point.workgroup_size[0]) {
+                 out << ", \"workgroup_size\": ["
+                     << entry_point.workgroup_size[0] << ", "
+                     << entry_point.workgroup_size[1] << ", "
+                     << entry_point.workgroup_size[2] << "]";
+               }
+             });
+  write_list("descriptor_bindings", reflection.resources.size(), false,
+             [&](size_t i) {
+               const auto& resource = reflection.resources[i];
+               out << "\"name\": " << QuoteJson(resource.name)
+                   << ", \"set\": " << resource.set
+                   << ", \"binding\": " << resource.binding
+                   << ", \"type\": "
+                   << QuoteJson(GetDescriptorTypeName(resource.type))
+                   << ", \"count\": " << resource.count;
+             });
+  write_list("push_constants", reflection.push_constants.size(), false,
+             [&](size_t i) {
+               const auto& block = reflection.push_constants[i];
+               out << "\"name\": " << QuoteJson(block.name)
+                   << ", \"size\": " << block.size;
+             });
+  write_list("specialization_constants", reflection.spec_constants.size(),
+             false, [&](size_t i) {
+               const auto& constant = reflection.spec_constants[i];
+               out << "\"name\": " << QuoteJson(constant.name)
+                   << ", \"id\": " << constant.spec_id
+                   << ", \"type\": " << QuoteJson(constant.type)
+                   << ", \"default\": " << constant.default_value;
+             });
+  for (const bool is_input : {true, false}) {
+    const auto& list = is_input ? reflection.inputs : reflection.outputs;
+    write_list(is_input ? "inputs" : "outputs", list.size(), !is_input,
+               [&](size_t i) {
+                 out << "\"name\": " << QuoteJson(list[i].name)
+                     << ", \"location\": " << list[i].location
+                     << ", \"component\": " << list[i].component;
+               });
+  }
+  out << "}";
+  return out.str();
+}
+
+bool BakeUniforms(const std::vector<BakedUniform>& uniforms,
+                  std::vector<uint32_t>* spirv, std::string* errors) {
+  const std::vector<uint32_t>& words = *spirv;
+  std::unordered_map<uint32_t, std::string> names;
+  // (struct id, member) -> member name.
+  std::map<std::pair<uint32_t, uint32_t>, std::string> member_names;
+  std::unordered_map<uint32_t, size_t> types;
+  std::unordered_map<uint32_t, uint32_t> constants;
+  std::unordered_map<uint32_t, uint32_t> pointers;
+  // Uniform and push constant block variables: id -> block type id.
+  std::unordered_map<uint32_t, uint32_t> blocks;
+  std::unordered_set<uint32_t> buffer_blocks;
+  size_t first_function = words.size();
+
+  for (size_t i = kHeaderWordCount; i < words.size();) {
+    const uint32_t word_count = words[i] >> 16;
+    const uint32_t opcode = words[i] & 0xffff;
+    if (word_count == 0 || i + word_count > words.size()) {
+      *errors = "malformed SPIR-V module";
+      return false;
+    }
+    const size_t end = i + word_count;
+    if (opcode == kOpFunction) {
+      first_function = i;
+      break;
+    }
+    switch (opcode) {
+      case kOpName:
+        names[words[i + 1]] = ReadString(words, i + 2, end);
+        break;
+      case kOpMemberName:
+        member_names[{words[i + 1], words[i + 2]}] =
+            ReadString(words, i + 3, end);
+        break;
+      case kOpTypeInt:
+      case kOpTypeFloat:
+      case kOpTypeVector:
+      case kOpTypeStruct:
+        types[words[i + 1]] = i;
+        break;
+      case kOpTypePointer:
+        pointers[words[i + 1]] = words[i + 3];
+        break;
+      case kOpConstant:
+        constants[words[i + 2]] = words[i + 3];
+        break;
+      case kOpVariable:
+        if (words[i + 3] == kStorageClassUniform ||
+            words[i + 3] == kStorageClassPushConstant) {
+          blocks[words[i + 2]] = pointers[words[i + 1]];
+        }
+        break;
+      case kOpDecorate:
+        if (words[i + 2] == kDecorationBufferBlock) {
+          buffer_blocks.insert(words[i + 1]);
+        }
+        break;
+      default:
+        break;
+    }
+    i = end;
+  }
+
+  // The value of each baked member, by (block variable id, member), as the
+  // bits of its components.
+  std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> values;
+  // Component type id of each baked member.
+  std::map<std::pair<uint32_t, uint32_t>, uint32_t> component_types;
+  for (const auto& uniform : uniforms) {
+    const std::string full_name = uniform.block + "." + uniform.member;
+    for (const auto& block : blocks) {
+      const uint32_t type = block.second;
+      auto struct_type = types.find(type);
+      if (struct_type == types.end() || buffer_blocks.count(type) ||
+          (words[struct_type->second] & 0xffff) != kOpTypeStruct ||
+          (names[type] != uniform.block &&
+           names[block.first] != uniform.block)) {
+        continue;
+      }
+      const size_t at = struct_type->second;
+      for (uint32_t m = 0; at + 2 + m < at + (words[at] >> 16); ++m) {
+        auto member_name = member_names.find({type, m});
+        if (member_name == member_names.end() ||
+            member_name->second != uniform.member) {
+          continue;
+        }
+        // A scalar, or a vector of scalars.
+        auto member_type = types.find(words[at + 2 + m]);
+        uint32_t component_type = words[at + 2 + m];
+        uint32_t num_components = 1;
+        if (member_type != types.end() &&
+            (words[member_type->second] & 0xffff) == kOpTypeVector) {
+          component_type = words[member_type->second + 2];
+          num_components = words[member_type->second + 3];
+        }
+        auto component = types.find(component_type);
+        if (component == types.end() ||
+            ((words[component->second] & 0xffff) != kOpTypeInt &&
+             (words[component->second] & 0xffff) != kOpTypeFloat) ||
+            words[component->second + 2] != 32) {
+          *errors = "cannot bake '" + full_name +
+                    "': only 32-bit scalars and vectors can be baked";
+          return false;
+        }
+        std::vector<uint32_t> bits;
+        std::istringstream text(uniform.value);
+        std::string part;
+        while (std::getline(text, part, ',')) {
+          bits.emplace_back();
+          if (!ParseBakedComponent(words, component->second, part,
+                                   &bits.back())) {
+            *errors = "cannot bake '" + full_name + "': invalid value '" +
+                      uniform.value + "'";
+            return false;
+          }
+        }
+        if (bits.size() != num_components) {
+          *errors = "cannot bake '" + full_name + "': expected " +
+                    std::to_string(num_components) +
+                    (num_components == 1 ? " component" : " components") +
+                    ", got " + std::to_string(bits.size());
+          return false;
+        }
+        values[{block.first, m}] = std::move(bits);
+        component_types[{block.first, m}] = component_type;
+      }
+    }
+  }
+  if (values.empty()) return true;
+
+  // Find the access chains to baked members, or to one of their components,
+  // and turn the loads through them into copies of new constants.
+  std::vector<uint32_t> result(words.begin(), words.begin() + first_function);
+  std::vector<uint32_t> new_constants;
+  // (type id, bits of each component) -> constant id.
+  std::map<std::pair<uint32_t, std::vector<uint32_t>>, uint32_t> made;
+  uint32_t bound = words[3];
+  auto get_constant = [&](uint32_t type,
+                          const std::vector<uint32_t>& bits) -> uint32_t {
+    auto it = made.find({type, bits});
+    if (it != made.end()) return it->second;
+    const uint32_t id = bound++;
+    made[{type, bits}] = id;
+    return id;
+  };
+  // Access chain id -> (baked member, component or -1 for all of it).
+  std::unordered_map<uint32_t,
+                     std::pair<std::pair<uint32_t, uint32_t>, int64_t>>
+      chains;
+  for (size_t i = first_function; i < words.size();) {
+    const uint32_t word_count = words[i] >> 16;
+    const uint32_t opcode = words[i] & 0xffff;
+    if (word_count == 0 || i + word_count > words.size()) {
+      *errors = "malformed SPIR-V module";
+      return false;
+    }
+    if ((opcode == kOpAccessChain || opcode == kOpInBoundsAccessChain) &&
+        (word_count == 5 || word_count == 6) && blocks.count(words[i + 3]) &&
+        constants.count(words[i + 4])) {
+      const std::pair<uint32_t, uint32_t> member(words[i + 3],
+                                                 constants[words[i + 4]]);
+      if (values.count(member)) {
+        if (word_count == 5) {
+          chains[words[i + 2]] = {member, -1};
+        } else if (constants.count(words[i + 5]) &&
+                   constants[words[i + 5]] < values[member].size()) {
+          chains[words[i + 2]] = {member, constants[words[i + 5]]};
+        }
+      }
+    }
+    auto chain = opcode == kOpLoad ? chains.find(words[i + 3]) : chains.end();
+    if (chain == chains.end()) {
+      result.insert(result.end(), words.begin() + i,
+                    words.begin() + i + word_count);
+      i += word_count;
+      continue;
+    }
+    const auto& bits = values[chain->second.first];
+    const uint32_t component_type = component_types[chain->second.first];
+    uint32_t constant = 0;
+    if (chain->second.second >= 0) {
+      constant = get_constant(component_type, {bits[chain->second.second]});
+    } else if (bits.size() == 1) {
+      constant = get_constant(component_type, bits);
+    } else {
+      std::vector<uint32_t> parts;
+      for (const uint32_t component : bits) {
+        parts.push_back(get_constant(component_type, {component}));
+      }
+      constant = get_constant(words[i + 1], parts);
+    }
+    result.insert(result.end(),
+                  {(4u << 16) | kOpCopyObject, words[i + 1], words[i + 2],
+                   constant});
+    i += word_count;
+  }
+  if (made.empty()) return true;
+
+  // Scalars get lower ids than the composites made of them, so emitting the
+  // constants by id defines each before its use.
+  std::map<uint32_t, const std::pair<uint32_t, std::vector<uint32_t>>*> by_id;
+  for (const auto& entry : made) by_id[entry.second] = &entry.first;
+  for (const auto& entry : by_id) {
+    const uint32_t type = entry.second->first;
+    const std::vector<uint32_t>& operands = entry.second->second;
+    const bool is_composite = (words[types[type]] & 0xffff) == kOpTypeVector;
+    new_constants.push_back(
+        static_cast<uint32_t>((3 + operands.size()) << 16) |
+        (is_composite ? kOpConstantComposite : kOpConstant));
+    new_constants.push_back(type);
+    new_constants.push_back(entry.first);
+    new_constants.insert(new_constants.end(), operands.begin(),
+                         operands.end());
+  }
+  result.insert(result.begin() + first_function, new_constants.begin(),
+                new_constants.end());
+  result[3] = bound;
+  spirv->swap(result);
+  return true;
+}
+
+bool OverrideWorkgroupSize(const WorkgroupSizeOverride& size_override,
+                           bool size_is_referenced,
+                           std::vector<uint32_t>* spirv, std::string* errors) {
+  const std::vector<uint32_t>& words = *spirv;
+  // The index of the first operand of each LocalSize execution mode.
+  std::vector<size_t> local_sizes;
+  std::unordered_map<uint32_t, size_t> constants;
+  std::unordered_set<uint32_t> used_spec_ids;
+  uint32_t workgroup_size_id = 0;
+  uint32_t uint_type = 0;
+  uint32_t uvec3_type = 0;
+  // Where new decorations go, and where new global declarations go.
+  size_t annotations_end = kHeaderWordCount;
+  size_t first_function = words.size();
+
+  for (size_t i = kHeaderWordCount; i < words.size();) {
+    const uint32_t word_count = words[i] >> 16;
+    const uint32_t opcode = words[i] & 0xffff;
+    if (word_count == 0 || i + word_count > words.size()) {
+      *errors = "malformed SPIR-V module";
+      return false;
+    }
+    if (opcode == kOpFunction) {
+      first_function = i;
+      break;
+    }
+    if (IsBeforeTypes(opcode)) annotations_end = i + word_count;
+    switch (opcode) {
+      case kOpExecutionMode:
+        if (words[i + 2] == kExecutionModeLocalSize) {
+          local_sizes.push_back(i + 3);
+        }
+        break;
+      case kOpExecutionModeId:
+        if (words[i + 2] == kExecutionModeLocalSizeId) {
+          *errors = "cannot override a workgroup size given by LocalSizeId";
+          return false;
+        }
+        break;
+      case kOpDecorate:
+        if (words[i + 2] == kDecorationSpecId) {
+          used_spec_ids.insert(words[i + 3]);
+        } else if (words[i + 2] == kDecorationBuiltIn &&
+                   words[i + 3] == kBuiltInWorkgroupSize) {
+          workgroup_size_id = words[i + 1];
+        }
+        break;
+      case kOpTypeInt:
+        if (words[i + 2] == 32 && words[i + 3] == 0) uint_type = words[i + 1];
+        break;
+      case kOpTypeVector:
+        if (uint_type && words[i + 2] == uint_type && words[i + 3] == 3) {
+          uvec3_type = words[i + 1];
+        }
+        break;
+      case kOpConstant:
+      case kOpConstantComposite:
+      case kOpSpecConstant:
+      case kOpSpecConstantComposite:
+        constants[words[i + 2]] = i;
+        break;
+      default:
+        break;
+    }
+    i += word_count;
+  }
+  if (local_sizes.empty()) {
+    *errors = "the module has no workgroup size";
+    return false;
+  }
+
+  // The WorkgroupSize built-in, if any, takes precedence over LocalSize.
+  size_t composite_at = 0;
+  if (workgroup_size_id) {
+    auto composite = constants.find(workgroup_size_id);
+    if (composite == constants.end() ||
+        (words[composite->second] >> 16) != 6 ||
+        ((words[composite->second] & 0xffff) != kOpConstantComposite &&
+         (words[composite->second] & 0xffff) != kOpSpecConstantComposite)) {
+      *errors = "unsupported WorkgroupSize built-in";
+      return false;
+    }
+    composite_at = composite->second;
+  }
+
+  static const char* const kComponentNames[] = {"x", "y", "z"};
+  std::vector<uint32_t> edited(words);
+  // New instructions, by the index they are inserted before.
+  std::map<size_t, std::vector<uint32_t>> insertions;
+  uint32_t bound = words[3];
+  std::unordered_set<uint32_t> new_spec_ids;
+  bool any_spec = composite_at && (words[composite_at] & 0xffff) ==
+                                      kOpSpecConstantComposite;
+  for (uint32_t c = 0; c < 3; ++c) {
+    size_t at = 0;
+    uint32_t current = words[local_sizes[0] + c];
+    if (composite_at) {
+      auto component = constants.find(words[composite_at + 3 + c]);
+      if (component == constants.end() ||
+          ((words[component->second] & 0xffff) != kOpConstant &&
+           (words[component->second] & 0xffff) != kOpSpecConstant)) {
+        *errors = "unsupported WorkgroupSize built-in";
+        return false;
+      }
+      at = component->second;
+      current = words[at + 3];
+    }
+    const uint32_t target = size_override.size[c] ? size_override.size[c]
+                                                   : current;
+    for (const size_t local_size : local_sizes) edited[local_size + c] = target;
+
+    if (at && (words[at] & 0xffff) == kOpSpecConstant) {
+      // Already specializable: only its default value changes.
+      edited[at + 3] = target;
+      any_spec = true;
+      continue;
+    }
+    if (target == current && !size_override.specializable) continue;
+    if (size_is_referenced) {
+      *errors = std::string("cannot change workgroup size component ") +
+                kComponentNames[c] +
+                ": the shader uses gl_WorkGroupSize, whose value is fixed "
+                "at compile time unless the size is declared with "
+                "local_size_" +
+                kComponentNames[c] + "_id";
+      return false;
+    }
+    if (!composite_at && !size_override.specializable) continue;
+
+    // The component needs a constant of its own.
+    if (!uint_type) {
+      uint_type = bound++;
+      insertions[first_function].insert(insertions[first_function].end(),
+                                        {(4u << 16) | kOpTypeInt, uint_type,
+                                         32, 0});
+    }
+    const uint32_t id = bound++;
+    const size_t insert_at = composite_at ? composite_at : first_function;
+    if (size_override.specializable) {
+      const uint32_t spec_id = size_override.spec_ids[c];
+      if (used_spec_ids.count(spec_id) ||
+          !new_spec_ids.insert(spec_id).second) {
+        *errors = "SpecId " + std::to_string(spec_id) + " is already used";
+        return false;
+      }
+      insertions[annotations_end].insert(
+          insertions[annotations_end].end(),
+          {(4u << 16) | kOpDecorate, id, kDecorationSpecId, spec_id});
+      any_spec = true;
+    }
+    insertions[insert_at].insert(
+        insertions[insert_at].end(),
+        {(4u << 16) |
+             (size_override.specializable ? kOpSpecConstant : kOpConstant),
+         uint_type, id, target});
+    if (composite_at) edited[composite_at + 3 + c] = id;
+  }
+
+  if (composite_at) {
+    edited[composite_at] = (6u << 16) | (any_spec ? kOpSpecConstantComposite
+                                                   : kOpConstantComposite);
+  } else if (size_override.specializable) {
+    // Give the module a WorkgroupSize built-in made of the new constants.
+    std::vector<uint32_t>& globals = insertions[first_function];
+    if (!uvec3_type) {
+      uvec3_type = bound++;
+      globals.insert(globals.end(),
+                     {(4u << 16) | kOpTypeVector, uvec3_type, uint_type, 3});
+    }
+    const uint32_t composite = bound++;
+    std::vector<uint32_t> components;
+    for (size_t i = 0; i < globals.size(); i += globals[i] >> 16) {
+      if ((globals[i] & 0xffff) == kOpSpecConstant) {
+        components.push_back(globals[i + 2]);
+      }
+    }
+    globals.insert(globals.end(), {(6u << 16) | kOpSpecConstantComposite,
+                                   uvec3_type, composite});
+    globals.insert(globals.end(), components.begin(), components.end());
+    insertions[annotations_end].insert(
+        insertions[annotations_end].end(),
+        {(4u << 16) | kOpDecorate, composite, kDecorationBuiltIn,
+         kBuiltInWorkgroupSize});
+  }
+
+  std::vector<uint32_t> result;
+  result.reserve(edited.size() + 32);
+  size_t copied = 0;
+  for (const auto& insertion : insertions) {
+    result.insert(result.end(), edited.begin() + copied,
+                  edited.begin() + insertion.first);
+    result.insert(result.end(), insertion.second.begin(),
+                  insertion.second.end());
+    copied = insertion.first;
+  }
+  result.insert(result.end(), edited.begin() + copied, edited.end());
+  result[3] = bound;
+  spirv->swap(result);
+  return true;
+}
+
+}  // namespace shaderc_util
@@ -0,0 +1,484 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/spirv_interface.h"
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include "libshaderc_util/spirv_tools_wrapper.h"
+
+namespace {
+
+using shaderc_util::AssignPipelineDescriptorBindings;
+using shaderc_util::BakeUniforms;
+using shaderc_util::BakedUniform;
+using shaderc_util::Compiler;
+using shaderc_util::CompactInterfaceLocations;
+using shaderc_util::DescriptorBinding;
+using shaderc_util::DescriptorType;
+using shaderc_util::OverrideWorkgroupSize;
+using shaderc_util::ReflectSpirv;
+using shaderc_util::ShaderReflection;
+using shaderc_util::WorkgroupSizeOverride;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+// Returns a module with one entry point of the given execution model, whose
+// interface is made of the variables a and b, of the given storage class and
+// types.  decorations is inserted with the other decorations.
+std::string Module(const std::string& execution_model,
+                   const std::string& storage_class, const std::string& type_a,
+                   const std::string& type_b, const std::string& decorations) {
+  return "OpCapability Shader\n"
+         "OpCapability Float64\n"
+         "OpMemoryModel Logical GLSL450\n"
+         "OpEntryPoint " +
+         execution_model +
+         " %main \"main\" %a %b\n"
+         "OpName %a \"a\"\n"
+         "OpName %b \"b\"\n" +
+         decorations +
+         "%void = OpTypeVoid\n"
+         "%fn = OpTypeFunction %void\n"
+         "%float = OpTypeFloat 32\n"
+         "%double = OpTypeFloat 64\n"
+         "%v2float = OpTypeVector %float 2\n"
+         "%v4float = OpTypeVector %float 4\n"
+         "%v3double = OpTypeVector %double 3\n"
+         "%mat3v2float = OpTypeMatrix %v2float 3\n"
+         "%uint = OpTypeInt 32 0\n"
+         "%uint_2 = OpConstant %uint 2\n"
+         "%arr = OpTypeArray %v4float %uint_2\n"
+         "%ptr_a = OpTypePointer " +
+         storage_class + " %" + type_a +
+         "\n"
+         "%ptr_b = OpTypePointer " +
+         storage_class + " %" + type_b +
+         "\n"
+         "%a = OpVariable %ptr_a " +
+         storage_class +
+         "\n"
+         "%b = OpVariable %ptr_b " +
+         storage_class +
+         "\n"
+         "%main = OpFunction %void None %fn\n"
+         "%entry = OpLabel\n"
+         "OpReturn\n"
+         "OpFunctionEnd\n";
+}
+
+std::vector<uint32_t> Assemble(const std::string& text) {
+  spv_binary binary = nullptr;
+  std::string errors;
+  EXPECT_TRUE(shaderc_util::SpirvToolsAssemble(
+      Compiler::TargetEnv::Vulkan, Compiler::TargetEnvVersion::Vulkan_1_0,
+      text, &binary, &errors))
+      << errors;
+  std::vector<uint32_t> words;
+  if (binary) {
+    words.assign(binary->code, binary->code + binary->wordCount);
+    spvBinaryDestroy(binary);
+  }
+  return words;
+}
+
+std::string Disassemble(const std::vector<uint32_t>& words) {
+  std::string text;
+  shaderc_util::SpirvToolsDisassemble(Compiler::TargetEnv::Vulkan,
+                                      Compiler::TargetEnvVersion::Vulkan_1_0,
+                                      words, &text);
+  return text;
+}
+
+TEST(CompactInterfaceLocations, PacksLocationsInOrder) {
+  std::vector<uint32_t> producer = Assemble(Module(
+      "Vertex", "Output", "arr", "v3double",
+      "OpDecorate %a Location 3\nOpDecorate %b Location 9\n"));
+  std::vector<uint32_t> consumer = Assemble(Module(
+      "Fragment", "Input", "arr", "v3double",
+      "OpDecorate %a Location 3\nOpDecorate %b Location 9\n"));
+  EXPECT_TRUE(CompactInterfaceLocations(&producer, &consumer));
+  // The array takes two locations, so the next variable starts at 2.
+  for (const auto* module : {&producer, &consumer}) {
+    const std::string text = Disassemble(*module);
+    EXPECT_THAT(text, HasSubstr("OpDecorate %a Location 0"));
+    EXPECT_THAT(text, HasSubstr("OpDecorate %b Location 2"));
+  }
+}
+
+TEST(CompactInterfaceLocations, SizesMatricesByColumn) {
+  std::vector<uint32_t> producer = Assemble(Module(
+      "Vertex", "Output", "mat3v2float", "v4float",
+      "OpDecorate %a Location 1\nOpDecorate %b Location 7\n"));
+  std::vector<uint32_t> consumer = Assemble(Module(
+      "Fragment", "Input", "mat3v2float", "v4float",
+      "OpDecorate %a Location 1\nOpDecorate %b Location 7\n"));
+  EXPECT_TRUE(CompactInterfaceLocations(&producer, &consumer));
+  EXPECT_THAT(Disassemble(consumer), HasSubstr("OpDecorate %b Location 3"));
+}
+
+TEST(CompactInterfaceLocations, LeavesPackedInterfaceAlone) {
+  const std::string decorations =
+      "OpDecorate %a Location 0\nOpDecorate %b Location 1\n";
+  std::vector<uint32_t> producer = Assemble(
+      Module("Vertex", "Output", "v4float", "v2float", decorations));
+  std::vector<uint32_t> consumer = Assemble(
+      Module("Fragment", "Input", "v4float", "v2float", decorations));
+  const std::vector<uint32_t> original = producer;
+  EXPECT_FALSE(CompactInterfaceLocations(&producer, &consumer));
+  EXPECT_EQ(original, producer);
+}
+
+TEST(CompactInterfaceLocations, LeavesComponentDecorationsAlone) {
+  const std::string decorations =
+      "OpDecorate %a Location 2\nOpDecorate %b Location 2\n"
+      "OpDecorate %b Component 2\n";
+  std::vector<uint32_t> producer = Assemble(
+      Module("Vertex", "Output", "v2float", "v2float", decorations));
+  std::vector<uint32_t> consumer = Assemble(
+      Module("Fragment", "Input", "v2float", "v2float", decorations));
+  const std::vector<uint32_t> original = consumer;
+  EXPECT_FALSE(CompactInterfaceLocations(&producer, &consumer));
+  EXPECT_EQ(original, consumer);
+}
+
+TEST(CompactInterfaceLocations, LeavesMismatchedStagesAlone) {
+  std::vector<uint32_t> producer = Assemble(Module(
+      "Vertex", "Output", "arr", "v4float",
+      "OpDecorate %a Location 2\nOpDecorate %b Location 5\n"));
+  // The consumer reads a single location where the producer writes two.
+  std::vector<uint32_t> consumer = Assemble(Module(
+      "Fragment", "Input", "v4float", "v4float",
+      "OpDecorate %a Location 2\nOpDecorate %b Location 5\n"));
+  EXPECT_FALSE(CompactInterfaceLocations(&producer, &consumer));
+}
+
+// Returns a fragment shader module declaring a storage buffer %buf and a
+// variable %res of the given UniformConstant type, both with the given
+// decorations.
+std::string ResourceModule(const std::string& type,
+                           const std::string& decorations) {
+  return "OpCapability Shader\n"
+         "OpMemoryModel Logical GLSL450\n"
+         "OpEntryPoint Fragment %main \"main\"\n"
+         "OpExecutionMode %main OriginUpperLeft\n"
+         "OpName %buf \"buf\"\n"
+         "OpName %res \"res\"\n"
+         "OpDecorate %block BufferBlock\n"
+         "OpMemberDecorate %block 0 Offset 0\n" +
+         decorations +
+         "%void = OpTypeVoid\n"
+         "%fn = OpTypeFunction %void\n"
+         "%float = OpTypeFloat 32\n"
+         "%uint = OpTypeInt 32 0\n"
+         "%uint_3 = OpConstant %uint 3\n"
+         "%block = OpTypeStruct %float\n"
+         "%sampler = OpTypeSampler\n"
+         "%image = OpTypeImage %float 2D 0 0 0 2 Rgba8\n"
+         "%samplers = OpTypeArray %sampler %uint_3\n"
+         "%ptr_block = OpTypePointer Uniform %block\n"
+         "%ptr_res = OpTypePointer UniformConstant %" +
+         type +
+         "\n"
+         "%buf = OpVariable %ptr_block Uniform\n"
+         "%res = OpVariable %ptr_res UniformConstant\n"
+         "%main = OpFunction %void None %fn\n"
+         "%entry = OpLabel\n"
+         "OpReturn\n"
+         "OpFunctionEnd\n";
+}
+
+TEST(AssignPipelineDescriptorBindings, MergesStagesAndCompacts) {
+  std::vector<uint32_t> first = Assemble(ResourceModule(
+      "image",
+      "OpDecorate %buf DescriptorSet 3\nOpDecorate %buf Binding 8\n"
+      "OpDecorate %res DescriptorSet 3\nOpDecorate %res Binding 2\n"));
+  std::vector<uint32_t> second = Assemble(ResourceModule(
+      "samplers",
+      "OpDecorate %buf DescriptorSet 3\nOpDecorate %buf Binding 8\n"
+      "OpDecorate %res Binding 6\n"));
+  std::vector<DescriptorBinding> layout;
+  std::string errors;
+  ASSERT_TRUE(AssignPipelineDescriptorBindings(
+      {&first, &second}, {0x1, 0x10}, true, &layout, &errors))
+      << errors;
+  ASSERT_EQ(3u, layout.size());
+  // The sampler array without a set decoration is in set 0.
+  EXPECT_EQ(0u, layout[0].set);
+  EXPECT_EQ(0u, layout[0].binding);
+  EXPECT_EQ(DescriptorType::Sampler, layout[0].type);
+  EXPECT_EQ(3u, layout[0].count);
+  EXPECT_EQ(0x10u, layout[0].stage_flags);
+  EXPECT_EQ(1u, layout[1].set);
+  EXPECT_EQ(0u, layout[1].binding);
+  EXPECT_EQ(DescriptorType::StorageImage, layout[1].type);
+  EXPECT_EQ(1u, layout[2].set);
+  EXPECT_EQ(1u, layout[2].binding);
+  EXPECT_EQ(DescriptorType::StorageBuffer, layout[2].type);
+  EXPECT_EQ(0x11u, layout[2].stage_flags);
+  EXPECT_THAT(Disassemble(second), HasSubstr("OpDecorate %buf Binding 1"));
+  EXPECT_THAT(Disassemble(second), HasSubstr("OpDecorate %res Binding 0"));
+}
+
+TEST(AssignPipelineDescriptorBindings, RejectsConflictingDeclarations) {
+  const std::string decorations =
+      "OpDecorate %buf Binding 0\nOpDecorate %res Binding 1\n";
+  std::vector<uint32_t> first =
+      Assemble(ResourceModule("image", decorations));
+  std::vector<uint32_t> second =
+      Assemble(ResourceModule("sampler", decorations));
+  const std::vector<uint32_t> original = second;
+  std::vector<DescriptorBinding> layout;
+  std::string errors;
+  EXPECT_FALSE(AssignPipelineDescriptorBindings(
+      {&first, &second}, {0x1, 0x10}, true, &layout, &errors));
+  EXPECT_THAT(errors, HasSubstr("set 0 binding 1 is declared differently"));
+  EXPECT_EQ(original, second);
+}
+
+const char kReflectedComputeShader[] =
+    "OpCapability Shader\n"
+    "OpMemoryModel Logical GLSL450\n"
+    "OpEntryPoint GLCompute %main \"main\"\n"
+    "OpExecutionMode %main LocalSize 8 4 1\n"
+    "OpName %params \"params\"\n"
+    "OpName %Data \"Data\"\n"
+    "OpName %count \"count\"\n"
+    "OpDecorate %count SpecId 3\n"
+    "OpDecorate %Params Block\n"
+    "OpMemberDecorate %Params 0 Offset 0\n"
+    "OpMemberDecorate %Params 1 Offset 16\n"
+    "OpDecorate %Data BufferBlock\n"
+    "OpMemberDecorate %Data 0 Offset 0\n"
+    "OpDecorate %data DescriptorSet 1\n"
+    "OpDecorate %data Binding 2\n"
+    "%void = OpTypeVoid\n"
+    "%fn = OpTypeFunction %void\n"
+    "%float = OpTypeFloat 32\n"
+    "%v4float = OpTypeVector %float 4\n"
+    "%int = OpTypeInt 32 1\n"
+    "%count = OpSpecConstant %int -7\n"
+    "%Params = OpTypeStruct %float %v4float\n"
+    "%Data = OpTypeStruct %float\n"
+    "%ptr_params = OpTypePointer PushConstant %Params\n"
+    "%ptr_data = OpTypePointer Uniform %Data\n"
+    "%params = OpVariable %ptr_params PushConstant\n"
+    "%data = OpVariable %ptr_data Uniform\n"
+    "%main = OpFunction %void None %fn\n"
+    "%entry = OpLabel\n"
+    "OpReturn\n"
+    "OpFunctionEnd\n";
+
+TEST(ReflectSpirv, DescribesComputeShader) {
+  ShaderReflection reflection;
+  std::string errors;
+  ASSERT_TRUE(ReflectSpirv(Assemble(kReflectedComputeShader), &reflection,
+                           &errors))
+      << errors;
+  ASSERT_EQ(1u, reflection.entry_points.size());
+  EXPECT_EQ("main", reflection.entry_points[0].name);
+  EXPECT_EQ("compute", reflection.entry_points[0].stage);
+  EXPECT_EQ(8u, reflection.entry_points[0].workgroup_size[0]);
+  EXPECT_EQ(4u, reflection.entry_points[0].workgroup_size[1]);
+  EXPECT_EQ(1u, reflection.entry_points[0].workgroup_size[2]);
+  ASSERT_EQ(1u, reflection.resources.size());
+  // The unnamed variable is named after its block type.
+  EXPECT_EQ("Data", reflection.resources[0].name);
+  EXPECT_EQ(1u, reflection.resources[0].set);
+  EXPECT_EQ(2u, reflection.resources[0].binding);
+  EXPECT_EQ(DescriptorType::StorageBuffer, reflection.resources[0].type);
+  ASSERT_EQ(1u, reflection.push_constants.size());
+  EXPECT_EQ("params", reflection.push_constants[0].name);
+  EXPECT_EQ(32u, reflection.push_constants[0].size);
+  ASSERT_EQ(1u, reflection.spec_constants.size());
+  EXPECT_EQ("count", reflection.spec_constants[0].name);
+  EXPECT_EQ(3u, reflection.spec_constants[0].spec_id);
+  EXPECT_EQ("int32", reflection.spec_constants[0].type);
+  EXPECT_EQ("-7", reflection.spec_constants[0].default_value);
+}
+
+TEST(ReflectSpirv, WritesJson) {
+  ShaderReflection reflection;
+  std::string errors;
+  ASSERT_TRUE(ReflectSpirv(Assemble(kReflectedComputeShader), &reflection,
+                           &errors));
+  const std::string json = shaderc_util::ReflectionToJson(reflection);
+  EXPECT_THAT(json, HasSubstr("{\"name\": \"main\", \"stage\": "
+                              "\"compute\", \"workgroup_size\": [8, 4, 1]}"));
+  EXPECT_THAT(json, HasSubstr("{\"name\": \"Data\", \"set\": 1, "
+                              "\"binding\": 2, \"type\": \"storage_buffer\", "
+                              "\"count\": 1}"));
+  EXPECT_THAT(json, HasSubstr("\"inputs\": [],\n"));
+  EXPECT_EQ('}', json.back());
+}
+
+const char kBakedFragmentShader[] =
+    "OpCapability Shader\n"
+    "OpMemoryModel Logical GLSL450\n"
+    "OpEntryPoint Fragment %main \"main\"\n"
+    "OpExecutionMode %main OriginUpperLeft\n"
+    "OpName %Material \"Material\"\n"
+    "OpMemberName %Material 0 \"roughness\"\n"
+    "OpMemberName %Material 1 \"tint\"\n"
+    "OpDecorate %Material Block\n"
+    "OpMemberDecorate %Material 0 Offset 0\n"
+    "OpMemberDecorate %Material 1 Offset 16\n"
+    "OpDecorate %material DescriptorSet 0\n"
+    "OpDecorate %material Binding 1\n"
+    "%void = OpTypeVoid\n"
+    "%fn = OpTypeFunction %void\n"
+    "%float = OpTypeFloat 32\n"
+    "%v3float = OpTypeVector %float 3\n"
+    "%int = OpTypeInt 32 1\n"
+    "%int_0 = OpConstant %int 0\n"
+    "%int_1 = OpConstant %int 1\n"
+    "%Material = OpTypeStruct %float %v3float\n"
+    "%ptr_material = OpTypePointer Uniform %Material\n"
+    "%ptr_float = OpTypePointer Uniform %float\n"
+    "%ptr_v3float = OpTypePointer Uniform %v3float\n"
+    "%material = OpVariable %ptr_material Uniform\n"
+    "%main = OpFunction %void None %fn\n"
+    "%entry = OpLabel\n"
+    "%1 = OpAccessChain %ptr_float %material %int_0\n"
+    "%roughness = OpLoad %float %1\n"
+    "%2 = OpAccessChain %ptr_v3float %material %int_1\n"
+    "%tint = OpLoad %v3float %2\n"
+    "%3 = OpAccessChain %ptr_float %material %int_1 %int_1\n"
+    "%green = OpLoad %float %3\n"
+    "OpReturn\n"
+    "OpFunctionEnd\n";
+
+TEST(BakeUniforms, ReplacesLoadsWithConstants) {
+  std::vector<uint32_t> spirv = Assemble(kBakedFragmentShader);
+  std::string errors;
+  ASSERT_TRUE(BakeUniforms({{"Material", "roughness", "0.5"},
+                            {"Material", "tint", "1, 0.25, 0"},
+                            {"Material", "missing", "1"}},
+                           &spirv, &errors))
+      << errors;
+  const std::string text = Disassemble(spirv);
+  EXPECT_THAT(text, HasSubstr("OpConstant %float 0.5\n"));
+  EXPECT_THAT(text, HasSubstr("OpConstant %float 0.25\n"));
+  EXPECT_THAT(text, HasSubstr("OpConstantComposite %v3float"));
+  EXPECT_THAT(text, Not(HasSubstr("OpLoad")));
+  EXPECT_THAT(text, HasSubstr("%roughness = OpCopyObject %float"));
+  EXPECT_THAT(text, HasSubstr("%tint = OpCopyObject %v3float"));
+  EXPECT_THAT(text, HasSubstr("%green = OpCopyObject %float"));
+}
+
+TEST(BakeUniforms, RejectsValuesThatDoNotFit) {
+  const std::vector<uint32_t> original = Assemble(kBakedFragmentShader);
+  std::vector<uint32_t> spirv = original;
+  std::string errors;
+  EXPECT_FALSE(BakeUniforms({{"Material", "tint", "1,0"}}, &spirv, &errors));
+  EXPECT_EQ("cannot bake 'Material.tint': expected 3 components, got 2",
+            errors);
+  EXPECT_FALSE(
+      BakeUniforms({{"Material", "roughness", "rough"}}, &spirv, &errors));
+  EXPECT_EQ("cannot bake 'Material.roughness': invalid value 'rough'",
+            errors);
+  EXPECT_EQ(original, spirv);
+}
+
+// A compute shader with a WorkgroupSize built-in whose y component is a
+// specialization constant.
+const char kWorkgroupSizeShader[] =
+    "OpCapability Shader\n"
+    "OpMemoryModel Logical GLSL450\n"
+    "OpEntryPoint GLCompute %main \"main\"\n"
+    "OpExecutionMode %main LocalSize 8 4 1\n"
+    "OpDecorate %y SpecId 1\n"
+    "OpDecorate %size BuiltIn WorkgroupSize\n"
+    "%void = OpTypeVoid\n"
+    "%fn = OpTypeFunction %void\n"
+    "%uint = OpTypeInt 32 0\n"
+    "%v3uint = OpTypeVector %uint 3\n"
+    "%x = OpConstant %uint 8\n"
+    "%y = OpSpecConstant %uint 4\n"
+    "%z = OpConstant %uint 1\n"
+    "%size = OpSpecConstantComposite %v3uint %x %y %z\n"
+    "%main = OpFunction %void None %fn\n"
+    "%entry = OpLabel\n"
+    "OpReturn\n"
+    "OpFunctionEnd\n";
+
+TEST(OverrideWorkgroupSize, ChangesLocalSizeAndBuiltIn) {
+  std::vector<uint32_t> spirv = Assemble(kWorkgroupSizeShader);
+  WorkgroupSizeOverride size_override;
+  size_override.size[0] = 64;
+  size_override.size[1] = 2;
+  std::string errors;
+  ASSERT_TRUE(OverrideWorkgroupSize(size_override,
+                                    /* size_is_referenced = */ false, &spirv,
+                                    &errors))
+      << errors;
+  const std::string text = Disassemble(spirv);
+  EXPECT_THAT(text, HasSubstr("OpExecutionMode %main LocalSize 64 2 1\n"));
+  EXPECT_THAT(text, HasSubstr("%y = OpSpecConstant %uint 2\n"));
+  EXPECT_THAT(text, HasSubstr("OpConstant %uint 64\n"));
+  EXPECT_THAT(text, Not(HasSubstr("%size = OpSpecConstantComposite %v3uint "
+                                  "%x %y %z\n")));
+}
+
+TEST(OverrideWorkgroupSize, MakesLocalSizeSpecializable) {
+  std::vector<uint32_t> spirv = Assemble(kReflectedComputeShader);
+  WorkgroupSizeOverride size_override;
+  size_override.size[2] = 2;
+  size_override.specializable = true;
+  size_override.spec_ids[0] = 10;
+  size_override.spec_ids[1] = 11;
+  size_override.spec_ids[2] = 12;
+  std::string errors;
+  ASSERT_TRUE(OverrideWorkgroupSize(size_override,
+                                    /* size_is_referenced = */ false, &spirv,
+                                    &errors))
+      << errors;
+  ShaderReflection reflection;
+  ASSERT_TRUE(ReflectSpirv(spirv, &reflection, &errors)) << errors;
+  EXPECT_EQ(2u, reflection.entry_points[0].workgroup_size[2]);
+  const std::string text = Disassemble(spirv);
+  EXPECT_THAT(text, HasSubstr("BuiltIn WorkgroupSize"));
+  EXPECT_THAT(text, HasSubstr("SpecId 10"));
+  EXPECT_THAT(text, HasSubstr("SpecId 12"));
+  EXPECT_THAT(text, HasSubstr("OpSpecConstantComposite"));
+}
+
+TEST(OverrideWorkgroupSize, RejectsChangesToFoldedComponents) {
+  const std::vector<uint32_t> original = Assemble(kWorkgroupSizeShader);
+  std::vector<uint32_t> spirv = original;
+  WorkgroupSizeOverride size_override;
+  size_override.size[1] = 16;
+  std::string errors;
+  // The y component is a specialization constant, so uses of it follow.
+  EXPECT_TRUE(OverrideWorkgroupSize(size_override,
+                                    /* size_is_referenced = */ true, &spirv,
+                                    &errors))
+      << errors;
+  spirv = original;
+  size_override.size[0] = 16;
+  EXPECT_FALSE(OverrideWorkgroupSize(size_override,
+                                     /* size_is_referenced = */ true, &spirv,
+                                     &errors));
+  EXPECT_THAT(errors, HasSubstr("cannot change workgroup size component x"));
+  EXPECT_EQ(original, spirv);
+
+  spirv = Assemble(kBakedFragmentShader);
+  EXPECT_FALSE(OverrideWorkgroupSize(size_override, false, &spirv, &errors));
+  EXPECT_EQ("the module has no workgroup size", errors);
+}
+
+}  // anonymous namespace
@@ -0,0 +1,255 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/spirv_size.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "libshaderc_util/json.h"
+
+namespace {
+
+// The parts of the SPIR-V grammar the size attribution needs.
+const size_t kHeaderWordCount = 5;
+const uint32_t kSpirvMagicNumber = 0x07230203;
+const uint32_t kOpSourceContinued = 2;
+const uint32_t kOpSource = 3;
+const uint32_t kOpSourceExtension = 4;
+const uint32_t kOpName = 5;
+const uint32_t kOpMemberName = 6;
+const uint32_t kOpString = 7;
+const uint32_t kOpLine = 8;
+const uint32_t kOpExtInstImport = 11;
+const uint32_t kOpExtInst = 12;
+const uint32_t kOpFunction = 54;
+const uint32_t kOpFunctionEnd = 56;
+const uint32_t kOpLabel = 248;
+const uint32_t kOpNoLine = 317;
+const uint32_t kOpModuleProcessed = 330;
+
+// Returns the literal string starting at words[at], which must end before
+// words[end].
+std::string ReadString(const std::vector<uint32_t>& words, size_t at,
+                       size_t end) {
+  std::string result;
+  for (; at < end; ++at) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      const char c = static_cast<char>((words[at] >> shift) & 0xff);
+      if (c == 0) return result;
+      result.push_back(c);
+    }
+  }
+  return result;
+}
+
+// Returns true for the instructions that stripping debug info removes.
+bool IsDebugInstruction(uint32_t opcode) {
+  switch (opcode) {
+    case kOpSourceContinued:
+    case kOpSource:
+    case kOpSourceExtension:
+    case kOpName:
+    case kOpMemberName:
+    case kOpString:
+    case kOpLine:
+    case kOpNoLine:
+    case kOpModuleProcessed:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the contributors in a map of name -> words, from the largest down.
+std::vector<shaderc_util::SizeAttribution::Contributor> SortContributors(
+    const std::map<std::string, uint64_t>& words) {
+  std::vector<shaderc_util::SizeAttribution::Contributor> contributors;
+  for (const auto& entry : words) {
+    contributors.push_back({entry.first, entry.second});
+  }
+  // The map is ordered by name, which breaks ties.
+  std::stable_sort(
+      contributors.begin(), contributors.end(),
+      [](const shaderc_util::SizeAttribution::Contributor& a,
+         const shaderc_util::SizeAttribution::Contributor& b) {
+        return a.words > b.words;
+      });
+  return contributors;
+}
+
+}  // anonymous namespace
+
+namespace shaderc_util {
+
+bool AttributeSpirvSize(const std::vector<uint32_t>& spirv,
+                        SizeAttribution* attribution, std::string* errors) {
+  *attribution = SizeAttribution();
+  if (spirv.size() < kHeaderWordCount || spirv[0] != kSpirvMagicNumber) {
+    *errors = "not a SPIR-V module";
+    return false;
+  }
+
+  std::unordered_map<uint32_t, std::string> names;
+  std::unordered_map<uint32_t, std::string> strings;
+  // The ids of extended instruction sets for debug info, which stripping
+  // removes with their instructions.
+  std::unordered_set<uint32_t> debug_sets;
+  // Function id -> words, and OpString id -> words of function code.
+  std::map<uint32_t, uint64_t> function_words;
+  std::map<uint32_t, uint64_t> string_words;
+  // Words of functions without any line.
+  uint64_t unattributed_words = 0;
+
+  attribution->total_words = kHeaderWordCount;
+  attribution->declaration_words = kHeaderWordCount;
+  bool in_function = false;
+  uint32_t function_id = 0;
+  // The file given by the last OpLine still in effect, the file of the first
+  // line in the current function, and the words of the current function not
+  // covered by any line.
+  uint32_t current_file = 0;
+  uint32_t first_file = 0;
+  uint64_t pending_words = 0;
+
+  for (size_t i = kHeaderWordCount; i < spirv.size();) {
+    const uint32_t word_count = spirv[i] >> 16;
+    const uint32_t opcode = spirv[i] & 0xffff;
+    const size_t end = i + word_count;
+    if (word_count == 0 || end > spirv.size()) {
+      *errors = "malformed instruction at word " + std::to_string(i);
+      return false;
+    }
+    bool counted = !IsDebugInstruction(opcode);
+    switch (opcode) {
+      case kOpName:
+        if (word_count > 2) names[spirv[i + 1]] = ReadString(spirv, i + 2, end);
+        break;
+      case kOpString:
+        if (word_count > 2) {
+          strings[spirv[i + 1]] = ReadString(spirv, i + 2, end);
+        }
+        break;
+      case kOpLine:
+        if (word_count > 1) current_file = spirv[i + 1];
+        break;
+      case kOpNoLine:
+        current_file = 0;
+        break;
+      case kOpExtInstImport: {
+        const std::string set = ReadString(spirv, i + 2, end);
+        if (set == "OpenCL.DebugInfo.100" ||
+            set == "NonSemantic.Shader.DebugInfo.100") {
+          debug_sets.insert(spirv[i + 1]);
+          counted = false;
+        }
+        break;
+      }
+      case kOpExtInst:
+        if (word_count > 3 && debug_sets.count(spirv[i + 3])) counted = false;
+        break;
+      case kOpFunction:
+        if (word_count < 3) {
+          *errors = "malformed instruction at word " + std::to_string(i);
+          return false;
+        }
+        in_function = true;
+        function_id = spirv[i + 2];
+        first_file = 0;
+        pending_words = 0;
+        break;
+      case kOpLabel:
+        // A line ends with its block.
+        current_file = 0;
+        break;
+      default:
+        break;
+    }
+
+    if (counted) {
+      attribution->total_words += word_count;
+      if (!in_function) {
+        attribution->declaration_words += word_count;
+      } else {
+        function_words[function_id] += word_count;
+        if (current_file) {
+          string_words[current_file] += word_count;
+          if (!first_file) first_file = current_file;
+        } else {
+          pending_words += word_count;
+        }
+      }
+    }
+
+    if (opcode == kOpFunctionEnd && in_function) {
+      if (first_file) {
+        string_words[first_file] += pending_words;
+      } else {
+        unattributed_words += pending_words;
+      }
+      in_function = false;
+      current_file = 0;
+    }
+    i = end;
+  }
+  if (in_function) {
+    *errors = "function %" + std::to_string(function_id) + " has no end";
+    return false;
+  }
+
+  std::map<std::string, uint64_t> by_function;
+  for (const auto& entry : function_words) {
+    auto name = names.find(entry.first);
+    by_function[name == names.end() ? "%" + std::to_string(entry.first)
+                                    : name->second] += entry.second;
+  }
+  // Several OpStrings may name the same file.
+  std::map<std::string, uint64_t> by_file;
+  for (const auto& entry : string_words) {
+    auto name = strings.find(entry.first);
+    by_file[name == strings.end() ? "" : name->second] += entry.second;
+  }
+  if (unattributed_words) by_file[""] += unattributed_words;
+  attribution->functions = SortContributors(by_function);
+  attribution->files = SortContributors(by_file);
+  return true;
+}
+
+std::string SizeAttributionToJson(const SizeAttribution& attribution) {
+  std::ostringstream out;
+  out << "{\n  \"total_words\": " << attribution.total_words
+      << ",\n  \"declaration_words\": " << attribution.declaration_words;
+  auto write = [&out](const char* key,
+                      const std::vector<SizeAttribution::Contributor>&
+                          contributors,
+                      bool null_for_empty_name) {
+    out << ",\n  \"" << key << "\": [";
+    for (size_t i = 0; i < contributors.size(); ++i) {
+      const std::string& name = contributors[i].name;
+      out << (i ? ",\n" : "\n") << "    {\"name\": "
+          << (name.empty() && null_for_empty_name ? "null" : QuoteJson(name))
+          << ", \"words\": " << contributors[i].words << "}";
+    }
+    out << (contributors.empty() ? "]" : "\n  ]");
+  };
+  write("functions", attribution.functions, false);
+  write("files", attribution.files, true);
+  out << "\n}";
+  return out.str();
+}
+
+}  // namespace shaderc_util
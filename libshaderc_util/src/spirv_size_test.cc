@@ -0,0 +1,139 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/spirv_size.h"
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include "libshaderc_util/spirv_tools_wrapper.h"
+
+namespace {
+
+using shaderc_util::AttributeSpirvSize;
+using shaderc_util::Compiler;
+using shaderc_util::SizeAttribution;
+
+std::vector<uint32_t> Assemble(const std::string& text) {
+  spv_binary binary = nullptr;
+  std::string errors;
+  EXPECT_TRUE(shaderc_util::SpirvToolsAssemble(
+      Compiler::TargetEnv::Vulkan, Compiler::TargetEnvVersion::Vulkan_1_0,
+      text, &binary, &errors))
+      << errors;
+  std::vector<uint32_t> words;
+  if (binary) {
+    words.assign(binary->code, binary->code + binary->wordCount);
+    spvBinaryDestroy(binary);
+  }
+  return words;
+}
+
+// A fragment shader whose entry point, from shader.frag, calls a helper from
+// noise.glsl.  A third function has no lines.  The word count of each
+// instruction that is not debug info is noted.
+const char kShaderWithLines[] = R"(
+               OpCapability Shader                         ; 2
+               OpMemoryModel Logical GLSL450               ; 3
+               OpEntryPoint Fragment %main "main"          ; 5
+               OpExecutionMode %main OriginUpperLeft       ; 3
+       %file = OpString "shader.frag"
+      %noise = OpString "noise.glsl"
+               OpName %main "main"
+               OpName %helper "helper("
+       %void = OpTypeVoid                                  ; 2
+         %fn = OpTypeFunction %void                        ; 3
+      %float = OpTypeFloat 32                              ; 3
+   %float_fn = OpTypeFunction %float                       ; 3
+    %float_1 = OpConstant %float 1                         ; 4
+               OpLine %noise 3 0
+     %helper = OpFunction %float None %float_fn            ; 5
+         %10 = OpLabel                                     ; 2
+               OpLine %noise 4 0
+        %sum = OpFAdd %float %float_1 %float_1             ; 5
+               OpReturnValue %sum                          ; 2
+               OpFunctionEnd                               ; 1
+       %main = OpFunction %void None %fn                   ; 5
+         %20 = OpLabel                                     ; 2
+               OpLine %file 10 0
+       %call = OpFunctionCall %float %helper               ; 4
+               OpReturn                                    ; 1
+               OpFunctionEnd                               ; 1
+     %unused = OpFunction %void None %fn                   ; 5
+         %30 = OpLabel                                     ; 2
+               OpReturn                                    ; 1
+               OpFunctionEnd                               ; 1
+)";
+
+TEST(AttributeSpirvSize, AttributesWordsToFunctionsAndFiles) {
+  SizeAttribution attribution;
+  std::string errors;
+  ASSERT_TRUE(AttributeSpirvSize(Assemble(kShaderWithLines), &attribution,
+                                 &errors))
+      << errors;
+  // The header and the declarations.
+  EXPECT_EQ(5u + 28u, attribution.declaration_words);
+  EXPECT_EQ(33u + 15u + 13u + 9u, attribution.total_words);
+
+  ASSERT_EQ(3u, attribution.functions.size());
+  EXPECT_EQ("helper(", attribution.functions[0].name);
+  EXPECT_EQ(15u, attribution.functions[0].words);
+  EXPECT_EQ("main", attribution.functions[1].name);
+  EXPECT_EQ(13u, attribution.functions[1].words);
+  EXPECT_EQ('%', attribution.functions[2].name[0]);
+  EXPECT_EQ(9u, attribution.functions[2].words);
+
+  // The label of each function counts for the file of its first line.
+  ASSERT_EQ(3u, attribution.files.size());
+  EXPECT_EQ("noise.glsl", attribution.files[0].name);
+  EXPECT_EQ(15u, attribution.files[0].words);
+  EXPECT_EQ("shader.frag", attribution.files[1].name);
+  EXPECT_EQ(13u, attribution.files[1].words);
+  EXPECT_EQ("", attribution.files[2].name);
+  EXPECT_EQ(9u, attribution.files[2].words);
+}
+
+TEST(AttributeSpirvSize, FailsOnMalformedModule) {
+  std::vector<uint32_t> words = Assemble(kShaderWithLines);
+  // Make the final OpFunctionEnd claim more words than the module has.
+  words.back() = (5u << 16) | 56u;
+  SizeAttribution attribution;
+  std::string errors;
+  EXPECT_FALSE(AttributeSpirvSize(words, &attribution, &errors));
+  EXPECT_FALSE(errors.empty());
+  EXPECT_FALSE(AttributeSpirvSize({1, 2, 3}, &attribution, &errors));
+}
+
+TEST(SizeAttributionToJson, WritesOneContributorPerLine) {
+  SizeAttribution attribution;
+  attribution.total_words = 40;
+  attribution.declaration_words = 20;
+  attribution.functions.push_back({"main", 20});
+  attribution.files.push_back({"a.glsl", 15});
+  attribution.files.push_back({"", 5});
+  EXPECT_EQ(
+      "{\n  \"total_words\": 40,\n  \"declaration_words\": 20,\n"
+      "  \"functions\": [\n    {\"name\": \"main\", \"words\": 20}\n  ],\n"
+      "  \"files\": [\n    {\"name\": \"a.glsl\", \"words\": 15},\n"
+      "    {\"name\": null, \"words\": 5}\n  ]\n}",
+      shaderc_util::SizeAttributionToJson(attribution));
+  EXPECT_EQ(
+      "{\n  \"total_words\": 0,\n  \"declaration_words\": 0,\n"
+      "  \"functions\": [],\n  \"files\": []\n}",
+      shaderc_util::SizeAttributionToJson(SizeAttribution()));
+}
+
+}  // anonymous namespace
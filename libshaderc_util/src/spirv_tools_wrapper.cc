@@ -15,9 +15,12 @@
 #include "libshaderc_util/spirv_tools_wrapper.h"
 
 #include <algorithm>
+#include <cctype>
+#include <functional>
 #include <sstream>
 
 #include "spirv-tools/libspirv.hpp"
+#include "spirv-tools/linker.hpp"
 #include "spirv-tools/optimizer.hpp"
 
 namespace shaderc_util {
@@ -57,6 +60,259 @@ spv_target_env GetSpirvToolsTargetEnv(Compiler::TargetEnv env,
   return SPV_ENV_VULKAN_1_0;
 }
 
+// Returns the options used to validate modules before they are optimized.
+spvtools::ValidatorOptions GetValidatorOptions() {
+  spvtools::ValidatorOptions val_opts;
+  // This allows flexible memory layout for HLSL.
+  val_opts.SetSkipBlockLayout(true);
+  // This allows HLSL legalization regarding resources.
+  val_opts.SetRelaxLogicalPointer(true);
+  // This uses relaxed rules for pre-legalized HLSL.
+  val_opts.SetBeforeHlslLegalization(true);
+  // Don't use friendly names when printing validation errors.
+  // It incurs a high startup cost whether or not there is an
+  // error. Validation failures are compiler bugs, and so they
+  // should be rare anyway.
+  val_opts.SetFriendlyNames(false);
+  return val_opts;
+}
+
+// Runs the passes registered by register_passes on *binary.  Modules that
+// come from our own front end need not be validated again, so validation
+// only runs if validate is true.
+bool RunPasses(
+    Compiler::TargetEnv env, Compiler::TargetEnvVersion version,
+    const std::function<void(spvtools::Optimizer*)>& register_passes,
+    std::vector<uint32_t>* binary, std::string* errors,
+    bool validate = false) {
+  errors->clear();
+  spvtools::Optimizer optimizer(GetSpirvToolsTargetEnv(env, version));
+  std::ostringstream oss;
+  optimizer.SetMessageConsumer(
+      [&oss](spv_message_level_t, const char*, const spv_position_t&,
+             const char* message) { oss << message << "\n"; });
+  register_passes(&optimizer);
+  spvtools::OptimizerOptions options;
+  options.set_run_validator(validate);
+  options.set_validator_options(GetValidatorOptions());
+  if (!optimizer.Run(binary->data(), binary->size(), binary, options)) {
+    *errors = oss.str();
+    return false;
+  }
+  return true;
+}
+
+// Registers the passes of the given id with optimizer.  Returns false if
+// user_pass_flags cannot be registered.
+bool RegisterPasses(PassId pass,
+                    const std::vector<std::string>& user_pass_flags,
+                    spvtools::Optimizer* optimizer) {
+  switch (pass) {
+    case PassId::kLegalizationPasses:
+      optimizer->RegisterLegalizationPasses();
+      break;
+    case PassId::kPerformancePasses:
+      optimizer->RegisterPerformancePasses();
+      break;
+    case PassId::kSizePasses:
+      optimizer->RegisterSizePasses();
+      break;
+    case PassId::kFastCompilePasses:
+      // Function-local passes that each make a single linear sweep.
+      // Inlining, scalar replacement, SSA rewriting and loop passes are
+      // left out, as they dominate the cost of the performance recipe.
+      optimizer->RegisterPass(
+          spvtools::CreateLocalSingleBlockLoadStoreElimPass());
+      optimizer->RegisterPass(spvtools::CreateLocalSingleStoreElimPass());
+      optimizer->RegisterPass(spvtools::CreateSimplificationPass());
+      optimizer->RegisterPass(spvtools::CreateDeadBranchElimPass());
+      optimizer->RegisterPass(spvtools::CreateAggressiveDCEPass());
+      optimizer->RegisterPass(spvtools::CreateCFGCleanupPass());
+      break;
+    case PassId::kMinimumSizePasses:
+      // SpirvToolsOptimize runs these in stages; this is the same sequence
+      // in a single run.
+      optimizer->RegisterSizePasses();
+      RegisterPasses(PassId::kRemoveDuplicates, user_pass_flags, optimizer);
+      optimizer->RegisterPass(spvtools::CreateCompactIdsPass());
+      break;
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES) \
+  case PassId::k##NAME##ProfilePasses:            \
+    return optimizer->RegisterPassesFromFlags(ParseSpirvOptPassList(PASSES));
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+    case PassId::kNullPass:
+      // We actually don't need to do anything for null pass.
+      break;
+    case PassId::kStripDebugInfo:
+      optimizer->RegisterPass(spvtools::CreateStripDebugInfoPass());
+      break;
+    case PassId::kStripNonSemanticInfo:
+      optimizer->RegisterPass(spvtools::CreateStripNonSemanticInfoPass());
+      break;
+    case PassId::kCompactIds:
+      optimizer->RegisterPass(spvtools::CreateCompactIdsPass());
+      break;
+    case PassId::kRemoveDuplicates:
+      optimizer->RegisterPass(spvtools::CreateRemoveDuplicatesPass());
+      optimizer->RegisterPass(spvtools::CreateUnifyConstantPass());
+      break;
+    case PassId::kEliminateDeadFunctions:
+      optimizer->RegisterPass(spvtools::CreateEliminateDeadFunctionsPass());
+      break;
+    case PassId::kRemoveUnusedInterfaceVariables:
+      optimizer->RegisterPass(
+          spvtools::CreateRemoveUnusedInterfaceVariablesPass());
+      optimizer->RegisterPass(spvtools::CreateDeadVariableEliminationPass());
+      break;
+    case PassId::kFoldBakedConstants:
+      optimizer->RegisterPass(spvtools::CreateSimplificationPass());
+      optimizer->RegisterPass(spvtools::CreateCCPPass());
+      optimizer->RegisterPass(spvtools::CreateDeadBranchElimPass());
+      optimizer->RegisterPass(spvtools::CreateAggressiveDCEPass());
+      optimizer->RegisterPass(spvtools::CreateCFGCleanupPass());
+      optimizer->RegisterPass(spvtools::CreateDeadVariableEliminationPass());
+      optimizer->RegisterPass(
+          spvtools::CreateRemoveUnusedInterfaceVariablesPass());
+      break;
+    case PassId::kUserPasses:
+      return optimizer->RegisterPassesFromFlags(user_pass_flags);
+  }
+  return true;
+}
+
+// Returns the name under which the size after the given passes is reported.
+const char* GetPassName(PassId pass) {
+  switch (pass) {
+    case PassId::kLegalizationPasses:
+      return "legalization";
+    case PassId::kPerformancePasses:
+      return "performance";
+    case PassId::kSizePasses:
+      return "size";
+    case PassId::kFastCompilePasses:
+      return "fast-compile";
+    case PassId::kMinimumSizePasses:
+      return "minimum-size";
+#define OPTIMIZATION_PROFILE(NAME, CNAME, PASSES) \
+  case PassId::k##NAME##ProfilePasses:            \
+    return #CNAME "-profile";
+#include "libshaderc_util/optimization_profiles.inc"
+#undef OPTIMIZATION_PROFILE
+    case PassId::kNullPass:
+      return "null";
+    case PassId::kStripDebugInfo:
+      return "strip-debug-info";
+    case PassId::kStripNonSemanticInfo:
+      return "strip-non-semantic-info";
+    case PassId::kCompactIds:
+      return "compact-ids";
+    case PassId::kRemoveDuplicates:
+      return "remove-duplicates";
+    case PassId::kEliminateDeadFunctions:
+      return "eliminate-dead-functions";
+    case PassId::kRemoveUnusedInterfaceVariables:
+      return "remove-unused-interface-variables";
+    case PassId::kFoldBakedConstants:
+      return "fold-baked-constants";
+    case PassId::kUserPasses:
+      return "user-passes";
+  }
+  return "unknown";
+}
+
+// The most passes that RunCancellablePasses runs between two checks of the
+// cancellation.  Each group costs a parse of the module, so smaller groups
+// stop sooner but optimize more slowly.
+const size_t kPassesPerStep = 8;
+
+// Runs the given passes like SpirvToolsOptimize, but in groups of up to
+// kPassesPerStep, checking the cancellation before each group.  A recipe with
+// a pass that cannot be registered from its name runs in one group of its
+// own, and a cancel that arrives during it names that pass.  Only the first
+// group validates its input.
+bool RunCancellablePasses(spv_target_env target_env,
+                          const std::vector<PassId>& enabled_passes,
+                          const std::vector<std::string>& user_pass_flags,
+                          const spvtools::MessageConsumer& consumer,
+                          const Cancellation& cancellation,
+                          spvtools::OptimizerOptions& optimizer_options,
+                          std::vector<uint32_t>* binary,
+                          std::ostringstream* messages, std::string* errors) {
+  // Each step is a group of passes given by their flags, or a whole recipe,
+  // with a note that says why it was not split unless it is a single pass.
+  struct Step {
+    PassId pass;
+    std::vector<std::string> flags;
+    std::string note;
+  };
+  std::vector<Step> steps;
+  for (const auto& pass : enabled_passes) {
+    if (pass == PassId::kNullPass) continue;
+    spvtools::Optimizer recipe(target_env);
+    recipe.SetMessageConsumer(consumer);
+    if (!RegisterPasses(pass, user_pass_flags, &recipe)) {
+      *errors = messages->str();
+      return false;
+    }
+    const std::vector<const char*> names = recipe.GetPassNames();
+    std::vector<std::string> flags;
+    const char* unregistered = nullptr;
+    spvtools::Optimizer scratch(target_env);
+    for (const char* name : names) {
+      flags.push_back(std::string("--") + name);
+      if (!scratch.RegisterPassFromFlag(flags.back())) {
+        unregistered = name;
+        break;
+      }
+    }
+    if (!unregistered) {
+      for (auto& flag : flags) {
+        if (steps.empty() || steps.back().flags.empty() ||
+            steps.back().flags.size() == kPassesPerStep) {
+          steps.push_back({pass, {}, std::string()});
+        }
+        steps.back().flags.push_back(std::move(flag));
+      }
+    } else if (names.size() == 1) {
+      // A pass of shaderc's own, which is a single step anyway.
+      steps.push_back({pass, {}, std::string()});
+    } else {
+      std::string note = std::string("the ") + GetPassName(pass) +
+                         " passes ran in one step, since pass '" +
+                         unregistered + "' cannot be registered from its name";
+      *messages << "note: " << note << "\n";
+      steps.push_back({pass, {}, std::move(note)});
+    }
+  }
+
+  const Step* previous = nullptr;
+  for (const auto& step : steps) {
+    if (cancellation.IsCancelled()) {
+      *errors = cancellation.message();
+      if (previous && !previous->note.empty()) {
+        *errors += ", noticed late because " + previous->note;
+      }
+      return false;
+    }
+    spvtools::Optimizer optimizer(target_env);
+    optimizer.SetMessageConsumer(consumer);
+    if (step.flags.empty()) {
+      RegisterPasses(step.pass, user_pass_flags, &optimizer);
+    } else {
+      for (const auto& flag : step.flags) optimizer.RegisterPassFromFlag(flag);
+    }
+    if (!optimizer.Run(binary->data(), binary->size(), binary,
+                       optimizer_options)) {
+      *errors = messages->str();
+      return false;
+    }
+    optimizer_options.set_run_validator(false);
+    previous = &step;
+  }
+  return true;
+}
+
 }  // anonymous namespace
 
 bool SpirvToolsDisassemble(Compiler::TargetEnv env,
@@ -108,11 +364,170 @@ bool SpirvToolsAssemble(Compiler::TargetEnv env,
   return success;
 }
 
+bool SpirvToolsValidatePassFlags(const std::vector<std::string>& flags,
+                                 std::string* errors) {
+  errors->clear();
+  // Registering a pass is cheap and does not depend on the target
+  // environment, so a throwaway optimizer is enough to vet the flags.
+  spvtools::Optimizer optimizer(SPV_ENV_UNIVERSAL_1_0);
+  std::ostringstream oss;
+  optimizer.SetMessageConsumer(
+      [&oss](spv_message_level_t, const char*, const spv_position_t&,
+             const char* message) { oss << message; });
+
+  for (const auto& flag : flags) {
+    if (!optimizer.FlagHasValidForm(flag)) {
+      *errors = "invalid optimizer flag '" + flag +
+                "': flags must start with '-O' or '--'";
+      return false;
+    }
+    if (!optimizer.RegisterPassFromFlag(flag)) {
+      *errors = "unknown optimizer flag '" + flag + "'";
+      const std::string details = oss.str();
+      if (!details.empty()) *errors += ": " + details;
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<std::string> SpirvToolsGetPassFlags(PassId pass) {
+  std::vector<std::string> flags;
+  spvtools::Optimizer optimizer(SPV_ENV_UNIVERSAL_1_0);
+  if (!RegisterPasses(pass, {}, &optimizer)) return flags;
+  // Pass names are spelled like the flags that create them, with arguments,
+  // as in "scalar-replacement=100".
+  for (const char* name : optimizer.GetPassNames()) {
+    flags.push_back(std::string("--") + name);
+  }
+  return flags;
+}
+
+std::vector<std::string> ParseSpirvOptPassList(const string_piece& text) {
+  std::vector<std::string> flags;
+  std::string flag;
+  bool in_comment = false;
+  for (const char c : text) {
+    if (c == '\n') in_comment = false;
+    if (c == '#') in_comment = true;
+    if (in_comment || std::isspace(static_cast<unsigned char>(c))) {
+      if (!flag.empty()) flags.push_back(std::move(flag));
+      flag.clear();
+    } else {
+      flag.push_back(c);
+    }
+  }
+  if (!flag.empty()) flags.push_back(std::move(flag));
+  return flags;
+}
+
+bool SpirvToolsLink(Compiler::TargetEnv env,
+                    Compiler::TargetEnvVersion version,
+                    const std::vector<std::vector<uint32_t>>& modules,
+                    std::vector<uint32_t>* linked, std::string* errors) {
+  errors->clear();
+  spvtools::Context context(GetSpirvToolsTargetEnv(env, version));
+  std::ostringstream oss;
+  context.SetMessageConsumer(
+      [&oss](spv_message_level_t, const char*, const spv_position_t&,
+             const char* message) { oss << message << "\n"; });
+  if (spvtools::Link(context, modules, linked) != SPV_SUCCESS) {
+    *errors = oss.str();
+    return false;
+  }
+  return true;
+}
+
+bool SpirvToolsAnalyzeLiveInputs(Compiler::TargetEnv env,
+                                 Compiler::TargetEnvVersion version,
+                                 const std::vector<uint32_t>& binary,
+                                 std::unordered_set<uint32_t>* live_locations,
+                                 std::unordered_set<uint32_t>* live_builtins,
+                                 std::string* errors) {
+  // The analysis does not change the module, so run it on a scratch copy.
+  std::vector<uint32_t> scratch(binary);
+  return RunPasses(
+      env, version,
+      [live_locations, live_builtins](spvtools::Optimizer* optimizer) {
+        optimizer->RegisterPass(spvtools::CreateAnalyzeLiveInputPass(
+            live_locations, live_builtins));
+      },
+      &scratch, errors);
+}
+
+bool SpirvToolsEliminateDeadOutputs(
+    Compiler::TargetEnv env, Compiler::TargetEnvVersion version,
+    const std::unordered_set<uint32_t>& live_locations,
+    const std::unordered_set<uint32_t>& live_builtins,
+    std::vector<uint32_t>* binary, std::string* errors) {
+  // The pass takes mutable sets, though it only reads them.
+  std::unordered_set<uint32_t> locations(live_locations);
+  std::unordered_set<uint32_t> builtins(live_builtins);
+  return RunPasses(
+      env, version,
+      [&locations, &builtins](spvtools::Optimizer* optimizer) {
+        optimizer->RegisterPass(spvtools::CreateEliminateDeadOutputStoresPass(
+            &locations, &builtins));
+        optimizer->RegisterPass(spvtools::CreateAggressiveDCEPass());
+        optimizer->RegisterPass(
+            spvtools::CreateRemoveUnusedInterfaceVariablesPass());
+        optimizer->RegisterPass(spvtools::CreateDeadVariableEliminationPass());
+      },
+      binary, errors);
+}
+
+bool SpirvToolsSpecialize(
+    Compiler::TargetEnv env, Compiler::TargetEnvVersion version,
+    const std::unordered_map<uint32_t, std::string>& values,
+    std::vector<uint32_t>* binary, std::string* errors) {
+  const bool success = RunPasses(
+      env, version,
+      [&values](spvtools::Optimizer* optimizer) {
+        optimizer->RegisterPass(
+            spvtools::CreateSetSpecConstantDefaultValuePass(values));
+        optimizer->RegisterPass(spvtools::CreateFreezeSpecConstantValuePass());
+        optimizer->RegisterPass(
+            spvtools::CreateFoldSpecConstantOpAndCompositePass());
+        optimizer->RegisterPass(spvtools::CreateUnifyConstantPass());
+        // Conditions computed from the frozen values are folded, so that
+        // the branches they rule out can be removed.
+        optimizer->RegisterPass(spvtools::CreateSimplificationPass());
+        optimizer->RegisterPass(spvtools::CreateDeadBranchElimPass());
+        optimizer->RegisterPass(spvtools::CreateAggressiveDCEPass());
+        optimizer->RegisterPass(spvtools::CreateCFGCleanupPass());
+      },
+      binary, errors, true);
+  if (!success && errors->empty()) {
+    *errors = "invalid specialization constant value";
+  }
+  return success;
+}
+
+bool SpirvToolsValidate(Compiler::TargetEnv env,
+                        Compiler::TargetEnvVersion version,
+                        const std::vector<uint32_t>& binary,
+                        std::string* errors) {
+  errors->clear();
+  spvtools::SpirvTools tools(GetSpirvToolsTargetEnv(env, version));
+  std::ostringstream oss;
+  tools.SetMessageConsumer(
+      [&oss](spv_message_level_t, const char*, const spv_position_t&,
+             const char* message) { oss << message << "\n"; });
+  if (!tools.Validate(binary.data(), binary.size(), GetValidatorOptions())) {
+    *errors = oss.str();
+    return false;
+  }
+  return true;
+}
+
 bool SpirvToolsOptimize(Compiler::TargetEnv env,
                         Compiler::TargetEnvVersion version,
                         const std::vector<PassId>& enabled_passes,
+                        const std::vector<std::string>& user_pass_flags,
                         spvtools::OptimizerOptions& optimizer_options,
-                        std::vector<uint32_t>* binary, std::string* errors) {
+                        std::vector<uint32_t>* binary, std::string* errors,
+                        std::vector<OptimizationStage>* stages,
+                        const Cancellation* cancellation) {
   errors->clear();
   if (enabled_passes.empty()) return true;
   if (std::all_of(
@@ -121,58 +536,111 @@ bool SpirvToolsOptimize(Compiler::TargetEnv env,
     return true;
   }
 
-  spvtools::ValidatorOptions val_opts;
-  // This allows flexible memory layout for HLSL.
-  val_opts.SetSkipBlockLayout(true);
-  // This allows HLSL legalization regarding resources.
-  val_opts.SetRelaxLogicalPointer(true);
-  // This uses relaxed rules for pre-legalized HLSL.
-  val_opts.SetBeforeHlslLegalization(true);
-  // Don't use friendly names when printing validation errors.
-  // It incurs a high startup cost whether or not there is an
-  // error. Validation failures are compiler bugs, and so they
-  // should be rare anyway.
-  val_opts.SetFriendlyNames(false);
-
-  // Set additional optimizer options.
-  optimizer_options.set_validator_options(val_opts);
-  optimizer_options.set_run_validator(true);
-
-  spvtools::Optimizer optimizer(GetSpirvToolsTargetEnv(env, version));
+  // Set additional optimizer options.  The fast-compile recipe skips the
+  // validator: its input comes straight from our own front end, or has been
+  // validated already by whoever supplied it, and on small shaders
+  // validation can cost as much as the passes themselves.  User passes may
+  // not expect invalid input, so with them the input is still validated.
+  const auto has_pass = [&enabled_passes](PassId id) {
+    return std::find(enabled_passes.cbegin(), enabled_passes.cend(), id) !=
+           enabled_passes.cend();
+  };
+  optimizer_options.set_validator_options(GetValidatorOptions());
+  optimizer_options.set_run_validator(
+      !has_pass(PassId::kFastCompilePasses) ||
+      has_pass(PassId::kUserPasses));
 
+  const spv_target_env target_env = GetSpirvToolsTargetEnv(env, version);
   std::ostringstream oss;
-  optimizer.SetMessageConsumer(
+  const spvtools::MessageConsumer consumer =
       [&oss](spv_message_level_t, const char*, const spv_position_t&,
-             const char* message) { oss << message << "\n"; });
+             const char* message) { oss << message << "\n"; };
 
+  if (std::none_of(enabled_passes.cbegin(), enabled_passes.cend(),
+                   [](const PassId& pass) {
+                     return pass == PassId::kMinimumSizePasses;
+                   })) {
+    if (cancellation && cancellation->is_active()) {
+      return RunCancellablePasses(target_env, enabled_passes, user_pass_flags,
+                                  consumer, *cancellation, optimizer_options,
+                                  binary, &oss, errors);
+    }
+    spvtools::Optimizer optimizer(target_env);
+    optimizer.SetMessageConsumer(consumer);
+    for (const auto& pass : enabled_passes) {
+      if (!RegisterPasses(pass, user_pass_flags, &optimizer)) {
+        *errors = oss.str();
+        return false;
+      }
+    }
+    if (!optimizer.Run(binary->data(), binary->size(), binary,
+                       optimizer_options)) {
+      *errors = oss.str();
+      return false;
+    }
+    return true;
+  }
+
+  // Each pass runs on its own, so that the size of the module after it is
+  // known.  Every run validates its input, which is the output of the run
+  // before, and the final output is validated at the end.
+  std::vector<OptimizationStage> sizes(
+      1, {"input", binary->size() * sizeof(uint32_t)});
+  auto run_stage = [&](const char* name, const std::vector<PassId>& passes,
+                       std::vector<uint32_t>* module) {
+    if (cancellation && cancellation->IsCancelled()) {
+      oss << cancellation->message() << "\n";
+      return false;
+    }
+    spvtools::Optimizer optimizer(target_env);
+    optimizer.SetMessageConsumer(consumer);
+    for (const auto& pass : passes) {
+      if (!RegisterPasses(pass, user_pass_flags, &optimizer)) return false;
+    }
+    if (!optimizer.Run(module->data(), module->size(), module,
+                       optimizer_options)) {
+      return false;
+    }
+    sizes.push_back({name, module->size() * sizeof(uint32_t)});
+    return true;
+  };
   for (const auto& pass : enabled_passes) {
-    switch (pass) {
-      case PassId::kLegalizationPasses:
-        optimizer.RegisterLegalizationPasses();
-        break;
-      case PassId::kPerformancePasses:
-        optimizer.RegisterPerformancePasses();
-        break;
-      case PassId::kSizePasses:
-        optimizer.RegisterSizePasses();
-        break;
-      case PassId::kNullPass:
-        // We actually don't need to do anything for null pass.
-        break;
-      case PassId::kStripDebugInfo:
-        optimizer.RegisterPass(spvtools::CreateStripDebugInfoPass());
-        break;
-      case PassId::kCompactIds:
-        optimizer.RegisterPass(spvtools::CreateCompactIdsPass());
-        break;
+    bool success = true;
+    if (pass == PassId::kNullPass) continue;
+    if (pass != PassId::kMinimumSizePasses) {
+      success = run_stage(GetPassName(pass), {pass}, binary);
+    } else {
+      success =
+          run_stage("size", {PassId::kSizePasses}, binary) &&
+          run_stage("remove-duplicates", {PassId::kRemoveDuplicates},
+                    binary) &&
+          run_stage("compact-ids", {PassId::kCompactIds}, binary);
+      // Merging duplicates can give the size passes more to do.
+      std::vector<uint32_t> again(*binary);
+      success = success && run_stage("recompaction",
+                                     {PassId::kSizePasses,
+                                      PassId::kRemoveDuplicates,
+                                      PassId::kCompactIds},
+                                     &again);
+      if (success) {
+        if (again.size() < binary->size()) {
+          binary->swap(again);
+        } else {
+          sizes.back().size_in_bytes = binary->size() * sizeof(uint32_t);
+        }
+      }
+    }
+    if (!success) {
+      *errors = oss.str();
+      return false;
     }
   }
 
-  if (!optimizer.Run(binary->data(), binary->size(), binary,
-                     optimizer_options)) {
-    *errors = oss.str();
+  if (!SpirvToolsValidate(env, version, *binary, errors)) {
+    *errors = "the optimized module is invalid: " + *errors;
     return false;
   }
+  if (stages) stages->insert(stages->end(), sizes.begin(), sizes.end());
   return true;
 }
 
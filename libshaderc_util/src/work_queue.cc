@@ -0,0 +1,133 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/work_queue.h"
+
+#include <algorithm>
+
+namespace shaderc_util {
+
+PriorityWorkQueue::PriorityWorkQueue(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::thread::hardware_concurrency();
+    if (num_threads == 0) num_threads = 1;
+  }
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+PriorityWorkQueue::~PriorityWorkQueue() {
+  std::vector<std::pair<uint64_t, Job>> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+    for (const auto& entry : order_) {
+      cancelled.emplace_back(entry.second,
+                             std::move(pending_[entry.second].job));
+    }
+    order_.clear();
+    pending_.clear();
+  }
+  work_available_.notify_all();
+  for (auto& job : cancelled) job.second(job.first, true);
+  for (auto& worker : workers_) worker.join();
+}
+
+uint64_t PriorityWorkQueue::Push(int priority, Job job) {
+  uint64_t id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    id = next_id_++;
+    order_.emplace(priority, id);
+    pending_.emplace(id, PendingJob{priority, std::move(job)});
+  }
+  work_available_.notify_one();
+  return id;
+}
+
+bool PriorityWorkQueue::SetPriority(uint64_t id, int priority) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = pending_.find(id);
+  if (it == pending_.end()) return false;
+  order_.erase({it->second.priority, id});
+  order_.emplace(priority, id);
+  it->second.priority = priority;
+  return true;
+}
+
+bool PriorityWorkQueue::Cancel(uint64_t id) {
+  Job job;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(id);
+    if (it == pending_.end()) return false;
+    order_.erase({it->second.priority, id});
+    job = std::move(it->second.job);
+    pending_.erase(it);
+    if (order_.empty() && num_running_ == 0) idle_.notify_all();
+  }
+  job(id, true);
+  return true;
+}
+
+void PriorityWorkQueue::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]() { return order_.empty() && num_running_ == 0; });
+}
+
+void PriorityWorkQueue::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    work_available_.wait(
+        lock, [this]() { return shutting_down_ || !order_.empty(); });
+    // The destructor empties the queue when it sets shutting_down_.
+    if (order_.empty()) return;
+
+    const uint64_t id = order_.begin()->second;
+    order_.erase(order_.begin());
+    auto it = pending_.find(id);
+    Job job = std::move(it->second.job);
+    pending_.erase(it);
+    ++num_running_;
+
+    lock.unlock();
+    job(id, false);
+    // Destroy whatever the job captured before reporting it as finished.
+    job = nullptr;
+    lock.lock();
+
+    --num_running_;
+    if (order_.empty() && num_running_ == 0) idle_.notify_all();
+  }
+}
+
+void RunInParallel(size_t count, const std::function<void(size_t)>& job) {
+  if (count <= 1) {
+    // Not worth a thread.
+    if (count == 1) job(0);
+    return;
+  }
+  PriorityWorkQueue queue(
+      std::min<size_t>(count, std::thread::hardware_concurrency()));
+  for (size_t i = 0; i < count; ++i) {
+    queue.Push(0, [&job, i](uint64_t, bool cancelled) {
+      if (!cancelled) job(i);
+    });
+  }
+  queue.WaitIdle();
+}
+
+}  // namespace shaderc_util
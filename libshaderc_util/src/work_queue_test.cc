@@ -0,0 +1,172 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshaderc_util/work_queue.h"
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using shaderc_util::PriorityWorkQueue;
+using testing::ElementsAre;
+
+#ifndef SHADERC_DISABLE_THREADED_TESTS
+
+// Keeps the only worker of a queue busy until Release() is called, so that
+// the order of the jobs queued behind it is fully determined.
+class Gate {
+ public:
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return open_; });
+  }
+  void Release() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      open_ = true;
+    }
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool open_ = false;
+};
+
+// Records the order in which jobs ran or were cancelled.
+class Log {
+ public:
+  PriorityWorkQueue::Job Record(int value) {
+    return [this, value](uint64_t, bool cancelled) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      (cancelled ? cancelled_ : ran_).push_back(value);
+    };
+  }
+  std::vector<int> ran() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ran_;
+  }
+  std::vector<int> cancelled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cancelled_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<int> ran_;
+  std::vector<int> cancelled_;
+};
+
+TEST(PriorityWorkQueueTest, RunsHigherPriorityFirstThenFifo) {
+  PriorityWorkQueue queue(1);
+  Gate gate;
+  Log log;
+  queue.Push(0, [&gate](uint64_t, bool) { gate.Wait(); });
+  queue.Push(1, log.Record(1));
+  queue.Push(5, log.Record(2));
+  queue.Push(1, log.Record(3));
+  queue.Push(-3, log.Record(4));
+  gate.Release();
+  queue.WaitIdle();
+  EXPECT_THAT(log.ran(), ElementsAre(2, 1, 3, 4));
+  EXPECT_THAT(log.cancelled(), ElementsAre());
+}
+
+TEST(PriorityWorkQueueTest, SetPriorityReordersPendingJobs) {
+  PriorityWorkQueue queue(1);
+  Gate gate;
+  Log log;
+  queue.Push(0, [&gate](uint64_t, bool) { gate.Wait(); });
+  queue.Push(1, log.Record(1));
+  const uint64_t second = queue.Push(1, log.Record(2));
+  EXPECT_TRUE(queue.SetPriority(second, 10));
+  gate.Release();
+  queue.WaitIdle();
+  EXPECT_THAT(log.ran(), ElementsAre(2, 1));
+  // The job has run, so it can no longer be changed.
+  EXPECT_FALSE(queue.SetPriority(second, 0));
+}
+
+TEST(PriorityWorkQueueTest, CancelCallsJobOnceWithCancelled) {
+  PriorityWorkQueue queue(1);
+  Gate gate;
+  Log log;
+  const uint64_t blocker =
+      queue.Push(0, [&gate](uint64_t, bool) { gate.Wait(); });
+  queue.Push(0, log.Record(1));
+  const uint64_t second = queue.Push(0, log.Record(2));
+  EXPECT_TRUE(queue.Cancel(second));
+  EXPECT_FALSE(queue.Cancel(second));
+  EXPECT_THAT(log.cancelled(), ElementsAre(2));
+  gate.Release();
+  queue.WaitIdle();
+  EXPECT_THAT(log.ran(), ElementsAre(1));
+  // A job that already ran cannot be cancelled.
+  EXPECT_FALSE(queue.Cancel(blocker));
+}
+
+TEST(PriorityWorkQueueTest, DestructorCancelsPendingJobs) {
+  Gate gate;
+  Log log;
+  {
+    PriorityWorkQueue queue(1);
+    std::atomic<bool> started(false);
+    queue.Push(0, [&gate, &started](uint64_t, bool) {
+      started = true;
+      gate.Wait();
+    });
+    queue.Push(0, log.Record(1));
+    queue.Push(0, log.Record(2));
+    while (!started) std::this_thread::yield();
+    gate.Release();
+  }
+  // Depending on timing, the worker may or may not have picked up more jobs
+  // before shutdown, but every job is accounted for exactly once.
+  std::vector<int> all = log.ran();
+  const std::vector<int> cancelled = log.cancelled();
+  all.insert(all.end(), cancelled.begin(), cancelled.end());
+  std::sort(all.begin(), all.end());
+  EXPECT_THAT(all, ElementsAre(1, 2));
+}
+
+TEST(PriorityWorkQueueTest, RunsJobsConcurrently) {
+  PriorityWorkQueue queue(4);
+  std::atomic<int> count(0);
+  for (int i = 0; i < 1000; ++i) {
+    queue.Push(i % 7, [&count](uint64_t, bool cancelled) {
+      if (!cancelled) ++count;
+    });
+  }
+  queue.WaitIdle();
+  EXPECT_EQ(1000, count.load());
+}
+
+#endif  // SHADERC_DISABLE_THREADED_TESTS
+
+TEST(PriorityWorkQueueTest, UnknownIdIsRejected) {
+  PriorityWorkQueue queue(1);
+  EXPECT_FALSE(queue.Cancel(12345));
+  EXPECT_FALSE(queue.SetPriority(12345, 1));
+  queue.WaitIdle();
+}
+
+}  // anonymous namespace
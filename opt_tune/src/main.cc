@@ -0,0 +1,230 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "libshaderc_util/args.h"
+#include "libshaderc_util/compiler.h"
+#include "libshaderc_util/io_shaderc.h"
+#include "libshaderc_util/spirv_tools_wrapper.h"
+#include "libshaderc_util/string_piece.h"
+#include "tuner.h"
+
+using shaderc_util::Compiler;
+using shaderc_util::PassId;
+using shaderc_util::string_piece;
+
+namespace {
+
+// Prints the help message.
+void PrintHelp(std::ostream* out) {
+  *out << R"(shaderc_opt_tune - Search for the optimizer pass list that works
+best on a corpus of shaders.
+
+Usage: shaderc_opt_tune [options] <module.spv>...
+
+The modules are unoptimized SPIR-V binaries, such as those produced by
+'glslc -c -O0'.  The search starts from the passes of -O and -Os, and keeps
+changing the best pass list found so far.  The result is a pass-list file
+for glslc -Xspirv-opt-file, or shaderc_compile_options_set_optimizer_pass_list.
+
+Options:
+  --budget=<n>      Evaluate at most <n> pass lists.  The default is 200.
+  --cost=<cost>     What to minimize, summed over the corpus.  Values are:
+                        size            # Module size in bytes, the default
+                        instructions    # Instructions in function bodies
+                        time            # Time spent optimizing
+  -h, --help        Display this help.
+  --jobs=<n>        Use <n> threads.  The default is one per hardware
+                    thread.
+  -o <file>         Write the pass list to <file>.  The default is '-',
+                    standard output.
+  --seed=<n>        Seed the random choices of the search with <n>, to
+                    repeat a run.  The default is 1.
+  --start=<file>    Also start from the pass list in <file>, such as the
+                    result of an earlier run.
+  --target-env=<environment>
+                    The target environment of the modules.  Values are
+                    vulkan1.0, the default, vulkan1.1, vulkan1.2,
+                    vulkan1.3, vulkan1.4 and opengl4.5.
+)";
+}
+
+// Parses the numeric argument of the given option.  Returns false, after
+// printing an error, if it is not a number.
+bool ParseNumber(const string_piece& arg, const char* option,
+                 uint32_t* value) {
+  if (!shaderc_util::ParseUint32(arg.substr(std::strlen(option)).str(),
+                                 value)) {
+    std::cerr << "shaderc_opt_tune: error: invalid value '"
+              << arg.substr(std::strlen(option)) << "' in '" << arg << "'"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Reads a SPIR-V binary module from the given file into *module.  Returns
+// false, after printing an error, if it cannot be read or is not a module.
+bool ReadModule(const std::string& file_name, std::vector<uint32_t>* module) {
+  std::vector<char> data;
+  if (!shaderc_util::ReadFile(file_name, &data)) return false;
+  const uint32_t kMagicNumber = 0x07230203;
+  if (data.size() < 5 * sizeof(uint32_t) ||
+      data.size() % sizeof(uint32_t) != 0) {
+    std::cerr << "shaderc_opt_tune: error: " << file_name
+              << ": not a SPIR-V binary module" << std::endl;
+    return false;
+  }
+  module->resize(data.size() / sizeof(uint32_t));
+  std::memcpy(module->data(), data.data(), data.size());
+  if ((*module)[0] != kMagicNumber) {
+    std::cerr << "shaderc_opt_tune: error: " << file_name
+              << ": not a SPIR-V binary module" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::string> input_files;
+  std::string output_file = "-";
+  std::string start_file;
+  uint32_t budget = 200;
+  uint32_t num_threads = 0;
+  uint32_t random_seed = 1;
+  opt_tune::CostFunction cost_function = opt_tune::CostFunction::Size;
+  Compiler::TargetEnv env = Compiler::TargetEnv::Vulkan;
+  Compiler::TargetEnvVersion version = Compiler::TargetEnvVersion::Vulkan_1_0;
+
+  for (int i = 1; i < argc; ++i) {
+    const string_piece arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      PrintHelp(&std::cout);
+      return 0;
+    } else if (arg.starts_with("--budget=")) {
+      if (!ParseNumber(arg, "--budget=", &budget)) return 1;
+    } else if (arg.starts_with("--cost=")) {
+      if (!opt_tune::ParseCostFunction(arg.substr(std::strlen("--cost=")),
+                                       &cost_function)) {
+        std::cerr << "shaderc_opt_tune: error: invalid value '"
+                  << arg.substr(std::strlen("--cost=")) << "' in '" << arg
+                  << "'" << std::endl;
+        return 1;
+      }
+    } else if (arg.starts_with("--jobs=")) {
+      if (!ParseNumber(arg, "--jobs=", &num_threads)) return 1;
+    } else if (arg.starts_with("-o")) {
+      string_piece file_name;
+      if (!shaderc_util::GetOptionArgument(argc, argv, &i, "-o",
+                                           &file_name)) {
+        std::cerr << "shaderc_opt_tune: error: argument to '-o' is missing"
+                  << std::endl;
+        return 1;
+      }
+      output_file = file_name.str();
+    } else if (arg.starts_with("--seed=")) {
+      if (!ParseNumber(arg, "--seed=", &random_seed)) return 1;
+    } else if (arg.starts_with("--start=")) {
+      start_file = arg.substr(std::strlen("--start=")).str();
+    } else if (arg.starts_with("--target-env=")) {
+      const string_piece name = arg.substr(std::strlen("--target-env="));
+      if (name == "vulkan1.0") {
+        version = Compiler::TargetEnvVersion::Vulkan_1_0;
+      } else if (name == "vulkan1.1") {
+        version = Compiler::TargetEnvVersion::Vulkan_1_1;
+      } else if (name == "vulkan1.2") {
+        version = Compiler::TargetEnvVersion::Vulkan_1_2;
+      } else if (name == "vulkan1.3") {
+        version = Compiler::TargetEnvVersion::Vulkan_1_3;
+      } else if (name == "vulkan1.4") {
+        version = Compiler::TargetEnvVersion::Vulkan_1_4;
+      } else if (name == "opengl4.5") {
+        env = Compiler::TargetEnv::OpenGL;
+        version = Compiler::TargetEnvVersion::OpenGL_4_5;
+      } else {
+        std::cerr << "shaderc_opt_tune: error: invalid value '" << name
+                  << "' in '" << arg << "'" << std::endl;
+        return 1;
+      }
+    } else if (arg.starts_with("-") && arg != "-") {
+      std::cerr << "shaderc_opt_tune: error: unknown argument: '" << arg
+                << "'" << std::endl;
+      return 1;
+    } else {
+      input_files.push_back(arg.str());
+    }
+  }
+
+  if (input_files.empty()) {
+    std::cerr << "shaderc_opt_tune: error: no input files" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::vector<uint32_t>> corpus(input_files.size());
+  std::string errors;
+  for (size_t i = 0; i < input_files.size(); ++i) {
+    if (!ReadModule(input_files[i], &corpus[i])) return 1;
+    // A bad module would make every pass list fail.
+    if (!shaderc_util::SpirvToolsValidate(env, version, corpus[i], &errors)) {
+      std::cerr << "shaderc_opt_tune: error: " << input_files[i]
+                << ": invalid module: " << errors;
+      return 1;
+    }
+  }
+
+  std::vector<std::vector<std::string>> seeds = {
+      shaderc_util::SpirvToolsGetPassFlags(PassId::kPerformancePasses),
+      shaderc_util::SpirvToolsGetPassFlags(PassId::kSizePasses),
+  };
+  if (!start_file.empty()) {
+    std::vector<char> text;
+    if (!shaderc_util::ReadFile(start_file, &text)) return 1;
+    seeds.push_back(shaderc_util::ParseSpirvOptPassList(
+        string_piece(text.data(), text.data() + text.size())));
+  }
+  for (const auto& seed : seeds) {
+    if (!shaderc_util::SpirvToolsValidatePassFlags(seed, &errors)) {
+      std::cerr << "shaderc_opt_tune: error: " << errors << std::endl;
+      return 1;
+    }
+  }
+
+  const opt_tune::Tuner tuner(env, version, std::move(corpus), cost_function,
+                              num_threads);
+  opt_tune::Candidate start;
+  const opt_tune::Candidate best =
+      tuner.Tune(seeds, budget, random_seed, &std::cerr, &start);
+  if (best.cost == std::numeric_limits<double>::infinity()) {
+    std::cerr << "shaderc_opt_tune: error: no starting pass list can "
+                 "optimize every module"
+              << std::endl;
+    return 1;
+  }
+
+  std::ofstream file;
+  std::ostream* output =
+      shaderc_util::GetOutputStream(output_file, &file, &std::cerr);
+  if (!output) return 1;
+  *output << opt_tune::FormatPassList(best, start, cost_function,
+                                      input_files.size());
+  return output->good() ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+#include "libshaderc_util/spirv_tools_wrapper.h"
+#include "libshaderc_util/work_queue.h"
+
+namespace opt_tune {
+
+namespace {
+
+// Opcodes that delimit the functions of a module.
+const uint32_t kOpFunction = 54;
+const uint32_t kOpFunctionEnd = 56;
+
+// The number of words in the header of a SPIR-V module.
+const size_t kHeaderWords = 5;
+
+const double kInfiniteCost = std::numeric_limits<double>::infinity();
+
+// Returns a random index into a container of the given size, which must not
+// be zero.
+size_t RandomIndex(size_t size, std::mt19937* random) {
+  return std::uniform_int_distribution<size_t>(0, size - 1)(*random);
+}
+
+}  // anonymous namespace
+
+bool ParseCostFunction(const shaderc_util::string_piece& name,
+                       CostFunction* cost_function) {
+  if (name == "size") {
+    *cost_function = CostFunction::Size;
+  } else if (name == "instructions") {
+    *cost_function = CostFunction::Instructions;
+  } else if (name == "time") {
+    *cost_function = CostFunction::CompileTime;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char* GetCostFunctionName(CostFunction cost_function) {
+  switch (cost_function) {
+    case CostFunction::Size:
+      return "size";
+    case CostFunction::Instructions:
+      return "instructions";
+    case CostFunction::CompileTime:
+      return "time";
+  }
+  return "unknown";
+}
+
+uint64_t CountFunctionInstructions(const std::vector<uint32_t>& module) {
+  uint64_t count = 0;
+  bool in_function = false;
+  for (size_t at = kHeaderWords; at < module.size();) {
+    const uint32_t word_count = module[at] >> 16;
+    const uint32_t opcode = module[at] & 0xffff;
+    if (word_count == 0) break;
+    if (opcode == kOpFunction) {
+      in_function = true;
+    } else if (opcode == kOpFunctionEnd) {
+      in_function = false;
+    } else if (in_function) {
+      ++count;
+    }
+    at += word_count;
+  }
+  return count;
+}
+
+std::vector<std::string> Mutate(const std::vector<std::string>& flags,
+                                const std::vector<std::string>& pool,
+                                std::mt19937* random) {
+  std::vector<std::string> result(flags);
+  const std::vector<std::string>& choices = pool.empty() ? flags : pool;
+  if (choices.empty()) return result;
+  if (result.empty()) {
+    result.push_back(choices[RandomIndex(choices.size(), random)]);
+    return result;
+  }
+  const size_t at = RandomIndex(result.size(), random);
+  switch (RandomIndex(5, random)) {
+    case 0:
+      if (result.size() > 1) {
+        result.erase(result.begin() + at);
+        break;
+      }
+      [[fallthrough]];
+    case 1:
+      result.insert(result.begin() + RandomIndex(result.size() + 1, random),
+                    result[at]);
+      break;
+    case 2: {
+      std::string flag = std::move(result[at]);
+      result.erase(result.begin() + at);
+      result.insert(result.begin() + RandomIndex(result.size() + 1, random),
+                    std::move(flag));
+      break;
+    }
+    case 3:
+      result[at] = choices[RandomIndex(choices.size(), random)];
+      break;
+    case 4: {
+      std::vector<size_t> numeric;
+      for (size_t i = 0; i < result.size(); ++i) {
+        const size_t equals = result[i].find('=');
+        if (equals != std::string::npos &&
+            std::all_of(result[i].begin() + equals + 1, result[i].end(),
+                        [](char c) { return c >= '0' && c <= '9'; })) {
+          numeric.push_back(i);
+        }
+      }
+      if (numeric.empty()) {
+        result.insert(result.begin() + at,
+                      choices[RandomIndex(choices.size(), random)]);
+        break;
+      }
+      std::string& flag = result[numeric[RandomIndex(numeric.size(), random)]];
+      const size_t equals = flag.find('=');
+      uint64_t value = 0;
+      std::istringstream(flag.substr(equals + 1)) >> value;
+      if (value == 0 || RandomIndex(2, random) == 0) {
+        value = value * 2 + (value == 0);
+      } else {
+        value /= 2;
+      }
+      flag = flag.substr(0, equals + 1) + std::to_string(value);
+      break;
+    }
+  }
+  return result;
+}
+
+bool Tuner::CostOf(const std::vector<std::string>& flags,
+                   const std::vector<uint32_t>& module, double* cost) const {
+  std::vector<uint32_t> binary(module);
+  std::string errors;
+  spvtools::OptimizerOptions options;
+  const auto start = std::chrono::steady_clock::now();
+  if (!shaderc_util::SpirvToolsOptimize(
+          env_, version_, {shaderc_util::PassId::kUserPasses}, flags, options,
+          &binary, &errors)) {
+    return false;
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  if (!shaderc_util::SpirvToolsValidate(env_, version_, binary, &errors)) {
+    return false;
+  }
+  switch (cost_function_) {
+    case CostFunction::Size:
+      *cost = static_cast<double>(binary.size() * sizeof(uint32_t));
+      break;
+    case CostFunction::Instructions:
+      *cost = static_cast<double>(CountFunctionInstructions(binary));
+      break;
+    case CostFunction::CompileTime:
+      *cost = static_cast<double>(
+          std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+              .count());
+      break;
+  }
+  return true;
+}
+
+void Tuner::Evaluate(const std::vector<std::vector<std::string>>& pipelines,
+                     std::vector<double>* costs) const {
+  // One job per pipeline and module, so that a small batch of pipelines still
+  // keeps every thread busy on a large corpus.
+  std::vector<double> module_costs(pipelines.size() * corpus_.size(),
+                                   kInfiniteCost);
+  {
+    shaderc_util::PriorityWorkQueue queue(num_threads_);
+    for (size_t p = 0; p < pipelines.size(); ++p) {
+      for (size_t m = 0; m < corpus_.size(); ++m) {
+        double* cost = &module_costs[p * corpus_.size() + m];
+        queue.Push(0, [this, &pipelines, p, m, cost](uint64_t, bool cancelled) {
+          if (!cancelled && !CostOf(pipelines[p], corpus_[m], cost)) {
+            *cost = kInfiniteCost;
+          }
+        });
+      }
+    }
+    queue.WaitIdle();
+  }
+  costs->assign(pipelines.size(), 0);
+  for (size_t p = 0; p < pipelines.size(); ++p) {
+    for (size_t m = 0; m < corpus_.size(); ++m) {
+      (*costs)[p] += module_costs[p * corpus_.size() + m];
+    }
+  }
+}
+
+Candidate Tuner::Tune(const std::vector<std::vector<std::string>>& seeds,
+                      size_t budget, uint32_t random_seed,
+                      std::ostream* log, Candidate* start) const {
+  std::vector<double> costs;
+  Evaluate(seeds, &costs);
+  Candidate best;
+  best.cost = kInfiniteCost;
+  for (size_t i = 0; i < seeds.size(); ++i) {
+    if (costs[i] < best.cost) best = {seeds[i], costs[i]};
+  }
+  *start = best;
+  if (best.cost == kInfiniteCost) return best;
+  *log << "start: " << best.cost << "\n";
+
+  std::vector<std::string> pool;
+  for (const auto& seed : seeds) {
+    for (const auto& flag : seed) {
+      if (std::find(pool.begin(), pool.end(), flag) == pool.end()) {
+        pool.push_back(flag);
+      }
+    }
+  }
+
+  std::mt19937 random(random_seed);
+  const size_t batch_size = std::max<size_t>(
+      1, num_threads_ ? num_threads_ : std::thread::hardware_concurrency());
+  size_t evaluated = seeds.size();
+  while (evaluated < budget) {
+    std::vector<std::vector<std::string>> batch;
+    while (batch.size() < batch_size && evaluated + batch.size() < budget) {
+      batch.push_back(Mutate(best.flags, pool, &random));
+    }
+    Evaluate(batch, &costs);
+    evaluated += batch.size();
+    const size_t cheapest =
+        std::min_element(costs.begin(), costs.end()) - costs.begin();
+    if (costs[cheapest] <= best.cost) {
+      if (costs[cheapest] < best.cost) {
+        *log << evaluated << ": " << costs[cheapest] << "\n";
+      }
+      best = {std::move(batch[cheapest]), costs[cheapest]};
+    }
+  }
+  return best;
+}
+
+std::string FormatPassList(const Candidate& best, const Candidate& start,
+                           CostFunction cost_function, size_t corpus_size) {
+  std::ostringstream text;
+  text << "# Tuned by shaderc_opt_tune over " << corpus_size << " module"
+       << (corpus_size == 1 ? "" : "s") << ".\n"
+       << "# Cost (" << GetCostFunctionName(cost_function)
+       << "): " << best.cost << ", against " << start.cost
+       << " for the best starting pipeline.\n";
+  for (const auto& flag : best.flags) text << flag << "\n";
+  return text.str();
+}
+
+}  // namespace opt_tune
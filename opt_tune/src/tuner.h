@@ -0,0 +1,120 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OPT_TUNE_TUNER_H
+#define OPT_TUNE_TUNER_H
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libshaderc_util/compiler.h"
+#include "libshaderc_util/string_piece.h"
+
+namespace opt_tune {
+
+// What the tuner minimizes, summed over the corpus.
+enum class CostFunction {
+  Size,          // Bytes of the optimized modules.
+  Instructions,  // Instructions in the function bodies of the optimized
+                 // modules.
+  CompileTime,   // Microseconds spent optimizing.
+};
+
+// Parses a cost function name: "size", "instructions" or "time".  Returns
+// false if the name is unknown.
+bool ParseCostFunction(const shaderc_util::string_piece& name,
+                       CostFunction* cost_function);
+
+// Returns the name of the given cost function, as accepted by
+// ParseCostFunction.
+const char* GetCostFunctionName(CostFunction cost_function);
+
+// Returns the number of instructions inside the functions of the given
+// SPIR-V module, from OpFunction to OpFunctionEnd.
+uint64_t CountFunctionInstructions(const std::vector<uint32_t>& module);
+
+// A pass pipeline, as spirv-opt command line flags, and its cost.
+struct Candidate {
+  std::vector<std::string> flags;
+  double cost = 0;
+};
+
+// Returns a copy of flags changed in one random way: a pass is removed,
+// repeated, moved, or replaced by one from pool, or the numeric argument of a
+// pass such as "--scalar-replacement=100" is halved or doubled.  If pool is
+// empty, passes are drawn from flags instead.  The result is empty only if
+// both are.
+std::vector<std::string> Mutate(const std::vector<std::string>& flags,
+                                const std::vector<std::string>& pool,
+                                std::mt19937* random);
+
+// Searches for the pass pipeline that minimizes a cost function over a corpus
+// of unoptimized SPIR-V modules.
+class Tuner {
+ public:
+  Tuner(shaderc_util::Compiler::TargetEnv env,
+        shaderc_util::Compiler::TargetEnvVersion version,
+        std::vector<std::vector<uint32_t>> corpus, CostFunction cost_function,
+        size_t num_threads)
+      : env_(env),
+        version_(version),
+        corpus_(std::move(corpus)),
+        cost_function_(cost_function),
+        num_threads_(num_threads) {}
+
+  // Runs the given pipelines over the corpus, in parallel, and writes the
+  // cost of each into *costs.  A pipeline that fails on any module, or
+  // produces an invalid module, gets an infinite cost.
+  void Evaluate(const std::vector<std::vector<std::string>>& pipelines,
+                std::vector<double>* costs) const;
+
+  // Starts from the cheapest of seeds and evaluates mutations of the best
+  // pipeline found so far, several at a time, until budget pipelines,
+  // including the seeds, have been evaluated.  A mutation is kept if it
+  // costs no more than the best, so that the search can cross plateaus.  The
+  // passes of the seeds make up the pool that mutations draw from.  Each
+  // improvement is reported on log.  Returns the best pipeline, and writes
+  // the cheapest seed to *start.  If every seed fails, both have an infinite
+  // cost.
+  Candidate Tune(const std::vector<std::vector<std::string>>& seeds,
+                 size_t budget, uint32_t random_seed, std::ostream* log,
+                 Candidate* start) const;
+
+ private:
+  // Optimizes one module with the given pipeline.  Returns false if the
+  // optimizer fails or its output is invalid.
+  bool CostOf(const std::vector<std::string>& flags,
+              const std::vector<uint32_t>& module, double* cost) const;
+
+  shaderc_util::Compiler::TargetEnv env_;
+  shaderc_util::Compiler::TargetEnvVersion version_;
+  std::vector<std::vector<uint32_t>> corpus_;
+  CostFunction cost_function_;
+  size_t num_threads_;
+};
+
+// Returns the text of a pass-list file for the given pipeline, which
+// -Xspirv-opt-file and shaderc_compile_options_set_optimizer_pass_list
+// accept.  It starts with comments giving its cost and, for comparison, the
+// cost of the pipeline the search started from.
+std::string FormatPassList(const Candidate& best, const Candidate& start,
+                           CostFunction cost_function, size_t corpus_size);
+
+}  // namespace opt_tune
+
+#endif  // OPT_TUNE_TUNER_H
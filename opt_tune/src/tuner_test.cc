@@ -0,0 +1,181 @@
+// Copyright 2025 The Shaderc Authors. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tuner.h"
+
+#include <gmock/gmock.h>
+
+#include <limits>
+#include <sstream>
+
+#include "libshaderc_util/spirv_tools_wrapper.h"
+
+namespace {
+
+using opt_tune::CostFunction;
+using opt_tune::Tuner;
+using shaderc_util::Compiler;
+using testing::HasSubstr;
+
+// A vertex shader whose main function calls a helper, and which stores a
+// value computed from constants, so that the optimizer has work to do.
+const char kShaderAssembly[] = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Vertex %main "main" %out
+               OpDecorate %out Location 0
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+      %float = OpTypeFloat 32
+   %float_fn = OpTypeFunction %float
+    %ptr_out = OpTypePointer Output %float
+   %ptr_func = OpTypePointer Function %float
+        %out = OpVariable %ptr_out Output
+    %float_1 = OpConstant %float 1
+    %float_2 = OpConstant %float 2
+     %helper = OpFunction %float None %float_fn
+         %10 = OpLabel
+        %sum = OpFAdd %float %float_1 %float_2
+               OpReturnValue %sum
+               OpFunctionEnd
+       %main = OpFunction %void None %fn
+         %20 = OpLabel
+        %var = OpVariable %ptr_func Function
+     %called = OpFunctionCall %float %helper
+               OpStore %var %called
+     %loaded = OpLoad %float %var
+               OpStore %out %loaded
+               OpReturn
+               OpFunctionEnd
+)";
+
+std::vector<uint32_t> Assemble(const char* assembly) {
+  spv_binary binary = nullptr;
+  std::string errors;
+  EXPECT_TRUE(shaderc_util::SpirvToolsAssemble(
+      Compiler::TargetEnv::Vulkan, Compiler::TargetEnvVersion::Vulkan_1_0,
+      assembly, &binary, &errors))
+      << errors;
+  std::vector<uint32_t> words;
+  if (binary) {
+    words.assign(binary->code, binary->code + binary->wordCount);
+    spvBinaryDestroy(binary);
+  }
+  return words;
+}
+
+TEST(CostFunction, ParsesNames) {
+  CostFunction cost_function = CostFunction::Size;
+  EXPECT_TRUE(opt_tune::ParseCostFunction("instructions", &cost_function));
+  EXPECT_EQ(CostFunction::Instructions, cost_function);
+  EXPECT_TRUE(opt_tune::ParseCostFunction("time", &cost_function));
+  EXPECT_EQ(CostFunction::CompileTime, cost_function);
+  EXPECT_TRUE(opt_tune::ParseCostFunction("size", &cost_function));
+  EXPECT_EQ(CostFunction::Size, cost_function);
+  EXPECT_FALSE(opt_tune::ParseCostFunction("speed", &cost_function));
+  EXPECT_EQ(std::string("size"), opt_tune::GetCostFunctionName(cost_function));
+}
+
+TEST(CountFunctionInstructions, CountsOnlyFunctionBodies) {
+  // Two labels, the OpFAdd, the OpReturnValue, and the six instructions of
+  // main after its label.
+  EXPECT_EQ(10u,
+            opt_tune::CountFunctionInstructions(Assemble(kShaderAssembly)));
+}
+
+TEST(Mutate, NeverEmptiesAPipeline) {
+  std::mt19937 random(7);
+  std::vector<std::string> flags = {"--ccp"};
+  for (int i = 0; i < 100; ++i) {
+    flags = opt_tune::Mutate(flags, {"--ccp", "--merge-blocks"}, &random);
+    ASSERT_FALSE(flags.empty());
+  }
+}
+
+TEST(Mutate, ChangesNumericArguments) {
+  std::mt19937 random(1);
+  bool changed = false;
+  for (int i = 0; i < 100 && !changed; ++i) {
+    const auto flags =
+        opt_tune::Mutate({"--scalar-replacement=100"}, {}, &random);
+    for (const auto& flag : flags) {
+      EXPECT_THAT(flag, HasSubstr("--scalar-replacement="));
+      if (flag == "--scalar-replacement=50" ||
+          flag == "--scalar-replacement=200") {
+        changed = true;
+      }
+    }
+  }
+  EXPECT_TRUE(changed);
+}
+
+TEST(Mutate, IsRepeatableWithTheSameSeed) {
+  const std::vector<std::string> flags = {"--ccp", "--merge-blocks",
+                                          "--scalar-replacement=8"};
+  const std::vector<std::string> pool = {"--ssa-rewrite", "--vector-dce"};
+  std::mt19937 first(42);
+  std::mt19937 second(42);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(opt_tune::Mutate(flags, pool, &first),
+              opt_tune::Mutate(flags, pool, &second));
+  }
+}
+
+TEST(Tuner, EvaluatesPipelinesOverTheCorpus) {
+  const std::vector<uint32_t> module = Assemble(kShaderAssembly);
+  const Tuner tuner(Compiler::TargetEnv::Vulkan,
+                    Compiler::TargetEnvVersion::Vulkan_1_0, {module, module},
+                    CostFunction::Size, 2);
+  std::vector<double> costs;
+  tuner.Evaluate({{}, {"-O"}, {"--no-such-pass"}}, &costs);
+  ASSERT_EQ(3u, costs.size());
+  EXPECT_EQ(2.0 * module.size() * sizeof(uint32_t), costs[0]);
+  EXPECT_LT(costs[1], costs[0]);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), costs[2]);
+}
+
+TEST(Tuner, NeverEndsWorseThanTheBestSeed) {
+  const Tuner tuner(Compiler::TargetEnv::Vulkan,
+                    Compiler::TargetEnvVersion::Vulkan_1_0,
+                    {Assemble(kShaderAssembly)}, CostFunction::Instructions,
+                    2);
+  const std::vector<std::vector<std::string>> seeds = {
+      {"--eliminate-dead-functions"},
+      shaderc_util::SpirvToolsGetPassFlags(
+          shaderc_util::PassId::kPerformancePasses)};
+  std::ostringstream log;
+  opt_tune::Candidate start;
+  const opt_tune::Candidate best = tuner.Tune(seeds, 12, 3, &log, &start);
+  EXPECT_EQ(seeds[1], start.flags);
+  EXPECT_LE(best.cost, start.cost);
+  EXPECT_THAT(log.str(), HasSubstr("start: "));
+
+  const std::string pass_list =
+      opt_tune::FormatPassList(best, start, CostFunction::Instructions, 1);
+  EXPECT_THAT(pass_list, HasSubstr("# Cost (instructions): "));
+  EXPECT_EQ(best.flags, shaderc_util::ParseSpirvOptPassList(pass_list));
+}
+
+TEST(SpirvToolsGetPassFlags, GivesValidFlagsForRecipes) {
+  std::string errors;
+  for (const auto pass : {shaderc_util::PassId::kPerformancePasses,
+                          shaderc_util::PassId::kSizePasses}) {
+    const auto flags = shaderc_util::SpirvToolsGetPassFlags(pass);
+    EXPECT_FALSE(flags.empty());
+    EXPECT_TRUE(shaderc_util::SpirvToolsValidatePassFlags(flags, &errors))
+        << errors;
+  }
+}
+
+}  // anonymous namespace
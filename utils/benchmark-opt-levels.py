@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+
+# Copyright 2025 The Shaderc Authors. All rights reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Compares glslc's optimization levels on a set of shaders: the time taken to
+compile each one, and the size and number of function instructions of the
+module produced.  Without shader arguments, a few built-in shaders are used.
+"""
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+LEVELS = ['-O0', '-Ofast-compile', '-O', '-Os']
+
+# Small but typical shaders: straight-line code, a loop over a helper
+# function, and a compute shader with several functions and branches.
+BUILTIN_SHADERS = {
+    'tonemap.frag': '''#version 450
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 color;
+layout(binding = 0) uniform sampler2D hdr;
+layout(binding = 1) uniform Params { float exposure; float gamma; };
+void main() {
+  vec3 c = texture(hdr, uv).rgb * exposure;
+  c = c / (c + vec3(1.0));
+  color = vec4(pow(c, vec3(1.0 / gamma)), 1.0);
+}
+''',
+    'blur.frag': '''#version 450
+layout(location = 0) in vec2 uv;
+layout(location = 0) out vec4 color;
+layout(binding = 0) uniform sampler2D image;
+const float weights[5] = float[](0.227, 0.194, 0.121, 0.054, 0.016);
+vec4 tap(vec2 offset, float weight) {
+  return texture(image, uv + offset) * weight;
+}
+void main() {
+  vec2 texel = 1.0 / vec2(textureSize(image, 0));
+  vec4 sum = tap(vec2(0.0), weights[0]);
+  for (int i = 1; i < 5; ++i) {
+    sum += tap(vec2(texel.x * i, 0.0), weights[i]);
+    sum += tap(vec2(-texel.x * i, 0.0), weights[i]);
+  }
+  color = sum;
+}
+''',
+    'particles.comp': '''#version 450
+layout(local_size_x = 64) in;
+struct Particle { vec4 position; vec4 velocity; };
+layout(std430, binding = 0) buffer Particles { Particle particles[]; };
+layout(binding = 1) uniform Step { float dt; vec4 gravity; uint count; };
+vec3 bounce(vec3 v, vec3 p) {
+  if (p.y < 0.0) v.y = abs(v.y) * 0.8;
+  return v;
+}
+vec3 drag(vec3 v) { return v * (1.0 - 0.01 * length(v)); }
+void main() {
+  uint i = gl_GlobalInvocationID.x;
+  if (i >= count) return;
+  Particle p = particles[i];
+  vec3 v = drag(p.velocity.xyz + gravity.xyz * dt);
+  vec3 x = p.position.xyz + v * dt;
+  v = bounce(v, x);
+  particles[i].position = vec4(max(x, vec3(-100.0)), p.position.w);
+  particles[i].velocity = vec4(v, p.velocity.w);
+}
+''',
+}
+
+
+def compile_shader(glslc, level, shader, output):
+    """Compiles shader at level to output, and returns the seconds taken."""
+    start = time.perf_counter()
+    subprocess.run([glslc, level, '-c', shader, '-o', output], check=True)
+    return time.perf_counter() - start
+
+
+def count_function_instructions(glslc, level, shader):
+    """Returns the number of instructions in the function bodies of the
+    module compiled from shader at level."""
+    assembly = subprocess.run([glslc, level, '-S', shader, '-o', '-'],
+                              check=True, stdout=subprocess.PIPE,
+                              universal_newlines=True).stdout
+    count = 0
+    in_function = False
+    for line in assembly.splitlines():
+        words = line.split()
+        if not words or words[0].startswith(';'):
+            continue
+        opcode = words[2] if len(words) > 2 and words[1] == '=' else words[0]
+        if opcode == 'OpFunction':
+            in_function = True
+        elif opcode == 'OpFunctionEnd':
+            in_function = False
+        elif in_function:
+            count += 1
+    return count
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--glslc', default='glslc', help='glslc to run')
+    parser.add_argument('--runs', type=int, default=10,
+                        help='compiles per shader and level; the median '
+                        'time is reported')
+    parser.add_argument('shaders', nargs='*', help='shaders to compile')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as directory:
+        shaders = args.shaders
+        if not shaders:
+            for name, source in sorted(BUILTIN_SHADERS.items()):
+                shaders.append(os.path.join(directory, name))
+                with open(shaders[-1], 'w') as shader_file:
+                    shader_file.write(source)
+        output = os.path.join(directory, 'out.spv')
+
+        print('{:<20} {:<15} {:>10} {:>8} {:>13}'.format(
+            'shader', 'level', 'time (ms)', 'bytes', 'instructions'))
+        for shader in shaders:
+            for level in LEVELS:
+                # The first compile warms up caches, and is not counted.
+                compile_shader(args.glslc, level, shader, output)
+                seconds = statistics.median(
+                    compile_shader(args.glslc, level, shader, output)
+                    for _ in range(args.runs))
+                print('{:<20} {:<15} {:>10.2f} {:>8} {:>13}'.format(
+                    os.path.basename(shader), level, seconds * 1000,
+                    os.path.getsize(output),
+                    count_function_instructions(args.glslc, level, shader)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())